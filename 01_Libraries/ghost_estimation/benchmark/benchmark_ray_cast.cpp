@@ -0,0 +1,130 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ghost_estimation/vector_map/range_table.hpp"
+#include "ghost_estimation/vector_map/segment_batch.hpp"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+
+constexpr int NUM_RAYS = 1024;
+constexpr float RANGE_MAX = 5.0;
+
+/**
+ * @brief Builds a 10m square field with num_lines random obstacle segments up to 1m long inside it.
+ */
+static vector_map::VectorMap makeMap(int num_lines)
+{
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> pos_dist(-5.0, 5.0);
+  std::uniform_real_distribution<float> offset_dist(-0.5, 0.5);
+  std::vector<Line2f> lines;
+  for (int i = 0; i < num_lines; i++) {
+    Vector2f p0(pos_dist(rng), pos_dist(rng));
+    lines.push_back(Line2f(p0, p0 + Vector2f(offset_dist(rng), offset_dist(rng))));
+  }
+  return vector_map::VectorMap(lines);
+}
+
+/**
+ * @brief Random ray origins inside the field with evenly spread unit directions.
+ */
+struct Rays
+{
+  Rays()
+  {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos_dist(-5.0, 5.0);
+    for (int i = 0; i < NUM_RAYS; i++) {
+      float angle = 2.0 * M_PI * i / NUM_RAYS;
+      origins.push_back(Vector2f(pos_dist(rng), pos_dist(rng)));
+      angles.push_back(angle);
+      directions.push_back(Vector2f(cos(angle), sin(angle)));
+    }
+  }
+  std::vector<Vector2f> origins;
+  std::vector<float> angles;
+  std::vector<Vector2f> directions;
+};
+
+static void registerLineCounts(benchmark::internal::Benchmark * b)
+{
+  for (int num_lines : {4, 16, 64, 256, 1024}) {
+    b->Arg(num_lines);
+  }
+}
+
+// One Line2f intersection at a time over every segment
+static void BM_ScalarRayCast(benchmark::State & state)
+{
+  auto map = makeMap(state.range(0));
+  Rays rays;
+  for (auto _ : state) {
+    for (int i = 0; i < NUM_RAYS; i++) {
+      benchmark::DoNotOptimize(
+        vector_map::RangeTable::castRay(map.lines, rays.origins[i], rays.angles[i], RANGE_MAX));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_RAYS);
+}
+
+// SIMD_WIDTH segments per instruction over every segment
+static void BM_SimdRayCast(benchmark::State & state)
+{
+  auto map = makeMap(state.range(0));
+  vector_map::SegmentBatch segments;
+  segments.assign(map.lines);
+  Rays rays;
+  for (auto _ : state) {
+    for (int i = 0; i < NUM_RAYS; i++) {
+      benchmark::DoNotOptimize(segments.castRay(rays.origins[i], rays.directions[i], RANGE_MAX));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_RAYS);
+}
+
+// Only the segments in grid cells along the ray
+static void BM_GridRayCast(benchmark::State & state)
+{
+  auto map = makeMap(state.range(0));
+  Rays rays;
+  for (auto _ : state) {
+    for (int i = 0; i < NUM_RAYS; i++) {
+      Vector2f ray_end = rays.origins[i] + RANGE_MAX * rays.directions[i];
+      benchmark::DoNotOptimize(map.GetRayIntersection(rays.origins[i], &ray_end));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_RAYS);
+}
+
+BENCHMARK(BM_ScalarRayCast)->Apply(registerLineCounts);
+BENCHMARK(BM_SimdRayCast)->Apply(registerLineCounts);
+BENCHMARK(BM_GridRayCast)->Apply(registerLineCounts);
+
+BENCHMARK_MAIN();
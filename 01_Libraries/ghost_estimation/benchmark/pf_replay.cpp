@@ -0,0 +1,391 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+#include "ghost_estimation/particle_filter/particle_filter.hpp"
+#include "ghost_estimation/particle_filter/replay_log.hpp"
+#include "ghost_util/angle_util.hpp"
+
+/**
+ * Replays a recorded log through the particle filter offline, as fast as it will run, and reports
+ * accuracy against ground truth alongside the time spent in each filter stage. Each particle count
+ * is replayed with several random seeds, so the error vs particle count curve shows the spread
+ * between runs.
+ *
+ * The filter is configured from the particle_filter parameters of a ROS parameter file, the same
+ * ones the localization nodes read, and starts at the first ground truth pose if the log has one.
+ * Pose estimates are taken after every scan and compared with ground truth interpolated to the scan
+ * stamp. Record logs with pf_log_recorder from ghost_localization.
+ *
+ * Usage: pf_replay <log_file> <config_yaml> [particle_counts=50,100,200,500,1000] [runs=3]
+ *   [csv_file]
+ */
+
+using Eigen::Vector2f;
+using particle_filter::ParticleFilter;
+using particle_filter::ParticleFilterConfig;
+using particle_filter::ReplayEvent;
+
+namespace
+{
+
+// Results of replaying the log once.
+struct RunResult
+{
+  int num_particles = 0;
+  unsigned int seed = 0;
+  double mean_particles = 0.0;     // Differs from num_particles under KLD-sampling
+  double ate_rmse = 0.0;           // Position error RMSE (m)
+  double ate_max = 0.0;
+  double heading_rmse = 0.0;       // rad
+  int num_poses = 0;
+  int num_updates = 0;
+  double predict_us = 0.0;         // Mean per odometry message
+  double preprocess_ms = 0.0;      // Means per laser update
+  double weights_ms = 0.0;
+  double resample_ms = 0.0;
+  double total_s = 0.0;            // Wall time for the whole replay
+};
+
+template<typename T>
+T getParam(const YAML::Node & params, const std::string & key, const T & default_value)
+{
+  return params[key] ? params[key].as<T>() : default_value;
+}
+
+// Mirrors the parameter names and defaults of EkfPfNode::LoadROSParams.
+ParticleFilterConfig loadConfig(const std::string & file)
+{
+  YAML::Node root = YAML::LoadFile(file);
+  YAML::Node params;
+  for (const auto & node : root) {
+    if (node.second["ros__parameters"] && node.second["ros__parameters"]["particle_filter"]) {
+      params = node.second["ros__parameters"]["particle_filter"];
+      break;
+    }
+  }
+  if (!params) {
+    throw std::runtime_error("[loadConfig] Error: no particle_filter parameters in " + file + ".");
+  }
+
+  ParticleFilterConfig config;
+  config.world_frame = getParam<std::string>(params, "world_frame", "");
+  config.map = getParam<std::string>(params, "map", "");
+  config.init_x = getParam(params, "init_x", 0.0);
+  config.init_y = getParam(params, "init_y", 0.0);
+  config.init_r = getParam(params, "init_r", 0.0);
+  config.resample_frequency = getParam(params, "resample_frequency", 1);
+  config.init_x_sigma = getParam(params, "init_x_sigma", 0.0);
+  config.init_y_sigma = getParam(params, "init_y_sigma", 0.0);
+  config.init_r_sigma = getParam(params, "init_r_sigma", 0.0);
+  config.k1 = getParam(params, "k1", 0.0);
+  config.k2 = getParam(params, "k2", 0.0);
+  config.k3 = getParam(params, "k3", 0.0);
+  config.k4 = getParam(params, "k4", 0.0);
+  config.k5 = getParam(params, "k5", 0.0);
+  config.k6 = getParam(params, "k6", 0.0);
+  config.k7 = getParam(params, "k7", 0.0);
+  config.k8 = getParam(params, "k8", 0.0);
+  config.k9 = getParam(params, "k9", 0.0);
+  config.laser_offset_x = getParam(params, "laser_offset_x", 0.0);
+  config.laser_offset_y = getParam(params, "laser_offset_y", 0.0);
+  config.laser_angle_offset = getParam(params, "laser_angle_offset", 0.0);
+  config.min_update_dist = getParam(params, "min_update_dist", 0.0);
+  config.min_update_angle = getParam(params, "min_update_angle", 0.0);
+  config.max_update_angular_velocity = getParam(params, "max_update_angular_velocity", 0.0);
+  config.sigma_observation = getParam(params, "sigma_observation", 0.0);
+  config.gamma = getParam(params, "gamma", 0.0);
+  config.dist_short = getParam(params, "dist_short", 0.0);
+  config.dist_long = getParam(params, "dist_long", 0.0);
+  config.range_min = getParam(params, "range_min", 0.0);
+  config.range_max = getParam(params, "range_max", 0.0);
+  config.resize_factor = getParam(params, "resize_factor", 0.0);
+  config.num_particles = getParam(params, "num_particles", 50);
+  config.use_skip_range = getParam(params, "use_skip_range", false);
+  config.skip_index_min = getParam(params, "skip_index_min", 0);
+  config.skip_index_max = getParam(params, "skip_index_max", 0);
+  config.scan_mask_angles = getParam(params, "scan_mask_angles", std::vector<double>{});
+  config.max_beams = getParam(params, "max_beams", 0);
+  config.num_threads = getParam(params, "num_threads", 0);
+  config.observation_model = getParam<std::string>(params, "observation_model", "ray_cast");
+  config.likelihood_field_resolution = getParam(params, "likelihood_field_resolution", 0.02);
+  config.range_table_xy_resolution = getParam(params, "range_table_xy_resolution", 0.05);
+  config.range_table_num_angles = getParam(params, "range_table_num_angles", 360);
+  config.range_table_interpolate = getParam(params, "range_table_interpolate", false);
+  config.map_cache_dir = getParam<std::string>(params, "map_cache_dir", "");
+  config.kld_sampling = getParam(params, "kld_sampling", false);
+  config.kld_min_particles = getParam(params, "kld_min_particles", 50);
+  config.kld_max_particles = getParam(params, "kld_max_particles", 2000);
+  config.kld_epsilon = getParam(params, "kld_epsilon", 0.05);
+  config.kld_z = getParam(params, "kld_z", 2.33);
+  config.kld_bin_size_xy = getParam(params, "kld_bin_size_xy", 0.1);
+  config.kld_bin_size_theta = getParam(params, "kld_bin_size_theta", 0.1745);
+  config.global_loc_particles = getParam(params, "global_loc_particles", 20000);
+  config.global_loc_xy_resolution = getParam(params, "global_loc_xy_resolution", 0.1);
+  config.global_loc_clearance = getParam(params, "global_loc_clearance", 0.1);
+  config.augmented_mcl = getParam(params, "augmented_mcl", false);
+  config.recovery_alpha_slow = getParam(params, "recovery_alpha_slow", 0.001);
+  config.recovery_alpha_fast = getParam(params, "recovery_alpha_fast", 0.1);
+  config.recovery_max_inject_ratio = getParam(params, "recovery_max_inject_ratio", 0.25);
+  return config;
+}
+
+// Ground truth at stamp, linearly interpolated between the surrounding poses. Returns false outside
+// the ground truth time span or across gaps longer than max_gap.
+bool interpolateGroundTruth(
+  const std::vector<ReplayEvent> & truth, double stamp, double max_gap,
+  Vector2f * loc, float * angle)
+{
+  auto upper = std::lower_bound(
+    truth.begin(), truth.end(), stamp,
+    [](const ReplayEvent & event, double t) {return event.stamp < t;});
+  if ((upper == truth.begin()) || (upper == truth.end())) {
+    return false;
+  }
+  const ReplayEvent & b = *upper;
+  const ReplayEvent & a = *(upper - 1);
+  if (b.stamp - a.stamp > max_gap) {
+    return false;
+  }
+  float t = (b.stamp > a.stamp) ? (stamp - a.stamp) / (b.stamp - a.stamp) : 0.0;
+  *loc = Vector2f(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+  *angle = a.theta + t * ghost_util::SmallestAngleDistRad(b.theta, a.theta);
+  return true;
+}
+
+double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+RunResult replay(
+  const std::vector<ReplayEvent> & events, const std::vector<ReplayEvent> & truth,
+  ParticleFilterConfig config)
+{
+  RunResult result;
+  result.num_particles = config.kld_sampling ? config.kld_max_particles : config.num_particles;
+  result.seed = config.random_seed;
+
+  Vector2f init_loc(config.init_x, config.init_y);
+  float init_angle = config.init_r;
+  if (!truth.empty()) {
+    init_loc = Vector2f(truth.front().x, truth.front().y);
+    init_angle = truth.front().theta;
+  }
+  ParticleFilter particle_filter(config);
+  particle_filter.Initialize(config.map, init_loc, init_angle);
+
+  double sum_sq_error = 0.0;
+  double sum_sq_heading = 0.0;
+  double sum_particles = 0.0;
+  int num_odometry = 0;
+  auto replay_start = std::chrono::steady_clock::now();
+  for (const ReplayEvent & event : events) {
+    if (event.type == ReplayEvent::ODOMETRY) {
+      particle_filter.setAngularVelocity(event.angular_velocity);
+      auto start = std::chrono::steady_clock::now();
+      particle_filter.Predict(Vector2f(event.x, event.y), event.theta);
+      result.predict_us += 1e6 * elapsedSeconds(start);
+      num_odometry++;
+    } else if (event.type == ReplayEvent::SCAN) {
+      particle_filter.ObserveLaser(
+        event.ranges, event.range_min, event.range_max,
+        event.angle_min + config.laser_angle_offset, event.angle_max + config.laser_angle_offset);
+      const auto & timings = particle_filter.GetLastUpdateTimings();
+      if (timings.updated) {
+        result.preprocess_ms += timings.preprocess_ms;
+        result.weights_ms += timings.weights_ms;
+        result.resample_ms += timings.resample_ms;
+        result.num_updates++;
+      }
+
+      Vector2f truth_loc;
+      float truth_angle;
+      if (interpolateGroundTruth(truth, event.stamp, 0.1, &truth_loc, &truth_angle)) {
+        Vector2f loc(0, 0);
+        float angle = 0;
+        std::array<double, 36> covariance;
+        particle_filter.GetLocation(&loc, &angle, &covariance);
+        double error = (loc - truth_loc).norm();
+        double heading_error = ghost_util::SmallestAngleDistRad(angle, truth_angle);
+        sum_sq_error += error * error;
+        sum_sq_heading += heading_error * heading_error;
+        result.ate_max = std::max(result.ate_max, error);
+        sum_particles += particle_filter.GetNumParticles();
+        result.num_poses++;
+      }
+    }
+  }
+  result.total_s = elapsedSeconds(replay_start);
+
+  if (result.num_poses > 0) {
+    result.ate_rmse = std::sqrt(sum_sq_error / result.num_poses);
+    result.heading_rmse = std::sqrt(sum_sq_heading / result.num_poses);
+    result.mean_particles = sum_particles / result.num_poses;
+  }
+  if (num_odometry > 0) {
+    result.predict_us /= num_odometry;
+  }
+  if (result.num_updates > 0) {
+    result.preprocess_ms /= result.num_updates;
+    result.weights_ms /= result.num_updates;
+    result.resample_ms /= result.num_updates;
+  }
+  return result;
+}
+
+double mean(const std::vector<double> & values)
+{
+  double sum = 0.0;
+  for (double value : values) {
+    sum += value;
+  }
+  return values.empty() ? 0.0 : sum / values.size();
+}
+
+double stddev(const std::vector<double> & values)
+{
+  double m = mean(values);
+  double sum_sq = 0.0;
+  for (double value : values) {
+    sum_sq += (value - m) * (value - m);
+  }
+  return (values.size() < 2) ? 0.0 : std::sqrt(sum_sq / (values.size() - 1));
+}
+
+std::vector<int> parseCounts(const std::string & list)
+{
+  std::vector<int> counts;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    counts.push_back(std::atoi(item.c_str()));
+  }
+  return counts;
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if (argc < 3) {
+    printf(
+      "Usage: %s <log_file> <config_yaml> [particle_counts=50,100,200,500,1000] [runs=3] "
+      "[csv_file]\n", argv[0]);
+    return 1;
+  }
+  std::vector<ReplayEvent> events = particle_filter::readReplayLog(argv[1]);
+  ParticleFilterConfig base_config = loadConfig(argv[2]);
+  std::vector<int> counts = parseCounts((argc > 3) ? argv[3] : "50,100,200,500,1000");
+  int runs = (argc > 4) ? std::max(1, atoi(argv[4])) : 3;
+  FILE * csv = (argc > 5) ? fopen(argv[5], "w") : nullptr;
+
+  std::vector<ReplayEvent> truth;
+  int num_scans = 0;
+  for (const ReplayEvent & event : events) {
+    if (event.type == ReplayEvent::GROUND_TRUTH) {
+      truth.push_back(event);
+    } else if (event.type == ReplayEvent::SCAN) {
+      num_scans++;
+    }
+  }
+  std::stable_sort(
+    truth.begin(), truth.end(),
+    [](const ReplayEvent & a, const ReplayEvent & b) {return a.stamp < b.stamp;});
+  double duration = events.empty() ? 0.0 : events.back().stamp - events.front().stamp;
+  if (truth.empty()) {
+    printf("Warning: log has no ground truth, only timings are reported\n");
+  }
+
+  std::vector<RunResult> results;
+  for (int count : counts) {
+    for (int run = 0; run < runs; run++) {
+      ParticleFilterConfig config = base_config;
+      if (config.kld_sampling) {
+        config.kld_max_particles = count;
+        config.kld_min_particles = std::min(config.kld_min_particles, count);
+      } else {
+        config.num_particles = count;
+      }
+      config.random_seed = run;
+      results.push_back(replay(events, truth, config));
+    }
+  }
+
+  printf(
+    "\nLog %s: %zu events, %d scans, %zu ground truth poses, %.1f s, observation model %s%s\n",
+    argv[1], events.size(), num_scans, truth.size(), duration,
+    base_config.observation_model.c_str(), base_config.kld_sampling ? ", KLD-sampling" : "");
+  printf(
+    "%9s %9s | %-17s %9s %9s | %9s %9s %9s %9s | %8s\n", "particles", "mean used",
+    "ATE rmse (m)", "max (m)", "yaw (deg)", "pred (us)", "prep (ms)", "wts (ms)", "res (ms)",
+    "x rt");
+  for (std::size_t i = 0; i < results.size(); i += runs) {
+    std::vector<double> ate, ate_max, heading, used, predict, preprocess, weights, resample, total;
+    for (int run = 0; run < runs; run++) {
+      const RunResult & r = results[i + run];
+      ate.push_back(r.ate_rmse);
+      ate_max.push_back(r.ate_max);
+      heading.push_back(r.heading_rmse * 180.0 / M_PI);
+      used.push_back(r.mean_particles);
+      predict.push_back(r.predict_us);
+      preprocess.push_back(r.preprocess_ms);
+      weights.push_back(r.weights_ms);
+      resample.push_back(r.resample_ms);
+      total.push_back(r.total_s);
+    }
+    printf(
+      "%9d %9.0f | %8.4f +-%6.4f %9.4f %9.3f | %9.1f %9.3f %9.3f %9.3f | %8.1f\n",
+      results[i].num_particles, mean(used), mean(ate), stddev(ate), mean(ate_max), mean(heading),
+      mean(predict), mean(preprocess), mean(weights), mean(resample),
+      (mean(total) > 0.0) ? duration / mean(total) : 0.0);
+  }
+
+  if (csv != nullptr) {
+    fprintf(
+      csv, "particles,seed,mean_particles,ate_rmse,ate_max,heading_rmse,poses,updates,predict_us,"
+      "preprocess_ms,weights_ms,resample_ms,total_s\n");
+    for (const RunResult & r : results) {
+      fprintf(
+        csv, "%d,%u,%.1f,%.6f,%.6f,%.6f,%d,%d,%.3f,%.4f,%.4f,%.4f,%.4f\n", r.num_particles, r.seed,
+        r.mean_particles, r.ate_rmse, r.ate_max, r.heading_rmse, r.num_poses, r.num_updates,
+        r.predict_us, r.preprocess_ms, r.weights_ms, r.resample_ms, r.total_s);
+    }
+    fclose(csv);
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace particle_filter
+{
+
+/**
+ * @brief Generates standard normal samples in batches with a counter-based generator.
+ *
+ * Sample k of a request is a pure function of (seed, counter + k / 2): each counter value is hashed
+ * into a pair of uniforms and turned into two normals with the Box-Muller transform, SIMD_WIDTH
+ * pairs at a time. Any split of a request into chunks starting at even offsets therefore produces
+ * the same samples, whichever thread fills each chunk.
+ */
+class GaussianBatch
+{
+public:
+  explicit GaussianBatch(uint64_t seed = 0)
+  : seed_(seed) {}
+
+  /**
+   * @brief Fills out with n standard normal samples and advances the counter past them.
+   */
+  void generate(float * out, std::size_t n)
+  {
+    generate(counter_, out, n);
+    counter_ += (n + 1) / 2;
+  }
+
+  /**
+   * @brief Fills out with the n standard normal samples starting at counter, without advancing the
+   * generator.
+   */
+  void generate(uint64_t counter, float * out, std::size_t n) const;
+
+  uint64_t getCounter() const
+  {
+    return counter_;
+  }
+
+  void setCounter(uint64_t counter)
+  {
+    counter_ = counter;
+  }
+
+private:
+  uint64_t seed_;
+  uint64_t counter_ = 0;
+};
+
+} // namespace particle_filter
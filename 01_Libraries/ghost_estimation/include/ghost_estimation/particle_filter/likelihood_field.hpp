@@ -0,0 +1,145 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+
+namespace particle_filter
+{
+
+/**
+ * @brief Grid of distances from each cell to the nearest map line, used to score laser beams by
+ * looking up their endpoints instead of ray-casting them against the map.
+ *
+ * Lines are rasterized into the grid and an exact Euclidean distance transform is run over it
+ * (Felzenszwalb & Huttenlocher), so distances are accurate to about one cell. Because the field map
+ * is static, the grid can be cached to disk and reloaded as long as the map hash matches.
+ */
+class LikelihoodField
+{
+public:
+  LikelihoodField() = default;
+
+  /**
+   * @brief Builds the distance grid covering the map plus padding on each side.
+   *
+   * @param map vector map to build from
+   * @param resolution cell size in meters
+   * @param padding distance in meters to extend the grid past the map bounds
+   */
+  void build(const vector_map::VectorMap & map, float resolution, float padding);
+
+  /**
+   * @brief Loads the grid from cache_file if it was built from the same map and settings, otherwise
+   * builds it and attempts to write cache_file. An empty cache_file disables caching. Does nothing
+   * if the current grid already matches.
+   *
+   * @return true if no rebuild was needed
+   */
+  bool loadOrBuild(
+    const vector_map::VectorMap & map, float resolution, float padding,
+    const std::string & cache_file);
+
+  /**
+   * @brief Writes the grid to a binary file.
+   *
+   * @return true on success
+   */
+  bool save(const std::string & file) const;
+
+  /**
+   * @brief Reads a grid from a binary file written by save.
+   *
+   * @param expected_hash hash of the map and settings the grid must have been built from
+   * @return true if the file was read and its hash matched
+   */
+  bool load(const std::string & file, uint64_t expected_hash);
+
+  /**
+   * @brief Hashes the map lines together with the grid settings, used to key cache files.
+   */
+  static uint64_t hashMap(const vector_map::VectorMap & map, float resolution, float padding);
+
+  /**
+   * @brief Returns the distance in meters from point to the nearest map line, or max_distance if
+   * point lies outside the grid.
+   */
+  float getDistance(const Eigen::Vector2f & point, float max_distance) const
+  {
+    int col = static_cast<int>((point.x() - origin_.x()) * inv_resolution_);
+    int row = static_cast<int>((point.y() - origin_.y()) * inv_resolution_);
+    if ((point.x() < origin_.x()) || (point.y() < origin_.y()) || (col >= width_) ||
+      (row >= height_))
+    {
+      return max_distance;
+    }
+    return std::min(distances_[row * width_ + col], max_distance);
+  }
+
+  bool empty() const
+  {
+    return distances_.empty();
+  }
+
+  int getWidth() const
+  {
+    return width_;
+  }
+
+  int getHeight() const
+  {
+    return height_;
+  }
+
+  float getResolution() const
+  {
+    return resolution_;
+  }
+
+  uint64_t getHash() const
+  {
+    return hash_;
+  }
+
+private:
+  // Bottom-left corner of cell (0, 0) in the map frame
+  Eigen::Vector2f origin_{0.0, 0.0};
+  float resolution_ = 0.0;
+  float inv_resolution_ = 0.0;
+  int width_ = 0;
+  int height_ = 0;
+  uint64_t hash_ = 0;
+
+  // Row-major distances in meters
+  std::vector<float> distances_;
+};
+
+} // namespace particle_filter
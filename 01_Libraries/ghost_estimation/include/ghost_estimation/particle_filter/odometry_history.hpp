@@ -0,0 +1,112 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+
+namespace particle_filter
+{
+
+/**
+ * @brief Odometry pose and yaw rate, and the time they were measured at, in seconds.
+ */
+struct OdometrySample
+{
+  double stamp = 0.0;
+  Eigen::Vector2f loc = Eigen::Vector2f::Zero();
+  float angle = 0.0;
+  float angular_velocity = 0.0;
+};
+
+/**
+ * @brief Fixed size ring buffer of recent odometry, queried by timestamp.
+ *
+ * Lets the filter be corrected at the time a laser scan was taken, then carried forward to the
+ * newest odometry. Samples must arrive in time order; a sample older than the newest one (e.g. a
+ * restarted bag) clears the history.
+ */
+class OdometryHistory
+{
+public:
+  explicit OdometryHistory(std::size_t capacity = 200);
+
+  /**
+   * @brief Adds a sample, overwriting the oldest one once the buffer is full.
+   */
+  void add(const OdometrySample & sample);
+
+  void clear();
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Newest sample. The history must not be empty.
+   */
+  const OdometrySample & latest() const;
+
+  /**
+   * @brief Odometry pose and yaw rate at stamp, interpolated between the two samples around it.
+   *
+   * Stamps outside the buffered window are clamped to the oldest or newest sample.
+   *
+   * @return false if the history is empty or the stamp had to be clamped
+   */
+  bool interpolate(double stamp, OdometrySample * sample) const;
+
+private:
+  const OdometrySample & at(std::size_t i) const
+  {
+    return samples_[(oldest_ + i) % samples_.size()];
+  }
+
+  std::vector<OdometrySample> samples_;
+  std::size_t oldest_ = 0;
+  std::size_t size_ = 0;
+};
+
+/**
+ * @brief Applies the odometry motion between odom_from and odom_to to a pose in another frame.
+ *
+ * Motion is taken in the robot frame, so a filter pose estimated at odom_from's time can be
+ * carried forward to odom_to's time. This is the noiseless version of ParticleFilter::Predict.
+ */
+void propagatePose(
+  const OdometrySample & odom_from,
+  const OdometrySample & odom_to,
+  Eigen::Vector2f * loc,
+  float * angle);
+
+} // namespace particle_filter
@@ -23,6 +23,8 @@
 // ========================================================================
 
 #include <algorithm>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include <cmath>
@@ -38,7 +40,13 @@
 
 #include "eigen3/Eigen/Dense"
 #include "eigen3/Eigen/Geometry"
+#include "ghost_estimation/particle_filter/gaussian_batch.hpp"
+#include "ghost_estimation/particle_filter/likelihood_field.hpp"
+#include "ghost_estimation/particle_filter/scan_preprocessor.hpp"
+#include "ghost_estimation/vector_map/range_table.hpp"
+#include "ghost_estimation/vector_map/segment_batch.hpp"
 #include "ghost_estimation/vector_map/vector_map.hpp"
+#include "ghost_util/thread_pool.hpp"
 #include "math/line2d.h"
 #include "util/random.h"
 
@@ -55,6 +63,60 @@ struct Particle
   double weight;
 };
 
+// Particles in structure-of-arrays layout, so per-particle loops run over contiguous arrays.
+// Weights hold log-likelihoods during an update and normalized linear weights otherwise.
+struct ParticleSet
+{
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> angle;
+  std::vector<double> weight;
+
+  std::size_t size() const
+  {
+    return x.size();
+  }
+
+  void resize(std::size_t n)
+  {
+    x.resize(n);
+    y.resize(n);
+    angle.resize(n);
+    weight.resize(n);
+  }
+
+  Particle get(std::size_t i) const
+  {
+    return Particle{Eigen::Vector2f(x[i], y[i]), angle[i], weight[i]};
+  }
+
+  void set(std::size_t i, const Particle & particle)
+  {
+    x[i] = particle.loc.x();
+    y[i] = particle.loc.y();
+    angle[i] = particle.angle;
+    weight[i] = particle.weight;
+  }
+
+  // Copies particle src_index of src into slot dst_index.
+  void copyFrom(const ParticleSet & src, std::size_t src_index, std::size_t dst_index)
+  {
+    x[dst_index] = src.x[src_index];
+    y[dst_index] = src.y[src_index];
+    angle[dst_index] = src.angle[src_index];
+    weight[dst_index] = src.weight[src_index];
+  }
+};
+
+// Wall time spent in each stage of the last laser update.
+struct UpdateTimings
+{
+  bool updated = false;        // False if the last scan was skipped
+  double preprocess_ms = 0.0;
+  double weights_ms = 0.0;
+  double resample_ms = 0.0;
+};
+
 struct ParticleFilterConfig
 {
   std::string world_frame;
@@ -92,6 +154,40 @@ struct ParticleFilterConfig
   bool use_skip_range;
   int skip_index_min;
   int skip_index_max;
+  int num_threads;              // Threads for particle weight updates, zero or less uses all cores
+  std::string observation_model;   // "ray_cast" (default), "likelihood_field" or "range_table"
+  float likelihood_field_resolution;         // Distance grid cell size (m)
+  float range_table_xy_resolution;           // Range table cell size (m)
+  int range_table_num_angles;                // Range table heading bins per turn
+  bool range_table_interpolate;              // Bilinear interpolation between range table cells
+  std::string map_cache_dir;                 // Precomputed map tables, empty uses the map directory
+  std::vector<double> scan_mask_angles;      // [min, max] beam angle windows (rad) to ignore
+  int max_beams = 0;                         // Beams scored per scan, zero keeps every strided beam
+
+  // KLD-sampling: resampling draws until the set is large enough to bound the KL divergence between
+  // the sampled and true posterior, so a converged cloud shrinks towards kld_min_particles.
+  bool kld_sampling = false;
+  int kld_min_particles = 50;
+  int kld_max_particles = 2000;                // Also the initial particle count
+  double kld_epsilon = 0.05;                   // Maximum KL divergence
+  double kld_z = 2.33;                         // Upper standard normal quantile of 1 - delta
+  float kld_bin_size_xy = 0.1;                 // Histogram cell size (m)
+  float kld_bin_size_theta = 0.1745;           // Histogram heading bin (rad)
+
+  // Global localization: GlobalInitialize spreads particles over the free space of the map,
+  // stratified in position and heading, for when the pose is unknown.
+  int global_loc_particles = 20000;            // Initial particle count
+  float global_loc_xy_resolution = 0.1;        // Free space cell size (m)
+  float global_loc_clearance = 0.1;            // Minimum distance from map lines (m)
+
+  // Augmented MCL: while the short-term average scan likelihood falls below the long-term one,
+  // resampling replaces a matching fraction of particles with random free space poses.
+  bool augmented_mcl = false;
+  double recovery_alpha_slow = 0.001;          // Long-term average rate, much smaller than fast
+  double recovery_alpha_fast = 0.1;            // Short-term average rate
+  double recovery_max_inject_ratio = 0.25;     // Cap on the fraction replaced per resample
+
+  unsigned int random_seed = 0;                // Seeds initialization, motion and resampling noise
 };
 
 class ParticleFilter
@@ -122,9 +218,30 @@ public:
     const Eigen::Vector2f & loc,
     const float angle);
 
+  // Initialize with the robot location unknown, spreading particles over the whole map.
+  void GlobalInitialize(const std::string & map_file);
+
   // Return the list of particles.
   void GetParticles(std::vector<Particle> * particles) const;
 
+  // Number of particles currently tracked.
+  int GetNumParticles() const
+  {
+    return particles_.size();
+  }
+
+  // Fraction of particles replaced with random ones by the last resample (augmented MCL).
+  double GetLastInjectRatio() const
+  {
+    return last_inject_ratio_;
+  }
+
+  // Stage timings of the last ObserveLaser call.
+  const UpdateTimings & GetLastUpdateTimings() const
+  {
+    return last_update_timings_;
+  }
+
   // Get robot's current location.
   void GetLocation(Eigen::Vector2f * loc, float * angle, std::array<double, 36> * cov_ptr) const;
 
@@ -142,10 +259,6 @@ public:
 
   void LowVarianceResample();
 
-  void SortMap();
-  static bool horizontal_line_compare(const geometry::Line2f l1, const geometry::Line2f l2);
-  static bool vertical_line_compare(const geometry::Line2f l1, const geometry::Line2f l2);
-
   // For debugging: get predicted point cloud from current location.
   void GetPredictedPointCloud(
     const Eigen::Vector2f & loc,
@@ -165,6 +278,11 @@ public:
 
   Eigen::Vector2f BaseLinkToSensorFrame(const Eigen::Vector2f & loc, const float & angle);
 
+  const LikelihoodField & GetLikelihoodField() const
+  {
+    return likelihood_field_;
+  }
+
   vector_map::VectorMap GetMap()
   {
     return map_;
@@ -176,21 +294,109 @@ public:
   }
 
 private:
+  // Buffers reused across ray-cast updates, one set per worker thread.
+  struct RayCastScratch
+  {
+    std::vector<int> scene_line_indices;
+    vector_map::SegmentBatch scene_segments;
+  };
+
+  // Score a particle against a preprocessed scan with the configured observation model.
+  void ScoreParticle(const PreprocessedScan & scan, Particle * p, RayCastScratch * scratch);
+
+  // Score a particle by ray-casting each beam against the nearby map lines.
+  void UpdateRayCast(const PreprocessedScan & scan, Particle * p, RayCastScratch * scratch);
+
+  // Score a particle by looking up each beam endpoint in the likelihood field.
+  void UpdateLikelihoodField(const PreprocessedScan & scan, Particle * p);
+
+  // Score a particle using expected ranges from the range table.
+  void UpdateRangeTable(const PreprocessedScan & scan, Particle * p);
+
+  // Resample with KLD-sampling, choosing the new particle count from the spread of the draws.
+  void KLDResample();
+
+  // Particles needed to bound KL divergence when the draws occupy num_bins histogram bins.
+  int KLDSampleCount(int num_bins) const;
+
+  // Load the map and build whatever the observation model and global localization need from it.
+  void LoadMap(const std::string & map_file);
+
+  // Collect the map cells far enough from every line to sample global poses from.
+  void BuildFreeSpace();
+
+  // Overwrite particle index with a uniformly random free space pose.
+  void SampleFreeSpace(std::size_t index);
+
+  // Update the augmented MCL likelihood averages from the weights of the current scan, and return
+  // the fraction of particles to replace.
+  double UpdateRecoveryAverages();
+
+  // Replace each particle with a random free space pose with probability inject_ratio.
+  void InjectRandomParticles(double inject_ratio);
+
+  // Recompute sensor frame beam directions if the scan geometry changed.
+  void UpdateBeamDirections(int num_ranges, float angle_min, float angle_max);
+
+  std::string GetMapCacheFile(
+    const std::string & map_file, uint64_t hash,
+    const std::string & extension) const;
+
   // Runtime Configuration Params
   ParticleFilterConfig config_params_;
 
-  // List of particles being tracked.
-  std::vector<Particle> particles_;
+  // Particles being tracked, and the buffer resampling writes into before the two are swapped.
+  ParticleSet particles_;
+  ParticleSet resample_buffer_;
+
+  // Histogram bins occupied by the particles drawn so far during KLD resampling.
+  std::unordered_set<uint64_t> kld_bins_;
 
   // Map of the environment.
   vector_map::VectorMap map_;
-  std::vector<geometry::Line2f> horizontal_lines_;
-  std::vector<geometry::Line2f> vertical_lines_;
-  std::vector<geometry::Line2f> angled_lines_;
+
+  // Lower corners of the map cells global poses are drawn from.
+  std::vector<Eigen::Vector2f> free_cells_;
+
+  // Augmented MCL long and short-term average scan likelihoods, in log space per beam.
+  bool recovery_initialized_ = false;
+  double log_w_slow_ = 0.0;
+  double log_w_fast_ = 0.0;
+  double last_inject_ratio_ = 0.0;
+
+  // Beams scored by every particle, rebuilt once per scan.
+  ScanPreprocessor scan_preprocessor_;
+  PreprocessedScan scan_;
+
+  // Unit beam directions in the sensor frame for the last scan geometry, used for visualization.
+  std::vector<Eigen::Vector2f> beam_directions_;
+  int beam_num_ranges_ = -1;
+  float beam_angle_min_ = 0.0;
+  float beam_angle_max_ = 0.0;
+
+  // Distance field observation model, only built when selected.
+  bool use_likelihood_field_ = false;
+  LikelihoodField likelihood_field_;
+
+  // Expected range lookup table, only built when selected. Shared because the table owns a mapping.
+  bool use_range_table_ = false;
+  std::shared_ptr<vector_map::RangeTable> range_table_;
 
   // Random number generator.
   util_random::Random rng_;
 
+  // Motion model noise, drawn for the whole particle set at once, and per-update buffers.
+  GaussianBatch motion_noise_;
+  std::vector<float> motion_noise_scratch_;
+  std::vector<float> sin_scratch_;
+  std::vector<float> cos_scratch_;
+
+  // Workers for the per-particle weight update, each with its own ray-cast buffers.
+  // Shared so the filter stays copyable.
+  std::shared_ptr<ghost_util::ThreadPool> thread_pool_;
+  std::vector<RayCastScratch> ray_cast_scratch_;
+  std::vector<double> thread_max_weight_log_;
+
   // Previous odometry-reported locations.
   Eigen::Vector2f prev_odom_loc_;
   float prev_odom_angle_;
@@ -208,7 +414,9 @@ private:
   Eigen::Vector2f last_update_loc_;
   float last_update_angle_;
   int resample_loop_counter_ = 0;
+  int update_count_ = 0;
   double end_time = 0;
+  UpdateTimings last_update_timings_;
 };
 
 }  // namespace particle_filter
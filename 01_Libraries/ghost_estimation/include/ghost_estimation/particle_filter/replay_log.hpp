@@ -0,0 +1,102 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace particle_filter
+{
+
+/**
+ * @brief One timestamped input to the particle filter, or a ground truth pose to score it against.
+ *
+ * Poses use x, y, theta. Odometry also sets angular_velocity, and scans set the scan geometry and
+ * ranges exactly as received in the LaserScan message.
+ */
+struct ReplayEvent
+{
+  enum Type : uint8_t
+  {
+    ODOMETRY = 0,
+    SCAN = 1,
+    GROUND_TRUTH = 2,
+  };
+
+  Type type = ODOMETRY;
+  double stamp = 0.0;
+
+  float x = 0.0;
+  float y = 0.0;
+  float theta = 0.0;
+  float angular_velocity = 0.0;
+
+  float angle_min = 0.0;
+  float angle_max = 0.0;
+  float range_min = 0.0;
+  float range_max = 0.0;
+  std::vector<float> ranges;
+};
+
+/**
+ * @brief Appends events to a binary replay log. Events are stored in the order written, which
+ * should be the order they were received.
+ */
+class ReplayLogWriter
+{
+public:
+  ReplayLogWriter() = default;
+
+  /**
+   * @brief Creates file, replacing any existing log, and writes the header.
+   *
+   * @return true on success
+   */
+  bool open(const std::string & file);
+
+  void write(const ReplayEvent & event);
+
+  void close();
+
+  bool isOpen() const
+  {
+    return stream_.is_open();
+  }
+
+private:
+  std::ofstream stream_;
+};
+
+/**
+ * @brief Reads every event from a log written by ReplayLogWriter. Throws std::runtime_error if the
+ * file cannot be opened or is not a replay log. A truncated final event, e.g. from a recorder that
+ * was killed, is dropped.
+ */
+std::vector<ReplayEvent> readReplayLog(const std::string & file);
+
+} // namespace particle_filter
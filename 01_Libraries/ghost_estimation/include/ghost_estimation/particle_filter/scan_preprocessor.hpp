@@ -0,0 +1,128 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <vector>
+
+namespace particle_filter
+{
+
+struct ScanPreprocessorConfig
+{
+  double range_min = 0.0;          // Readings outside [range_min, range_max] are dropped
+  double range_max = 0.0;
+  double resize_factor = 1.0;      // Stride between candidate beams
+  bool use_skip_range = false;     // Drop scan indices in [skip_index_min, skip_index_max]
+  int skip_index_min = 0;
+  int skip_index_max = 0;
+  std::vector<double> mask_angles; // Flat list of [min, max] beam angle windows (rad) to drop
+  int max_beams = 0;               // Beams kept per scan after selection, zero keeps all
+};
+
+/**
+ * @brief Beams that survived preprocessing, stored as parallel arrays. Angles are in the sensor
+ * frame, with their sine and cosine precomputed so particles only need to rotate them.
+ */
+struct PreprocessedScan
+{
+  std::vector<int> index;
+  std::vector<float> range;
+  std::vector<float> angle;
+  std::vector<float> cos;
+  std::vector<float> sin;
+
+  std::size_t size() const
+  {
+    return index.size();
+  }
+
+  void clear()
+  {
+    index.clear();
+    range.clear();
+    angle.clear();
+    cos.clear();
+    sin.clear();
+  }
+};
+
+/**
+ * @brief Turns a raw laser scan into the set of beams the observation model scores. Runs once per
+ * scan so that clipping, masking and beam selection stay out of the per-particle loop.
+ *
+ * Candidate beams are taken every resize_factor readings, minus those inside the index skip range
+ * or any angular mask window (e.g. where the robot body blocks the lidar). Their angle table only
+ * changes with the scan geometry, so it is cached between scans. Readings outside the valid range
+ * are then dropped, and if more than max_beams remain, the field of view is split into max_beams
+ * sectors and the beam with the most local range curvature is kept from each. Corners and clutter
+ * constrain the pose in more directions than a long flat wall, which only fixes the distance to it.
+ */
+class ScanPreprocessor
+{
+public:
+  ScanPreprocessor() = default;
+  explicit ScanPreprocessor(const ScanPreprocessorConfig & config);
+
+  /**
+   * @brief Fills scan with the beams to score from ranges.
+   *
+   * @param ranges raw scan readings, evenly spaced from angle_min to angle_max
+   * @param angle_min angle of the first reading in the sensor frame
+   * @param angle_max angle of the last reading in the sensor frame
+   * @param scan output beams, reusing its storage
+   */
+  void process(
+    const std::vector<float> & ranges, float angle_min, float angle_max,
+    PreprocessedScan * scan);
+
+  const ScanPreprocessorConfig & getConfig() const
+  {
+    return config_;
+  }
+
+private:
+  void updateCandidates(int num_ranges, float angle_min, float angle_max);
+
+  bool isMasked(int index, float angle) const;
+
+  bool isValid(float range) const
+  {
+    return (range >= config_.range_min) && (range <= config_.range_max);
+  }
+
+  ScanPreprocessorConfig config_;
+
+  // Unmasked beams for the cached scan geometry
+  int num_ranges_ = -1;
+  float angle_min_ = 0.0;
+  float angle_max_ = 0.0;
+  PreprocessedScan candidates_;
+
+  // Per-candidate selection scores, reused between scans
+  std::vector<float> scores_;
+};
+
+} // namespace particle_filter
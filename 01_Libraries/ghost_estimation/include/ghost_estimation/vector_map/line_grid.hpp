@@ -0,0 +1,124 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "math/line2d.h"
+
+namespace vector_map
+{
+
+/**
+ * @brief Uniform grid over line segments for ray and region queries.
+ *
+ * Each cell lists the segments passing through it, stored by value in cell order so a query reads
+ * contiguous memory. Rays walk the cells they cross in order (Amanatides & Woo DDA) and stop as
+ * soon as a hit is closer than the exit of the current cell, so cost scales with the lines near a
+ * ray rather than with the size of the map.
+ */
+class LineGrid
+{
+public:
+  LineGrid() = default;
+
+  /**
+   * @brief Indexes lines into a grid covering their bounds.
+   *
+   * @param lines segments to index, query results refer to their positions in this vector
+   * @param cell_size cell edge length in meters
+   */
+  void build(const std::vector<geometry::Line2f> & lines, float cell_size);
+
+  void clear();
+
+  bool empty() const
+  {
+    return num_lines_ == 0;
+  }
+
+  /**
+   * @brief Number of lines the grid was built from.
+   */
+  size_t getNumLines() const
+  {
+    return num_lines_;
+  }
+
+  /**
+   * @brief Finds lines that pass through the query box. Lines whose bounding box overlaps the box
+   * but which never enter it may also be returned.
+   *
+   * @param line_indices filled with line indices in ascending order
+   */
+  void queryBox(
+    const Eigen::Vector2f & min_corner, const Eigen::Vector2f & max_corner,
+    std::vector<int> * line_indices) const;
+
+  /**
+   * @brief Finds the nearest line crossing the segment from p0 to ray_end.
+   *
+   * @param ray_end end of the ray, moved to the nearest intersection if there is one
+   * @param skip_line_idx line to ignore, e.g. the one the ray starts on
+   * @return index of the intersecting line, or -1 if none
+   */
+  int raycast(
+    const Eigen::Vector2f & p0, Eigen::Vector2f * ray_end,
+    int skip_line_idx = -1) const;
+
+  /**
+   * @brief Returns true if any line crosses the segment from p0 to p1.
+   */
+  bool intersects(const Eigen::Vector2f & p0, const Eigen::Vector2f & p1) const;
+
+private:
+  struct Entry
+  {
+    geometry::Line2f line;
+    int index;
+  };
+
+  /**
+   * @brief Calls visit(col, row, t_exit) for each cell the segment crosses, in order along the
+   * segment, where t_exit is the segment parameter in [0, 1] at which it leaves the cell. Stops
+   * early when visit returns false.
+   */
+  template<typename Visitor>
+  void traverse(const Eigen::Vector2f & p0, const Eigen::Vector2f & p1, Visitor visit) const;
+
+  Eigen::Vector2f origin_{0.0, 0.0};
+  float cell_size_ = 0.0;
+  float inv_cell_size_ = 0.0;
+  int width_ = 0;
+  int height_ = 0;
+  size_t num_lines_ = 0;
+
+  // Entries of cell i are cell_entries_[cell_start_[i]] to cell_entries_[cell_start_[i + 1] - 1]
+  std::vector<int> cell_start_;
+  std::vector<Entry> cell_entries_;
+};
+
+} // namespace vector_map
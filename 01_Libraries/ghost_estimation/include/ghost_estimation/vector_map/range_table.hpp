@@ -0,0 +1,202 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+#include "ghost_util/thread_pool.hpp"
+
+namespace vector_map
+{
+
+struct RangeTableConfig
+{
+  float xy_resolution;    // Cell size (m)
+  int num_angles;         // Heading bins over a full turn
+  float range_max;        // Ranges are clamped to this (m)
+};
+
+/**
+ * @brief Precomputed expected ranges over (x, y, theta) bins covering a VectorMap.
+ *
+ * Each cell stores the ray-cast range from its center for every heading bin, quantized to 16 bits
+ * over [0, range_max]. Headings for a cell are stored contiguously, so all beams of a scan read
+ * from the same few cache lines. Tables are generated once per map, saved to a file and
+ * memory-mapped on later runs, so large maps cost page cache rather than heap.
+ */
+class RangeTable
+{
+public:
+  RangeTable() = default;
+  ~RangeTable();
+
+  RangeTable(const RangeTable &) = delete;
+  RangeTable & operator=(const RangeTable &) = delete;
+
+  /**
+   * @brief Ray-casts every cell and heading bin of the map into an in-memory table.
+   *
+   * @param map vector map to generate from
+   * @param config table resolution and range
+   * @param thread_pool optional workers to split rows across
+   */
+  void generate(
+    const VectorMap & map, const RangeTableConfig & config,
+    ghost_util::ThreadPool * thread_pool = nullptr);
+
+  /**
+   * @brief Writes the table to a binary file that open can memory-map.
+   *
+   * @return true on success
+   */
+  bool save(const std::string & file) const;
+
+  /**
+   * @brief Memory-maps a table file written by save.
+   *
+   * @param expected_hash hash of the map and config the table must have been generated from
+   * @return true if the file was mapped and its hash matched
+   */
+  bool open(const std::string & file, uint64_t expected_hash);
+
+  /**
+   * @brief Opens file if it matches map and config, otherwise generates the table, saves it to file
+   * and maps the saved copy. An empty file keeps the generated table in memory.
+   *
+   * @return true if an existing file was opened
+   */
+  bool openOrGenerate(
+    const VectorMap & map, const RangeTableConfig & config, const std::string & file,
+    ghost_util::ThreadPool * thread_pool = nullptr);
+
+  /**
+   * @brief Hashes the map lines together with the table config, used to key table files.
+   */
+  static uint64_t hashMap(const VectorMap & map, const RangeTableConfig & config);
+
+  /**
+   * @brief Exact range along a single ray by intersecting it with every line, range_max on a miss.
+   */
+  static float castRay(
+    const std::vector<geometry::Line2f> & lines, const Eigen::Vector2f & loc, float angle,
+    float range_max);
+
+  /**
+   * @brief Range from the cell containing loc at the nearest heading bin. Locations outside the
+   * table return range_max.
+   */
+  float getRange(const Eigen::Vector2f & loc, float angle) const;
+
+  /**
+   * @brief Range bilinearly interpolated between the four nearest cell centers at the nearest
+   * heading bin. Smoother than getRange in open space, but blends across walls.
+   */
+  float getRangeInterpolated(const Eigen::Vector2f & loc, float angle) const;
+
+  /**
+   * @brief Table-backed equivalent of VectorMap::GetPredictedScan, ranges are clamped to range_max.
+   */
+  void GetPredictedScan(
+    const Eigen::Vector2f & loc,
+    float range_max,
+    float angle_min,
+    float angle_max,
+    int num_rays,
+    bool interpolate,
+    std::vector<float> * scan) const;
+
+  bool empty() const
+  {
+    return ranges_ == nullptr;
+  }
+
+  bool isMemoryMapped() const
+  {
+    return mmap_addr_ != nullptr;
+  }
+
+  /**
+   * @brief Size of the range data in bytes.
+   */
+  size_t getMemoryBytes() const
+  {
+    return static_cast<size_t>(width_) * height_ * num_angles_ * sizeof(uint16_t);
+  }
+
+  int getWidth() const
+  {
+    return width_;
+  }
+
+  int getHeight() const
+  {
+    return height_;
+  }
+
+  int getNumAngles() const
+  {
+    return num_angles_;
+  }
+
+  uint64_t getHash() const
+  {
+    return hash_;
+  }
+
+private:
+  void close();
+
+  int getAngleIndex(float angle) const;
+
+  float getCellRange(int col, int row, int angle_index) const
+  {
+    return ranges_[(static_cast<size_t>(row) * width_ + col) * num_angles_ + angle_index] *
+           range_scale_;
+  }
+
+  // Bottom-left corner of cell (0, 0) in the map frame
+  Eigen::Vector2f origin_{0.0, 0.0};
+  float xy_resolution_ = 0.0;
+  float inv_xy_resolution_ = 0.0;
+  float angle_resolution_ = 0.0;
+  float range_max_ = 0.0;
+  float range_scale_ = 0.0;     // Meters per quantization step
+  int width_ = 0;
+  int height_ = 0;
+  int num_angles_ = 0;
+  uint64_t hash_ = 0;
+
+  // Points into owned_ranges_ or the mapped file
+  const uint16_t * ranges_ = nullptr;
+  std::vector<uint16_t> owned_ranges_;
+  void * mmap_addr_ = nullptr;
+  size_t mmap_size_ = 0;
+};
+
+} // namespace vector_map
@@ -0,0 +1,88 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_util/simd_math.hpp"
+#include "math/line2d.h"
+
+namespace vector_map
+{
+
+using ghost_util::FloatBatch;
+using ghost_util::SIMD_WIDTH;
+
+/**
+ * @brief Map segments in structure-of-arrays layout, padded to whole SIMD batches, for casting rays
+ * against many segments at once.
+ *
+ * Each ray is tested against SIMD_WIDTH segments per instruction. Padding segments have zero length
+ * and never report a hit.
+ */
+class SegmentBatch
+{
+public:
+  SegmentBatch() = default;
+
+  /**
+   * @brief Loads all of lines.
+   */
+  void assign(const std::vector<geometry::Line2f> & lines);
+
+  /**
+   * @brief Loads lines[i] for each i in line_indices, e.g. the scene lines near a pose.
+   */
+  void assign(const std::vector<geometry::Line2f> & lines, const std::vector<int> & line_indices);
+
+  size_t size() const
+  {
+    return num_segments_;
+  }
+
+  /**
+   * @brief Distance along a ray to the nearest segment, or range_max if nothing is closer.
+   *
+   * @param origin ray start
+   * @param direction unit ray direction
+   */
+  float castRay(const Eigen::Vector2f & origin, const Eigen::Vector2f & direction, float range_max)
+  const;
+
+private:
+  void resize(size_t num_segments);
+
+  size_t num_segments_ = 0;
+
+  // Segment start points and p1 - p0 vectors, one lane per segment
+  std::vector<FloatBatch> p0_x_;
+  std::vector<FloatBatch> p0_y_;
+  std::vector<FloatBatch> d_x_;
+  std::vector<FloatBatch> d_y_;
+};
+
+} // namespace vector_map
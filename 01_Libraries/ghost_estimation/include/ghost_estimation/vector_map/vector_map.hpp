@@ -19,10 +19,12 @@
  */
 // ========================================================================
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "eigen3/Eigen/Dense"
+#include "ghost_estimation/vector_map/line_grid.hpp"
 #include "math/line2d.h"
 
 #ifndef VECTOR_MAP_H
@@ -40,6 +42,9 @@ void TrimOcclusion(
   geometry::Line2f * line2_ptr,
   std::vector<geometry::Line2f> * scene_lines_ptr);
 
+// FNV-1a hash of size bytes at data, continuing from hash. Used to key map-derived caches.
+uint64_t HashBytes(const void * data, size_t size, uint64_t hash = 0xCBF29CE484222325ull);
+
 struct VectorMap
 {
   VectorMap()
@@ -48,6 +53,7 @@ struct VectorMap
   explicit VectorMap(const std::vector<geometry::Line2f> & lines)
   : lines(lines)
   {
+    BuildIndex();
   }
   explicit VectorMap(const std::string & file)
   {
@@ -59,6 +65,19 @@ struct VectorMap
     float max_range,
     std::vector<geometry::Line2f> * lines_list) const;
 
+  // Indices into lines of the lines GetSceneLines would return, in ascending order.
+  void GetSceneLineIndices(
+    const Eigen::Vector2f & loc,
+    float max_range,
+    std::vector<int> * line_indices) const;
+
+  // Shortens ray_end to the nearest line crossing the ray from loc, ignoring skip_line_idx.
+  // Returns the index of that line, or -1 if the ray is clear.
+  int GetRayIntersection(
+    const Eigen::Vector2f & loc,
+    Eigen::Vector2f * ray_end,
+    int skip_line_idx = -1) const;
+
 
   void SceneRender(
     const Eigen::Vector2f & loc,
@@ -85,9 +104,28 @@ struct VectorMap
 
   void Load(const std::string & file);
 
+  // Rebuild the spatial index, needed after editing lines directly.
+  void BuildIndex();
+
   bool Intersects(const Eigen::Vector2f & v0, const Eigen::Vector2f & v1) const;
+
+  // Hash of the map lines, changes whenever the map geometry does.
+  uint64_t Hash() const;
+
   std::vector<geometry::Line2f> lines;
   std::string file_name;
+
+  // Uniform grid over lines used by all ray and region queries. It does not track edits to
+  // lines, so call BuildIndex() after any change. Queries scan lines linearly only while the index
+  // is empty or was built from a different number of lines, so an in-place edit that keeps the
+  // count leaves queries on the old geometry.
+  LineGrid index;
+
+  // Cheap per-query check for a missing or resized index, see index.
+  bool IndexValid() const
+  {
+    return !index.empty() && (index.getNumLines() == lines.size());
+  }
 };
 
 }  // namespace vector_map
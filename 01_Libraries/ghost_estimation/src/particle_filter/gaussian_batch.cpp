@@ -0,0 +1,83 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "ghost_estimation/particle_filter/gaussian_batch.hpp"
+#include "ghost_util/simd_math.hpp"
+
+using ghost_util::FloatBatch;
+using ghost_util::SIMD_WIDTH;
+using ghost_util::fastLog;
+using ghost_util::fastSinCos;
+
+namespace particle_filter
+{
+
+namespace
+{
+
+// SplitMix64 finalizer over (seed, counter)
+inline uint64_t hashCounter(uint64_t seed, uint64_t counter)
+{
+  uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr float INV_2_24 = 1.0f / 16777216.0f;
+constexpr float TWO_PI = 6.28318531f;
+
+} // namespace
+
+void GaussianBatch::generate(uint64_t counter, float * out, std::size_t n) const
+{
+  // Pairs are produced SIMD_WIDTH at a time, the last batch may be partly unused
+  FloatBatch u1, u2, s, c;
+  for (std::size_t i = 0; i < n; i += 2 * SIMD_WIDTH) {
+    for (int j = 0; j < SIMD_WIDTH; j++) {
+      uint64_t h = hashCounter(seed_, counter + i / 2 + j);
+      u1[j] = ((h >> 40) + 1) * INV_2_24;                // (0, 1], keeps the log finite
+      u2[j] = ((h >> 16) & 0xFFFFFF) * INV_2_24;         // [0, 1)
+    }
+    FloatBatch radius_sq = -2.0f * fastLog(u1);
+    FloatBatch radius;
+    for (int j = 0; j < SIMD_WIDTH; j++) {
+      radius[j] = std::sqrt(radius_sq[j]);
+    }
+    fastSinCos(u2 * TWO_PI, &s, &c);
+    FloatBatch z0 = radius * c;
+    FloatBatch z1 = radius * s;
+
+    std::size_t count = std::min<std::size_t>(2 * SIMD_WIDTH, n - i);
+    for (std::size_t j = 0; j < count; j++) {
+      out[i + j] = (j % 2 == 0) ? z0[j / 2] : z1[j / 2];
+    }
+  }
+}
+
+} // namespace particle_filter
@@ -0,0 +1,239 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "ghost_estimation/particle_filter/likelihood_field.hpp"
+
+using Eigen::Vector2f;
+using vector_map::VectorMap;
+
+namespace particle_filter
+{
+
+namespace
+{
+
+constexpr uint32_t CACHE_MAGIC = 0x464C4847;   // "GHLF"
+constexpr uint32_t CACHE_VERSION = 1;
+
+// Exact 1D squared distance transform of f (Felzenszwalb & Huttenlocher, 2012).
+// v, z are scratch buffers of at least n and n + 1 elements.
+void distanceTransform1D(
+  const float * f, int n, float * d, int * v, float * z)
+{
+  const float inf = std::numeric_limits<float>::infinity();
+  int k = 0;
+  v[0] = 0;
+  z[0] = -inf;
+  z[1] = inf;
+  for (int q = 1; q < n; q++) {
+    if (f[q] == inf) {
+      continue;
+    }
+    if (f[v[k]] == inf) {
+      // Only infinite parabolas so far, replace the one in front
+      v[k] = q;
+      continue;
+    }
+    float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+    while (s <= z[k]) {
+      k--;
+      s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+    }
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = inf;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++) {
+    while (z[k + 1] < q) {
+      k++;
+    }
+    d[q] = (f[v[k]] == inf) ? inf : (q - v[k]) * (q - v[k]) + f[v[k]];
+  }
+}
+
+} // namespace
+
+uint64_t LikelihoodField::hashMap(const VectorMap & map, float resolution, float padding)
+{
+  uint64_t hash = map.Hash();
+  hash = vector_map::HashBytes(&CACHE_VERSION, sizeof(CACHE_VERSION), hash);
+  hash = vector_map::HashBytes(&resolution, sizeof(resolution), hash);
+  return vector_map::HashBytes(&padding, sizeof(padding), hash);
+}
+
+void LikelihoodField::build(const VectorMap & map, float resolution, float padding)
+{
+  if (resolution <= 0.0) {
+    throw std::runtime_error("[LikelihoodField::build] Error: resolution must be positive.");
+  }
+  if (map.lines.empty()) {
+    throw std::runtime_error("[LikelihoodField::build] Error: map has no lines.");
+  }
+
+  Vector2f min_corner = map.lines[0].p0;
+  Vector2f max_corner = map.lines[0].p0;
+  for (const auto & line : map.lines) {
+    min_corner = min_corner.cwiseMin(line.p0).cwiseMin(line.p1);
+    max_corner = max_corner.cwiseMax(line.p0).cwiseMax(line.p1);
+  }
+  min_corner -= Vector2f(padding, padding);
+  max_corner += Vector2f(padding, padding);
+
+  resolution_ = resolution;
+  inv_resolution_ = 1.0 / resolution;
+  origin_ = min_corner;
+  width_ = static_cast<int>(std::ceil((max_corner.x() - min_corner.x()) * inv_resolution_)) + 1;
+  height_ = static_cast<int>(std::ceil((max_corner.y() - min_corner.y()) * inv_resolution_)) + 1;
+  hash_ = hashMap(map, resolution, padding);
+
+  // Rasterize lines by sampling each at half a cell spacing. Occupied cells start at zero.
+  const float inf = std::numeric_limits<float>::infinity();
+  std::vector<float> grid(static_cast<size_t>(width_) * height_, inf);
+  for (const auto & line : map.lines) {
+    int num_samples = static_cast<int>(std::ceil(line.Length() * 2.0 * inv_resolution_)) + 1;
+    for (int i = 0; i <= num_samples; i++) {
+      Vector2f p = line.p0 + (line.p1 - line.p0) * (static_cast<float>(i) / num_samples);
+      int col = static_cast<int>((p.x() - origin_.x()) * inv_resolution_);
+      int row = static_cast<int>((p.y() - origin_.y()) * inv_resolution_);
+      grid[row * width_ + col] = 0.0;
+    }
+  }
+
+  // Separable transform, columns then rows, on squared cell distances
+  int max_dim = std::max(width_, height_);
+  std::vector<float> f(max_dim);
+  std::vector<float> d(max_dim);
+  std::vector<int> v(max_dim);
+  std::vector<float> z(max_dim + 1);
+  for (int col = 0; col < width_; col++) {
+    for (int row = 0; row < height_; row++) {
+      f[row] = grid[row * width_ + col];
+    }
+    distanceTransform1D(f.data(), height_, d.data(), v.data(), z.data());
+    for (int row = 0; row < height_; row++) {
+      grid[row * width_ + col] = d[row];
+    }
+  }
+  for (int row = 0; row < height_; row++) {
+    float * grid_row = &grid[row * width_];
+    std::copy(grid_row, grid_row + width_, f.begin());
+    distanceTransform1D(f.data(), width_, grid_row, v.data(), z.data());
+  }
+
+  for (float & cell : grid) {
+    cell = std::sqrt(cell) * resolution_;
+  }
+  distances_ = std::move(grid);
+}
+
+bool LikelihoodField::loadOrBuild(
+  const VectorMap & map, float resolution, float padding,
+  const std::string & cache_file)
+{
+  uint64_t hash = hashMap(map, resolution, padding);
+  if (!empty() && (hash_ == hash)) {
+    return true;
+  }
+  if (!cache_file.empty() && load(cache_file, hash)) {
+    return true;
+  }
+  build(map, resolution, padding);
+  if (!cache_file.empty() && !save(cache_file)) {
+    std::cout << "[LikelihoodField] Unable to write cache file " << cache_file << std::endl;
+  }
+  return false;
+}
+
+bool LikelihoodField::save(const std::string & file) const
+{
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  float origin[2] = {origin_.x(), origin_.y()};
+  out.write(reinterpret_cast<const char *>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+  out.write(reinterpret_cast<const char *>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+  out.write(reinterpret_cast<const char *>(&hash_), sizeof(hash_));
+  out.write(reinterpret_cast<const char *>(&width_), sizeof(width_));
+  out.write(reinterpret_cast<const char *>(&height_), sizeof(height_));
+  out.write(reinterpret_cast<const char *>(&resolution_), sizeof(resolution_));
+  out.write(reinterpret_cast<const char *>(origin), sizeof(origin));
+  out.write(
+    reinterpret_cast<const char *>(distances_.data()), distances_.size() * sizeof(float));
+  return out.good();
+}
+
+bool LikelihoodField::load(const std::string & file, uint64_t expected_hash)
+{
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t hash = 0;
+  int width = 0;
+  int height = 0;
+  float resolution = 0.0;
+  float origin[2] = {0.0, 0.0};
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(&hash), sizeof(hash));
+  in.read(reinterpret_cast<char *>(&width), sizeof(width));
+  in.read(reinterpret_cast<char *>(&height), sizeof(height));
+  in.read(reinterpret_cast<char *>(&resolution), sizeof(resolution));
+  in.read(reinterpret_cast<char *>(origin), sizeof(origin));
+  if (!in || (magic != CACHE_MAGIC) || (version != CACHE_VERSION) || (hash != expected_hash) ||
+    (width <= 0) || (height <= 0) || (resolution <= 0.0))
+  {
+    return false;
+  }
+
+  std::vector<float> distances(static_cast<size_t>(width) * height);
+  in.read(reinterpret_cast<char *>(distances.data()), distances.size() * sizeof(float));
+  if (!in) {
+    return false;
+  }
+
+  origin_ = Vector2f(origin[0], origin[1]);
+  resolution_ = resolution;
+  inv_resolution_ = 1.0 / resolution;
+  width_ = width;
+  height_ = height;
+  hash_ = hash;
+  distances_ = std::move(distances);
+  return true;
+}
+
+} // namespace particle_filter
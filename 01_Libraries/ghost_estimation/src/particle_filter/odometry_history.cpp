@@ -0,0 +1,123 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ghost_estimation/particle_filter/odometry_history.hpp"
+#include "math/math_util.h"
+
+namespace particle_filter
+{
+
+OdometryHistory::OdometryHistory(std::size_t capacity)
+{
+  if (capacity < 2) {
+    throw std::runtime_error(
+            "[OdometryHistory::OdometryHistory] Error: capacity must be at least 2");
+  }
+  samples_.resize(capacity);
+}
+
+void OdometryHistory::add(const OdometrySample & sample)
+{
+  if ((size_ > 0) && (sample.stamp < latest().stamp)) {
+    clear();
+  }
+
+  if (size_ < samples_.size()) {
+    samples_[(oldest_ + size_) % samples_.size()] = sample;
+    size_++;
+  } else {
+    samples_[oldest_] = sample;
+    oldest_ = (oldest_ + 1) % samples_.size();
+  }
+}
+
+void OdometryHistory::clear()
+{
+  oldest_ = 0;
+  size_ = 0;
+}
+
+const OdometrySample & OdometryHistory::latest() const
+{
+  if (size_ == 0) {
+    throw std::runtime_error("[OdometryHistory::latest] Error: history is empty");
+  }
+  return at(size_ - 1);
+}
+
+bool OdometryHistory::interpolate(double stamp, OdometrySample * sample) const
+{
+  if (size_ == 0) {
+    return false;
+  }
+  if (stamp <= at(0).stamp) {
+    *sample = at(0);
+    return stamp == at(0).stamp;
+  }
+  if (stamp >= latest().stamp) {
+    *sample = latest();
+    return stamp == latest().stamp;
+  }
+
+  // First sample newer than stamp, the clamps above guarantee 0 < hi < size_
+  std::size_t lo = 0;
+  std::size_t hi = size_ - 1;
+  while (hi - lo > 1) {
+    std::size_t mid = lo + (hi - lo) / 2;
+    if (at(mid).stamp <= stamp) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  const OdometrySample & a = at(lo);
+  const OdometrySample & b = at(hi);
+  const float t = static_cast<float>((stamp - a.stamp) / (b.stamp - a.stamp));
+  sample->stamp = stamp;
+  sample->loc = a.loc + t * (b.loc - a.loc);
+  sample->angle = math_util::AngleMod(a.angle + t * math_util::AngleDiff(b.angle, a.angle));
+  sample->angular_velocity = a.angular_velocity + t * (b.angular_velocity - a.angular_velocity);
+  return true;
+}
+
+void propagatePose(
+  const OdometrySample & odom_from,
+  const OdometrySample & odom_to,
+  Eigen::Vector2f * loc,
+  float * angle)
+{
+  // Motion in the robot frame at odom_from, same as the particle motion model
+  const Eigen::Vector2f delta_translation =
+    Eigen::Rotation2D<float>(-odom_from.angle) * (odom_to.loc - odom_from.loc);
+  const float delta_angle = math_util::AngleDiff(odom_to.angle, odom_from.angle);
+
+  *loc += Eigen::Rotation2D<float>(*angle) * delta_translation;
+  *angle = math_util::AngleMod(*angle + delta_angle);
+}
+
+} // namespace particle_filter
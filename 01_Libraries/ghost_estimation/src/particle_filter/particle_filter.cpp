@@ -24,6 +24,7 @@
 
 #include "ghost_estimation/particle_filter/particle_filter.hpp"
 #include "ghost_util/angle_util.hpp"
+#include "ghost_util/simd_math.hpp"
 
 using Eigen::Vector2f;
 using Eigen::Vector2i;
@@ -42,23 +43,81 @@ Vector2f first_odom_loc;
 float first_odom_angle;
 
 ParticleFilter::ParticleFilter()
-: prev_odom_loc_(0, 0),
+: thread_pool_(std::make_shared<ghost_util::ThreadPool>(1)),
+  prev_odom_loc_(0, 0),
   prev_odom_angle_(0),
   odom_initialized_(false)
 {
 }
 
 ParticleFilter::ParticleFilter(ParticleFilterConfig & config_params)
-: prev_odom_loc_(0, 0),
+: rng_(config_params.random_seed),
+  motion_noise_(config_params.random_seed),
+  thread_pool_(std::make_shared<ghost_util::ThreadPool>(config_params.num_threads)),
+  prev_odom_loc_(0, 0),
   prev_odom_angle_(0),
   odom_initialized_(false)
 {
   config_params_ = config_params;
+  if (config_params_.observation_model == "likelihood_field") {
+    use_likelihood_field_ = true;
+  } else if (config_params_.observation_model == "range_table") {
+    use_range_table_ = true;
+    range_table_ = std::make_shared<vector_map::RangeTable>();
+  } else if (!config_params_.observation_model.empty() &&
+    (config_params_.observation_model != "ray_cast"))
+  {
+    throw std::runtime_error(
+            "[ParticleFilter::ParticleFilter] Error: unknown observation model " +
+            config_params_.observation_model + ".");
+  }
+  ScanPreprocessorConfig scan_config;
+  scan_config.range_min = config_params_.range_min;
+  scan_config.range_max = config_params_.range_max;
+  scan_config.resize_factor = config_params_.resize_factor;
+  scan_config.use_skip_range = config_params_.use_skip_range;
+  scan_config.skip_index_min = config_params_.skip_index_min;
+  scan_config.skip_index_max = config_params_.skip_index_max;
+  scan_config.mask_angles = config_params_.scan_mask_angles;
+  scan_config.max_beams = config_params_.max_beams;
+  scan_preprocessor_ = ScanPreprocessor(scan_config);
+  if (config_params_.kld_sampling &&
+    ((config_params_.kld_min_particles < 1) ||
+    (config_params_.kld_max_particles < config_params_.kld_min_particles)))
+  {
+    throw std::runtime_error(
+            "[ParticleFilter::ParticleFilter] Error: KLD particle bounds must satisfy "
+            "0 < kld_min_particles <= kld_max_particles.");
+  }
+  if ((config_params_.global_loc_xy_resolution <= 0.0) ||
+    (config_params_.global_loc_particles < 1))
+  {
+    throw std::runtime_error(
+            "[ParticleFilter::ParticleFilter] Error: global_loc_xy_resolution and "
+            "global_loc_particles must be positive.");
+  }
+  if (config_params_.augmented_mcl &&
+    ((config_params_.recovery_alpha_slow <= 0.0) ||
+    (config_params_.recovery_alpha_fast <= config_params_.recovery_alpha_slow) ||
+    (config_params_.recovery_alpha_fast > 1.0)))
+  {
+    throw std::runtime_error(
+            "[ParticleFilter::ParticleFilter] Error: recovery rates must satisfy "
+            "0 < recovery_alpha_slow < recovery_alpha_fast <= 1.");
+  }
+  if (config_params_.augmented_mcl && !use_likelihood_field_ && !use_range_table_) {
+    // Recovery scores many spread out particles, which brute force ray casting is too slow for
+    std::cout << "Warning: augmented MCL works best with the likelihood_field or range_table " <<
+      "observation model." << std::endl;
+  }
 }
 
 void ParticleFilter::GetParticles(vector<Particle> * particles) const
 {
-  *particles = particles_;
+  particles->resize(particles_.size());
+  for (std::size_t i = 0; i < particles_.size(); i++) {
+    (*particles)[i] = particles_.get(i);
+  }
 }
 
 void ParticleFilter::GetPredictedPointCloud(
@@ -78,97 +137,35 @@ void ParticleFilter::GetPredictedPointCloud(
   scan.resize((int)(num_ranges / config_params_.resize_factor));
 
   Vector2f sensor_loc = BaseLinkToSensorFrame(loc, angle);
-  int v_start_index =
-    std::lower_bound(
-    horizontal_lines_.begin(), horizontal_lines_.end(),
-    Line2f(sensor_loc, sensor_loc), horizontal_line_compare) - horizontal_lines_.begin();
-  int h_start_index =
-    std::lower_bound(
-    vertical_lines_.begin(), vertical_lines_.end(), Line2f(
-      sensor_loc,
-      sensor_loc),
-    vertical_line_compare) - vertical_lines_.begin();
 
   // Return if no map is loaded
-  if (!vertical_lines_.size() || !horizontal_lines_.size()) {
+  if (map_.lines.empty()) {
     return;
   }
 
-  // Fill in the entries of scan using array writes, e.g. scan[i] = ...
-  for (size_t i = 0; i < scan.size(); ++i) {     // for each ray
-    // Initialize the ray line
-    float ray_angle = angle + angle_min + config_params_.resize_factor * i / num_ranges *
-      (angle_max - angle_min);
-    float C0 = cos(ray_angle);
-    float S0 = sin(ray_angle);
-    Vector2f final_intersection = sensor_loc + config_params_.range_max * Vector2f(C0, S0);
-    Line2f ray(sensor_loc, final_intersection);
-    int h_dir = math_util::Sign(ray.Dir().x());
-    int v_dir = math_util::Sign(ray.Dir().y());
-
-    std::size_t v_search_index = v_start_index;
-    std::size_t h_search_index = h_start_index;
-
-    if (h_dir < 0) {
-      h_search_index -= 1;
-    }
-
-    if (v_dir < 0) {
-      v_search_index -= 1;
-    }
-
-    // Clip bounds so that we don't accidently generate invalid index if we go outside map
-    h_search_index = std::min(std::max(h_search_index, std::size_t(0)), vertical_lines_.size());
-    v_search_index = std::min(std::max(v_search_index, std::size_t(0)), horizontal_lines_.size());
-
-    Vector2f final_intersection_xy = final_intersection;
-    bool intersection_found = false;
-    double curr_dist = 0;
-    while (!intersection_found && curr_dist < ray.Length()) {
-      float xi = (h_search_index < vertical_lines_.size()) ? abs(
-        vertical_lines_[h_search_index].p0.x() - ray.p0.x()) : 100;
-      float yi = (v_search_index < horizontal_lines_.size()) ? abs(
-        horizontal_lines_[v_search_index].p0.y() - ray.p0.y()) : 100;
-      float rx = abs(xi / C0);
-      float ry = abs(yi / S0);
-
-      if ((rx < ry) && (rx < ray.Length())) {
-        curr_dist = rx;
-        intersection_found = ray.Intersection(
-          vertical_lines_[h_search_index],
-          &final_intersection_xy);
-        h_search_index += h_dir;
-      } else if ((ry <= rx) && (ry < ray.Length())) {
-        curr_dist = ry;
-        intersection_found = ray.Intersection(
-          horizontal_lines_[v_search_index],
-          &final_intersection_xy);
-        v_search_index += v_dir;
-      } else {
-        final_intersection_xy = final_intersection;
-        break;
-      }
-    }
-
-    float curr_dist_angled = range_max;
-    Vector2f final_intersection_angled = final_intersection;
-    for (size_t i = 0; i < angled_lines_.size(); ++i) {
-      if (ray.Intersection(angled_lines_[i], &final_intersection_angled)) {
-        float new_dist = (final_intersection_angled - ray.p0).norm();
-        if (new_dist < curr_dist_angled) {
-          curr_dist_angled = new_dist;
-        }
-      }
-    }
-
-    if ((final_intersection_angled - ray.p0).norm() < (final_intersection - ray.p0).norm()) {
-      final_intersection = final_intersection_angled;
-    }
-    if ((final_intersection_xy - ray.p0).norm() < (final_intersection - ray.p0).norm()) {
-      final_intersection = final_intersection_xy;
+  if (use_range_table_) {
+    for (size_t i = 0; i < scan.size(); ++i) {
+      float ray_angle = angle + angle_min + config_params_.resize_factor * i / num_ranges *
+        (angle_max - angle_min);
+      float range = config_params_.range_table_interpolate ?
+        range_table_->getRangeInterpolated(sensor_loc, ray_angle) :
+        range_table_->getRange(sensor_loc, ray_angle);
+      scan[i] = sensor_loc + range * Vector2f(cos(ray_angle), sin(ray_angle));
     }
+    return;
+  }
 
-    scan[i] = final_intersection;
+  // Test each ray against all nearby map lines, several lines per instruction
+  vector<int> scene_line_indices;
+  map_.GetSceneLineIndices(sensor_loc, config_params_.range_max, &scene_line_indices);
+  vector_map::SegmentBatch scene_segments;
+  scene_segments.assign(map_.lines, scene_line_indices);
+  UpdateBeamDirections(num_ranges, angle_min, angle_max);
+  auto rot = Eigen::Rotation2D<float>(angle).toRotationMatrix();
+  for (size_t i = 0; i < scan.size(); ++i) {
+    Vector2f direction = rot * beam_directions_[i];
+    float range = scene_segments.castRay(sensor_loc, direction, config_params_.range_max);
+    scan[i] = sensor_loc + range * direction;
   }
 }
 
@@ -190,153 +187,325 @@ double ParticleFilter::GetRobustObservationLikelihood(
 // Update the weight of the particle based on how well it fits the observation
 void ParticleFilter::Update(
   const vector<float> & ranges,
-  float range_min,
-  float range_max,
+  float /*range_min*/,
+  float /*range_max*/,
   float angle_min,
   float angle_max,
   Particle * p_ptr)
 {
-  // Get predicted point cloud
+  PreprocessedScan scan;
+  scan_preprocessor_.process(ranges, angle_min, angle_max, &scan);
+  RayCastScratch scratch;
+  ScoreParticle(scan, p_ptr, &scratch);
+}
+
+void ParticleFilter::ScoreParticle(
+  const PreprocessedScan & scan, Particle * p_ptr,
+  RayCastScratch * scratch)
+{
+  if (use_likelihood_field_) {
+    UpdateLikelihoodField(scan, p_ptr);
+  } else if (use_range_table_) {
+    UpdateRangeTable(scan, p_ptr);
+  } else {
+    UpdateRayCast(scan, p_ptr, scratch);
+  }
+}
+
+void ParticleFilter::UpdateRayCast(
+  const PreprocessedScan & scan, Particle * p_ptr,
+  RayCastScratch * scratch)
+{
   Particle & particle = *p_ptr;
-  vector<Vector2f> predicted_cloud;       // map frame
-  GetPredictedPointCloud(
-    particle.loc,
-    particle.angle,
-    ranges.size(),
-    range_min,
-    range_max,
-    angle_min,
-    angle_max,
-    &predicted_cloud);
+  particle.weight = 0;
+  // Without a map every beam reads as max range
+  if (map_.lines.empty()) {
+    return;
+  }
+
   Vector2f sensor_loc = BaseLinkToSensorFrame(particle.loc, particle.angle);
-  // resize the ranges
-  vector<float> trimmed_ranges(predicted_cloud.size());
+  map_.GetSceneLineIndices(sensor_loc, config_params_.range_max, &scratch->scene_line_indices);
+  scratch->scene_segments.assign(map_.lines, scratch->scene_line_indices);
+
+  // Rotate the precomputed beam directions by the particle heading
+  const float c = cos(particle.angle);
+  const float s = sin(particle.angle);
+  for (std::size_t i = 0; i < scan.size(); i++) {
+    Vector2f direction(c * scan.cos[i] - s * scan.sin[i], s * scan.cos[i] + c * scan.sin[i]);
+    double predicted_range =
+      scratch->scene_segments.castRay(sensor_loc, direction, config_params_.range_max);
+    double diff = GetRobustObservationLikelihood(
+      scan.range[i], predicted_range,
+      config_params_.dist_short,
+      config_params_.dist_long);
+    particle.weight += -config_params_.gamma * Sq(diff) / Sq(config_params_.sigma_observation);
+  }
+}
+
+void ParticleFilter::UpdateLikelihoodField(const PreprocessedScan & scan, Particle * p_ptr)
+{
+  Particle & particle = *p_ptr;
+
+  // Beam endpoints further than this from any wall get the same penalty as a bad ray-cast range
+  float max_dist = std::max(config_params_.dist_short, config_params_.dist_long);
+  Vector2f sensor_loc = BaseLinkToSensorFrame(particle.loc, particle.angle);
+  const float c = cos(particle.angle);
+  const float s = sin(particle.angle);
   particle.weight = 0;
-  // Calculate the particle weight
-  for (std::size_t i = 0; i < predicted_cloud.size(); i++) {
-    int laser_index = i * config_params_.resize_factor;
-    if (!config_params_.use_skip_range || (laser_index < config_params_.skip_index_min) ||
-      (laser_index > config_params_.skip_index_max) )
-    {
-      trimmed_ranges[i] = ranges[laser_index];
-      double predicted_range = (predicted_cloud[i] - sensor_loc).norm();
-      double diff = GetRobustObservationLikelihood(
-        trimmed_ranges[i], predicted_range,
-        config_params_.dist_short,
-        config_params_.dist_long);
-      particle.weight += -config_params_.gamma * Sq(diff) / Sq(config_params_.sigma_observation);
-    }
+  for (std::size_t i = 0; i < scan.size(); i++) {
+    Vector2f endpoint = sensor_loc + scan.range[i] *
+      Vector2f(c * scan.cos[i] - s * scan.sin[i], s * scan.cos[i] + c * scan.sin[i]);
+    double diff = likelihood_field_.getDistance(endpoint, max_dist);
+    particle.weight += -config_params_.gamma * Sq(diff) / Sq(config_params_.sigma_observation);
+  }
+}
+
+void ParticleFilter::UpdateRangeTable(const PreprocessedScan & scan, Particle * p_ptr)
+{
+  // Same beams and scoring as the ray-cast path, with expected ranges looked up instead of cast
+  Particle & particle = *p_ptr;
+  Vector2f sensor_loc = BaseLinkToSensorFrame(particle.loc, particle.angle);
+  particle.weight = 0;
+  for (std::size_t i = 0; i < scan.size(); i++) {
+    float ray_angle = particle.angle + scan.angle[i];
+    double predicted_range = config_params_.range_table_interpolate ?
+      range_table_->getRangeInterpolated(sensor_loc, ray_angle) :
+      range_table_->getRange(sensor_loc, ray_angle);
+    double diff = GetRobustObservationLikelihood(
+      scan.range[i], predicted_range,
+      config_params_.dist_short,
+      config_params_.dist_long);
+    particle.weight += -config_params_.gamma * Sq(diff) / Sq(config_params_.sigma_observation);
   }
 }
 
+void ParticleFilter::UpdateBeamDirections(int num_ranges, float angle_min, float angle_max)
+{
+  if ((num_ranges == beam_num_ranges_) && (angle_min == beam_angle_min_) &&
+    (angle_max == beam_angle_max_))
+  {
+    return;
+  }
+  // Same beam spacing as GetPredictedPointCloud
+  beam_directions_.resize((int)(num_ranges / config_params_.resize_factor));
+  for (size_t i = 0; i < beam_directions_.size(); i++) {
+    float beam_angle = angle_min + config_params_.resize_factor * i / num_ranges *
+      (angle_max - angle_min);
+    beam_directions_[i] = Vector2f(cos(beam_angle), sin(beam_angle));
+  }
+  beam_num_ranges_ = num_ranges;
+  beam_angle_min_ = angle_min;
+  beam_angle_max_ = angle_max;
+}
+
+std::string ParticleFilter::GetMapCacheFile(
+  const std::string & map_file, uint64_t hash,
+  const std::string & extension) const
+{
+  // Key the cache on the map contents, so edited maps never load a stale table
+  char hash_str[17];
+  snprintf(hash_str, sizeof(hash_str), "%016llx", (unsigned long long)hash);
+
+  std::size_t slash = map_file.find_last_of('/');
+  std::string map_name = (slash == std::string::npos) ? map_file : map_file.substr(slash + 1);
+  std::string dir = config_params_.map_cache_dir;
+  if (dir.empty()) {
+    dir = (slash == std::string::npos) ? "." : map_file.substr(0, slash);
+  }
+  return dir + "/" + map_name + "." + hash_str + "." + extension;
+}
+
 void ParticleFilter::Resample()
 {
-  vector<Particle> new_particles(particles_.size());
-  vector<double> weight_bins(particles_.size());
+  const std::size_t num_particles = particles_.size();
+  resample_buffer_.resize(num_particles);
+  weight_bins_.resize(num_particles);
 
   // Calculate weight sum, get bins sized by particle weights as vector
   double weight_sum = 0;
-  for (std::size_t i = 0; i < particles_.size(); i++) {
-    weight_sum += particles_[i].weight;
-    weight_bins[i] = weight_sum;
+  for (std::size_t i = 0; i < num_particles; i++) {
+    weight_sum += particles_.weight[i];
+    weight_bins_[i] = weight_sum;
   }
 
-  // During resampling:
-  for (std::size_t i = 0; i < particles_.size(); i++) {
+  // Draw each particle independently
+  for (std::size_t i = 0; i < num_particles; i++) {
     double rand_weight = rng_.UniformRandom(0, weight_sum);
     auto new_particle_index =
-      std::lower_bound(weight_bins.begin(), weight_bins.end(), rand_weight) - weight_bins.begin();
-    new_particles[i] = particles_[new_particle_index];
-    new_particles[i].weight = 1 / ((double) particles_.size());
+      std::lower_bound(weight_bins_.begin(), weight_bins_.end(), rand_weight) - weight_bins_.begin();
+    resample_buffer_.copyFrom(particles_, new_particle_index, i);
+    resample_buffer_.weight[i] = 1 / ((double) num_particles);
   }
-  // After resampling:
-  particles_ = new_particles;
+  std::swap(particles_, resample_buffer_);
+  weight_sum_ = 1.0;
 }
 
 void ParticleFilter::LowVarianceResample()
 {
-  vector<Particle> new_particles(particles_.size());
-  double select_weight = rng_.UniformRandom(0, weight_sum_);
+  // Systematic resampling: N evenly spaced pointers with one random offset, walked through the
+  // cumulative weight bins in a single pass. A globally initialized set halves on every resample
+  // until it is back to num_particles, leaving a few scans to tell similar looking places apart.
+  const std::size_t num_bins = particles_.size();
+  const std::size_t num_particles = std::max<std::size_t>(
+    std::min<std::size_t>(config_params_.num_particles, num_bins), num_bins / 2);
+  resample_buffer_.resize(num_particles);
+  const double step = weight_sum_ / ((double) num_particles);
+  double select_weight = rng_.UniformRandom(0, step);
+
+  std::size_t bin = 0;
+  for (std::size_t i = 0; i < num_particles; i++) {
+    while ((bin < num_bins - 1) && (weight_bins_[bin] < select_weight)) {
+      bin++;
+    }
+    resample_buffer_.copyFrom(particles_, bin, i);
+    resample_buffer_.weight[i] = 1 / ((double) num_particles);
+    select_weight += step;
+  }
+  std::swap(particles_, resample_buffer_);
+  weight_sum_ = 1.0;
+}
 
-  for (std::size_t i = 0; i < particles_.size(); i++) {
-    int new_particle_index = std::lower_bound(
-      weight_bins_.begin(),
-      weight_bins_.end(), select_weight) - weight_bins_.begin();
-    select_weight = std::fmod(
-      select_weight + weight_sum_ / ((double) particles_.size()), weight_sum_);
-    new_particles[i] = particles_[new_particle_index];
-    new_particles[i].weight = 1 / ((double) particles_.size());             // rng_.UniformRandom(); good for testing
+void ParticleFilter::KLDResample()
+{
+  const std::size_t num_particles = particles_.size();
+  const int max_particles = config_params_.kld_max_particles;
+  resample_buffer_.resize(max_particles);
+  kld_bins_.clear();
+
+  int target_particles = config_params_.kld_min_particles;
+  int n = 0;
+  while ((n < max_particles) && (n < target_particles)) {
+    // Draws are independent, the final count is not known up front
+    double rand_weight = rng_.UniformRandom(0, weight_sum_);
+    std::size_t index =
+      std::lower_bound(weight_bins_.begin(), weight_bins_.end(), rand_weight) - weight_bins_.begin();
+    index = std::min(index, num_particles - 1);
+    resample_buffer_.copyFrom(particles_, index, n);
+    n++;
+
+    int32_t bin_x = std::floor(particles_.x[index] / config_params_.kld_bin_size_xy);
+    int32_t bin_y = std::floor(particles_.y[index] / config_params_.kld_bin_size_xy);
+    int32_t bin_theta = std::floor(
+      (math_util::AngleMod(particles_.angle[index]) + M_PI) / config_params_.kld_bin_size_theta);
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(bin_x) & 0x1FFFFF)) |
+      (static_cast<uint64_t>(static_cast<uint32_t>(bin_y) & 0x1FFFFF) << 21) |
+      (static_cast<uint64_t>(static_cast<uint32_t>(bin_theta) & 0x3FFFFF) << 42);
+    if (kld_bins_.insert(key).second) {
+      target_particles = std::max(
+        config_params_.kld_min_particles, KLDSampleCount(kld_bins_.size()));
+    }
   }
 
+  // Shrinking keeps the buffer capacity, so later resamples do not allocate
+  resample_buffer_.resize(n);
+  std::fill(resample_buffer_.weight.begin(), resample_buffer_.weight.end(), 1 / ((double) n));
+  std::swap(particles_, resample_buffer_);
   weight_sum_ = 1.0;
+}
 
-  // After resampling:
-  particles_ = new_particles;
+int ParticleFilter::KLDSampleCount(int num_bins) const
+{
+  if (num_bins <= 1) {
+    return config_params_.kld_min_particles;
+  }
+  // Wilson-Hilferty approximation of the chi-square quantile with num_bins - 1 degrees of freedom
+  double k = num_bins - 1;
+  double a = 2.0 / (9.0 * k);
+  double b = 1.0 - a + std::sqrt(a) * config_params_.kld_z;
+  return std::ceil(k / (2.0 * config_params_.kld_epsilon) * b * b * b);
 }
 
 void ParticleFilter::SetParticlesForTesting(vector<Particle> new_particles)
 {
-  particles_ = new_particles;
+  particles_.resize(new_particles.size());
+  for (std::size_t i = 0; i < new_particles.size(); i++) {
+    particles_.set(i, new_particles[i]);
+  }
 }
 
 void ParticleFilter::ObserveLaser(
   const vector<float> & ranges,
-  float range_min,
-  float range_max,
+  float /*range_min*/,
+  float /*range_max*/,
   float angle_min,
   float angle_max)
 {
   // A new laser scan observation is available (in the laser frame)
   // Call the Update and Resample steps as necessary.
+  last_update_timings_ = UpdateTimings();
   double delta_translation = (last_update_loc_ - prev_odom_loc_).norm();
   double delta_angle = math_util::AngleDiff(last_update_angle_, prev_odom_angle_);
   if (((delta_translation > config_params_.min_update_dist) ||
     (std::abs(delta_angle) > config_params_.min_update_angle)) &&
     (std::abs(angular_velocity_curr_) < config_params_.max_update_angular_velocity))
   {
-    static int i = 0;
     double start_time = GetMonotonicTime();
-    max_weight_log_ = -1e10;             // Should be smaller than any
     weight_sum_ = 0;
     weight_bins_.resize(particles_.size());
     std::fill(weight_bins_.begin(), weight_bins_.end(), 0);
 
-    // Update each particle with log error weight and find largest weight (smallest negative number)
-    double particle_update_start = GetMonotonicTime();
-    double p_update_start = 0;
-    double p_update_diff_avg = 0;
-    for (Particle & p : particles_) {
-      p_update_start = GetMonotonicTime();
-      Update(ranges, range_min, range_max, angle_min, angle_max, &p);
-      max_weight_log_ = std::max(max_weight_log_, p.weight);
-      p_update_diff_avg += 1000000 * (GetMonotonicTime() - p_update_start);
+    // Shared by every particle, so preprocess the scan before the workers read it
+    scan_preprocessor_.process(ranges, angle_min, angle_max, &scan_);
+    double weights_start_time = GetMonotonicTime();
+    int num_threads = thread_pool_->getNumThreads();
+    ray_cast_scratch_.resize(num_threads);
+    thread_max_weight_log_.assign(num_threads, -1e10);             // Should be smaller than any
+
+    // Update each particle with log error weight and find largest weight (smallest negative number).
+    // Particles are split into fixed chunks per thread, and the per-thread maxima are combined in thread
+    // order, so the result does not depend on scheduling.
+    thread_pool_->parallelFor(
+      particles_.size(), [&](int begin, int end, int thread_index) {
+        auto & scratch = ray_cast_scratch_[thread_index];
+        double & thread_max_weight_log = thread_max_weight_log_[thread_index];
+        for (int j = begin; j < end; j++) {
+          Particle particle = particles_.get(j);
+          ScoreParticle(scan_, &particle, &scratch);
+          particles_.weight[j] = particle.weight;
+          thread_max_weight_log = std::max(thread_max_weight_log, particle.weight);
+        }
+      });
+    max_weight_log_ = -1e10;
+    for (double thread_max_weight_log : thread_max_weight_log_) {
+      max_weight_log_ = std::max(max_weight_log_, thread_max_weight_log);
     }
-    double particle_update_diff = 1000 * (GetMonotonicTime() - particle_update_start);
-    p_update_diff_avg /= particles_.size();
-    std::cout << "Particle Update (ms): " << particle_update_diff << " Avg (us): " <<
-      p_update_diff_avg << std::endl;
 
     // Normalize log-likelihood weights by max log weight and transform back to linear scale
     // Sum all linear weights and generate bins
     for (std::size_t i = 0; i < particles_.size(); i++) {
-      particles_[i].weight = exp(particles_[i].weight - max_weight_log_);
-      weight_sum_ += particles_[i].weight;
+      particles_.weight[i] = exp(particles_.weight[i] - max_weight_log_);
+      weight_sum_ += particles_.weight[i];
       weight_bins_[i] = weight_sum_;
     }
 
+    double resample_start_time = GetMonotonicTime();
+    double inject_ratio = config_params_.augmented_mcl ? UpdateRecoveryAverages() : 0.0;
+    last_inject_ratio_ = 0.0;
     if (!(resample_loop_counter_ % config_params_.resample_frequency)) {
-      LowVarianceResample();
+      if (config_params_.kld_sampling) {
+        KLDResample();
+      } else {
+        LowVarianceResample();
+      }
+      if (inject_ratio > 0.0) {
+        InjectRandomParticles(inject_ratio);
+      }
     }
+    double end_update_time = GetMonotonicTime();
+    last_update_timings_.updated = true;
+    last_update_timings_.preprocess_ms = 1000 * (weights_start_time - start_time);
+    last_update_timings_.weights_ms = 1000 * (resample_start_time - weights_start_time);
+    last_update_timings_.resample_ms = 1000 * (end_update_time - resample_start_time);
     last_update_loc_ = prev_odom_loc_;
     last_update_angle_ = prev_odom_angle_;
     resample_loop_counter_++;
 
-    end_time += 1000 * (GetMonotonicTime() - start_time);
-    if (i % 10 == 0) {
+    end_time += 1000 * (end_update_time - start_time);
+    if (update_count_ % 10 == 0) {
       std::cout << "Total Update Avg (ms): " << end_time / 10.0 << std::endl << std::endl;
       end_time = 0;
     }
-    i++;
+    update_count_++;
   }
 }
 
@@ -369,19 +538,33 @@ void ParticleFilter::Predict(
     config_params_.k8 * delta_translation.y() +
     config_params_.k9 * abs(delta_angle);
 
-  for (Particle & particle : particles_) {
-    Eigen::Vector2f e_xy = Eigen::Vector2f(
-      (float) rng_.Gaussian(
-        0.0,
-        sigma_x),
-      (float) rng_.Gaussian(0.0, sigma_y));
-    Eigen::Vector2f noisy_translation = delta_translation + e_xy;
-    float noisy_angle = delta_angle + rng_.Gaussian(0.0, sigma_tht);
-
-    // Transform noise to map using current particle angle
-    auto rot_bl1_to_map = Eigen::Rotation2D<float>(particle.angle).toRotationMatrix();
-    particle.loc += rot_bl1_to_map * noisy_translation;
-    particle.angle += noisy_angle;
+  // Draw every particle's noise and heading rotation up front, so the update below is a plain
+  // element-wise loop over the particle arrays
+  const std::size_t num_particles = particles_.size();
+  motion_noise_scratch_.resize(3 * num_particles);
+  sin_scratch_.resize(num_particles);
+  cos_scratch_.resize(num_particles);
+  motion_noise_.generate(motion_noise_scratch_.data(), motion_noise_scratch_.size());
+  ghost_util::fastSinCos(
+    particles_.angle.data(), sin_scratch_.data(), cos_scratch_.data(), num_particles);
+
+  const float * e_x = motion_noise_scratch_.data();
+  const float * e_y = e_x + num_particles;
+  const float * e_tht = e_y + num_particles;
+  const float * s = sin_scratch_.data();
+  const float * c = cos_scratch_.data();
+  float * x = particles_.x.data();
+  float * y = particles_.y.data();
+  float * tht = particles_.angle.data();
+  const float dx = delta_translation.x();
+  const float dy = delta_translation.y();
+  for (std::size_t i = 0; i < num_particles; i++) {
+    // Transform noisy translation to map using current particle angle
+    float noisy_x = dx + sigma_x * e_x[i];
+    float noisy_y = dy + sigma_y * e_y[i];
+    x[i] += c[i] * noisy_x - s[i] * noisy_y;
+    y[i] += s[i] * noisy_x + c[i] * noisy_y;
+    tht[i] += delta_angle + sigma_tht * e_tht[i];
   }
 
   // Update previous odometry
@@ -402,55 +585,197 @@ void ParticleFilter::Initialize(
   // The "set_pose" button on the GUI was clicked, or an initialization message
   // was received from the log.
 
-  particles_.resize(config_params_.num_particles);
-  std::cout << "Num Particles: " << config_params_.num_particles << std::endl;
+  // Start wide under KLD-sampling, the cloud shrinks as it converges
+  int num_particles = config_params_.kld_sampling ?
+    config_params_.kld_max_particles : config_params_.num_particles;
+  particles_.resize(num_particles);
+  std::cout << "Num Particles: " << num_particles << std::endl;
 
-  for (Particle & particle : particles_) {
-    particle.loc = Eigen::Vector2f(
-      loc[0] + rng_.Gaussian(0, config_params_.init_x_sigma),
-      loc[1] + rng_.Gaussian(0, config_params_.init_y_sigma)
-    );
-    particle.angle = angle + rng_.Gaussian(0, config_params_.init_r_sigma);
-    particle.weight = 1 / ((double)particles_.size());
+  for (std::size_t i = 0; i < particles_.size(); i++) {
+    particles_.x[i] = loc[0] + rng_.Gaussian(0, config_params_.init_x_sigma);
+    particles_.y[i] = loc[1] + rng_.Gaussian(0, config_params_.init_y_sigma);
+    particles_.angle[i] = angle + rng_.Gaussian(0, config_params_.init_r_sigma);
+    particles_.weight[i] = 1 / ((double)particles_.size());
   }
   weight_sum_ = 1;
   max_weight_log_ = 0;
   last_update_loc_ = prev_odom_loc_;
   last_update_angle_ = prev_odom_angle_;
+  recovery_initialized_ = false;
+  LoadMap(map_file);
+}
+
+void ParticleFilter::GlobalInitialize(const string & map_file)
+{
+  LoadMap(map_file);
+  if (free_cells_.empty()) {
+    throw std::runtime_error(
+            "[ParticleFilter::GlobalInitialize] Error: map has no free space to place particles "
+            "in, check global_loc_clearance.");
+  }
+
+  // Far more than tracking needs, so some particle lands close enough to the true pose to win
+  // over places that look alike. Resampling brings the count back down.
+  int num_particles = config_params_.global_loc_particles;
+  particles_.resize(num_particles);
+  std::cout << "Global Localization: " << num_particles << " particles over " <<
+    free_cells_.size() << " free cells" << std::endl;
+
+  // Stratify position and heading separately: cells are picked by evenly spaced pointers, and
+  // headings are one per equal slice of the circle, shuffled so they do not follow cell order.
+  const double cell_step = free_cells_.size() / ((double) num_particles);
+  double cell_pointer = rng_.UniformRandom(0, cell_step);
+  const float resolution = config_params_.global_loc_xy_resolution;
+  for (int i = 0; i < num_particles; i++) {
+    std::size_t cell = std::min<std::size_t>(cell_pointer, free_cells_.size() - 1);
+    particles_.x[i] = free_cells_[cell].x() + rng_.UniformRandom(0, resolution);
+    particles_.y[i] = free_cells_[cell].y() + rng_.UniformRandom(0, resolution);
+    particles_.angle[i] = 2 * M_PI * (i + rng_.UniformRandom(0, 1)) / num_particles - M_PI;
+    particles_.weight[i] = 1 / ((double) num_particles);
+    cell_pointer += cell_step;
+  }
+  for (int i = num_particles - 1; i > 0; i--) {
+    int j = std::min<int>(rng_.UniformRandom(0, i + 1), i);
+    std::swap(particles_.angle[i], particles_.angle[j]);
+  }
+
+  weight_sum_ = 1;
+  max_weight_log_ = 0;
+  last_update_loc_ = prev_odom_loc_;
+  last_update_angle_ = prev_odom_angle_;
+  recovery_initialized_ = false;
+}
+
+void ParticleFilter::LoadMap(const string & map_file)
+{
   map_.Load(map_file);
-  SortMap();
+
+  if (use_likelihood_field_) {
+    double start_time = GetMonotonicTime();
+    float padding = std::max(config_params_.dist_short, config_params_.dist_long);
+    uint64_t hash =
+      LikelihoodField::hashMap(map_, config_params_.likelihood_field_resolution, padding);
+    bool cached = likelihood_field_.loadOrBuild(
+      map_, config_params_.likelihood_field_resolution, padding,
+      GetMapCacheFile(map_file, hash, "lf"));
+    std::cout << "Likelihood Field: " << likelihood_field_.getWidth() << "x" <<
+      likelihood_field_.getHeight() << (cached ? " loaded" : " built") << " in " <<
+      1000 * (GetMonotonicTime() - start_time) << " ms" << std::endl;
+  }
+
+  if (use_range_table_) {
+    double start_time = GetMonotonicTime();
+    vector_map::RangeTableConfig table_config{
+      config_params_.range_table_xy_resolution,
+      config_params_.range_table_num_angles,
+      static_cast<float>(config_params_.range_max)};
+    uint64_t hash = vector_map::RangeTable::hashMap(map_, table_config);
+    bool cached = range_table_->openOrGenerate(
+      map_, table_config, GetMapCacheFile(map_file, hash, "rt"), thread_pool_.get());
+    std::cout << "Range Table: " << range_table_->getWidth() << "x" <<
+      range_table_->getHeight() << "x" << range_table_->getNumAngles() << ", " <<
+      range_table_->getMemoryBytes() / 1e6 << " MB" << (cached ? " loaded" : " generated") <<
+      " in " << 1000 * (GetMonotonicTime() - start_time) << " ms" << std::endl;
+  }
+
+  BuildFreeSpace();
 }
 
-bool ParticleFilter::horizontal_line_compare(const geometry::Line2f l1, const geometry::Line2f l2)
+void ParticleFilter::BuildFreeSpace()
 {
-  return l1.p0.y() < l2.p0.y();
+  free_cells_.clear();
+  if (map_.lines.empty()) {
+    return;
+  }
+
+  Vector2f map_min = map_.lines[0].p0;
+  Vector2f map_max = map_.lines[0].p0;
+  for (const auto & line : map_.lines) {
+    map_min = map_min.cwiseMin(line.p0).cwiseMin(line.p1);
+    map_max = map_max.cwiseMax(line.p0).cwiseMax(line.p1);
+  }
+
+  // A cell is free if its center is clear of every line, so particles never start in a wall
+  const float resolution = config_params_.global_loc_xy_resolution;
+  const float clearance = config_params_.global_loc_clearance;
+  vector<int> line_indices;
+  for (float y = map_min.y(); y + resolution <= map_max.y(); y += resolution) {
+    for (float x = map_min.x(); x + resolution <= map_max.x(); x += resolution) {
+      Vector2f center(x + 0.5 * resolution, y + 0.5 * resolution);
+      map_.GetSceneLineIndices(center, clearance, &line_indices);
+      bool free = true;
+      for (int line_index : line_indices) {
+        const Line2f & line = map_.lines[line_index];
+        Vector2f dir = line.p1 - line.p0;
+        float t = dir.squaredNorm() > 0 ? (center - line.p0).dot(dir) / dir.squaredNorm() : 0;
+        Vector2f closest = line.p0 + std::clamp(t, 0.0f, 1.0f) * dir;
+        if ((center - closest).norm() < clearance) {
+          free = false;
+          break;
+        }
+      }
+      if (free) {
+        free_cells_.push_back(Vector2f(x, y));
+      }
+    }
+  }
 }
 
-bool ParticleFilter::vertical_line_compare(const geometry::Line2f l1, const geometry::Line2f l2)
+void ParticleFilter::SampleFreeSpace(std::size_t index)
 {
-  return l1.p0.x() < l2.p0.x();
+  const float resolution = config_params_.global_loc_xy_resolution;
+  std::size_t cell = std::min<std::size_t>(
+    rng_.UniformRandom(0, free_cells_.size()), free_cells_.size() - 1);
+  particles_.x[index] = free_cells_[cell].x() + rng_.UniformRandom(0, resolution);
+  particles_.y[index] = free_cells_[cell].y() + rng_.UniformRandom(0, resolution);
+  particles_.angle[index] = rng_.UniformRandom(-M_PI, M_PI);
+}
+
+double ParticleFilter::UpdateRecoveryAverages()
+{
+  if (scan_.size() == 0) {
+    return 0.0;
+  }
+
+  // Mean particle likelihood of this scan, from the normalized weights. Taken per beam so that
+  // scans with more valid beams do not look more or less likely, and kept in log space because
+  // whole scan likelihoods underflow.
+  const double log_w_avg =
+    (max_weight_log_ + std::log(weight_sum_ / particles_.size())) / scan_.size();
+  if (!recovery_initialized_) {
+    log_w_slow_ = log_w_avg;
+    log_w_fast_ = log_w_avg;
+    recovery_initialized_ = true;
+    return 0.0;
+  }
+
+  // w += alpha * (w_avg - w), evaluated as a log of a weighted sum
+  auto update_average = [log_w_avg](double log_w, double alpha) {
+      double a = std::log(1.0 - alpha) + log_w;
+      double b = std::log(alpha) + log_w_avg;
+      double m = std::max(a, b);
+      return m + std::log(std::exp(a - m) + std::exp(b - m));
+    };
+  log_w_slow_ = update_average(log_w_slow_, config_params_.recovery_alpha_slow);
+  log_w_fast_ = update_average(log_w_fast_, config_params_.recovery_alpha_fast);
+
+  double inject_ratio = 1.0 - std::exp(log_w_fast_ - log_w_slow_);
+  return std::clamp(inject_ratio, 0.0, config_params_.recovery_max_inject_ratio);
 }
 
-void ParticleFilter::SortMap()
+void ParticleFilter::InjectRandomParticles(double inject_ratio)
 {
-  // Split lines in map into horizontal, vertical, and angled
-  horizontal_lines_.clear();
-  vertical_lines_.clear();
-  angled_lines_.clear();
-
-  for (size_t i = 0; i < map_.lines.size(); ++i) {
-    const geometry::Line2f line = map_.lines[i];
-    if (line.p0.y() == line.p1.y()) {
-      horizontal_lines_.push_back(line);
-    } else if (line.p0.x() == line.p1.x()) {
-      vertical_lines_.push_back(line);
-    } else {
-      angled_lines_.push_back(line);
+  if (free_cells_.empty()) {
+    return;
+  }
+  int num_injected = 0;
+  for (std::size_t i = 0; i < particles_.size(); i++) {
+    if (rng_.UniformRandom(0, 1) < inject_ratio) {
+      SampleFreeSpace(i);
+      num_injected++;
     }
   }
-  // Sort horizontal and vertical in ascending order
-  std::sort(horizontal_lines_.begin(), horizontal_lines_.end(), horizontal_line_compare);
-  std::sort(vertical_lines_.begin(), vertical_lines_.end(), vertical_line_compare);
+  last_inject_ratio_ = num_injected / ((double) particles_.size());
 }
 
 void ParticleFilter::GetLocation(
@@ -465,9 +790,10 @@ void ParticleFilter::GetLocation(
   // Compute the best estimate of the robot's location based on the current set
   // of particles.
   Eigen::Vector2f angle_point = Eigen::Vector2f(0, 0);
-  for (Particle particle : particles_) {
-    loc += particle.loc * particle.weight;
-    angle_point += Eigen::Vector2f(cos(particle.angle), sin(particle.angle)) * particle.weight;
+  for (std::size_t i = 0; i < particles_.size(); i++) {
+    const double weight = particles_.weight[i];
+    loc += Eigen::Vector2f(particles_.x[i], particles_.y[i]) * weight;
+    angle_point += Eigen::Vector2f(cos(particles_.angle[i]), sin(particles_.angle[i])) * weight;
   }
 
   // Get Average
@@ -477,12 +803,12 @@ void ParticleFilter::GetLocation(
 
   Eigen::Vector3d sum_diff = Eigen::Vector3d(0.0, 0.0, 0.0);
   Eigen::Vector3d cov_vector = Eigen::Vector3d(0.0, 0.0, 0.0);
-  for (Particle particle : particles_) {
-    double weight = particle.weight;
-    double sum_diff_x = particle.weight * math_util::Pow(particle.loc(0) - loc(0), 2);
-    double sum_diff_y = particle.weight * math_util::Pow(particle.loc(1) - loc(1), 2);
-    double sum_diff_tht = particle.weight *
-      math_util::Pow(ghost_util::SmallestAngleDistRad(particle.angle, angle), 2);
+  for (std::size_t i = 0; i < particles_.size(); i++) {
+    const double weight = particles_.weight[i];
+    double sum_diff_x = weight * math_util::Pow(particles_.x[i] - loc(0), 2);
+    double sum_diff_y = weight * math_util::Pow(particles_.y[i] - loc(1), 2);
+    double sum_diff_tht = weight *
+      math_util::Pow(ghost_util::SmallestAngleDistRad(particles_.angle[i], angle), 2);
 
     Eigen::Vector3d sum_data(sum_diff_x, sum_diff_y, sum_diff_tht);
     sum_diff += sum_data;
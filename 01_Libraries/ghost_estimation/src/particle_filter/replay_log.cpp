@@ -0,0 +1,152 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include <stdexcept>
+
+#include "ghost_estimation/particle_filter/replay_log.hpp"
+
+namespace particle_filter
+{
+
+namespace
+{
+
+constexpr uint32_t LOG_MAGIC = 0x52504847;   // "GHPR"
+constexpr uint32_t LOG_VERSION = 1;
+
+template<typename T>
+void writeValue(std::ofstream & stream, const T & value)
+{
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readValue(std::ifstream & stream, T * value)
+{
+  return static_cast<bool>(stream.read(reinterpret_cast<char *>(value), sizeof(T)));
+}
+
+} // namespace
+
+bool ReplayLogWriter::open(const std::string & file)
+{
+  stream_.open(file, std::ios::binary | std::ios::trunc);
+  if (!stream_) {
+    return false;
+  }
+  writeValue(stream_, LOG_MAGIC);
+  writeValue(stream_, LOG_VERSION);
+  return static_cast<bool>(stream_);
+}
+
+void ReplayLogWriter::write(const ReplayEvent & event)
+{
+  writeValue(stream_, event.type);
+  writeValue(stream_, event.stamp);
+  switch (event.type) {
+    case ReplayEvent::ODOMETRY:
+      writeValue(stream_, event.x);
+      writeValue(stream_, event.y);
+      writeValue(stream_, event.theta);
+      writeValue(stream_, event.angular_velocity);
+      break;
+    case ReplayEvent::SCAN:
+      writeValue(stream_, event.angle_min);
+      writeValue(stream_, event.angle_max);
+      writeValue(stream_, event.range_min);
+      writeValue(stream_, event.range_max);
+      writeValue(stream_, static_cast<uint32_t>(event.ranges.size()));
+      stream_.write(
+        reinterpret_cast<const char *>(event.ranges.data()),
+        event.ranges.size() * sizeof(float));
+      break;
+    case ReplayEvent::GROUND_TRUTH:
+      writeValue(stream_, event.x);
+      writeValue(stream_, event.y);
+      writeValue(stream_, event.theta);
+      break;
+  }
+}
+
+void ReplayLogWriter::close()
+{
+  stream_.close();
+}
+
+std::vector<ReplayEvent> readReplayLog(const std::string & file)
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("[readReplayLog] Error: could not open " + file + ".");
+  }
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  if (!readValue(stream, &magic) || !readValue(stream, &version) || (magic != LOG_MAGIC) ||
+    (version != LOG_VERSION))
+  {
+    throw std::runtime_error("[readReplayLog] Error: " + file + " is not a replay log.");
+  }
+
+  std::vector<ReplayEvent> events;
+  ReplayEvent event;
+  while (readValue(stream, &event.type) && readValue(stream, &event.stamp)) {
+    bool complete = false;
+    switch (event.type) {
+      case ReplayEvent::ODOMETRY:
+        complete = readValue(stream, &event.x) && readValue(stream, &event.y) &&
+          readValue(stream, &event.theta) && readValue(stream, &event.angular_velocity);
+        break;
+      case ReplayEvent::SCAN: {
+          uint32_t num_ranges = 0;
+          complete = readValue(stream, &event.angle_min) && readValue(stream, &event.angle_max) &&
+            readValue(stream, &event.range_min) && readValue(stream, &event.range_max) &&
+            readValue(stream, &num_ranges);
+          if (complete) {
+            event.ranges.resize(num_ranges);
+            complete = static_cast<bool>(
+              stream.read(
+                reinterpret_cast<char *>(event.ranges.data()),
+                num_ranges * sizeof(float)));
+          }
+          break;
+        }
+      case ReplayEvent::GROUND_TRUTH:
+        complete = readValue(stream, &event.x) && readValue(stream, &event.y) &&
+          readValue(stream, &event.theta);
+        break;
+      default:
+        throw std::runtime_error(
+                "[readReplayLog] Error: unknown event type in " + file + ".");
+    }
+    if (!complete) {
+      break;
+    }
+    events.push_back(event);
+    event.ranges.clear();
+  }
+  return events;
+}
+
+} // namespace particle_filter
@@ -0,0 +1,156 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ghost_estimation/particle_filter/scan_preprocessor.hpp"
+#include "ghost_util/angle_util.hpp"
+
+namespace particle_filter
+{
+
+ScanPreprocessor::ScanPreprocessor(const ScanPreprocessorConfig & config)
+: config_(config)
+{
+  if (config_.resize_factor <= 0.0) {
+    throw std::runtime_error(
+            "[ScanPreprocessor::ScanPreprocessor] Error: resize_factor must be positive.");
+  }
+  if (config_.mask_angles.size() % 2 != 0) {
+    throw std::runtime_error(
+            "[ScanPreprocessor::ScanPreprocessor] Error: mask_angles must hold [min, max] pairs.");
+  }
+}
+
+bool ScanPreprocessor::isMasked(int index, float angle) const
+{
+  if (config_.use_skip_range && (index >= config_.skip_index_min) &&
+    (index <= config_.skip_index_max))
+  {
+    return true;
+  }
+  double wrapped = ghost_util::WrapAnglePI(angle);
+  for (std::size_t i = 0; i + 1 < config_.mask_angles.size(); i += 2) {
+    double lo = ghost_util::WrapAnglePI(config_.mask_angles[i]);
+    double hi = ghost_util::WrapAnglePI(config_.mask_angles[i + 1]);
+    // A window with min > max wraps through +-pi
+    bool inside = (lo <= hi) ? ((wrapped >= lo) && (wrapped <= hi)) :
+      ((wrapped >= lo) || (wrapped <= hi));
+    if (inside) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ScanPreprocessor::updateCandidates(int num_ranges, float angle_min, float angle_max)
+{
+  if ((num_ranges == num_ranges_) && (angle_min == angle_min_) && (angle_max == angle_max_)) {
+    return;
+  }
+  candidates_.clear();
+  int num_beams = (int)(num_ranges / config_.resize_factor);
+  for (int i = 0; i < num_beams; i++) {
+    int index = i * config_.resize_factor;
+    float angle = angle_min + config_.resize_factor * i / num_ranges * (angle_max - angle_min);
+    if (isMasked(index, angle)) {
+      continue;
+    }
+    candidates_.index.push_back(index);
+    candidates_.range.push_back(0.0);
+    candidates_.angle.push_back(angle);
+    candidates_.cos.push_back(std::cos(angle));
+    candidates_.sin.push_back(std::sin(angle));
+  }
+  num_ranges_ = num_ranges;
+  angle_min_ = angle_min;
+  angle_max_ = angle_max;
+}
+
+void ScanPreprocessor::process(
+  const std::vector<float> & ranges, float angle_min, float angle_max,
+  PreprocessedScan * scan_ptr)
+{
+  PreprocessedScan & scan = *scan_ptr;
+  updateCandidates(ranges.size(), angle_min, angle_max);
+  scan.clear();
+
+  const int num_candidates = candidates_.size();
+  const bool select = (config_.max_beams > 0) && (num_candidates > config_.max_beams);
+  if (!select) {
+    for (int j = 0; j < num_candidates; j++) {
+      float range = ranges[candidates_.index[j]];
+      if (isValid(range)) {
+        scan.index.push_back(candidates_.index[j]);
+        scan.range.push_back(range);
+        scan.angle.push_back(candidates_.angle[j]);
+        scan.cos.push_back(candidates_.cos[j]);
+        scan.sin.push_back(candidates_.sin[j]);
+      }
+    }
+    return;
+  }
+
+  // Curvature against the neighbouring candidate readings, invalid neighbours count as flat
+  const int stride = std::max(1, static_cast<int>(config_.resize_factor));
+  const int num_ranges = ranges.size();
+  scores_.resize(num_candidates);
+  for (int j = 0; j < num_candidates; j++) {
+    int index = candidates_.index[j];
+    float range = ranges[index];
+    if (!isValid(range)) {
+      scores_[j] = -1.0;
+      continue;
+    }
+    float prev = (index - stride >= 0) ? ranges[index - stride] : range;
+    float next = (index + stride < num_ranges) ? ranges[index + stride] : range;
+    prev = isValid(prev) ? prev : range;
+    next = isValid(next) ? next : range;
+    scores_[j] = std::abs(prev + next - 2.0f * range);
+  }
+
+  for (int sector = 0; sector < config_.max_beams; sector++) {
+    int begin = (int64_t)sector * num_candidates / config_.max_beams;
+    int end = (int64_t)(sector + 1) * num_candidates / config_.max_beams;
+    int best = -1;
+    for (int j = begin; j < end; j++) {
+      if ((scores_[j] >= 0.0) && ((best < 0) || (scores_[j] > scores_[best]))) {
+        best = j;
+      }
+    }
+    if (best >= 0) {
+      scan.index.push_back(candidates_.index[best]);
+      scan.range.push_back(ranges[candidates_.index[best]]);
+      scan.angle.push_back(candidates_.angle[best]);
+      scan.cos.push_back(candidates_.cos[best]);
+      scan.sin.push_back(candidates_.sin[best]);
+    }
+  }
+}
+
+} // namespace particle_filter
@@ -0,0 +1,279 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "ghost_estimation/vector_map/line_grid.hpp"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using std::vector;
+
+namespace vector_map
+{
+
+namespace
+{
+
+// Clips p0 + t * d for t in [0, 1] to an axis aligned box (Liang-Barsky). Returns false if the
+// segment misses the box, otherwise the clipped parameter range.
+bool clipSegment(
+  const Vector2f & p0, const Vector2f & d, const Vector2f & box_min,
+  const Vector2f & box_max, float * t_enter, float * t_leave)
+{
+  *t_enter = 0.0;
+  *t_leave = 1.0;
+  for (int axis = 0; axis < 2; axis++) {
+    if (d[axis] == 0.0) {
+      if ((p0[axis] < box_min[axis]) || (p0[axis] > box_max[axis])) {
+        return false;
+      }
+      continue;
+    }
+    float ta = (box_min[axis] - p0[axis]) / d[axis];
+    float tb = (box_max[axis] - p0[axis]) / d[axis];
+    if (ta > tb) {
+      std::swap(ta, tb);
+    }
+    *t_enter = std::max(*t_enter, ta);
+    *t_leave = std::min(*t_leave, tb);
+    if (*t_enter > *t_leave) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool boxesOverlap(
+  const Line2f & line, const Vector2f & box_min, const Vector2f & box_max)
+{
+  return !(((line.p0.x() < box_min.x()) && (line.p1.x() < box_min.x())) ||
+         ((line.p0.y() < box_min.y()) && (line.p1.y() < box_min.y())) ||
+         ((line.p0.x() > box_max.x()) && (line.p1.x() > box_max.x())) ||
+         ((line.p0.y() > box_max.y()) && (line.p1.y() > box_max.y())));
+}
+
+} // namespace
+
+void LineGrid::clear()
+{
+  width_ = 0;
+  height_ = 0;
+  num_lines_ = 0;
+  cell_start_.clear();
+  cell_entries_.clear();
+}
+
+void LineGrid::build(const vector<Line2f> & lines, float cell_size)
+{
+  if (cell_size <= 0.0) {
+    throw std::runtime_error("[LineGrid::build] Error: cell size must be positive.");
+  }
+  clear();
+  if (lines.empty()) {
+    return;
+  }
+
+  Vector2f min_corner = lines[0].p0;
+  Vector2f max_corner = lines[0].p0;
+  for (const Line2f & line : lines) {
+    min_corner = min_corner.cwiseMin(line.p0).cwiseMin(line.p1);
+    max_corner = max_corner.cwiseMax(line.p0).cwiseMax(line.p1);
+  }
+  origin_ = min_corner;
+  cell_size_ = cell_size;
+  inv_cell_size_ = 1.0 / cell_size;
+  Vector2f extent = (max_corner - min_corner) * inv_cell_size_;
+  width_ = static_cast<int>(extent.x()) + 1;
+  height_ = static_cast<int>(extent.y()) + 1;
+
+  // Visit every cell a line passes through, testing each cell in its bounding box. Cells are grown
+  // slightly so lines on a cell boundary land in both neighbours.
+  const float kCellMargin = 1e-4;
+  auto for_each_line_cell = [&](const Line2f & line, auto visit) {
+      Vector2f g0 = (line.p0 - origin_) * inv_cell_size_;
+      Vector2f g1 = (line.p1 - origin_) * inv_cell_size_;
+      Vector2f lo = g0.cwiseMin(g1) - Vector2f::Constant(kCellMargin);
+      Vector2f hi = g0.cwiseMax(g1) + Vector2f::Constant(kCellMargin);
+      int col_min = std::max(0, static_cast<int>(std::floor(lo.x())));
+      int col_max = std::min(width_ - 1, static_cast<int>(hi.x()));
+      int row_min = std::max(0, static_cast<int>(std::floor(lo.y())));
+      int row_max = std::min(height_ - 1, static_cast<int>(hi.y()));
+      for (int row = row_min; row <= row_max; row++) {
+        for (int col = col_min; col <= col_max; col++) {
+          float t_enter, t_leave;
+          Vector2f cell_min(col - kCellMargin, row - kCellMargin);
+          Vector2f cell_max(col + 1 + kCellMargin, row + 1 + kCellMargin);
+          if (clipSegment(g0, g1 - g0, cell_min, cell_max, &t_enter, &t_leave)) {
+            visit(row * width_ + col);
+          }
+        }
+      }
+    };
+
+  // Count entries per cell, then fill in cell order
+  cell_start_.assign(width_ * height_ + 1, 0);
+  for (const Line2f & line : lines) {
+    for_each_line_cell(line, [&](int cell) {cell_start_[cell + 1]++;});
+  }
+  for (size_t i = 1; i < cell_start_.size(); i++) {
+    cell_start_[i] += cell_start_[i - 1];
+  }
+  cell_entries_.resize(cell_start_.back());
+  vector<int> cell_fill(cell_start_.begin(), cell_start_.end() - 1);
+  for (size_t i = 0; i < lines.size(); i++) {
+    for_each_line_cell(
+      lines[i], [&](int cell) {
+        cell_entries_[cell_fill[cell]++] = Entry{lines[i], static_cast<int>(i)};
+      });
+  }
+  num_lines_ = lines.size();
+}
+
+template<typename Visitor>
+void LineGrid::traverse(const Vector2f & p0, const Vector2f & p1, Visitor visit) const
+{
+  const Vector2f g0 = (p0 - origin_) * inv_cell_size_;
+  const Vector2f d = (p1 - p0) * inv_cell_size_;
+  float t_enter, t_leave;
+  if (!clipSegment(g0, d, Vector2f(0, 0), Vector2f(width_, height_), &t_enter, &t_leave)) {
+    return;
+  }
+
+  const Vector2f start = g0 + t_enter * d;
+  int col = std::min(std::max(static_cast<int>(std::floor(start.x())), 0), width_ - 1);
+  int row = std::min(std::max(static_cast<int>(std::floor(start.y())), 0), height_ - 1);
+
+  const float inf = std::numeric_limits<float>::infinity();
+  const int step_col = (d.x() > 0.0) ? 1 : ((d.x() < 0.0) ? -1 : 0);
+  const int step_row = (d.y() > 0.0) ? 1 : ((d.y() < 0.0) ? -1 : 0);
+  const float t_delta_col = (step_col != 0) ? std::abs(1.0 / d.x()) : inf;
+  const float t_delta_row = (step_row != 0) ? std::abs(1.0 / d.y()) : inf;
+  float t_max_col = (step_col != 0) ? (col + (step_col > 0) - g0.x()) / d.x() : inf;
+  float t_max_row = (step_row != 0) ? (row + (step_row > 0) - g0.y()) / d.y() : inf;
+
+  while (true) {
+    const float t_exit = std::min(std::min(t_max_col, t_max_row), t_leave);
+    if (!visit(col, row, t_exit) || (t_exit >= t_leave)) {
+      return;
+    }
+    if (t_max_col < t_max_row) {
+      col += step_col;
+      t_max_col += t_delta_col;
+    } else {
+      row += step_row;
+      t_max_row += t_delta_row;
+    }
+    if ((col < 0) || (col >= width_) || (row < 0) || (row >= height_)) {
+      return;
+    }
+  }
+}
+
+void LineGrid::queryBox(
+  const Vector2f & min_corner, const Vector2f & max_corner,
+  vector<int> * line_indices) const
+{
+  line_indices->clear();
+  if (empty()) {
+    return;
+  }
+  Vector2f g_min = (min_corner - origin_) * inv_cell_size_;
+  Vector2f g_max = (max_corner - origin_) * inv_cell_size_;
+  if ((g_max.x() < 0.0) || (g_max.y() < 0.0) || (g_min.x() >= width_) || (g_min.y() >= height_)) {
+    return;
+  }
+  int col_min = std::max(0, static_cast<int>(std::floor(g_min.x())));
+  int col_max = std::min(width_ - 1, static_cast<int>(g_max.x()));
+  int row_min = std::max(0, static_cast<int>(std::floor(g_min.y())));
+  int row_max = std::min(height_ - 1, static_cast<int>(g_max.y()));
+  for (int row = row_min; row <= row_max; row++) {
+    for (int col = col_min; col <= col_max; col++) {
+      int cell = row * width_ + col;
+      for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; i++) {
+        if (boxesOverlap(cell_entries_[i].line, min_corner, max_corner)) {
+          line_indices->push_back(cell_entries_[i].index);
+        }
+      }
+    }
+  }
+  // Lines spanning several cells are found once per cell
+  std::sort(line_indices->begin(), line_indices->end());
+  line_indices->erase(
+    std::unique(line_indices->begin(), line_indices->end()), line_indices->end());
+}
+
+int LineGrid::raycast(const Vector2f & p0, Vector2f * ray_end, int skip_line_idx) const
+{
+  const Vector2f p1 = *ray_end;
+  const Vector2f ray = p1 - p0;
+  const float sq_length = ray.squaredNorm();
+  if (empty() || (sq_length == 0.0)) {
+    return -1;
+  }
+
+  int best_idx = -1;
+  float best_t = std::numeric_limits<float>::infinity();
+  Vector2f intersection;
+  traverse(
+    p0, p1, [&](int col, int row, float t_exit) {
+      int cell = row * width_ + col;
+      for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; i++) {
+        const Entry & entry = cell_entries_[i];
+        if ((entry.index != skip_line_idx) && entry.line.Intersection(p0, p1, &intersection)) {
+          float t = (intersection - p0).dot(ray) / sq_length;
+          if (t < best_t) {
+            best_t = t;
+            best_idx = entry.index;
+            *ray_end = intersection;
+          }
+        }
+      }
+      // Cells further along can only hold hits beyond t_exit
+      return best_t > t_exit;
+    });
+  return best_idx;
+}
+
+bool LineGrid::intersects(const Vector2f & p0, const Vector2f & p1) const
+{
+  if (empty()) {
+    return false;
+  }
+  bool found = false;
+  traverse(
+    p0, p1, [&](int col, int row, float /*t_exit*/) {
+      int cell = row * width_ + col;
+      for (int i = cell_start_[cell]; (i < cell_start_[cell + 1]) && !found; i++) {
+        found = cell_entries_[i].line.Intersects(p0, p1);
+      }
+      return !found;
+    });
+  return found;
+}
+
+} // namespace vector_map
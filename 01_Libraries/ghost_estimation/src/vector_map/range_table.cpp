@@ -0,0 +1,314 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "ghost_estimation/vector_map/range_table.hpp"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using std::vector;
+
+namespace vector_map
+{
+
+namespace
+{
+
+constexpr uint32_t TABLE_MAGIC = 0x54524847;   // "GHRT"
+constexpr uint32_t TABLE_VERSION = 1;
+
+// Fixed layout file header, range data follows immediately after.
+struct RangeTableHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t hash;
+  int32_t width;
+  int32_t height;
+  int32_t num_angles;
+  int32_t reserved;
+  float origin_x;
+  float origin_y;
+  float xy_resolution;
+  float range_max;
+};
+
+} // namespace
+
+RangeTable::~RangeTable()
+{
+  close();
+}
+
+void RangeTable::close()
+{
+  if (mmap_addr_ != nullptr) {
+    munmap(mmap_addr_, mmap_size_);
+    mmap_addr_ = nullptr;
+    mmap_size_ = 0;
+  }
+  owned_ranges_.clear();
+  owned_ranges_.shrink_to_fit();
+  ranges_ = nullptr;
+}
+
+uint64_t RangeTable::hashMap(const VectorMap & map, const RangeTableConfig & config)
+{
+  uint64_t hash = map.Hash();
+  hash = HashBytes(&TABLE_VERSION, sizeof(TABLE_VERSION), hash);
+  hash = HashBytes(&config.xy_resolution, sizeof(config.xy_resolution), hash);
+  hash = HashBytes(&config.num_angles, sizeof(config.num_angles), hash);
+  return HashBytes(&config.range_max, sizeof(config.range_max), hash);
+}
+
+float RangeTable::castRay(
+  const vector<Line2f> & lines, const Vector2f & loc, float angle,
+  float range_max)
+{
+  const Line2f ray(loc, loc + range_max * Vector2f(cos(angle), sin(angle)));
+  float range = range_max;
+  Vector2f intersection;
+  for (const Line2f & line : lines) {
+    if (ray.Intersection(line, &intersection)) {
+      range = std::min(range, (intersection - loc).norm());
+    }
+  }
+  return range;
+}
+
+void RangeTable::generate(
+  const VectorMap & map, const RangeTableConfig & config,
+  ghost_util::ThreadPool * thread_pool)
+{
+  if ((config.xy_resolution <= 0.0) || (config.num_angles <= 0) || (config.range_max <= 0.0)) {
+    throw std::runtime_error(
+            "[RangeTable::generate] Error: resolution, angles and range must be positive.");
+  }
+  if (map.lines.empty()) {
+    throw std::runtime_error("[RangeTable::generate] Error: map has no lines.");
+  }
+  close();
+
+  Vector2f min_corner = map.lines[0].p0;
+  Vector2f max_corner = map.lines[0].p0;
+  for (const Line2f & line : map.lines) {
+    min_corner = min_corner.cwiseMin(line.p0).cwiseMin(line.p1);
+    max_corner = max_corner.cwiseMax(line.p0).cwiseMax(line.p1);
+  }
+
+  origin_ = min_corner;
+  xy_resolution_ = config.xy_resolution;
+  inv_xy_resolution_ = 1.0 / xy_resolution_;
+  num_angles_ = config.num_angles;
+  angle_resolution_ = 2.0 * M_PI / num_angles_;
+  range_max_ = config.range_max;
+  range_scale_ = range_max_ / UINT16_MAX;
+  Vector2f extent = (max_corner - min_corner) * inv_xy_resolution_;
+  width_ = std::max(1, static_cast<int>(std::ceil(extent.x())));
+  height_ = std::max(1, static_cast<int>(std::ceil(extent.y())));
+  hash_ = hashMap(map, config);
+
+  owned_ranges_.resize(getMemoryBytes() / sizeof(uint16_t));
+  auto generate_rows = [&](int begin, int end, int /*thread_index*/) {
+      for (int row = begin; row < end; row++) {
+        for (int col = 0; col < width_; col++) {
+          Vector2f center = origin_ + xy_resolution_ * Vector2f(col + 0.5, row + 0.5);
+          uint16_t * cell = &owned_ranges_[(static_cast<size_t>(row) * width_ + col) * num_angles_];
+          for (int a = 0; a < num_angles_; a++) {
+            const float angle = a * angle_resolution_;
+            Vector2f ray_end = center + range_max_ * Vector2f(cos(angle), sin(angle));
+            map.GetRayIntersection(center, &ray_end);
+            float range = std::min((ray_end - center).norm(), range_max_);
+            cell[a] = static_cast<uint16_t>(std::lround(range / range_scale_));
+          }
+        }
+      }
+    };
+  if (thread_pool != nullptr) {
+    thread_pool->parallelFor(height_, generate_rows);
+  } else {
+    generate_rows(0, height_, 0);
+  }
+  ranges_ = owned_ranges_.data();
+}
+
+bool RangeTable::save(const std::string & file) const
+{
+  if (empty()) {
+    return false;
+  }
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  RangeTableHeader header{TABLE_MAGIC, TABLE_VERSION, hash_, width_, height_, num_angles_, 0,
+    origin_.x(), origin_.y(), xy_resolution_, range_max_};
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(ranges_), getMemoryBytes());
+  return out.good();
+}
+
+bool RangeTable::open(const std::string & file, uint64_t expected_hash)
+{
+  int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) != 0) || (file_stat.st_size < (off_t)sizeof(RangeTableHeader))) {
+    ::close(fd);
+    return false;
+  }
+  size_t size = file_stat.st_size;
+  void * addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+
+  const RangeTableHeader & header = *static_cast<const RangeTableHeader *>(addr);
+  size_t data_size = static_cast<size_t>(std::max(header.width, 0)) *
+    std::max(header.height, 0) * std::max(header.num_angles, 0) * sizeof(uint16_t);
+  if ((header.magic != TABLE_MAGIC) || (header.version != TABLE_VERSION) ||
+    (header.hash != expected_hash) || (data_size == 0) ||
+    (size != sizeof(RangeTableHeader) + data_size))
+  {
+    munmap(addr, size);
+    return false;
+  }
+
+  close();
+  mmap_addr_ = addr;
+  mmap_size_ = size;
+  origin_ = Vector2f(header.origin_x, header.origin_y);
+  xy_resolution_ = header.xy_resolution;
+  inv_xy_resolution_ = 1.0 / xy_resolution_;
+  num_angles_ = header.num_angles;
+  angle_resolution_ = 2.0 * M_PI / num_angles_;
+  range_max_ = header.range_max;
+  range_scale_ = range_max_ / UINT16_MAX;
+  width_ = header.width;
+  height_ = header.height;
+  hash_ = header.hash;
+  ranges_ = reinterpret_cast<const uint16_t *>(
+    static_cast<const uint8_t *>(addr) + sizeof(RangeTableHeader));
+  return true;
+}
+
+bool RangeTable::openOrGenerate(
+  const VectorMap & map, const RangeTableConfig & config, const std::string & file,
+  ghost_util::ThreadPool * thread_pool)
+{
+  uint64_t hash = hashMap(map, config);
+  if (!empty() && (hash_ == hash)) {
+    return true;
+  }
+  if (!file.empty() && open(file, hash)) {
+    return true;
+  }
+  generate(map, config, thread_pool);
+  if (!file.empty()) {
+    // Map the saved copy so the generated table does not stay on the heap
+    if (!save(file) || !open(file, hash)) {
+      std::cout << "[RangeTable] Unable to write table file " << file << std::endl;
+    }
+  }
+  return false;
+}
+
+int RangeTable::getAngleIndex(float angle) const
+{
+  float wrapped = std::fmod(angle, static_cast<float>(2.0 * M_PI));
+  if (wrapped < 0.0) {
+    wrapped += 2.0 * M_PI;
+  }
+  int index = static_cast<int>(wrapped / angle_resolution_ + 0.5);
+  return (index >= num_angles_) ? index - num_angles_ : index;
+}
+
+float RangeTable::getRange(const Vector2f & loc, float angle) const
+{
+  float x = (loc.x() - origin_.x()) * inv_xy_resolution_;
+  float y = (loc.y() - origin_.y()) * inv_xy_resolution_;
+  if ((x < 0.0) || (y < 0.0) || (x >= width_) || (y >= height_)) {
+    return range_max_;
+  }
+  return getCellRange(static_cast<int>(x), static_cast<int>(y), getAngleIndex(angle));
+}
+
+float RangeTable::getRangeInterpolated(const Vector2f & loc, float angle) const
+{
+  float x = (loc.x() - origin_.x()) * inv_xy_resolution_;
+  float y = (loc.y() - origin_.y()) * inv_xy_resolution_;
+  if ((x < 0.0) || (y < 0.0) || (x >= width_) || (y >= height_)) {
+    return range_max_;
+  }
+
+  // Interpolate between cell centers, holding the edge value in the outer half cells
+  x = std::min(std::max(x - 0.5f, 0.0f), width_ - 1.0f);
+  y = std::min(std::max(y - 0.5f, 0.0f), height_ - 1.0f);
+  int col0 = static_cast<int>(x);
+  int row0 = static_cast<int>(y);
+  int col1 = std::min(col0 + 1, width_ - 1);
+  int row1 = std::min(row0 + 1, height_ - 1);
+  float tx = x - col0;
+  float ty = y - row0;
+  int angle_index = getAngleIndex(angle);
+
+  float bottom = (1.0 - tx) * getCellRange(col0, row0, angle_index) +
+    tx * getCellRange(col1, row0, angle_index);
+  float top = (1.0 - tx) * getCellRange(col0, row1, angle_index) +
+    tx * getCellRange(col1, row1, angle_index);
+  return (1.0 - ty) * bottom + ty * top;
+}
+
+void RangeTable::GetPredictedScan(
+  const Vector2f & loc,
+  float range_max,
+  float angle_min,
+  float angle_max,
+  int num_rays,
+  bool interpolate,
+  vector<float> * scan_ptr) const
+{
+  vector<float> & scan = *scan_ptr;
+  scan.resize(num_rays);
+  const float da = (angle_max - angle_min) / static_cast<float>(num_rays);
+  for (int i = 0; i < num_rays; ++i) {
+    const float a = angle_min + static_cast<float>(i) * da;
+    const float range = interpolate ? getRangeInterpolated(loc, a) : getRange(loc, a);
+    scan[i] = std::min(range, range_max);
+  }
+}
+
+} // namespace vector_map
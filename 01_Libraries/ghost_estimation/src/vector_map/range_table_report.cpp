@@ -0,0 +1,151 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ghost_estimation/vector_map/range_table.hpp"
+#include "ghost_util/thread_pool.hpp"
+
+/**
+ * Reports range table accuracy against exact ray casting, and the memory each resolution costs,
+ * to help pick range_table_xy_resolution and range_table_num_angles for a map.
+ *
+ * Usage: range_table_report <map_file> [range_max=5.0] [num_samples=20000] [max_table_mb=512]
+ */
+
+using Eigen::Vector2f;
+using vector_map::RangeTable;
+using vector_map::RangeTableConfig;
+using vector_map::VectorMap;
+
+namespace
+{
+
+struct ErrorStats
+{
+  double mean;
+  double p95;
+  double max;
+};
+
+ErrorStats getErrorStats(std::vector<float> errors)
+{
+  ErrorStats stats{0.0, 0.0, 0.0};
+  if (errors.empty()) {
+    return stats;
+  }
+  std::sort(errors.begin(), errors.end());
+  for (float error : errors) {
+    stats.mean += error;
+  }
+  stats.mean /= errors.size();
+  stats.p95 = errors[static_cast<size_t>(0.95 * (errors.size() - 1))];
+  stats.max = errors.back();
+  return stats;
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2) {
+    printf("Usage: %s <map_file> [range_max=5.0] [num_samples=20000] [max_table_mb=512]\n", argv[0]);
+    return 1;
+  }
+  VectorMap map(argv[1]);
+  float range_max = (argc > 2) ? atof(argv[2]) : 5.0;
+  int num_samples = (argc > 3) ? atoi(argv[3]) : 20000;
+  double max_table_mb = (argc > 4) ? atof(argv[4]) : 512.0;
+  if (map.lines.empty()) {
+    printf("Map %s has no lines\n", argv[1]);
+    return 1;
+  }
+
+  // Sample poses uniformly over the map bounds, with exact ranges from brute force ray casts
+  Vector2f min_corner = map.lines[0].p0;
+  Vector2f max_corner = map.lines[0].p0;
+  for (const auto & line : map.lines) {
+    min_corner = min_corner.cwiseMin(line.p0).cwiseMin(line.p1);
+    max_corner = max_corner.cwiseMax(line.p0).cwiseMax(line.p1);
+  }
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> x_dist(min_corner.x(), max_corner.x());
+  std::uniform_real_distribution<float> y_dist(min_corner.y(), max_corner.y());
+  std::uniform_real_distribution<float> angle_dist(-M_PI, M_PI);
+  std::vector<Vector2f> locs(num_samples);
+  std::vector<float> angles(num_samples);
+  std::vector<float> exact(num_samples);
+  for (int i = 0; i < num_samples; i++) {
+    locs[i] = Vector2f(x_dist(rng), y_dist(rng));
+    angles[i] = angle_dist(rng);
+    exact[i] = RangeTable::castRay(map.lines, locs[i], angles[i], range_max);
+  }
+
+  printf(
+    "Map %s: %zu lines, %.2f x %.2f m, range_max %.2f m, %d samples\n", argv[1], map.lines.size(),
+    max_corner.x() - min_corner.x(), max_corner.y() - min_corner.y(), range_max, num_samples);
+  printf(
+    "%8s %7s %10s %10s | %-26s | %-26s\n", "xy (m)", "angles", "size (MB)", "gen (ms)",
+    "nearest mean/p95/max (m)", "bilinear mean/p95/max (m)");
+
+  ghost_util::ThreadPool thread_pool;
+  for (float xy_resolution : {0.2f, 0.1f, 0.05f, 0.025f}) {
+    for (int num_angles : {180, 360, 720}) {
+      RangeTableConfig config{xy_resolution, num_angles, range_max};
+      Vector2f extent = (max_corner - min_corner) / xy_resolution;
+      double table_mb = std::ceil(extent.x()) * std::ceil(extent.y()) * num_angles *
+        sizeof(uint16_t) / 1e6;
+      if (table_mb > max_table_mb) {
+        printf("%8.3f %7d %10.1f %10s | skipped, over %.0f MB\n", xy_resolution, num_angles,
+          table_mb, "-", max_table_mb);
+        continue;
+      }
+
+      RangeTable table;
+      auto start = std::chrono::steady_clock::now();
+      table.generate(map, config, &thread_pool);
+      double gen_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+      std::vector<float> nearest_errors(num_samples);
+      std::vector<float> bilinear_errors(num_samples);
+      for (int i = 0; i < num_samples; i++) {
+        nearest_errors[i] = std::abs(table.getRange(locs[i], angles[i]) - exact[i]);
+        bilinear_errors[i] = std::abs(table.getRangeInterpolated(locs[i], angles[i]) - exact[i]);
+      }
+      ErrorStats nearest = getErrorStats(nearest_errors);
+      ErrorStats bilinear = getErrorStats(bilinear_errors);
+      printf(
+        "%8.3f %7d %10.1f %10.0f | %8.4f %8.4f %8.4f | %8.4f %8.4f %8.4f\n", xy_resolution,
+        num_angles, table.getMemoryBytes() / 1e6, gen_ms, nearest.mean, nearest.p95, nearest.max,
+        bilinear.mean, bilinear.p95, bilinear.max);
+    }
+  }
+  return 0;
+}
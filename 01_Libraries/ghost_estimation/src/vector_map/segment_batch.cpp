@@ -0,0 +1,98 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "ghost_estimation/vector_map/segment_batch.hpp"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using std::vector;
+
+namespace vector_map
+{
+
+void SegmentBatch::resize(size_t num_segments)
+{
+  num_segments_ = num_segments;
+  size_t num_batches = (num_segments + SIMD_WIDTH - 1) / SIMD_WIDTH;
+  const FloatBatch zero = {};
+  p0_x_.assign(num_batches, zero);
+  p0_y_.assign(num_batches, zero);
+  d_x_.assign(num_batches, zero);
+  d_y_.assign(num_batches, zero);
+}
+
+void SegmentBatch::assign(const vector<Line2f> & lines)
+{
+  resize(lines.size());
+  for (size_t i = 0; i < lines.size(); i++) {
+    const Line2f & line = lines[i];
+    p0_x_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p0.x();
+    p0_y_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p0.y();
+    d_x_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p1.x() - line.p0.x();
+    d_y_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p1.y() - line.p0.y();
+  }
+}
+
+void SegmentBatch::assign(const vector<Line2f> & lines, const vector<int> & line_indices)
+{
+  resize(line_indices.size());
+  for (size_t i = 0; i < line_indices.size(); i++) {
+    const Line2f & line = lines[line_indices[i]];
+    p0_x_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p0.x();
+    p0_y_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p0.y();
+    d_x_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p1.x() - line.p0.x();
+    d_y_[i / SIMD_WIDTH][i % SIMD_WIDTH] = line.p1.y() - line.p0.y();
+  }
+}
+
+float SegmentBatch::castRay(const Vector2f & origin, const Vector2f & direction, float range_max)
+const
+{
+  // Solving origin + t * r = p0 + u * d with cross products gives
+  //   t = (q x d) / (r x d),  u = (q x r) / (r x d),  q = p0 - origin
+  // A segment is hit when the denominator is nonzero, 0 <= t and 0 <= u <= 1. Lanes with a zero
+  // denominator produce inf or nan, which fail every comparison.
+  const FloatBatch zero = {};
+  const FloatBatch o_x = zero + origin.x();
+  const FloatBatch o_y = zero + origin.y();
+  const FloatBatch r_x = zero + direction.x();
+  const FloatBatch r_y = zero + direction.y();
+  FloatBatch best = zero + range_max;
+  for (size_t b = 0; b < p0_x_.size(); b++) {
+    const FloatBatch q_x = p0_x_[b] - o_x;
+    const FloatBatch q_y = p0_y_[b] - o_y;
+    const FloatBatch inv_denom = 1.0f / (r_x * d_y_[b] - r_y * d_x_[b]);
+    const FloatBatch t = (q_x * d_y_[b] - q_y * d_x_[b]) * inv_denom;
+    const FloatBatch u = (q_x * r_y - q_y * r_x) * inv_denom;
+    best = ((t >= zero) & (u >= zero) & (u <= 1.0f) & (t < best)) ? t : best;
+  }
+
+  float range = range_max;
+  for (int lane = 0; lane < SIMD_WIDTH; lane++) {
+    range = (best[lane] < range) ? best[lane] : range;
+  }
+  return range;
+}
+
+} // namespace vector_map
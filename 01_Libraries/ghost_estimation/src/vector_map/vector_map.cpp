@@ -29,6 +29,7 @@
 #include "eigen3/Eigen/Geometry"
 #include "gflags/gflags.h"
 
+#include "ghost_estimation/vector_map/segment_batch.hpp"
 #include "ghost_estimation/vector_map/vector_map.hpp"
 #include "math/geometry.h"
 #include "math/line2d.h"
@@ -56,6 +57,11 @@ DEFINE_double(
   0.05,
   "Minimum line length to consider for Analytic ray casting");
 
+DEFINE_double(
+  map_grid_cell_size,
+  0.5,
+  "Cell size of the spatial index over map lines");
+
 namespace vector_map
 {
 
@@ -212,17 +218,24 @@ void TrimOcclusion(
 }
 
 
-void VectorMap::GetSceneLines(
+void VectorMap::GetSceneLineIndices(
   const Vector2f & loc,
   float max_range,
-  vector<Line2f> * lines_list) const
+  vector<int> * line_indices) const
 {
+  const Vector2f range(max_range, max_range);
+  if (IndexValid()) {
+    index.queryBox(loc - range, loc + range, line_indices);
+    return;
+  }
+
   const float x_min = loc.x() - max_range;
   const float y_min = loc.y() - max_range;
   const float x_max = loc.x() + max_range;
   const float y_max = loc.y() + max_range;
-  lines_list->clear();
-  for (const Line2f & l : lines) {
+  line_indices->clear();
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const Line2f & l = lines[i];
     if ((l.p0.x() < x_min) && (l.p1.x() < x_min) ) {
       continue;
     }
@@ -235,7 +248,20 @@ void VectorMap::GetSceneLines(
     if ((l.p0.y() > y_max) && (l.p1.y() > y_max) ) {
       continue;
     }
-    lines_list->push_back(l);
+    line_indices->push_back(i);
+  }
+}
+
+void VectorMap::GetSceneLines(
+  const Vector2f & loc,
+  float max_range,
+  vector<Line2f> * lines_list) const
+{
+  vector<int> line_indices;
+  GetSceneLineIndices(loc, max_range, &line_indices);
+  lines_list->clear();
+  for (int i : line_indices) {
+    lines_list->push_back(lines[i]);
   }
 }
 
@@ -312,6 +338,17 @@ int GetRayIntersection(
   return intersecting_line_idx;
 }
 
+int VectorMap::GetRayIntersection(
+  const Vector2f & loc,
+  Vector2f * ray_end,
+  int skip_line_idx) const
+{
+  if (IndexValid()) {
+    return index.raycast(loc, ray_end, skip_line_idx);
+  }
+  return vector_map::GetRayIntersection(loc, skip_line_idx, lines, ray_end);
+}
+
 void VectorMap::RayCast(
   const Vector2f & loc,
   float max_range,
@@ -320,8 +357,8 @@ void VectorMap::RayCast(
   static const float kEpsilon = 1e-4;
 
   // Small optimization: ignore all lines not within max_range.
-  vector<Line2f> lines_list;
-  GetSceneLines(loc, max_range, &lines_list);
+  vector<int> line_indices;
+  GetSceneLineIndices(loc, max_range, &line_indices);
 
   // NOTE(joydeep): In this function, "iidx" refers to the index of
   // the line segment from lines_list that intersects with the associated
@@ -340,15 +377,15 @@ void VectorMap::RayCast(
   };
   // Go through all lines, and check for intersection of rays.
   vector<RayCastRay> ray_cast_rays;
-  for (size_t i = 0; i < lines_list.size(); ++i) {
-    const Line2f & l = lines_list[i];
+  for (int i : line_indices) {
+    const Line2f & l = lines[i];
     const Vector2f dir = kEpsilon * (l.p1 - l.p0).normalized();
 
     // Add rays from loc to just inside of the line segment.
     Vector2f r0 = l.p0 + dir;
     Vector2f r1 = l.p1 - dir;
-    int r0_iidx = GetRayIntersection(loc, i, lines_list, &r0);
-    int r1_iidx = GetRayIntersection(loc, i, lines_list, &r1);
+    int r0_iidx = GetRayIntersection(loc, &r0, i);
+    int r1_iidx = GetRayIntersection(loc, &r1, i);
     if (r0_iidx < 0) {
       r0_iidx = i;
     }
@@ -361,8 +398,8 @@ void VectorMap::RayCast(
     // Add rays from loc to max_range just past the line segment.
     Vector2f end_p0 = loc + (l.p0 - dir - loc).normalized() * max_range;
     Vector2f end_p1 = loc + (l.p1 + dir - loc).normalized() * max_range;
-    const int end_p0_iidx = GetRayIntersection(loc, i, lines_list, &end_p0);
-    const int end_p1_iidx = GetRayIntersection(loc, i, lines_list, &end_p1);
+    const int end_p0_iidx = GetRayIntersection(loc, &end_p0, i);
+    const int end_p1_iidx = GetRayIntersection(loc, &end_p1, i);
     if (end_p0_iidx >= 0) {
       ray_cast_rays.push_back(RayCastRay(end_p0, end_p0_iidx));
     }
@@ -428,6 +465,7 @@ void VectorMap::Cleanup()
     ShrinkLine(kShrinkDistance, &l);
   }
   lines = new_lines;
+  BuildIndex();
 }
 
 void VectorMap::Load(const string & file)
@@ -444,11 +482,40 @@ void VectorMap::Load(const string & file)
   }
   fclose(fid);
   Cleanup();
+  BuildIndex();
   file_name = file;
 }
 
+void VectorMap::BuildIndex()
+{
+  index.build(lines, FLAGS_map_grid_cell_size);
+}
+
+uint64_t HashBytes(const void * data, size_t size, uint64_t hash)
+{
+  const uint8_t * bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+uint64_t VectorMap::Hash() const
+{
+  uint64_t hash = HashBytes(nullptr, 0);
+  for (const Line2f & l : lines) {
+    const float coords[4] = {l.p0.x(), l.p0.y(), l.p1.x(), l.p1.y()};
+    hash = HashBytes(coords, sizeof(coords), hash);
+  }
+  return hash;
+}
+
 bool VectorMap::Intersects(const Vector2f & v0, const Vector2f & v1) const
 {
+  if (IndexValid()) {
+    return index.intersects(v0, v1);
+  }
   for (const Line2f & l : lines) {
     if (l.Intersects(v0, v1)) {
       return true;
@@ -469,58 +536,17 @@ void VectorMap::GetPredictedScan(
   static CumulativeFunctionTimer function_timer_(__FUNCTION__);
   CumulativeFunctionTimer::Invocation invoke(&function_timer_);
   vector<float> & scan = *scan_ptr;
-  vector<Line2f> raycast;
-  SceneRender(loc, range_max, angle_min, angle_max, &raycast);
-  scan.resize(num_rays);
-  std::fill(scan.begin(), scan.end(), range_max);
-  if (raycast.empty()) {
-    return;
-  }
-  struct LineCast
-  {
-    Line2f line;
-    float a0;
-    float a1;
-    bool wraps_around;
-  };
-  vector<LineCast> line_cast;
-  for (size_t i = 0; i < raycast.size(); ++i) {
-    const Line2f & r = raycast[i];
-    LineCast l;
-    l.line.p0 = r.p0 - loc;
-    l.line.p1 = r.p1 - loc;
-    l.a0 = atan2(l.line.p0.y(), l.line.p0.x());
-    l.a1 = atan2(l.line.p1.y(), l.line.p1.x());
-    if (fabs(l.a0 - l.a1) < 0.0001) {
-      continue;
-    }
-    l.wraps_around = fabs(l.a1 - l.a0) > M_PI;
-    if ((l.wraps_around && (l.a0 < l.a1) ) ||
-      (!l.wraps_around && (l.a0 > l.a1) ))
-    {
-      swap(l.a0, l.a1);
-      swap(l.line.p0, l.line.p1);
-    }
-    line_cast.push_back(l);
-  }
-  if (line_cast.empty()) {
-    return;
-  }
-  // Iterate over the ray cast, filling the angles
   scan.resize(num_rays);
+
+  // Cast every ray against the lines in range, several lines per instruction
+  vector<int> line_indices;
+  GetSceneLineIndices(loc, range_max, &line_indices);
+  SegmentBatch segments;
+  segments.assign(lines, line_indices);
   const float da = (angle_max - angle_min) / static_cast<float>(num_rays);
   for (int i = 0; i < num_rays; ++i) {
-    const float a = AngleMod(angle_min + static_cast<float>(i) * da);
-    for (const LineCast & l : line_cast) {
-      if ((!l.wraps_around && (l.a0 <= a) && (l.a1 >= a)) ||
-        (l.wraps_around && ((l.a0 <= a) || (l.a1 >= a))))
-      {
-        const Vector2f n = l.line.UnitNormal();
-        const Vector2f r(cos(a), sin(a));
-        scan[i] = n.dot(l.line.p0) / n.dot(r);
-        break;
-      }
-    }
+    const float a = angle_min + static_cast<float>(i) * da;
+    scan[i] = segments.castRay(loc, Vector2f(cos(a), sin(a)), range_max);
   }
 }
 
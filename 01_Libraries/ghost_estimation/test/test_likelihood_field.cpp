@@ -0,0 +1,225 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/particle_filter/likelihood_field.hpp"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+#include "gtest/gtest.h"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using particle_filter::LikelihoodField;
+using vector_map::VectorMap;
+
+class TestLikelihoodField : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    // Box with an interior diagonal and a short wall, nothing aligned to the grid
+    map_ = VectorMap(
+      std::vector<Line2f>{
+        Line2f(0.03, 0.07, 3.11, 0.07),
+        Line2f(3.11, 0.07, 3.11, 2.93),
+        Line2f(3.11, 2.93, 0.03, 2.93),
+        Line2f(0.03, 2.93, 0.03, 0.07),
+        Line2f(0.6, 0.5, 2.4, 2.1),
+        Line2f(1.9, 0.4, 2.6, 0.9)});
+    other_map_ = VectorMap(
+      std::vector<Line2f>{
+        Line2f(0.0, 0.0, 2.0, 0.0),
+        Line2f(2.0, 0.0, 2.0, 2.0)});
+    cache_file_ = ::testing::TempDir() + "test_likelihood_field.bin";
+    std::remove(cache_file_.c_str());
+  }
+
+  void TearDown() override
+  {
+    std::remove(cache_file_.c_str());
+  }
+
+  static float bruteForceDistance(const VectorMap & map, const Vector2f & point)
+  {
+    float min_distance = INFINITY;
+    for (const auto & line : map.lines) {
+      Vector2f dir = line.p1 - line.p0;
+      float t = std::clamp((point - line.p0).dot(dir) / dir.squaredNorm(), 0.0f, 1.0f);
+      min_distance = std::min(min_distance, (point - (line.p0 + t * dir)).norm());
+    }
+    return min_distance;
+  }
+
+  static void expectSameField(const LikelihoodField & a, const LikelihoodField & b)
+  {
+    ASSERT_EQ(a.getWidth(), b.getWidth());
+    ASSERT_EQ(a.getHeight(), b.getHeight());
+    ASSERT_EQ(a.getResolution(), b.getResolution());
+    ASSERT_EQ(a.getHash(), b.getHash());
+    for (float x = -0.5; x < 3.6; x += 0.037) {
+      for (float y = -0.5; y < 3.4; y += 0.041) {
+        EXPECT_EQ(a.getDistance(Vector2f(x, y), 10.0), b.getDistance(Vector2f(x, y), 10.0));
+      }
+    }
+  }
+
+  VectorMap map_;
+  VectorMap other_map_;
+  std::string cache_file_;
+};
+
+TEST_F(TestLikelihoodField, testDistanceMatchesBruteForce) {
+  const float resolution = 0.05;
+  const float padding = 0.5;
+  LikelihoodField field;
+  field.build(map_, resolution, padding);
+
+  // Cell centers are sampled, so the only error is where a line crosses its rasterized cell
+  const float tolerance = resolution * std::sqrt(0.5) + 1e-4;
+  const Vector2f origin(0.03 - padding, 0.07 - padding);
+  for (int row = 0; row < field.getHeight(); row++) {
+    for (int col = 0; col < field.getWidth(); col++) {
+      Vector2f center = origin + resolution * Vector2f(col + 0.5, row + 0.5);
+      EXPECT_NEAR(field.getDistance(center, 10.0), bruteForceDistance(map_, center), tolerance) <<
+        "cell (" << col << ", " << row << ")";
+    }
+  }
+
+  // Anywhere inside a cell is also within one cell diagonal
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> x_dist(-0.4, 3.5);
+  std::uniform_real_distribution<float> y_dist(-0.4, 3.3);
+  for (int i = 0; i < 5000; i++) {
+    Vector2f point(x_dist(rng), y_dist(rng));
+    EXPECT_NEAR(
+      field.getDistance(point, 10.0), bruteForceDistance(map_, point),
+      resolution * std::sqrt(2.0) + 1e-4);
+  }
+}
+
+TEST_F(TestLikelihoodField, testDistanceIsClampedAndBounded) {
+  LikelihoodField field;
+  field.build(map_, 0.05, 0.5);
+
+  EXPECT_EQ(field.getDistance(Vector2f(1.5, 1.5), 0.1), 0.1f);
+  EXPECT_EQ(field.getDistance(Vector2f(-5.0, 1.0), 2.0), 2.0f);
+  EXPECT_EQ(field.getDistance(Vector2f(1.0, 50.0), 2.0), 2.0f);
+  EXPECT_EQ(field.getDistance(Vector2f(50.0, 1.0), 2.0), 2.0f);
+}
+
+TEST_F(TestLikelihoodField, testBuildRejectsInvalidInput) {
+  LikelihoodField field;
+  EXPECT_THROW(field.build(map_, 0.0, 0.5), std::runtime_error);
+  EXPECT_THROW(field.build(VectorMap(), 0.05, 0.5), std::runtime_error);
+  EXPECT_TRUE(field.empty());
+}
+
+TEST_F(TestLikelihoodField, testCacheRoundTrip) {
+  LikelihoodField built;
+  EXPECT_FALSE(built.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  EXPECT_EQ(built.getHash(), LikelihoodField::hashMap(map_, 0.05, 0.5));
+
+  // Already current, no work
+  EXPECT_TRUE(built.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+
+  LikelihoodField loaded;
+  EXPECT_TRUE(loaded.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  expectSameField(built, loaded);
+}
+
+TEST_F(TestLikelihoodField, testStaleCacheIsRebuilt) {
+  LikelihoodField field;
+  field.build(other_map_, 0.05, 0.5);
+  ASSERT_TRUE(field.save(cache_file_));
+
+  // Different map
+  LikelihoodField rebuilt;
+  EXPECT_FALSE(rebuilt.load(cache_file_, LikelihoodField::hashMap(map_, 0.05, 0.5)));
+  EXPECT_FALSE(rebuilt.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  LikelihoodField expected;
+  expected.build(map_, 0.05, 0.5);
+  expectSameField(expected, rebuilt);
+
+  // Different settings on the same map
+  LikelihoodField coarse;
+  EXPECT_FALSE(coarse.loadOrBuild(map_, 0.1, 0.5, cache_file_));
+  EXPECT_EQ(coarse.getResolution(), 0.1f);
+
+  // The rebuild replaced the stale file
+  LikelihoodField reloaded;
+  EXPECT_TRUE(reloaded.loadOrBuild(map_, 0.1, 0.5, cache_file_));
+  expectSameField(coarse, reloaded);
+}
+
+TEST_F(TestLikelihoodField, testCorruptCacheIsRebuilt) {
+  LikelihoodField field;
+  field.build(map_, 0.05, 0.5);
+  ASSERT_TRUE(field.save(cache_file_));
+  const uint64_t hash = field.getHash();
+
+  std::vector<char> bytes;
+  {
+    std::ifstream in(cache_file_, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  auto write_cache = [this](const std::vector<char> & data) {
+      std::ofstream out(cache_file_, std::ios::binary | std::ios::trunc);
+      out.write(data.data(), data.size());
+    };
+
+  // Bad magic
+  std::vector<char> bad_magic = bytes;
+  bad_magic[0] ^= 0xFF;
+  write_cache(bad_magic);
+  LikelihoodField from_bad_magic;
+  EXPECT_FALSE(from_bad_magic.load(cache_file_, hash));
+  EXPECT_FALSE(from_bad_magic.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  expectSameField(field, from_bad_magic);
+
+  // Truncated distance grid
+  write_cache(std::vector<char>(bytes.begin(), bytes.end() - 16));
+  LikelihoodField from_truncated;
+  EXPECT_FALSE(from_truncated.load(cache_file_, hash));
+  EXPECT_TRUE(from_truncated.empty());
+  EXPECT_FALSE(from_truncated.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  expectSameField(field, from_truncated);
+
+  // Truncated header
+  write_cache(std::vector<char>(bytes.begin(), bytes.begin() + 10));
+  LikelihoodField from_short_header;
+  EXPECT_FALSE(from_short_header.load(cache_file_, hash));
+  EXPECT_FALSE(from_short_header.loadOrBuild(map_, 0.05, 0.5, cache_file_));
+  expectSameField(field, from_short_header);
+
+  // Each rebuild rewrote the file
+  LikelihoodField reloaded;
+  EXPECT_TRUE(reloaded.load(cache_file_, hash));
+  expectSameField(field, reloaded);
+}
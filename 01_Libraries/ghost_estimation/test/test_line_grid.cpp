@@ -0,0 +1,236 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/vector_map/line_grid.hpp"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+#include "gtest/gtest.h"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using vector_map::LineGrid;
+using vector_map::VectorMap;
+
+class TestLineGrid : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    // Walls put the grid origin at (0, 0), so multiples of the cell size are cell boundaries
+    lines_ = {
+      Line2f(0.0, 0.0, 10.0, 0.0),
+      Line2f(10.0, 0.0, 10.0, 10.0),
+      Line2f(10.0, 10.0, 0.0, 10.0),
+      Line2f(0.0, 10.0, 0.0, 0.0),
+      Line2f(2.0, 3.0, 7.0, 3.0),
+      Line2f(4.0, 1.0, 4.0, 8.0),
+      Line2f(1.0, 1.0, 3.0, 3.0)};
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(0.1, 9.9);
+    std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+    std::uniform_real_distribution<float> length(0.1, 3.0);
+    for (int i = 0; i < 80; i++) {
+      Vector2f p0(coord(rng), coord(rng));
+      float a = angle(rng);
+      Vector2f p1 = p0 + length(rng) * Vector2f(std::cos(a), std::sin(a));
+      lines_.push_back(Line2f(p0, p1.cwiseMax(Vector2f(0.1, 0.1)).cwiseMin(Vector2f(9.9, 9.9))));
+    }
+
+    brute_force_map_ = VectorMap(lines_);
+    brute_force_map_.index.clear();
+    ASSERT_FALSE(brute_force_map_.IndexValid());
+  }
+
+  // Every ray is checked both ways so rays leaving and entering each cell are covered
+  std::vector<Line2f> getTestRays(float cell_size) const
+  {
+    std::vector<Line2f> rays;
+    for (float b = 0.0; b <= 10.0; b += cell_size) {
+      rays.push_back(Line2f(-1.0, b, 11.0, b));
+      rays.push_back(Line2f(b, -1.0, b, 11.0));
+      rays.push_back(Line2f(b - 5.0, -5.0, b + 15.0, 15.0));
+      rays.push_back(Line2f(b, 0.0, b + 3.0, 3.0 * cell_size));
+    }
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> coord(-2.0, 12.0);
+    for (int i = 0; i < 2000; i++) {
+      rays.push_back(Line2f(coord(rng), coord(rng), coord(rng), coord(rng)));
+    }
+
+    // Short rays that start and end inside one cell
+    std::uniform_real_distribution<float> offset(-0.5 * cell_size, 0.5 * cell_size);
+    for (int i = 0; i < 500; i++) {
+      Vector2f p0(coord(rng), coord(rng));
+      rays.push_back(Line2f(p0, p0 + Vector2f(offset(rng), offset(rng))));
+    }
+
+    size_t num_rays = rays.size();
+    for (size_t i = 0; i < num_rays; i++) {
+      rays.push_back(Line2f(rays[i].p1, rays[i].p0));
+    }
+    return rays;
+  }
+
+  static bool segmentTouchesBox(
+    const Line2f & line, const Vector2f & box_min, const Vector2f & box_max)
+  {
+    auto inside = [&](const Vector2f & p) {
+        return (p.array() >= box_min.array()).all() && (p.array() <= box_max.array()).all();
+      };
+    if (inside(line.p0) || inside(line.p1)) {
+      return true;
+    }
+    const Vector2f corners[4] = {
+      box_min, Vector2f(box_max.x(), box_min.y()), box_max, Vector2f(box_min.x(), box_max.y())};
+    for (int i = 0; i < 4; i++) {
+      if (line.Intersects(corners[i], corners[(i + 1) % 4])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<Line2f> lines_;
+  VectorMap brute_force_map_;
+};
+
+TEST_F(TestLineGrid, testRaycastMatchesBruteForce) {
+  for (float cell_size : {0.37f, 0.5f, 1.0f, 20.0f}) {
+    LineGrid grid;
+    grid.build(lines_, cell_size);
+    ASSERT_EQ(grid.getNumLines(), lines_.size());
+
+    for (const Line2f & ray : getTestRays(cell_size)) {
+      Vector2f expected_end = ray.p1;
+      int expected_idx = brute_force_map_.GetRayIntersection(ray.p0, &expected_end);
+      Vector2f grid_end = ray.p1;
+      int grid_idx = grid.raycast(ray.p0, &grid_end);
+
+      ASSERT_EQ(grid_idx < 0, expected_idx < 0) << "cell size " << cell_size << ", ray (" <<
+        ray.p0.transpose() << ") to (" << ray.p1.transpose() << ")";
+      EXPECT_NEAR((grid_end - ray.p0).norm(), (expected_end - ray.p0).norm(), 1e-4);
+      if ((grid_idx >= 0) && (grid_idx != expected_idx)) {
+        // Only acceptable when both lines are hit at the same point, e.g. a shared endpoint
+        EXPECT_LT((grid_end - expected_end).norm(), 1e-4);
+      }
+    }
+  }
+}
+
+TEST_F(TestLineGrid, testRaycastSkipsLine) {
+  LineGrid grid;
+  grid.build(lines_, 0.5);
+
+  // Starting on the horizontal line at y = 3 and casting along it
+  Vector2f ray_end(7.5, 3.0);
+  int idx = grid.raycast(Vector2f(2.5, 3.0), &ray_end, 4);
+  Vector2f expected_end(7.5, 3.0);
+  int expected_idx = brute_force_map_.GetRayIntersection(Vector2f(2.5, 3.0), &expected_end, 4);
+  EXPECT_NE(idx, 4);
+  EXPECT_EQ(idx, expected_idx);
+  EXPECT_NEAR((ray_end - expected_end).norm(), 0.0, 1e-4);
+
+  // Nothing to hit
+  ray_end = Vector2f(5.5, 5.5);
+  EXPECT_EQ(grid.raycast(Vector2f(5.5, 5.5), &ray_end), -1);
+  ray_end = Vector2f(-5.0, -3.0);
+  EXPECT_EQ(grid.raycast(Vector2f(-5.0, -1.0), &ray_end), -1);
+  EXPECT_EQ(ray_end, Vector2f(-5.0, -3.0));
+}
+
+TEST_F(TestLineGrid, testIntersectsMatchesBruteForce) {
+  for (float cell_size : {0.37f, 0.5f, 1.0f}) {
+    LineGrid grid;
+    grid.build(lines_, cell_size);
+    for (const Line2f & ray : getTestRays(cell_size)) {
+      EXPECT_EQ(grid.intersects(ray.p0, ray.p1), brute_force_map_.Intersects(ray.p0, ray.p1)) <<
+        "cell size " << cell_size << ", ray (" << ray.p0.transpose() << ") to (" <<
+        ray.p1.transpose() << ")";
+    }
+  }
+}
+
+TEST_F(TestLineGrid, testQueryBoxMatchesBruteForce) {
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> center(-1.0, 11.0);
+  std::uniform_real_distribution<float> half_size(0.0, 4.0);
+  for (float cell_size : {0.37f, 0.5f, 1.0f}) {
+    LineGrid grid;
+    grid.build(lines_, cell_size);
+    for (int i = 0; i < 1000; i++) {
+      // Every fourth box has edges on cell boundaries
+      Vector2f c(center(rng), center(rng));
+      float h = half_size(rng);
+      if (i % 4 == 0) {
+        c = cell_size * (c / cell_size).array().round().matrix();
+        h = cell_size * std::round(h / cell_size);
+      }
+      Vector2f box_min = c - Vector2f(h, h);
+      Vector2f box_max = c + Vector2f(h, h);
+
+      std::vector<int> grid_indices;
+      grid.queryBox(box_min, box_max, &grid_indices);
+      ASSERT_TRUE(std::is_sorted(grid_indices.begin(), grid_indices.end()));
+      ASSERT_EQ(
+        std::adjacent_find(grid_indices.begin(), grid_indices.end()), grid_indices.end());
+
+      // Brute force keeps every line whose bounding box overlaps, the grid may drop those that
+      // never enter the box, but must keep every line that does
+      std::vector<int> bbox_indices;
+      brute_force_map_.GetSceneLineIndices(c, h, &bbox_indices);
+      EXPECT_TRUE(
+        std::includes(
+          bbox_indices.begin(), bbox_indices.end(), grid_indices.begin(), grid_indices.end()));
+      for (size_t j = 0; j < lines_.size(); j++) {
+        if (segmentTouchesBox(lines_[j], box_min, box_max)) {
+          EXPECT_TRUE(std::binary_search(grid_indices.begin(), grid_indices.end(), j)) <<
+            "line " << j << " missing from box (" << box_min.transpose() << ") to (" <<
+            box_max.transpose() << ")";
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestLineGrid, testEmptyGrid) {
+  LineGrid grid;
+  grid.build({}, 0.5);
+  EXPECT_TRUE(grid.empty());
+
+  Vector2f ray_end(1.0, 1.0);
+  EXPECT_EQ(grid.raycast(Vector2f(0.0, 0.0), &ray_end), -1);
+  EXPECT_FALSE(grid.intersects(Vector2f(0.0, 0.0), Vector2f(1.0, 1.0)));
+  std::vector<int> indices = {1};
+  grid.queryBox(Vector2f(-1.0, -1.0), Vector2f(1.0, 1.0), &indices);
+  EXPECT_TRUE(indices.empty());
+
+  EXPECT_THROW(grid.build(lines_, 0.0), std::runtime_error);
+}
@@ -0,0 +1,185 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cmath>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/particle_filter/odometry_history.hpp"
+#include "gtest/gtest.h"
+
+using Eigen::Vector2f;
+using particle_filter::OdometryHistory;
+using particle_filter::OdometrySample;
+using particle_filter::propagatePose;
+
+namespace
+{
+
+// Straight line along x with a steady turn, one sample per second
+OdometrySample makeSample(int i)
+{
+  return OdometrySample{1000.0 + i, Vector2f(0.5 * i, 1.0), 0.1f * i, 0.2f * i};
+}
+
+} // namespace
+
+TEST(TestOdometryHistory, testInterpolatesBetweenSamples) {
+  OdometryHistory history(10);
+  for (int i = 0; i < 4; i++) {
+    history.add(makeSample(i));
+  }
+
+  OdometrySample sample;
+  EXPECT_TRUE(history.interpolate(1001.25, &sample));
+  EXPECT_DOUBLE_EQ(sample.stamp, 1001.25);
+  EXPECT_NEAR(sample.loc.x(), 0.625, 1e-6);
+  EXPECT_NEAR(sample.loc.y(), 1.0, 1e-6);
+  EXPECT_NEAR(sample.angle, 0.125, 1e-6);
+  EXPECT_NEAR(sample.angular_velocity, 0.25, 1e-6);
+
+  // Exact sample stamps, including both ends of the window
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(history.interpolate(1000.0 + i, &sample));
+    EXPECT_NEAR(sample.loc.x(), 0.5 * i, 1e-6);
+    EXPECT_NEAR(sample.angle, 0.1 * i, 1e-6);
+  }
+}
+
+TEST(TestOdometryHistory, testInterpolatesAngleAcrossWrap) {
+  OdometryHistory history(10);
+  history.add(OdometrySample{0.0, Vector2f(0.0, 0.0), 3.0, 0.0});
+  history.add(OdometrySample{1.0, Vector2f(0.0, 0.0), -3.0, 0.0});
+
+  // The short way round passes through pi, not through zero
+  OdometrySample sample;
+  EXPECT_TRUE(history.interpolate(0.5, &sample));
+  EXPECT_NEAR(std::abs(sample.angle), M_PI, 1e-5);
+  EXPECT_TRUE(history.interpolate(0.25, &sample));
+  EXPECT_NEAR(sample.angle, 3.0 + 0.25 * (2.0 * M_PI - 6.0), 1e-5);
+}
+
+TEST(TestOdometryHistory, testClampsOutsideWindow) {
+  OdometryHistory history(10);
+  OdometrySample sample;
+  EXPECT_FALSE(history.interpolate(1000.0, &sample));
+  EXPECT_THROW(history.latest(), std::runtime_error);
+
+  for (int i = 0; i < 4; i++) {
+    history.add(makeSample(i));
+  }
+
+  // Older than the buffer, the caller can tell from the stamp how far off it is
+  EXPECT_FALSE(history.interpolate(990.0, &sample));
+  EXPECT_DOUBLE_EQ(sample.stamp, 1000.0);
+  EXPECT_NEAR(sample.loc.x(), 0.0, 1e-6);
+
+  // Newer than the last sample
+  EXPECT_FALSE(history.interpolate(1010.0, &sample));
+  EXPECT_DOUBLE_EQ(sample.stamp, 1003.0);
+  EXPECT_NEAR(sample.loc.x(), 1.5, 1e-6);
+  EXPECT_NEAR(sample.angular_velocity, 0.6, 1e-6);
+}
+
+TEST(TestOdometryHistory, testWrapsAroundAfterCapacity) {
+  OdometryHistory history(5);
+  for (int i = 0; i < 12; i++) {
+    history.add(makeSample(i));
+    EXPECT_EQ(history.size(), std::min(i + 1, 5));
+    EXPECT_DOUBLE_EQ(history.latest().stamp, 1000.0 + i);
+  }
+
+  // Samples 7 to 11 remain, in order
+  OdometrySample sample;
+  EXPECT_FALSE(history.interpolate(1006.5, &sample));
+  EXPECT_DOUBLE_EQ(sample.stamp, 1007.0);
+  for (double stamp = 1007.0; stamp <= 1011.0; stamp += 0.25) {
+    EXPECT_TRUE(history.interpolate(stamp, &sample));
+    EXPECT_NEAR(sample.loc.x(), 0.5 * (stamp - 1000.0), 1e-5) << "stamp " << stamp;
+    EXPECT_NEAR(sample.angular_velocity, 0.2 * (stamp - 1000.0), 1e-5) << "stamp " << stamp;
+  }
+}
+
+TEST(TestOdometryHistory, testOlderSampleClearsHistory) {
+  OdometryHistory history(5);
+  for (int i = 0; i < 8; i++) {
+    history.add(makeSample(i));
+  }
+
+  // e.g. a restarted bag
+  history.add(makeSample(2));
+  EXPECT_EQ(history.size(), 1u);
+  EXPECT_DOUBLE_EQ(history.latest().stamp, 1002.0);
+
+  history.add(makeSample(3));
+  OdometrySample sample;
+  EXPECT_TRUE(history.interpolate(1002.5, &sample));
+  EXPECT_NEAR(sample.loc.x(), 1.25, 1e-6);
+
+  history.clear();
+  EXPECT_TRUE(history.empty());
+  EXPECT_THROW(OdometryHistory(1), std::runtime_error);
+}
+
+TEST(TestOdometryHistory, testPropagatePose) {
+  // Odometry drives one meter forward while turning left a quarter turn
+  OdometrySample from{0.0, Vector2f(1.0, 2.0), 0.0, 0.0};
+  OdometrySample to{1.0, Vector2f(2.0, 2.0), M_PI / 2.0, 0.0};
+
+  // The same motion in a map frame where the robot faces +y
+  Vector2f loc(5.0, 5.0);
+  float angle = M_PI / 2.0;
+  propagatePose(from, to, &loc, &angle);
+  EXPECT_NEAR(loc.x(), 5.0, 1e-6);
+  EXPECT_NEAR(loc.y(), 6.0, 1e-6);
+  EXPECT_NEAR(std::abs(angle), M_PI, 1e-6);
+
+  // No odometry motion leaves the pose alone
+  loc = Vector2f(-1.0, 3.0);
+  angle = -2.0;
+  propagatePose(to, to, &loc, &angle);
+  EXPECT_NEAR(loc.x(), -1.0, 1e-6);
+  EXPECT_NEAR(loc.y(), 3.0, 1e-6);
+  EXPECT_NEAR(angle, -2.0, 1e-6);
+
+  // Propagating in two steps through an interpolated sample matches one step
+  OdometryHistory history(10);
+  history.add(OdometrySample{0.0, Vector2f(0.0, 0.0), 0.3, 0.0});
+  history.add(OdometrySample{1.0, Vector2f(1.0, 0.5), 1.1, 0.0});
+  history.add(OdometrySample{2.0, Vector2f(1.5, 1.5), 2.0, 0.0});
+  OdometrySample mid;
+  ASSERT_TRUE(history.interpolate(1.4, &mid));
+
+  Vector2f one_step_loc(0.0, 0.0);
+  float one_step_angle = 0.7;
+  OdometrySample first;
+  ASSERT_TRUE(history.interpolate(0.0, &first));
+  propagatePose(first, history.latest(), &one_step_loc, &one_step_angle);
+
+  Vector2f two_step_loc(0.0, 0.0);
+  float two_step_angle = 0.7;
+  propagatePose(first, mid, &two_step_loc, &two_step_angle);
+  propagatePose(mid, history.latest(), &two_step_loc, &two_step_angle);
+  EXPECT_NEAR((one_step_loc - two_step_loc).norm(), 0.0, 1e-5);
+  EXPECT_NEAR(one_step_angle, two_step_angle, 1e-5);
+}
@@ -0,0 +1,181 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include "ghost_estimation/vector_map/segment_batch.hpp"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+#include "gtest/gtest.h"
+
+using Eigen::Vector2f;
+using geometry::Line2f;
+using vector_map::SegmentBatch;
+using vector_map::SIMD_WIDTH;
+using vector_map::VectorMap;
+
+class TestSegmentBatch : public ::testing::Test
+{
+public:
+  // Random segments away from the origin, where the zero length padding segments sit
+  static std::vector<Line2f> getRandomLines(int num_lines, std::mt19937 * rng)
+  {
+    std::uniform_real_distribution<float> coord(1.0, 9.0);
+    std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+    std::uniform_real_distribution<float> length(0.2, 4.0);
+    std::vector<Line2f> lines;
+    for (int i = 0; i < num_lines; i++) {
+      Vector2f p0(coord(*rng), coord(*rng));
+      float a = angle(*rng);
+      lines.push_back(Line2f(p0, p0 + length(*rng) * Vector2f(std::cos(a), std::sin(a))));
+    }
+    return lines;
+  }
+
+  static float bruteForceRange(
+    const VectorMap & map, const Vector2f & origin, const Vector2f & direction, float range_max)
+  {
+    Vector2f ray_end = origin + range_max * direction;
+    if (map.GetRayIntersection(origin, &ray_end) < 0) {
+      return range_max;
+    }
+    return (ray_end - origin).norm();
+  }
+};
+
+TEST_F(TestSegmentBatch, testCastRayMatchesBruteForce) {
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> coord(-1.0, 11.0);
+  std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+  const float range_max = 8.0;
+
+  // Counts below, at and past whole batches leave 0 to SIMD_WIDTH - 1 padding lanes
+  for (int num_lines = 1; num_lines <= 3 * SIMD_WIDTH + 1; num_lines++) {
+    std::vector<Line2f> lines = getRandomLines(num_lines, &rng);
+    VectorMap map(lines);
+    map.index.clear();
+    SegmentBatch segments;
+    segments.assign(lines);
+    ASSERT_EQ(segments.size(), lines.size());
+
+    for (int i = 0; i < 500; i++) {
+      Vector2f origin(coord(rng), coord(rng));
+      float a = angle(rng);
+      Vector2f direction(std::cos(a), std::sin(a));
+      EXPECT_NEAR(
+        segments.castRay(origin, direction, range_max),
+        bruteForceRange(map, origin, direction, range_max), 1e-3) <<
+        num_lines << " lines, ray from (" << origin.transpose() << ") at " << a;
+    }
+  }
+}
+
+TEST_F(TestSegmentBatch, testPaddingLanesNeverHit) {
+  std::mt19937 rng(23);
+  std::uniform_real_distribution<float> coord(-5.0, 5.0);
+  std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+  const float range_max = 20.0;
+
+  for (int num_lines = 1; num_lines < SIMD_WIDTH; num_lines++) {
+    std::vector<Line2f> lines = getRandomLines(num_lines, &rng);
+    VectorMap map(lines);
+    map.index.clear();
+    SegmentBatch segments;
+    segments.assign(lines);
+
+    for (int i = 0; i < 200; i++) {
+      // Rays aimed through, starting at, and sweeping across the padding segments at the origin
+      Vector2f origin(coord(rng), coord(rng));
+      Vector2f through_origin = -origin.normalized();
+      EXPECT_NEAR(
+        segments.castRay(origin, through_origin, range_max),
+        bruteForceRange(map, origin, through_origin, range_max), 1e-3);
+
+      float a = angle(rng);
+      Vector2f direction(std::cos(a), std::sin(a));
+      EXPECT_NEAR(
+        segments.castRay(Vector2f(0.0, 0.0), direction, range_max),
+        bruteForceRange(map, Vector2f(0.0, 0.0), direction, range_max), 1e-3);
+    }
+    EXPECT_EQ(segments.castRay(Vector2f(-1.0, 0.0), Vector2f(1.0, 0.0), 0.5), 0.5f);
+  }
+
+  // Nothing loaded at all
+  SegmentBatch empty;
+  empty.assign({});
+  EXPECT_EQ(empty.size(), 0u);
+  EXPECT_EQ(empty.castRay(Vector2f(-1.0, 0.0), Vector2f(1.0, 0.0), 5.0), 5.0f);
+}
+
+TEST_F(TestSegmentBatch, testAssignSubset) {
+  std::mt19937 rng(29);
+  std::vector<Line2f> lines = getRandomLines(50, &rng);
+  std::vector<int> line_indices;
+  std::vector<Line2f> subset;
+  for (int i = 3; i < 50; i += 4) {
+    line_indices.push_back(i);
+    subset.push_back(lines[i]);
+  }
+  VectorMap map(subset);
+  map.index.clear();
+  SegmentBatch segments;
+  segments.assign(lines, line_indices);
+  ASSERT_EQ(segments.size(), line_indices.size());
+
+  std::uniform_real_distribution<float> coord(0.0, 10.0);
+  std::uniform_real_distribution<float> angle(-M_PI, M_PI);
+  for (int i = 0; i < 1000; i++) {
+    Vector2f origin(coord(rng), coord(rng));
+    float a = angle(rng);
+    Vector2f direction(std::cos(a), std::sin(a));
+    EXPECT_NEAR(
+      segments.castRay(origin, direction, 10.0), bruteForceRange(map, origin, direction, 10.0),
+      1e-3);
+  }
+}
+
+TEST_F(TestSegmentBatch, testPredictedScanMatchesBruteForce) {
+  std::mt19937 rng(31);
+  VectorMap map(getRandomLines(40, &rng));
+  VectorMap brute_force_map = map;
+  brute_force_map.index.clear();
+
+  std::uniform_real_distribution<float> coord(0.0, 10.0);
+  const int num_rays = 181;
+  for (int i = 0; i < 20; i++) {
+    Vector2f loc(coord(rng), coord(rng));
+    std::vector<float> scan;
+    map.GetPredictedScan(loc, 0.1, 6.0, -M_PI, M_PI, num_rays, &scan);
+    ASSERT_EQ(scan.size(), static_cast<size_t>(num_rays));
+
+    const float da = 2.0 * M_PI / num_rays;
+    for (int j = 0; j < num_rays; j++) {
+      const float a = -M_PI + j * da;
+      EXPECT_NEAR(
+        scan[j], bruteForceRange(brute_force_map, loc, Vector2f(cos(a), sin(a)), 6.0), 1e-3);
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ghost_serial/cobs/cobs.hpp"
+
+/**
+ * Sensor update for an 8 motor swerve with every optional motor field enabled:
+ * 8 motors * 28 bytes + 4 rotation sensors * 12 bytes + IMU (28 bytes) + 2 joysticks * 18 bytes
+ * + competition status byte + "sout" start sequence + checksum byte.
+ */
+constexpr int SWERVE_SENSOR_UPDATE_LEN = 8 * 28 + 4 * 12 + 28 + 2 * 18 + 1 + 4 + 1;
+
+/**
+ * @brief Fills a buffer with float-encoded sensor values. Idle motors report exact zeros, which puts
+ * zero bytes into the stream the same way real sensor updates do.
+ *
+ * @param num_bytes length of packet
+ * @return std::vector<uint8_t> packet
+ */
+static std::vector<uint8_t> makeSensorPacket(int num_bytes)
+{
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> value_dist(-600.0, 600.0);
+  std::vector<uint8_t> packet(num_bytes, 0);
+  for (int i = 0; i + 4 <= num_bytes; i += 4) {
+    float value = (rng() % 4 == 0) ? 0.0 : value_dist(rng);
+    memcpy(packet.data() + i, &value, 4);
+  }
+  return packet;
+}
+
+static void registerPacketSizes(benchmark::internal::Benchmark * b)
+{
+  for (int size : {16, 64, SWERVE_SENSOR_UPDATE_LEN, 1024, 4096}) {
+    b->Arg(size);
+  }
+}
+
+template<size_t (* EncodeFunc)(const void *, size_t, uint8_t *)>
+static void BM_Encode(benchmark::State & state)
+{
+  auto packet = makeSensorPacket(state.range(0));
+  std::vector<uint8_t> encoded(packet.size() + packet.size() / 254 + 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(EncodeFunc(packet.data(), packet.size(), encoded.data()));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+
+static void BM_Decode(benchmark::State & state)
+{
+  auto packet = makeSensorPacket(state.range(0));
+  std::vector<uint8_t> encoded(packet.size() + packet.size() / 254 + 2);
+  size_t encoded_len = COBS::cobsEncodeBytewise(packet.data(), packet.size(), encoded.data());
+  std::vector<uint8_t> decoded(encoded.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(COBS::cobsDecode(encoded.data(), encoded_len, decoded.data()));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+
+BENCHMARK_TEMPLATE(BM_Encode, COBS::cobsEncodeBytewise)->Apply(registerPacketSizes);
+BENCHMARK_TEMPLATE(BM_Encode, COBS::cobsEncode)->Apply(registerPacketSizes);
+BENCHMARK(BM_Decode)->Apply(registerPacketSizes);
+
+BENCHMARK_MAIN();
@@ -28,6 +28,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "../msg_parser/msg_parser.hpp"
 
@@ -53,7 +54,7 @@ public:
     int read_msg_max_len,
     bool use_checksum = false);
 
-  ~GenericSerialBase();
+  virtual ~GenericSerialBase();
 
   /**
    * @brief Thread-safe method to write msg buffer to serial port. Shares mutex with reader thread,
@@ -66,7 +67,7 @@ public:
    * @param num_bytes length of msg in bytes
    * @return bool if write was successful
    */
-  bool writeMsgToSerial(const unsigned char buffer[], const int num_bytes);
+  virtual bool writeMsgToSerial(const unsigned char buffer[], const int num_bytes);
 
   // Platform specific depending on Serial IO interfaces
   virtual bool readMsgFromSerial(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len) = 0;
@@ -80,6 +81,42 @@ public:
    */
   void checkReadMsgBufferLength(std::vector<unsigned char> & msg_buffer) const;
 
+  /**
+   * @brief Returns the worst case length of an encoded write msg, including COBS overhead and the
+   * null delimiter.
+   *
+   * @param num_bytes length of msg in bytes
+   * @return int encoded length in bytes
+   */
+  int getMaxEncodedMsgLength(const int num_bytes) const;
+
+  /**
+   * @brief Prepends the write start sequence, appends checksum (if configured), and applies COBS encoding
+   * with a trailing null delimiter.
+   *
+   * @param buffer          msg to encode
+   * @param num_bytes       length of msg in bytes
+   * @param raw_msg_buffer  scratch buffer of at least write start sequence + num_bytes + 1 bytes
+   * @param encoded_buffer  output buffer of at least getMaxEncodedMsgLength(num_bytes) bytes
+   * @return int length of encoded msg in bytes
+   */
+  int encodeMsg(
+    const unsigned char buffer[], const int num_bytes,
+    unsigned char raw_msg_buffer[], unsigned char encoded_buffer[]) const;
+
+  bool isPortOpen() const
+  {
+    return port_open_;
+  }
+
+  /**
+   * @brief Returns the number of received msgs which were discarded because the pending msg queue was full.
+   */
+  uint32_t getDroppedMsgCount() const
+  {
+    return dropped_msg_count_;
+  }
+
 protected:
   // Platform specific depending on Serial IO interfaces
   virtual bool flushStream() const = 0;
@@ -95,6 +132,24 @@ protected:
    */
   static uint8_t calculateChecksum(const unsigned char buffer[], const int & num_bytes);
 
+  /**
+   * @brief Parses raw serial data and queues every msg found. If the queue is full, the oldest
+   * pending msg is discarded, as newer data is more relevant for control.
+   *
+   * @param num_bytes number of valid bytes at the front of read_buffer_
+   * @return int number of msgs found
+   */
+  int parseReadBuffer(const int num_bytes);
+
+  /**
+   * @brief Copies the oldest pending msg into msg_buffer and removes it from the queue.
+   *
+   * @param msg_buffer      buffer of at least read_msg_max_len_ bytes
+   * @param parsed_msg_len  length of the returned msg
+   * @return bool false if no msgs are pending
+   */
+  bool popPendingMsg(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+
   // Msg Config
   std::string write_msg_start_seq;
   std::string read_msg_start_seq;
@@ -112,6 +167,14 @@ protected:
   // Msg Buffers
   std::vector<unsigned char> read_buffer_;
   std::unique_ptr<MsgParser> msg_parser_;
+
+  // Fixed-size ring of parsed msgs waiting to be returned by readMsgFromSerial
+  static constexpr int pending_msg_queue_size_ = 8;
+  std::vector<unsigned char> pending_msg_buffer_;
+  std::vector<int> pending_msg_lengths_;
+  int pending_msg_head_;
+  int pending_msg_count_;
+  uint32_t dropped_msg_count_;
 };
 
 } // namespace ghost_serial
@@ -0,0 +1,191 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#ifndef GHOST_SERIAL__JETSON_DUAL_PORT_SERIAL_BASE_HPP
+#define GHOST_SERIAL__JETSON_DUAL_PORT_SERIAL_BASE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ghost_serial/base_interfaces/jetson_epoll_serial_base.hpp"
+
+namespace ghost_serial
+{
+
+/**
+ * @brief Runs one logical V5 link over two serial ports at once, each driven by its own
+ * JetsonEpollSerialBase.
+ *
+ * SPLIT:  the primary port carries incoming (sensor) msgs and the secondary port carries outgoing
+ *         (actuator) msgs, so neither direction competes with the other for bandwidth.
+ * STRIPE: outgoing msgs alternate between ports and incoming msgs are accepted from both. Every msg is
+ *         prefixed with a one byte sequence number. Msgs older than the newest one already returned are
+ *         dropped, so the reader always sees the latest state even when the ports drift relative to
+ *         each other.
+ *
+ * The port pair is treated as a single link: if either port fails, isPortOpen() is false and both must
+ * be reopened. Like JetsonEpollSerialBase, exactly one thread may read and one thread may write.
+ */
+class JetsonDualPortSerialBase
+{
+public:
+  enum dual_port_mode_e
+  {
+    SPLIT,
+    STRIPE
+  };
+
+  /**
+   * @brief Construct a new JetsonDualPortSerialBase object
+   *
+   * @param write_msg_start_seq   start sequence prepended to outgoing msgs
+   * @param read_msg_start_seq    start sequence to search for in incoming msgs
+   * @param read_msg_max_len      max length of incoming msgs (excluding stripe sequence number)
+   * @param write_msg_max_len     max length of outgoing msgs (excluding stripe sequence number)
+   * @param mode                  how traffic is divided between the two ports
+   * @param use_checksum          append/validate checksum byte
+   * @param verbose               print debug info
+   * @param queue_size            number of frames buffered in each direction, per port
+   */
+  JetsonDualPortSerialBase(
+    std::string write_msg_start_seq,
+    std::string read_msg_start_seq,
+    int read_msg_max_len,
+    int write_msg_max_len,
+    dual_port_mode_e mode,
+    bool use_checksum = false,
+    bool verbose = false,
+    int queue_size = 16);
+
+  /**
+   * @brief Opens both ports. If the secondary port fails, the primary is closed again so the pair is
+   * never left half open. Resets stripe sequence tracking.
+   *
+   * THROWS runtime errors when either serial device is not available or fails to open.
+   *
+   * @returns if init is successful or not
+   */
+  bool trySerialInit(std::string primary_port_name, std::string secondary_port_name);
+
+  /**
+   * @brief Closes both ports, releasing any blocked reader.
+   */
+  void closeSerialPort();
+
+  /**
+   * @brief Blocks until a msg is available, either port closes, or the read timeout elapses.
+   *
+   * @param msg_buffer      buffer of at least read_msg_max_len bytes
+   * @param parsed_msg_len  length of the returned msg
+   * @return bool if msg was returned
+   */
+  bool readMsgFromSerial(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+
+  /**
+   * @brief Queues msg on the secondary port (SPLIT) or the next port in turn (STRIPE). In STRIPE mode a
+   * msg is moved to the other port if the chosen one is backed up. Never blocks on the serial port.
+   *
+   * @param buffer    msg to write to serial
+   * @param num_bytes length of msg in bytes
+   * @return bool false if the ports are closed or no outbound queue has room
+   */
+  bool writeMsgToSerial(const unsigned char buffer[], const int num_bytes);
+
+  bool isPortOpen() const;
+
+  /**
+   * @brief Sets the baud rate of both ports, applied the next time they are opened.
+   */
+  void setBaudRate(int baud_rate);
+
+  /**
+   * @brief Sets how long readMsgFromSerial waits for a msg. Defaults to 1s.
+   */
+  void setReadTimeout(std::chrono::milliseconds read_timeout)
+  {
+    read_timeout_ = read_timeout;
+    links_[0]->setReadTimeout(read_timeout);        // Blocking reads only happen on the primary
+  }
+
+  dual_port_mode_e getMode() const
+  {
+    return mode_;
+  }
+
+  uint32_t getDroppedReadMsgCount() const;
+  uint32_t getDroppedWriteMsgCount() const;
+  uint32_t getWriteErrorCount() const;
+
+  /**
+   * @brief Number of STRIPE msgs discarded because a newer msg had already been returned.
+   */
+  uint32_t getStaleMsgCount() const
+  {
+    return stale_msg_count_;
+  }
+
+private:
+  bool readSplitMsg(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+  bool readStripedMsg(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+
+  /**
+   * @brief Checks the sequence number of a STRIPE msg in read_staging_buffer_ and, if it is newer than
+   * the last msg returned, copies its payload to msg_buffer.
+   *
+   * @return bool if msg was accepted
+   */
+  bool acceptStripedMsg(int frame_len, std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+
+  // A burst of stale msgs this long means the sender restarted its sequence, so tracking is reset
+  static constexpr int MAX_CONSECUTIVE_STALE_MSGS = 4;
+
+  dual_port_mode_e mode_;
+  int read_msg_max_len_;
+  int write_msg_max_len_;
+  std::chrono::milliseconds read_timeout_;
+
+  // [0] primary port, [1] secondary port
+  std::array<std::unique_ptr<JetsonEpollSerialBase>, 2> links_;
+
+  // Used only by the reader thread
+  std::vector<unsigned char> read_staging_buffer_;
+  int next_read_link_;
+  bool has_last_read_seq_;
+  uint8_t last_read_seq_;
+  int consecutive_stale_msgs_;
+
+  // Used only by the writer thread
+  std::vector<unsigned char> write_staging_buffer_;
+  int next_write_link_;
+  uint8_t next_write_seq_;
+
+  std::atomic<uint32_t> stale_msg_count_;
+};
+
+} // namespace ghost_serial
+
+#endif // GHOST_SERIAL__JETSON_DUAL_PORT_SERIAL_BASE_HPP
@@ -0,0 +1,208 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#ifndef GHOST_SERIAL__JETSON_EPOLL_SERIAL_BASE_HPP
+#define GHOST_SERIAL__JETSON_EPOLL_SERIAL_BASE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "ghost_serial/base_interfaces/jetson_serial_base.hpp"
+#include "ghost_serial/util/spsc_frame_queue.hpp"
+
+namespace ghost_serial
+{
+
+/**
+ * @brief Event-driven serial transport for the Jetson.
+ *
+ * A dedicated IO thread waits on the serial port with epoll. It reads and parses incoming data into an
+ * inbound frame queue, and drains an outbound frame queue with non-blocking writes. When the kernel
+ * buffer fills mid-frame, it resumes the write once the port is writable again.
+ *
+ * Readers and writers share no lock: readMsgFromSerial() only touches the inbound queue and
+ * writeMsgToSerial() only touches the outbound queue. Each queue is single-producer/single-consumer, so
+ * exactly one thread may read msgs and exactly one thread may write msgs.
+ */
+class JetsonEpollSerialBase : public JetsonSerialBase
+{
+public:
+  /**
+   * @brief Construct a new JetsonEpollSerialBase object
+   *
+   * @param write_msg_start_seq   start sequence prepended to outgoing msgs
+   * @param read_msg_start_seq    start sequence to search for in incoming msgs
+   * @param read_msg_max_len      max length of incoming msgs
+   * @param write_msg_max_len     max length of outgoing msgs
+   * @param use_checksum          append/validate checksum byte
+   * @param verbose               print debug info
+   * @param queue_size            number of frames buffered in each direction
+   */
+  JetsonEpollSerialBase(
+    std::string write_msg_start_seq,
+    std::string read_msg_start_seq,
+    int read_msg_max_len,
+    int write_msg_max_len,
+    bool use_checksum = false,
+    bool verbose = false,
+    int queue_size = 16);
+
+  ~JetsonEpollSerialBase();
+
+  /**
+   * @brief Opens and configures the serial port in non-blocking mode, then starts the IO thread.
+   *
+   * THROWS runtime errors when serial device is not available or fails to open.
+   *
+   * @returns if init is successful or not
+   */
+  bool trySerialInit(std::string port_name);
+
+  /**
+   * @brief Stops the IO thread and closes the serial port. Unsent outgoing msgs are kept and
+   * sent after the port is reopened.
+   */
+  void closeSerialPort() override;
+
+  /**
+   * @brief Returns the oldest msg received by the IO thread. If none are queued, blocks until one
+   * arrives, the port closes, or the read timeout elapses.
+   *
+   * @param msg_buffer      buffer of at least read_msg_max_len bytes
+   * @param parsed_msg_len  length of the returned msg
+   * @return bool if msg was returned
+   */
+  bool readMsgFromSerial(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len) override;
+
+  /**
+   * @brief Non-blocking readMsgFromSerial. Returns the oldest queued msg, if any.
+   *
+   * @param msg_buffer      buffer of at least read_msg_max_len bytes
+   * @param parsed_msg_len  length of the returned msg
+   * @return bool if msg was returned
+   */
+  bool tryReadMsgFromSerial(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len);
+
+  /**
+   * @brief eventfd signalled whenever msgs are queued or the port fails. Lets a single reader wait on
+   * several transports at once; the reader clears the counter after waking and then drains each
+   * transport with tryReadMsgFromSerial().
+   */
+  int getReadEventFd() const
+  {
+    return rx_event_fd_;
+  }
+
+  /**
+   * @brief Encodes msg directly into the outbound queue and wakes the IO thread. Never blocks on the
+   * serial port.
+   *
+   * @param buffer    msg to write to serial
+   * @param num_bytes length of msg in bytes
+   * @return bool false if the port is closed or the outbound queue is full
+   */
+  bool writeMsgToSerial(const unsigned char buffer[], const int num_bytes) override;
+
+  /**
+   * @brief Sets how long readMsgFromSerial waits for a msg. Defaults to 1s.
+   */
+  void setReadTimeout(std::chrono::milliseconds read_timeout)
+  {
+    read_timeout_ = read_timeout;
+  }
+
+  uint32_t getDroppedReadMsgCount() const
+  {
+    return dropped_read_msg_count_;
+  }
+
+  uint32_t getDroppedWriteMsgCount() const
+  {
+    return dropped_write_msg_count_;
+  }
+
+  uint32_t getWriteErrorCount() const
+  {
+    return write_error_count_;
+  }
+
+private:
+  /**
+   * @brief Main loop of IO thread. Exits when the port closes or closeSerialPort() is called.
+   */
+  void ioLoop();
+
+  /**
+   * @brief Reads until the port has no more data, pushing every parsed msg to the inbound queue.
+   *
+   * @return bool false if the port has failed
+   */
+  bool handleReadable();
+
+  /**
+   * @brief Writes queued outbound frames until the queue is empty or the port would block.
+   */
+  void handleWritable();
+
+  /**
+   * @brief Enables/disables EPOLLOUT notifications for the serial port (only when the state changes).
+   */
+  void setWriteInterest(bool enabled);
+
+  /**
+   * @brief Adds one to an eventfd counter, waking anything waiting on it.
+   */
+  static void signalEvent(int event_fd);
+
+  int write_msg_max_len_;
+  std::chrono::milliseconds read_timeout_;
+
+  // Frame queues between the IO thread and the reader/writer threads
+  SPSCFrameQueue rx_queue_;
+  SPSCFrameQueue tx_queue_;
+
+  // Used only by the writer thread to assemble msgs before encoding
+  std::vector<unsigned char> write_staging_buffer_;
+
+  // Used only by the IO thread
+  int tx_frame_offset_;
+  bool write_interest_;
+
+  // IO thread and its wakeup descriptors
+  std::thread io_thread_;
+  std::atomic_bool io_thread_running_;
+  int epoll_fd_;
+  int tx_event_fd_;       // Wakes IO thread for new outbound frames or shutdown
+  int rx_event_fd_;       // Wakes reader for new inbound frames or port failure
+
+  // Diagnostics
+  std::atomic<uint32_t> dropped_read_msg_count_;
+  std::atomic<uint32_t> dropped_write_msg_count_;
+  std::atomic<uint32_t> write_error_count_;
+};
+
+} // namespace ghost_serial
+
+#endif // GHOST_SERIAL__JETSON_EPOLL_SERIAL_BASE_HPP
@@ -60,7 +60,7 @@ public:
    *
    * Internally, this closes file descriptions and may propogate exceptions returned from close()
    */
-  void closeSerialPort();
+  virtual void closeSerialPort();
 
   /**
    * @brief Attempts to open serial port for read/write and set port configuration.
@@ -71,6 +71,20 @@ public:
    */
   bool trySerialInit(std::string port_name);
 
+  /**
+   * @brief Sets the baud rate applied the next time a port is opened. Standard rates use the termios
+   * Bxxx constants; anything else (e.g. 250000 or 1500000 for FTDI/RS485 adapters) is set through
+   * termios2. Defaults to 115200.
+   *
+   * THROWS runtime error if baud_rate is not positive.
+   */
+  void setBaudRate(int baud_rate);
+
+  int getBaudRate() const
+  {
+    return baud_rate_;
+  }
+
   /**
    * @brief Thread-safe method to read serial port for new msgs. Blocks until new msg is recieved
    * or 1s timeout elapses. Implementation uses Poll() system call to avoid busy-waiting. Highly efficient!
@@ -78,6 +92,9 @@ public:
    * Internally applies COBS decoding and checksum for msg validation. Searches for specified start sequence
    * and then reads for msg_len until null delimiter is found.
    *
+   * A single read may contain several msgs. All of them are queued, and subsequent calls return the
+   * queued msgs (oldest first) without waiting on the port.
+   *
    * THROWS system_error if poll returns -1.
    *
    * @param msg_buffer buffer of length msg_len to store incoming serial msgs
@@ -90,7 +107,7 @@ public:
    */
   void printReadBufferDebugInfo();
 
-private:
+protected:
   /**
    * @brief Flushes buffer from serial input stream (reader), clearing old data.
 
@@ -113,15 +130,17 @@ private:
    */
   bool setSerialPortConfig() override;
 
+  // Config params
+  std::string port_name_;
+  bool verbose_;
+  int baud_rate_;
+
+private:
   // Error Handling for mismatched messages / invalid data
   // After first N bytes, we start complaining if we don't get valid messages
   const int startup_junk_byte_count_ = 1500;
   int bytes_received_;
 
-  // Config params
-  std::string port_name_;
-  bool verbose_;
-
   // Poll Config Structure
   struct pollfd pollfd_read_;
 };
@@ -0,0 +1,53 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#ifndef GHOST_SERIAL__TERMIOS2_BAUD_RATE_HPP
+#define GHOST_SERIAL__TERMIOS2_BAUD_RATE_HPP
+
+namespace ghost_serial
+{
+
+// Kept out of jetson_serial_base.hpp because <asm/termbits.h> redefines struct termios and cannot be
+// included alongside <termios.h>.
+
+/**
+ * @brief Sets an arbitrary input/output baud rate on an open tty using the Linux termios2 interface
+ * (BOTHER). All other port settings are left unchanged.
+ *
+ * @param fd        open tty file descriptor
+ * @param baud_rate baud rate in bits per second
+ * @return true if the rate was applied
+ */
+bool setCustomBaudRate(int fd, int baud_rate);
+
+/**
+ * @brief Reads the output baud rate of an open tty in bits per second.
+ *
+ * @param fd open tty file descriptor
+ * @return int baud rate, or -1 if it could not be read
+ */
+int getCustomBaudRate(int fd);
+
+} // namespace ghost_serial
+
+#endif // GHOST_SERIAL__TERMIOS2_BAUD_RATE_HPP
@@ -19,18 +19,25 @@ namespace COBS
         @param buffer Pointer to encoded output buffer
         @return Encoded buffer length in bytes
         @note Does not output delimiter byte
+        @note Scans for zero bytes 16/32 at a time with SSE2/AVX2 (x86) or NEON (aarch64) where available
  */
 size_t cobsEncode(const void * data, size_t length, uint8_t * buffer);
 
 /** COBS decode data from buffer
         @param buffer Pointer to encoded input bytes
         @param length Number of bytes to decode
-        @param data Pointer to decoded output data
+        @param data Pointer to decoded output data (may be the same as buffer)
         @return Number of bytes successfully decoded
         @note Stops decoding if delimiter byte is found
  */
 size_t cobsDecode(const uint8_t * buffer, size_t length, void * data);
 
+/** Reference byte-at-a-time COBS encoder. Produces output identical to cobsEncode.
+        @note Kept for testing and benchmarking against cobsEncode. Decoding is driven by the code bytes
+        rather than a search for zeros, so cobsDecode has no vectorized counterpart.
+ */
+size_t cobsEncodeBytewise(const void * data, size_t length, uint8_t * buffer);
+
 int test();
 
 } // namespace COBS
@@ -43,35 +43,88 @@ public:
 
   /**
    * @brief Iterates through stream of bytes, searching for msg start sequence, and then extracts msg.
-   * Will not register msgs that do not match MsgParser msg_len. Intended to be called repeatedly with
+   * Will not register msgs that exceed MsgParser max_msg_len. Intended to be called repeatedly with
    * sequential serial data.
    *
-   * In general, num_bytes is not intended to exceed 2*msg_len - 1 bytes. If multiple msgs exist in array,
-   * function will (probably) return the most recent complete msg (closest to end of array).
-   *
+   * If multiple msgs exist in array, the most recent valid msg (closest to end of array) is returned.
+   * Use the callback overload below to receive every msg.
    *
    * @param raw_data_buffer   array containing raw serial data
    * @param num_bytes         number of bytes to read in raw_data_buffer
-   * @param parsed_msg        array of size msg_len to store extracted msgs
+   * @param parsed_msg        array of size max_msg_len to store extracted msgs
+   * @param parsed_msg_len    length of the returned msg
    * @return bool whether msg is found
    */
   bool parseByteStream(
     const unsigned char raw_data_buffer[], const int num_bytes,
     unsigned char parsed_msg[], int & parsed_msg_len);
 
+  /**
+   * @brief Streaming variant of parseByteStream which invokes msg_callback for every valid msg found in
+   * raw_data_buffer, in the order they were received.
+   *
+   * Msgs are decoded in place within the parser's preallocated frame buffer, so no memory is allocated.
+   * The pointer passed to msg_callback is only valid for the duration of the callback; copy out anything
+   * which must outlive it.
+   *
+   * @param raw_data_buffer   array containing raw serial data
+   * @param num_bytes         number of bytes to read in raw_data_buffer
+   * @param msg_callback      callable with signature void(const unsigned char * msg, int msg_len)
+   * @return int number of valid msgs found
+   */
+  template<typename MsgCallback>
+  int parseByteStream(
+    const unsigned char raw_data_buffer[], const int num_bytes,
+    MsgCallback && msg_callback)
+  {
+    int num_msgs = 0;
+    for (int i = 0; i < num_bytes; i++) {
+      if (processByte(raw_data_buffer[i])) {
+        msg_callback(static_cast<const unsigned char *>(incoming_msg_buffer_.data()), parsed_msg_len_);
+        num_msgs++;
+      }
+    }
+    return num_msgs;
+  }
+
 private:
+  /**
+   * @brief Advances the parser state machine by one byte.
+   *
+   * @param byte  next byte from the serial stream
+   * @return bool true if byte completed a valid msg, which is then held decoded at the front of
+   * incoming_msg_buffer_ with length parsed_msg_len_
+   */
+  bool processByte(const unsigned char byte);
+
+  /**
+   * @brief Decodes the accumulated COBS frame in place and validates its checksum.
+   *
+   * @return bool if frame contained a valid msg
+   */
+  bool decodeFrame();
+
+  /**
+   * @brief Clears parser state to begin searching for the next start sequence.
+   */
+  void resetParser()
+  {
+    start_seq_index_ = 0;
+    msg_packet_index_ = 1;     // COBS leading byte
+  }
+
   // Config params
   std::string msg_start_seq_;
   int max_msg_len_;
   bool use_checksum_;
 
-  // Serial Buffers
+  // Holds the raw COBS frame as it accumulates, then the decoded msg once a frame is complete
   std::vector<unsigned char> incoming_msg_buffer_;
-  std::vector<char> parsed_msg_buffer_;
 
   // Variables for parsing msg stream
   uint8_t start_seq_index_;
   int msg_packet_index_;
+  int parsed_msg_len_;
 };
 
 } // namespace ghost_serial
@@ -0,0 +1,183 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#ifndef GHOST_SERIAL__SPSC_FRAME_QUEUE_HPP
+#define GHOST_SERIAL__SPSC_FRAME_QUEUE_HPP
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ghost_serial
+{
+
+/**
+ * @brief Fixed-capacity, lock-free queue of variable length byte frames for exactly one producer thread
+ * and one consumer thread.
+ *
+ * All storage is allocated at construction. Producers may encode directly into a slot with
+ * beginPush()/commitPush(), and consumers may read a frame in place with front()/pop(), so frames are
+ * never copied unless the caller asks for it.
+ */
+class SPSCFrameQueue
+{
+public:
+  /**
+   * @brief Construct a new SPSCFrameQueue
+   *
+   * @param capacity        max number of frames held, rounded up to the next power of two
+   * @param max_frame_len   max length of a single frame in bytes
+   */
+  SPSCFrameQueue(int capacity, int max_frame_len)
+  : max_frame_len_(max_frame_len),
+    head_(0),
+    tail_(0)
+  {
+    if ((capacity <= 0) || (max_frame_len <= 0)) {
+      throw std::runtime_error(
+              "[SPSCFrameQueue::SPSCFrameQueue] Error: capacity and max_frame_len must be positive. "
+              "capacity: " + std::to_string(capacity) + ", max_frame_len: " +
+              std::to_string(max_frame_len));
+    }
+    capacity_ = 1;
+    while (capacity_ < capacity) {
+      capacity_ <<= 1;
+    }
+    frame_buffer_ = std::vector<unsigned char>(capacity_ * max_frame_len_);
+    frame_lengths_ = std::vector<int>(capacity_);
+  }
+
+  /**
+   * @brief Producer only. Returns the next free slot (max_frame_len bytes) to write a frame into.
+   *
+   * @return unsigned char* slot, or nullptr if the queue is full
+   */
+  unsigned char * beginPush()
+  {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == (uint32_t)capacity_) {
+      return nullptr;
+    }
+    return frame_buffer_.data() + (tail & (capacity_ - 1)) * max_frame_len_;
+  }
+
+  /**
+   * @brief Producer only. Publishes the slot returned by the last beginPush() to the consumer.
+   *
+   * @param frame_len number of bytes written to the slot
+   */
+  void commitPush(int frame_len)
+  {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    frame_lengths_[tail & (capacity_ - 1)] = frame_len;
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Producer only. Copies a frame into the queue.
+   *
+   * @return bool false if the queue is full or the frame exceeds max_frame_len
+   */
+  bool tryPush(const unsigned char frame[], int frame_len)
+  {
+    unsigned char * slot = beginPush();
+    if ((slot == nullptr) || (frame_len > max_frame_len_)) {
+      return false;
+    }
+    memcpy(slot, frame, frame_len);
+    commitPush(frame_len);
+    return true;
+  }
+
+  /**
+   * @brief Consumer only. Returns the oldest frame without removing it.
+   *
+   * @param frame_len length of the returned frame
+   * @return const unsigned char* frame, or nullptr if the queue is empty
+   */
+  const unsigned char * front(int & frame_len) const
+  {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    frame_len = frame_lengths_[head & (capacity_ - 1)];
+    return frame_buffer_.data() + (head & (capacity_ - 1)) * max_frame_len_;
+  }
+
+  /**
+   * @brief Consumer only. Removes the frame returned by front().
+   */
+  void pop()
+  {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Consumer only. Copies the oldest frame out of the queue and removes it.
+   *
+   * @return bool false if the queue is empty
+   */
+  bool tryPop(unsigned char frame[], int & frame_len)
+  {
+    const unsigned char * slot = front(frame_len);
+    if (slot == nullptr) {
+      return false;
+    }
+    memcpy(frame, slot, frame_len);
+    pop();
+    return true;
+  }
+
+  bool empty() const
+  {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  int capacity() const
+  {
+    return capacity_;
+  }
+
+  int maxFrameLength() const
+  {
+    return max_frame_len_;
+  }
+
+private:
+  int capacity_;
+  int max_frame_len_;
+  std::vector<unsigned char> frame_buffer_;
+  std::vector<int> frame_lengths_;
+
+  // Kept on separate cache lines so producer and consumer do not contend
+  alignas(64) std::atomic<uint32_t> head_;
+  alignas(64) std::atomic<uint32_t> tail_;
+};
+
+} // namespace ghost_serial
+
+#endif // GHOST_SERIAL__SPSC_FRAME_QUEUE_HPP
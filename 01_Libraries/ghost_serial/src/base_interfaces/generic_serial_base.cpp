@@ -46,11 +46,20 @@ GenericSerialBase::GenericSerialBase(
   write_msg_start_seq(write_msg_start_seq),
   read_msg_start_seq(read_msg_start_seq),
   use_checksum_(use_checksum),
-  port_open_(false)
+  port_open_(false),
+  serial_write_fd_(-1),
+  serial_read_fd_(-1),
+  pending_msg_head_(0),
+  pending_msg_count_(0),
+  dropped_msg_count_(0)
 {
   // Reads a maximum of two msgs - one byte at once
   read_buffer_ = std::vector<unsigned char>(2 * (read_msg_max_len + use_checksum_ + 2) - 1);
   msg_parser_ = std::make_unique<MsgParser>(read_msg_max_len, read_msg_start_seq, use_checksum_);
+
+  // A single read can contain several msgs, which are held here until returned
+  pending_msg_buffer_ = std::vector<unsigned char>(pending_msg_queue_size_ * read_msg_max_len);
+  pending_msg_lengths_ = std::vector<int>(pending_msg_queue_size_);
 }
 
 /**
@@ -90,6 +99,67 @@ void GenericSerialBase::checkReadMsgBufferLength(std::vector<unsigned char> & ms
   }
 }
 
+int GenericSerialBase::parseReadBuffer(const int num_bytes)
+{
+  return msg_parser_->parseByteStream(
+    read_buffer_.data(), num_bytes,
+    [this](const unsigned char msg[], int msg_len) {
+      if (pending_msg_count_ == pending_msg_queue_size_) {
+        // Overwrite oldest msg
+        pending_msg_head_ = (pending_msg_head_ + 1) % pending_msg_queue_size_;
+        pending_msg_count_--;
+        dropped_msg_count_++;
+      }
+      int tail = (pending_msg_head_ + pending_msg_count_) % pending_msg_queue_size_;
+      memcpy(pending_msg_buffer_.data() + tail * read_msg_max_len_, msg, msg_len);
+      pending_msg_lengths_[tail] = msg_len;
+      pending_msg_count_++;
+    });
+}
+
+bool GenericSerialBase::popPendingMsg(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len)
+{
+  if (pending_msg_count_ == 0) {
+    return false;
+  }
+  checkReadMsgBufferLength(msg_buffer);       // Throws if msg_buffer is misconfigured
+
+  parsed_msg_len = pending_msg_lengths_[pending_msg_head_];
+  memcpy(
+    msg_buffer.data(), pending_msg_buffer_.data() + pending_msg_head_ * read_msg_max_len_,
+    parsed_msg_len);
+  pending_msg_head_ = (pending_msg_head_ + 1) % pending_msg_queue_size_;
+  pending_msg_count_--;
+  return true;
+}
+
+int GenericSerialBase::getMaxEncodedMsgLength(const int num_bytes) const
+{
+  // COBS adds a leading byte, plus one byte per 254 bytes without a zero
+  int raw_msg_len = write_msg_start_seq.length() + num_bytes + use_checksum_;
+  return raw_msg_len + raw_msg_len / 254 + 2;
+}
+
+int GenericSerialBase::encodeMsg(
+  const unsigned char buffer[], const int num_bytes,
+  unsigned char raw_msg_buffer[], unsigned char encoded_buffer[]) const
+{
+  int raw_msg_len = write_msg_start_seq.length() + num_bytes + use_checksum_;
+
+  // Copy start_sequence and msg
+  memcpy(raw_msg_buffer, write_msg_start_seq.c_str(), write_msg_start_seq.length());
+  memcpy(raw_msg_buffer + write_msg_start_seq.length(), buffer, num_bytes);
+
+  // Calculate and append checksum byte (if used)
+  if (use_checksum_) {
+    raw_msg_buffer[raw_msg_len - 1] = calculateChecksum(buffer, num_bytes);
+  }
+
+  int encoded_len = COBS::cobsEncode(raw_msg_buffer, raw_msg_len, encoded_buffer);
+  encoded_buffer[encoded_len] = 0x00;       // Null delimiter
+  return encoded_len + 1;
+}
+
 bool GenericSerialBase::writeMsgToSerial(const unsigned char buffer[], const int num_bytes)
 {
   bool succeeded = false;
@@ -101,21 +171,11 @@ bool GenericSerialBase::writeMsgToSerial(const unsigned char buffer[], const int
         0,
       };
 
-      // Copy start_sequence and msg
-      memcpy(raw_msg_buffer, write_msg_start_seq.c_str(), write_msg_start_seq.length());
-      memcpy(raw_msg_buffer + write_msg_start_seq.length(), buffer, num_bytes);
-
-      // Calculate and append checksum byte (if used)
-      if (use_checksum_) {
-        raw_msg_buffer[raw_msg_len - 1] = calculateChecksum(buffer, num_bytes);
-      }
-
       // COBS Encode (Adds leading byte and null delimiter byte)
-      int write_buffer_len = raw_msg_len + 2;
-      unsigned char write_buffer[write_buffer_len] = {
+      unsigned char write_buffer[getMaxEncodedMsgLength(num_bytes)] = {
         0,
       };
-      COBS::cobsEncode(raw_msg_buffer, raw_msg_len, write_buffer);
+      int write_buffer_len = encodeMsg(buffer, num_bytes, raw_msg_buffer, write_buffer);
 
       // Write to serial port
       std::unique_lock<CROSSPLATFORM_MUTEX_T> write_lock(serial_io_mutex_);
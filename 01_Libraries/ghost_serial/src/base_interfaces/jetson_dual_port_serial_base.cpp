@@ -0,0 +1,239 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "ghost_serial/base_interfaces/jetson_dual_port_serial_base.hpp"
+
+#include <poll.h>
+
+#include <cstring>
+#include <exception>
+#include <system_error>
+
+namespace ghost_serial
+{
+
+JetsonDualPortSerialBase::JetsonDualPortSerialBase(
+  std::string write_msg_start_seq,
+  std::string read_msg_start_seq,
+  int read_msg_max_len,
+  int write_msg_max_len,
+  dual_port_mode_e mode,
+  bool use_checksum,
+  bool verbose,
+  int queue_size)
+: mode_(mode),
+  read_msg_max_len_(read_msg_max_len),
+  write_msg_max_len_(write_msg_max_len),
+  read_timeout_(1000),
+  next_read_link_(0),
+  has_last_read_seq_(false),
+  last_read_seq_(0),
+  consecutive_stale_msgs_(0),
+  next_write_link_(0),
+  next_write_seq_(0),
+  stale_msg_count_(0)
+{
+  // Striped msgs carry a sequence number byte in front of the payload
+  int seq_len = (mode_ == STRIPE) ? 1 : 0;
+  for (auto & link : links_) {
+    link = std::make_unique<JetsonEpollSerialBase>(
+      write_msg_start_seq,
+      read_msg_start_seq,
+      read_msg_max_len + seq_len,
+      write_msg_max_len + seq_len,
+      use_checksum,
+      verbose,
+      queue_size);
+  }
+  read_staging_buffer_ = std::vector<unsigned char>(read_msg_max_len + seq_len);
+  write_staging_buffer_ = std::vector<unsigned char>(write_msg_max_len + seq_len);
+}
+
+bool JetsonDualPortSerialBase::trySerialInit(
+  std::string primary_port_name,
+  std::string secondary_port_name)
+{
+  closeSerialPort();
+  links_[0]->trySerialInit(primary_port_name);
+  try {
+    links_[1]->trySerialInit(secondary_port_name);
+  } catch (...) {
+    links_[0]->closeSerialPort();
+    throw;
+  }
+
+  // Sender restarts its sequence whenever the link is reestablished
+  has_last_read_seq_ = false;
+  consecutive_stale_msgs_ = 0;
+  return true;
+}
+
+void JetsonDualPortSerialBase::closeSerialPort()
+{
+  for (auto & link : links_) {
+    link->closeSerialPort();
+  }
+}
+
+bool JetsonDualPortSerialBase::isPortOpen() const
+{
+  return links_[0]->isPortOpen() && links_[1]->isPortOpen();
+}
+
+void JetsonDualPortSerialBase::setBaudRate(int baud_rate)
+{
+  for (auto & link : links_) {
+    link->setBaudRate(baud_rate);
+  }
+}
+
+uint32_t JetsonDualPortSerialBase::getDroppedReadMsgCount() const
+{
+  return links_[0]->getDroppedReadMsgCount() + links_[1]->getDroppedReadMsgCount();
+}
+
+uint32_t JetsonDualPortSerialBase::getDroppedWriteMsgCount() const
+{
+  return links_[0]->getDroppedWriteMsgCount() + links_[1]->getDroppedWriteMsgCount();
+}
+
+uint32_t JetsonDualPortSerialBase::getWriteErrorCount() const
+{
+  return links_[0]->getWriteErrorCount() + links_[1]->getWriteErrorCount();
+}
+
+bool JetsonDualPortSerialBase::readMsgFromSerial(
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  if ((int)msg_buffer.size() < read_msg_max_len_) {
+    throw std::runtime_error(
+            "[JetsonDualPortSerialBase::readMsgFromSerial] Error: msg_buffer size (" +
+            std::to_string(msg_buffer.size()) + ") must be at least read_msg_max_len (" +
+            std::to_string(read_msg_max_len_) + ").");
+  }
+  return (mode_ == SPLIT) ?
+         readSplitMsg(msg_buffer, parsed_msg_len) :
+         readStripedMsg(msg_buffer, parsed_msg_len);
+}
+
+bool JetsonDualPortSerialBase::readSplitMsg(
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  return links_[0]->readMsgFromSerial(msg_buffer, parsed_msg_len);
+}
+
+bool JetsonDualPortSerialBase::readStripedMsg(
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  auto deadline = std::chrono::steady_clock::now() + read_timeout_;
+  while (true) {
+    // Alternate which port is drained first so neither can starve the other
+    for (int i = 0; i < 2; i++) {
+      auto & link = links_[next_read_link_];
+      next_read_link_ ^= 1;
+
+      int frame_len;
+      while (link->tryReadMsgFromSerial(read_staging_buffer_, frame_len)) {
+        if (acceptStripedMsg(frame_len, msg_buffer, parsed_msg_len)) {
+          return true;
+        }
+      }
+    }
+
+    auto time_remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+    if (!isPortOpen() || (time_remaining.count() <= 0)) {
+      return false;
+    }
+
+    // Queues were empty when checked, so any msg queued since then has signalled its eventfd
+    struct pollfd pollfd_rx_events[2]{};
+    for (int i = 0; i < 2; i++) {
+      pollfd_rx_events[i].fd = links_[i]->getReadEventFd();
+      pollfd_rx_events[i].events = POLLIN;
+    }
+    if ((poll(pollfd_rx_events, 2, time_remaining.count()) == -1) && (errno != EINTR)) {
+      throw std::system_error(errno, std::generic_category());
+    }
+    for (const auto & pollfd_rx_event : pollfd_rx_events) {
+      uint64_t event_count;
+      (void)!read(pollfd_rx_event.fd, &event_count, sizeof(event_count));
+    }
+  }
+}
+
+bool JetsonDualPortSerialBase::acceptStripedMsg(
+  int frame_len,
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  if (frame_len < 1) {
+    return false;
+  }
+
+  // Wrapping comparison, valid while the ports are less than 128 msgs apart
+  uint8_t seq = read_staging_buffer_[0];
+  bool stale = has_last_read_seq_ && ((int8_t)(seq - last_read_seq_) <= 0);
+  if (stale && (++consecutive_stale_msgs_ <= MAX_CONSECUTIVE_STALE_MSGS)) {
+    stale_msg_count_++;
+    return false;
+  }
+
+  has_last_read_seq_ = true;
+  last_read_seq_ = seq;
+  consecutive_stale_msgs_ = 0;
+  parsed_msg_len = frame_len - 1;
+  memcpy(msg_buffer.data(), read_staging_buffer_.data() + 1, parsed_msg_len);
+  return true;
+}
+
+bool JetsonDualPortSerialBase::writeMsgToSerial(const unsigned char buffer[], const int num_bytes)
+{
+  if (num_bytes > write_msg_max_len_) {
+    throw std::runtime_error(
+            "[JetsonDualPortSerialBase::writeMsgToSerial] Error: msg of " +
+            std::to_string(num_bytes) + " bytes exceeds write_msg_max_len of " +
+            std::to_string(write_msg_max_len_) + " bytes.");
+  }
+
+  if (mode_ == SPLIT) {
+    return links_[1]->writeMsgToSerial(buffer, num_bytes);
+  }
+
+  write_staging_buffer_[0] = next_write_seq_;
+  memcpy(write_staging_buffer_.data() + 1, buffer, num_bytes);
+  for (int i = 0; i < 2; i++) {
+    auto & link = links_[next_write_link_];
+    next_write_link_ ^= 1;
+    if (link->writeMsgToSerial(write_staging_buffer_.data(), num_bytes + 1)) {
+      next_write_seq_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace ghost_serial
@@ -0,0 +1,324 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "ghost_serial/base_interfaces/jetson_epoll_serial_base.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <cstring>
+#include <exception>
+
+namespace ghost_serial
+{
+
+JetsonEpollSerialBase::JetsonEpollSerialBase(
+  std::string write_msg_start_seq,
+  std::string read_msg_start_seq,
+  int read_msg_max_len,
+  int write_msg_max_len,
+  bool use_checksum,
+  bool verbose,
+  int queue_size)
+: JetsonSerialBase(
+    write_msg_start_seq,
+    read_msg_start_seq,
+    read_msg_max_len,
+    use_checksum,
+    verbose),
+  write_msg_max_len_(write_msg_max_len),
+  read_timeout_(1000),
+  rx_queue_(queue_size, read_msg_max_len),
+  tx_queue_(queue_size, getMaxEncodedMsgLength(write_msg_max_len)),
+  tx_frame_offset_(0),
+  write_interest_(false),
+  io_thread_running_(false),
+  epoll_fd_(-1),
+  dropped_read_msg_count_(0),
+  dropped_write_msg_count_(0),
+  write_error_count_(0)
+{
+  write_staging_buffer_ = std::vector<unsigned char>(
+    write_msg_start_seq.length() + write_msg_max_len + use_checksum);
+
+  tx_event_fd_ = eventfd(0, EFD_NONBLOCK);
+  rx_event_fd_ = eventfd(0, EFD_NONBLOCK);
+  if ((tx_event_fd_ < 0) || (rx_event_fd_ < 0)) {
+    throw std::runtime_error(
+            std::string("[JetsonEpollSerialBase::JetsonEpollSerialBase] Error: eventfd failed, ") +
+            strerror(errno));
+  }
+}
+
+JetsonEpollSerialBase::~JetsonEpollSerialBase()
+{
+  closeSerialPort();
+  close(tx_event_fd_);
+  close(rx_event_fd_);
+}
+
+bool JetsonEpollSerialBase::trySerialInit(std::string port_name)
+{
+  // Reset from any previous session, including one whose IO thread exited on a port failure
+  closeSerialPort();
+  JetsonSerialBase::trySerialInit(port_name);
+
+  // Reads and writes must never block the IO thread
+  int flags = fcntl(serial_read_fd_, F_GETFL, 0);
+  if ((flags == -1) || (fcntl(serial_read_fd_, F_SETFL, flags | O_NONBLOCK) == -1)) {
+    std::string err_string = "[JetsonEpollSerialBase::trySerialInit] Error: failed to set " +
+      port_name + " non-blocking, " + strerror(errno);
+    JetsonSerialBase::closeSerialPort();
+    throw std::runtime_error(err_string);
+  }
+
+  epoll_fd_ = epoll_create1(0);
+  struct epoll_event serial_event{};
+  serial_event.events = EPOLLIN;
+  serial_event.data.fd = serial_read_fd_;
+  struct epoll_event wakeup_event{};
+  wakeup_event.events = EPOLLIN;
+  wakeup_event.data.fd = tx_event_fd_;
+  if ((epoll_fd_ < 0) ||
+    (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, serial_read_fd_, &serial_event) == -1) ||
+    (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, tx_event_fd_, &wakeup_event) == -1))
+  {
+    std::string err_string = "[JetsonEpollSerialBase::trySerialInit] Error: epoll setup failed for " +
+      port_name + ", " + strerror(errno);
+    closeSerialPort();
+    throw std::runtime_error(err_string);
+  }
+  write_interest_ = false;
+  tx_frame_offset_ = 0;
+
+  io_thread_running_ = true;
+  io_thread_ = std::thread(&JetsonEpollSerialBase::ioLoop, this);
+  return true;
+}
+
+void JetsonEpollSerialBase::closeSerialPort()
+{
+  io_thread_running_ = false;
+  if (io_thread_.joinable()) {
+    signalEvent(tx_event_fd_);
+    io_thread_.join();
+  }
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  JetsonSerialBase::closeSerialPort();
+
+  // Release any reader waiting on the closed port
+  signalEvent(rx_event_fd_);
+}
+
+bool JetsonEpollSerialBase::readMsgFromSerial(
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  checkReadMsgBufferLength(msg_buffer);       // Throws if msg_buffer is misconfigured
+
+  auto deadline = std::chrono::steady_clock::now() + read_timeout_;
+  while (rx_queue_.empty() && port_open_) {
+    auto time_remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+    if (time_remaining.count() <= 0) {
+      break;
+    }
+
+    // Block waiting for IO thread to signal new msgs (or timeout)
+    struct pollfd pollfd_rx_event{};
+    pollfd_rx_event.fd = rx_event_fd_;
+    pollfd_rx_event.events = POLLIN;
+    if ((poll(&pollfd_rx_event, 1, time_remaining.count()) == -1) && (errno != EINTR)) {
+      throw std::system_error(errno, std::generic_category());
+    }
+
+    // Clear event counter. Msgs are tracked by the queue itself, so the count is not needed.
+    uint64_t event_count;
+    (void)!read(rx_event_fd_, &event_count, sizeof(event_count));
+  }
+  return rx_queue_.tryPop(msg_buffer.data(), parsed_msg_len);
+}
+
+bool JetsonEpollSerialBase::tryReadMsgFromSerial(
+  std::vector<unsigned char> & msg_buffer,
+  int & parsed_msg_len)
+{
+  checkReadMsgBufferLength(msg_buffer);
+  return rx_queue_.tryPop(msg_buffer.data(), parsed_msg_len);
+}
+
+bool JetsonEpollSerialBase::writeMsgToSerial(const unsigned char buffer[], const int num_bytes)
+{
+  if (num_bytes > write_msg_max_len_) {
+    throw std::runtime_error(
+            "[JetsonEpollSerialBase::writeMsgToSerial] Error: msg of " + std::to_string(num_bytes) +
+            " bytes exceeds write_msg_max_len of " + std::to_string(write_msg_max_len_) + " bytes.");
+  }
+  if (!port_open_) {
+    return false;
+  }
+
+  unsigned char * frame = tx_queue_.beginPush();
+  if (frame == nullptr) {
+    // IO thread has fallen behind the serial port
+    dropped_write_msg_count_++;
+    return false;
+  }
+  tx_queue_.commitPush(encodeMsg(buffer, num_bytes, write_staging_buffer_.data(), frame));
+  signalEvent(tx_event_fd_);
+  return true;
+}
+
+void JetsonEpollSerialBase::ioLoop()
+{
+  struct epoll_event events[2];
+  while (io_thread_running_) {
+    int num_events = epoll_wait(epoll_fd_, events, 2, -1);
+    if (num_events == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("[JetsonEpollSerialBase::ioLoop] Error");
+      break;
+    }
+
+    for (int i = 0; i < num_events; i++) {
+      if (events[i].data.fd == tx_event_fd_) {
+        // New outbound frames (handled below) or shutdown
+        uint64_t event_count;
+        (void)!read(tx_event_fd_, &event_count, sizeof(event_count));
+      } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+        // Device was unplugged or failed
+        io_thread_running_ = false;
+      } else if ((events[i].events & EPOLLIN) && !handleReadable()) {
+        io_thread_running_ = false;
+      }
+    }
+
+    if (io_thread_running_) {
+      handleWritable();
+    }
+  }
+
+  // Covers exits caused by port failures (not just closeSerialPort)
+  port_open_ = false;
+  signalEvent(rx_event_fd_);
+}
+
+bool JetsonEpollSerialBase::handleReadable()
+{
+  bool msg_pushed = false;
+  while (true) {
+    int num_bytes_read = read(serial_read_fd_, read_buffer_.data(), read_buffer_.size());
+    if (num_bytes_read == -1) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        break;
+      } else if (errno == EINTR) {
+        continue;
+      }
+      perror("[JetsonEpollSerialBase::handleReadable] Error");
+      return false;
+    } else if (num_bytes_read == 0) {
+      // Non-canonical tty with VMIN = 0 returns 0 once drained
+      break;
+    }
+
+    if (verbose_) {
+      std::cout << "Read " << num_bytes_read << " bytes" << std::endl;
+    }
+
+    msg_parser_->parseByteStream(
+      read_buffer_.data(), num_bytes_read,
+      [this, &msg_pushed](const unsigned char msg[], int msg_len) {
+        if (rx_queue_.tryPush(msg, msg_len)) {
+          msg_pushed = true;
+        } else {
+          // Reader has fallen behind
+          dropped_read_msg_count_++;
+        }
+      });
+
+    if (num_bytes_read < (int)read_buffer_.size()) {
+      break;
+    }
+  }
+
+  if (msg_pushed) {
+    signalEvent(rx_event_fd_);
+  }
+  return true;
+}
+
+void JetsonEpollSerialBase::handleWritable()
+{
+  int frame_len;
+  const unsigned char * frame;
+  while ((frame = tx_queue_.front(frame_len)) != nullptr) {
+    int ret = write(serial_write_fd_, frame + tx_frame_offset_, frame_len - tx_frame_offset_);
+    if (ret == -1) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        // Kernel buffer is full, resume when port is writable
+        setWriteInterest(true);
+        return;
+      } else if (errno == EINTR) {
+        continue;
+      }
+      // Drop frame rather than retrying it forever
+      write_error_count_++;
+      tx_frame_offset_ = 0;
+      tx_queue_.pop();
+      continue;
+    }
+
+    tx_frame_offset_ += ret;
+    if (tx_frame_offset_ == frame_len) {
+      tx_frame_offset_ = 0;
+      tx_queue_.pop();
+    }
+  }
+  setWriteInterest(false);
+}
+
+void JetsonEpollSerialBase::setWriteInterest(bool enabled)
+{
+  if (enabled == write_interest_) {
+    return;
+  }
+  struct epoll_event serial_event{};
+  serial_event.events = EPOLLIN | (enabled ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+  serial_event.data.fd = serial_read_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, serial_read_fd_, &serial_event) == 0) {
+    write_interest_ = enabled;
+  }
+}
+
+void JetsonEpollSerialBase::signalEvent(int event_fd)
+{
+  uint64_t one = 1;
+  (void)!write(event_fd, &one, sizeof(one));
+}
+
+} // namespace ghost_serial
@@ -22,15 +22,45 @@
  */
 
 #include "ghost_serial/base_interfaces/jetson_serial_base.hpp"
+#include "ghost_serial/base_interfaces/termios2_baud_rate.hpp"
 
 #include <cstring>
 #include <exception>
+#include <utility>
 
 using namespace std::chrono_literals;
 
 namespace ghost_serial
 {
 
+namespace
+{
+
+/**
+ * @brief Maps a baud rate to its termios speed constant.
+ *
+ * @return false if the rate has no Bxxx constant and must be set with termios2
+ */
+bool getStandardBaudRate(int baud_rate, speed_t & speed)
+{
+  static const std::pair<int, speed_t> standard_baud_rates[] = {
+    {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+    {230400, B230400}, {460800, B460800}, {500000, B500000}, {576000, B576000},
+    {921600, B921600}, {1000000, B1000000}, {1152000, B1152000}, {1500000, B1500000},
+    {2000000, B2000000}, {2500000, B2500000}, {3000000, B3000000}, {3500000, B3500000},
+    {4000000, B4000000}};
+
+  for (const auto & standard_baud_rate : standard_baud_rates) {
+    if (standard_baud_rate.first == baud_rate) {
+      speed = standard_baud_rate.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
 /**
  * @brief Construct a new JetsonSerialBase object
  *
@@ -48,6 +78,7 @@ JetsonSerialBase::JetsonSerialBase(
     read_msg_max_len,
     use_checksum),
   verbose_{verbose},
+  baud_rate_{115200},
   bytes_received_{0}
 {
 }
@@ -59,6 +90,27 @@ JetsonSerialBase::~JetsonSerialBase()
   port_open_ = false;
 }
 
+void JetsonSerialBase::setBaudRate(int baud_rate)
+{
+  if (baud_rate <= 0) {
+    throw std::runtime_error(
+            "[JetsonSerialBase::setBaudRate] Error: baud rate must be positive, got " +
+            std::to_string(baud_rate) + ".");
+  }
+  baud_rate_ = baud_rate;
+}
+
+void JetsonSerialBase::closeSerialPort()
+{
+  std::unique_lock<CROSSPLATFORM_MUTEX_T> close_lock(serial_io_mutex_);
+  port_open_ = false;
+  if (serial_read_fd_ >= 0) {
+    close(serial_read_fd_);
+  }
+  serial_read_fd_ = -1;
+  serial_write_fd_ = -1;
+}
+
 /**
  * @brief Shorthand to flush bytes from serial port
  */
@@ -84,6 +136,9 @@ bool JetsonSerialBase::setSerialPortConfig()
 {
   // Serial Port Configuration
   struct termios tty;
+  if (tcgetattr(serial_read_fd_, &tty) != 0) {
+    return false;
+  }
 
   tty.c_cflag &= ~PARENB;              // Clear parity bit
   tty.c_cflag &= ~CSTOPB;              // Single stop bit
@@ -113,11 +168,20 @@ bool JetsonSerialBase::setSerialPortConfig()
   tty.c_cc[VMIN] = 0;
 
   // Set Baud Rate
-  cfsetispeed(&tty, B115200);
-  cfsetospeed(&tty, B115200);
+  speed_t speed;
+  bool standard_baud_rate = getStandardBaudRate(baud_rate_, speed);
+  if (standard_baud_rate) {
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+  }
 
   // Save tty settings, also checking for error
-  return tcsetattr(serial_read_fd_, TCSANOW, &tty) == 0;
+  if (tcsetattr(serial_read_fd_, TCSANOW, &tty) != 0) {
+    return false;
+  }
+
+  // Non-standard rates can only be applied on top of the settings above
+  return standard_baud_rate || setCustomBaudRate(serial_read_fd_, baud_rate_);
 }
 
 bool JetsonSerialBase::trySerialInit(std::string port_name)
@@ -164,6 +228,11 @@ bool JetsonSerialBase::readMsgFromSerial(
   std::vector<unsigned char> & msg_buffer,
   int & parsed_msg_len)
 {
+  // Return msgs left over from a previous read before waiting on the port again
+  if (popPendingMsg(msg_buffer, parsed_msg_len)) {
+    return true;
+  }
+
   if (port_open_) {
     // Block waiting for read or timeout (1s)
     int ret = poll(&pollfd_read_, 1, 1000);
@@ -187,14 +256,13 @@ bool JetsonSerialBase::readMsgFromSerial(
         }
 
         checkReadMsgBufferLength(msg_buffer);                         // Throws if msg_buffer is misconfigured
-        bool msg_found = msg_parser_->parseByteStream(
-          read_buffer_.data(), num_bytes_read, msg_buffer.data(), parsed_msg_len);
-        if (!msg_found && (bytes_received_ > startup_junk_byte_count_)) {
+        int num_msgs = parseReadBuffer(num_bytes_read);
+        if ((num_msgs == 0) && (bytes_received_ > startup_junk_byte_count_)) {
           std::cout << "WARNING: Received " << num_bytes_read <<
             " bytes but found no compatible message. Are both devices using the same robot config?"
                     << std::endl;
         }
-        return msg_found;
+        return popPendingMsg(msg_buffer, parsed_msg_len);
       } else if (num_bytes_read == -1) {
         perror("Error");
       }
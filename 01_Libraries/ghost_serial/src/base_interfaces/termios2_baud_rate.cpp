@@ -0,0 +1,56 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "ghost_serial/base_interfaces/termios2_baud_rate.hpp"
+
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+namespace ghost_serial
+{
+
+bool setCustomBaudRate(int fd, int baud_rate)
+{
+  struct termios2 tty;
+  if (ioctl(fd, TCGETS2, &tty) == -1) {
+    return false;
+  }
+
+  // Input speed lives in the bits above IBSHIFT
+  tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+  tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+  tty.c_ispeed = baud_rate;
+  tty.c_ospeed = baud_rate;
+  return ioctl(fd, TCSETS2, &tty) != -1;
+}
+
+int getCustomBaudRate(int fd)
+{
+  struct termios2 tty;
+  if (ioctl(fd, TCGETS2, &tty) == -1) {
+    return -1;
+  }
+  return tty.c_ospeed;
+}
+
+} // namespace ghost_serial
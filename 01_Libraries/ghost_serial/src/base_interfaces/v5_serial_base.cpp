@@ -93,6 +93,12 @@ bool V5SerialBase::setSerialPortConfig()
 bool V5SerialBase::readMsgFromSerial(std::vector<unsigned char> & msg_buffer, int & parsed_msg_len)
 {
   int max_read_bytes = read_msg_max_len_ + use_checksum_ + read_msg_start_seq.length() + 2;
+
+  // Return msgs left over from a previous read before blocking on stdin again
+  if (popPendingMsg(msg_buffer, parsed_msg_len)) {
+    return true;
+  }
+
   if (port_open_) {
     try {
       // Lock serial port mutex from writes and read serial data
@@ -106,9 +112,8 @@ bool V5SerialBase::readMsgFromSerial(std::vector<unsigned char> & msg_buffer, in
       // Extract any msgs from serial stream and return if msg is found
       if (num_bytes_read > 0) {
         checkReadMsgBufferLength(msg_buffer);                         // Throws if msg_buffer is misconfigured
-        return msg_parser_->parseByteStream(
-          read_buffer_.data(), num_bytes_read,
-          msg_buffer.data(), parsed_msg_len);
+        parseReadBuffer(num_bytes_read);
+        return popPendingMsg(msg_buffer, parsed_msg_len);
       } else if (num_bytes_read == -1) {
         // TODO: stdout is a no-go on this device. We need to add log files and SD card.
         // perror("Error");
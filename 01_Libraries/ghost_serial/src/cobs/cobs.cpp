@@ -1,10 +1,22 @@
 /**
- * This entire file is pulled from https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing
+ * cobsEncodeBytewise and cobsDecode are pulled from https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing
  * All credit goes to original authors.
+ *
+ * cobsEncode is a vectorized rewrite of the same encoder. The V5 Brain (32-bit ARM) compiles the scalar path.
  */
 
 #include "ghost_serial/cobs/cobs.hpp"
 
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace COBS
 {
 
@@ -15,7 +27,7 @@ namespace COBS
         @return Encoded buffer length in bytes
         @note Does not output delimiter byte
  */
-size_t cobsEncode(const void * data, size_t length, uint8_t * buffer)
+size_t cobsEncodeBytewise(const void * data, size_t length, uint8_t * buffer)
 {
   assert(data && buffer);
 
@@ -46,6 +58,7 @@ size_t cobsEncode(const void * data, size_t length, uint8_t * buffer)
         @param data Pointer to decoded output data
         @return Number of bytes successfully decoded
         @note Stops decoding if delimiter byte is found
+        @note Output never gets ahead of input, so buffer and data may be the same (decode in place)
  */
 size_t cobsDecode(const uint8_t * buffer, size_t length, void * data)
 {
@@ -71,4 +84,95 @@ size_t cobsDecode(const uint8_t * buffer, size_t length, void * data)
   return (size_t)(decode - (uint8_t *)data);
 }
 
+#if defined(__AVX2__)
+#define COBS_CHUNK_SIZE 32
+#define COBS_MASK_BITS_PER_BYTE 1
+#elif defined(__SSE2__)
+#define COBS_CHUNK_SIZE 16
+#define COBS_MASK_BITS_PER_BYTE 1
+#elif defined(__aarch64__)
+#define COBS_CHUNK_SIZE 16
+#define COBS_MASK_BITS_PER_BYTE 4
+#endif
+
+#ifdef COBS_CHUNK_SIZE
+/** Copies one vector register worth of bytes and flags which of them are zero
+        @param src Pointer to COBS_CHUNK_SIZE input bytes
+        @param dst Pointer to COBS_CHUNK_SIZE output bytes
+        @return Bitmask with COBS_MASK_BITS_PER_BYTE bits set for each zero byte
+ */
+static inline uint64_t copyChunkFindZeros(const uint8_t * src, uint8_t * dst)
+{
+#if defined(__AVX2__)
+  __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), chunk);
+  return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_setzero_si256()));
+#elif defined(__SSE2__)
+  __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), chunk);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+#elif defined(__aarch64__)
+  uint8x16_t chunk = vld1q_u8(src);
+  vst1q_u8(dst, chunk);
+  // NEON has no movemask, so narrow each 8-bit comparison lane to 4 bits to fit in 64 bits
+  uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(vceqzq_u8(chunk)), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+#endif
+}
+#endif
+
+size_t cobsEncode(const void * data, size_t length, uint8_t * buffer)
+{
+  assert(data && buffer);
+
+  const uint8_t * byte = (const uint8_t *)data;      // Input byte pointer
+  const uint8_t * end = byte + length;
+  uint8_t * encode = buffer;      // Encoded byte pointer
+  uint8_t * codep = encode++;      // Output code pointer
+  uint8_t code = 1;       // Code value
+
+  while (byte < end) {
+#ifdef COBS_CHUNK_SIZE
+    // Every input byte maps to exactly one output byte (zeros become the following block's code byte),
+    // unless a block reaches the 254 byte limit. So while the current block cannot fill up within this
+    // chunk, copy the chunk whole and then patch the code bytes where the zeros were.
+    // The remaining input guarantees at least COBS_CHUNK_SIZE output bytes remain in buffer.
+    if ((end - byte >= COBS_CHUNK_SIZE) && (code < 0xff - COBS_CHUNK_SIZE)) {
+      uint64_t zero_mask = copyChunkFindZeros(byte, encode);
+      int consumed = 0;
+      while (zero_mask) {
+        int z = __builtin_ctzll(zero_mask) / COBS_MASK_BITS_PER_BYTE;
+        code += z - consumed;
+        *codep = code;
+        codep = encode + z;
+        code = 1;
+        consumed = z + 1;
+        zero_mask &= ~(((1ULL << COBS_MASK_BITS_PER_BYTE) - 1) << (z * COBS_MASK_BITS_PER_BYTE));
+      }
+      code += COBS_CHUNK_SIZE - consumed;
+      encode += COBS_CHUNK_SIZE;
+      byte += COBS_CHUNK_SIZE;
+      continue;
+    }
+#endif
+    // Byte at a time near the end of the input or of a full block
+    uint8_t value = *byte++;
+    if (value) {           // Byte not zero, write it
+      *encode++ = value, ++code;
+    }
+    if (!value || (code == 0xff)) {           // Input is zero or block completed, restart
+      *codep = code, code = 1, codep = encode;
+      if (!value || (byte < end)) {
+        ++encode;
+      }
+    }
+  }
+  // Write final code value, unless the input ended exactly on a full block
+  if (codep < encode) {
+    *codep = code;
+  }
+
+  return (size_t)(encode - buffer);
+}
+
 } // namespace COBS
@@ -21,6 +21,9 @@
  *   SOFTWARE.
  */
 
+#include <random>
+#include <vector>
+
 #include "ghost_serial/cobs/cobs.hpp"
 
 #include "gtest/gtest.h"
@@ -75,6 +78,39 @@ TEST_F(TestCOBS, testCOBSDecodeSerialData) {
 }
 
 
+TEST_F(TestCOBS, testCOBSEncodeMatchesBytewise) {
+  std::mt19937 rng(0);
+
+  // Sizes straddle vector widths and the 254 byte COBS block limit
+  std::vector<size_t> sizes{0, 1, 15, 16, 17, 31, 32, 33, 253, 254, 255, 508, 509, 1000, 4096};
+  for (size_t size : sizes) {
+    // Sparse, dense, and no zero bytes
+    for (int zero_period : {0, 2, 50}) {
+      std::vector<uint8_t> input(size + 1);       // Never empty, so data() is never null
+      for (size_t i = 0; i < size; i++) {
+        input[i] = (zero_period && (rng() % zero_period == 0)) ? 0 : (uint8_t)(rng() % 255 + 1);
+      }
+
+      size_t max_encoded_len = size + size / 254 + 2;
+      std::vector<uint8_t> expected_encoded(max_encoded_len, 0);
+      std::vector<uint8_t> encoded(max_encoded_len, 0);
+      size_t expected_len = COBS::cobsEncodeBytewise(input.data(), size, expected_encoded.data());
+      size_t encoded_len = COBS::cobsEncode(input.data(), size, encoded.data());
+      ASSERT_EQ(expected_len, encoded_len) << "size: " << size;
+      for (size_t i = 0; i < encoded_len; i++) {
+        ASSERT_EQ(expected_encoded[i], encoded[i]) << "size: " << size << ", index: " << i;
+      }
+
+      // Decode in place, as MsgParser does
+      size_t decoded_len = COBS::cobsDecode(encoded.data(), encoded_len, encoded.data());
+      ASSERT_EQ(decoded_len, size);
+      for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(input[i], encoded[i]) << "size: " << size << ", index: " << i;
+      }
+    }
+  }
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,235 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ghost_serial/base_interfaces/jetson_dual_port_serial_base.hpp"
+#include "ghost_serial/cobs/cobs.hpp"
+#include "ghost_serial/msg_parser/msg_parser.hpp"
+
+#include "gtest/gtest.h"
+
+using ghost_serial::JetsonDualPortSerialBase;
+using namespace std::chrono_literals;
+
+/**
+ * @brief Opens two pseudo-terminals standing in for the two V5 ports. The test holds both master sides.
+ */
+class TestJetsonDualPortSerialBase : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    for (int i = 0; i < 2; i++) {
+      master_fds_[i] = posix_openpt(O_RDWR | O_NOCTTY);
+      ASSERT_GE(master_fds_[i], 0);
+      ASSERT_EQ(grantpt(master_fds_[i]), 0);
+      ASSERT_EQ(unlockpt(master_fds_[i]), 0);
+      port_names_[i] = ptsname(master_fds_[i]);
+    }
+  }
+
+  void TearDown() override
+  {
+    serial_base_.reset();
+    for (int fd : master_fds_) {
+      close(fd);
+    }
+  }
+
+  void openSerialBase(JetsonDualPortSerialBase::dual_port_mode_e mode)
+  {
+    serial_base_ = std::make_shared<JetsonDualPortSerialBase>(
+      "msg", "sout", read_msg_len_, write_msg_len_, mode, true);
+    serial_base_->setReadTimeout(200ms);
+    ASSERT_TRUE(serial_base_->trySerialInit(port_names_[0], port_names_[1]));
+  }
+
+  // Writes msg to one port as the V5 Brain would (start sequence, checksum, COBS, delimiter)
+  void writeFromV5(int port, const std::vector<unsigned char> & msg)
+  {
+    std::vector<unsigned char> raw_msg{'s', 'o', 'u', 't'};
+    raw_msg.insert(raw_msg.end(), msg.begin(), msg.end());
+    unsigned char checksum = 0;
+    for (auto byte : msg) {
+      checksum += byte;
+    }
+    raw_msg.push_back(checksum);
+
+    std::vector<unsigned char> encoded(raw_msg.size() + 2, 0);
+    int encoded_len = COBS::cobsEncode(raw_msg.data(), raw_msg.size(), encoded.data());
+    ASSERT_EQ(write(master_fds_[port], encoded.data(), encoded_len + 1), encoded_len + 1);
+  }
+
+  // Parses every msg the V5 Brain would receive on one port within the timeout
+  std::vector<std::vector<unsigned char>> readOnV5(int port, int msg_len, int num_msgs)
+  {
+    ghost_serial::MsgParser parser(msg_len, "msg", true);
+    std::vector<std::vector<unsigned char>> msgs;
+    std::vector<unsigned char> read_buffer(256);
+    auto deadline = std::chrono::steady_clock::now() + 500ms;
+    while (((int)msgs.size() < num_msgs) && (std::chrono::steady_clock::now() < deadline)) {
+      struct pollfd pfd{master_fds_[port], POLLIN, 0};
+      if (poll(&pfd, 1, 50) <= 0) {
+        continue;
+      }
+      int n = read(master_fds_[port], read_buffer.data(), read_buffer.size());
+      if (n <= 0) {
+        break;
+      }
+      parser.parseByteStream(
+        read_buffer.data(), n, [&msgs](const unsigned char msg[], int len) {
+          msgs.emplace_back(msg, msg + len);
+        });
+    }
+    return msgs;
+  }
+
+  const int read_msg_len_ = 4;
+  const int write_msg_len_ = 3;
+  std::array<int, 2> master_fds_;
+  std::array<std::string, 2> port_names_;
+  std::shared_ptr<JetsonDualPortSerialBase> serial_base_;
+};
+
+TEST_F(TestJetsonDualPortSerialBase, testSplitSeparatesDirections) {
+  openSerialBase(JetsonDualPortSerialBase::SPLIT);
+
+  // Only the primary port is read
+  writeFromV5(1, {9, 9, 9, 9});
+  writeFromV5(0, {1, 2, 3, 4});
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_EQ(msg_len, read_msg_len_);
+  ASSERT_EQ(msg_buffer, (std::vector<unsigned char>{1, 2, 3, 4}));
+
+  // Only the secondary port is written
+  unsigned char msg[3] = {5, 6, 7};
+  ASSERT_TRUE(serial_base_->writeMsgToSerial(msg, 3));
+  auto secondary_msgs = readOnV5(1, write_msg_len_, 1);
+  ASSERT_EQ(secondary_msgs.size(), 1u);
+  ASSERT_EQ(secondary_msgs[0], (std::vector<unsigned char>{5, 6, 7}));
+  ASSERT_TRUE(readOnV5(0, write_msg_len_, 1).empty());
+}
+
+TEST_F(TestJetsonDualPortSerialBase, testStripeAlternatesWrites) {
+  openSerialBase(JetsonDualPortSerialBase::STRIPE);
+
+  const int num_msgs = 6;
+  for (int i = 0; i < num_msgs; i++) {
+    unsigned char msg[3] = {(unsigned char)(10 + i), 0, 1};
+    ASSERT_TRUE(serial_base_->writeMsgToSerial(msg, 3));
+  }
+
+  // Each port receives every other msg, prefixed with its sequence number
+  for (int port = 0; port < 2; port++) {
+    auto msgs = readOnV5(port, write_msg_len_ + 1, num_msgs / 2);
+    ASSERT_EQ(msgs.size(), (size_t)num_msgs / 2);
+    for (int i = 0; i < num_msgs / 2; i++) {
+      unsigned char seq = 2 * i + port;
+      ASSERT_EQ(msgs[i], (std::vector<unsigned char>{seq, (unsigned char)(10 + seq), 0, 1}));
+    }
+  }
+}
+
+TEST_F(TestJetsonDualPortSerialBase, testStripeReadsBothPortsAndDropsStaleMsgs) {
+  openSerialBase(JetsonDualPortSerialBase::STRIPE);
+
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+
+  writeFromV5(0, {0, 1, 1, 1, 1});
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_EQ(msg_len, read_msg_len_);
+  ASSERT_EQ(msg_buffer, (std::vector<unsigned char>{1, 1, 1, 1}));
+
+  writeFromV5(1, {1, 2, 2, 2, 2});
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_EQ(msg_buffer, (std::vector<unsigned char>{2, 2, 2, 2}));
+
+  // Seq 1 arrives late on the other port and is discarded
+  writeFromV5(0, {1, 9, 9, 9, 9});
+  writeFromV5(0, {2, 3, 3, 3, 3});
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_EQ(msg_buffer, (std::vector<unsigned char>{3, 3, 3, 3}));
+  ASSERT_EQ(serial_base_->getStaleMsgCount(), 1u);
+}
+
+TEST_F(TestJetsonDualPortSerialBase, testStripeResyncsAfterSenderRestart) {
+  openSerialBase(JetsonDualPortSerialBase::STRIPE);
+
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  writeFromV5(0, {100, 1, 1, 1, 1});
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+
+  // Sender restarts at seq 0, which looks older than 100
+  for (unsigned char seq = 0; seq < 5; seq++) {
+    writeFromV5(0, {seq, seq, seq, seq, seq});
+  }
+  ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_EQ(msg_buffer, (std::vector<unsigned char>{4, 4, 4, 4}));
+  ASSERT_EQ(serial_base_->getStaleMsgCount(), 4u);
+}
+
+TEST_F(TestJetsonDualPortSerialBase, testReadTimeoutAndClose) {
+  openSerialBase(JetsonDualPortSerialBase::STRIPE);
+  serial_base_->setReadTimeout(20ms);
+
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+  serial_base_->closeSerialPort();
+  ASSERT_FALSE(serial_base_->isPortOpen());
+  unsigned char msg[3] = {0, };
+  ASSERT_FALSE(serial_base_->writeMsgToSerial(msg, 3));
+  ASSERT_THROW(serial_base_->writeMsgToSerial(msg, 4), std::runtime_error);
+}
+
+TEST_F(TestJetsonDualPortSerialBase, testSecondaryFailureClosesPrimary) {
+  serial_base_ = std::make_shared<JetsonDualPortSerialBase>(
+    "msg", "sout", read_msg_len_, write_msg_len_, JetsonDualPortSerialBase::SPLIT, true);
+  ASSERT_THROW(
+    serial_base_->trySerialInit(port_names_[0], "/dev/ghost_serial_missing_port"),
+    std::runtime_error);
+  ASSERT_FALSE(serial_base_->isPortOpen());
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,252 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ghost_serial/base_interfaces/jetson_epoll_serial_base.hpp"
+#include "ghost_serial/base_interfaces/termios2_baud_rate.hpp"
+#include "ghost_serial/cobs/cobs.hpp"
+#include "ghost_serial/util/spsc_frame_queue.hpp"
+
+#include "gtest/gtest.h"
+
+using ghost_serial::JetsonEpollSerialBase;
+using ghost_serial::SPSCFrameQueue;
+using namespace std::chrono_literals;
+
+TEST(TestSPSCFrameQueue, testPushPop) {
+  SPSCFrameQueue queue(3, 4);
+  ASSERT_EQ(queue.capacity(), 4);
+  ASSERT_TRUE(queue.empty());
+
+  unsigned char frame[4] = {1, 2, 3, 4};
+  for (int i = 0; i < 4; i++) {
+    frame[0] = i;
+    ASSERT_TRUE(queue.tryPush(frame, i + 1));
+  }
+  ASSERT_FALSE(queue.tryPush(frame, 1));                // Full
+  ASSERT_FALSE(queue.empty());
+
+  unsigned char output[4];
+  int output_len;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(queue.tryPop(output, output_len));
+    ASSERT_EQ(output_len, i + 1);
+    ASSERT_EQ(output[0], i);
+  }
+  ASSERT_FALSE(queue.tryPop(output, output_len));
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(TestSPSCFrameQueue, testFrameTooLong) {
+  SPSCFrameQueue queue(2, 4);
+  unsigned char frame[5] = {0, };
+  ASSERT_FALSE(queue.tryPush(frame, 5));
+  ASSERT_THROW(SPSCFrameQueue(0, 4), std::runtime_error);
+}
+
+TEST(TestSPSCFrameQueue, testProducerConsumerThreads) {
+  SPSCFrameQueue queue(8, sizeof(uint32_t));
+  const uint32_t num_frames = 100000;
+
+  std::thread producer([&]() {
+      for (uint32_t i = 0; i < num_frames; ) {
+        if (queue.tryPush(reinterpret_cast<unsigned char *>(&i), sizeof(i))) {
+          i++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+  uint32_t expected = 0;
+  while (expected < num_frames) {
+    uint32_t value;
+    int len;
+    if (queue.tryPop(reinterpret_cast<unsigned char *>(&value), len)) {
+      ASSERT_EQ(value, expected);
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+/**
+ * @brief Opens a pseudo-terminal so the transport can be exercised without hardware. The test holds the
+ * master side, acting as the V5 Brain, and the transport opens the slave side like a real serial device.
+ */
+class TestJetsonEpollSerialBase : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    master_fd_ = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master_fd_, 0);
+    ASSERT_EQ(grantpt(master_fd_), 0);
+    ASSERT_EQ(unlockpt(master_fd_), 0);
+    port_name_ = ptsname(master_fd_);
+
+    serial_base_ = std::make_shared<JetsonEpollSerialBase>(
+      "msg", "sout", read_msg_len_, write_msg_len_, true);
+    ASSERT_TRUE(serial_base_->trySerialInit(port_name_));
+  }
+
+  void TearDown() override
+  {
+    serial_base_.reset();
+    close(master_fd_);
+  }
+
+  // Writes msg as the V5 Brain would (start sequence, checksum, COBS, delimiter)
+  void writeFromV5(const std::vector<unsigned char> & msg)
+  {
+    std::vector<unsigned char> raw_msg{'s', 'o', 'u', 't'};
+    raw_msg.insert(raw_msg.end(), msg.begin(), msg.end());
+    unsigned char checksum = 0;
+    for (auto byte : msg) {
+      checksum += byte;
+    }
+    raw_msg.push_back(checksum);
+
+    std::vector<unsigned char> encoded(raw_msg.size() + 2, 0);
+    int encoded_len = COBS::cobsEncode(raw_msg.data(), raw_msg.size(), encoded.data());
+    ASSERT_EQ(write(master_fd_, encoded.data(), encoded_len + 1), encoded_len + 1);
+  }
+
+  const int read_msg_len_ = 6;
+  const int write_msg_len_ = 5;
+  int master_fd_;
+  std::string port_name_;
+  std::shared_ptr<JetsonEpollSerialBase> serial_base_;
+};
+
+TEST_F(TestJetsonEpollSerialBase, testReadMultipleMsgs) {
+  std::vector<std::vector<unsigned char>> msgs{
+    {1, 2, 3, 4, 5, 6}, {0, 0, 0, 0, 0, 0}, {7, 0, 8, 0, 9, 0}};
+  for (const auto & msg : msgs) {
+    writeFromV5(msg);
+  }
+
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  for (const auto & msg : msgs) {
+    ASSERT_TRUE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+    ASSERT_EQ(msg_len, read_msg_len_);
+    ASSERT_EQ(msg_buffer, msg);
+  }
+}
+
+TEST_F(TestJetsonEpollSerialBase, testReadTimeout) {
+  serial_base_->setReadTimeout(20ms);
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+TEST_F(TestJetsonEpollSerialBase, testWriteMsgs) {
+  const int num_msgs = 200;
+  for (int i = 0; i < num_msgs; i++) {
+    unsigned char msg[5] = {(unsigned char)i, 1, 0, 2, 3};
+    // Queue may briefly fill if the pty is slow to drain
+    while (!serial_base_->writeMsgToSerial(msg, 5)) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+
+  // Parse from master side as the V5 Brain would
+  ghost_serial::MsgParser parser(write_msg_len_, "msg", true);
+  std::vector<unsigned char> read_buffer(256);
+  int num_parsed = 0;
+  auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (num_parsed < num_msgs && std::chrono::steady_clock::now() < deadline) {
+    struct pollfd pfd{master_fd_, POLLIN, 0};
+    if (poll(&pfd, 1, 100) <= 0) {
+      continue;
+    }
+    int n = read(master_fd_, read_buffer.data(), read_buffer.size());
+    ASSERT_GT(n, 0);
+    parser.parseByteStream(
+      read_buffer.data(), n, [&](const unsigned char msg[], int msg_len) {
+        ASSERT_EQ(msg_len, write_msg_len_);
+        ASSERT_EQ(msg[0], (unsigned char)num_parsed);
+        num_parsed++;
+      });
+  }
+  ASSERT_EQ(num_parsed, num_msgs);
+  ASSERT_EQ(serial_base_->getWriteErrorCount(), 0u);
+}
+
+TEST_F(TestJetsonEpollSerialBase, testWriteTooLongThrows) {
+  unsigned char msg[6] = {0, };
+  ASSERT_THROW(serial_base_->writeMsgToSerial(msg, 6), std::runtime_error);
+}
+
+TEST_F(TestJetsonEpollSerialBase, testPortClosedUnblocksReader) {
+  std::vector<unsigned char> msg_buffer(read_msg_len_);
+  int msg_len;
+  std::thread closer([&]() {
+      std::this_thread::sleep_for(50ms);
+      serial_base_->closeSerialPort();
+    });
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(serial_base_->readMsgFromSerial(msg_buffer, msg_len));
+  ASSERT_LT(std::chrono::steady_clock::now() - start, 900ms);
+  closer.join();
+
+  unsigned char msg[5] = {0, };
+  ASSERT_FALSE(serial_base_->writeMsgToSerial(msg, 5));
+}
+
+TEST_F(TestJetsonEpollSerialBase, testBaudRate) {
+  ASSERT_EQ(serial_base_->getBaudRate(), 115200);
+  ASSERT_THROW(serial_base_->setBaudRate(0), std::runtime_error);
+
+  // Standard rate goes through cfsetospeed, non-standard rate through termios2
+  for (int baud_rate : {460800, 250000}) {
+    serial_base_->setBaudRate(baud_rate);
+    ASSERT_TRUE(serial_base_->trySerialInit(port_name_));
+
+    int slave_fd = open(port_name_.c_str(), O_RDWR | O_NOCTTY);
+    ASSERT_GE(slave_fd, 0);
+    EXPECT_EQ(ghost_serial::getCustomBaudRate(slave_fd), baud_rate);
+    close(slave_fd);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
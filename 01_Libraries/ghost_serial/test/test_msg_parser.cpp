@@ -21,6 +21,8 @@
  *   SOFTWARE.
  */
 
+#include <vector>
+
 #include "ghost_serial/cobs/cobs.hpp"
 #include "ghost_serial/msg_parser/msg_parser.hpp"
 
@@ -254,6 +256,100 @@ TEST_F(TestMsgParser, testChecksumInvalid) {
   );
 }
 
+TEST_F(TestMsgParser, testChecksumShortMsg) {
+  // Msg Configuration
+  std::string start_seq = "start";
+  int max_msg_len = 10;
+  int msg_len = 3;
+
+  // Msg Data (checksum must only cover the bytes actually sent)
+  uint8_t checksum_byte = (uint8_t) ('m' + 's' + 'g');
+  unsigned char input_buffer[10] =
+  {'s', 't', 'a', 'r', 't', 'm', 's', 'g', checksum_byte};
+  unsigned char encoded_input_buffer[11] = {0, };
+  COBS::cobsEncode(input_buffer, 9, encoded_input_buffer);
+
+  // Msg Parser
+  auto msg_parser = ghost_serial::MsgParser(max_msg_len, start_seq, true);
+
+  // Parse the stream
+  int parsed_msg_len;
+  unsigned char output_buffer[10] = {0, };
+  ASSERT_TRUE(
+    msg_parser.parseByteStream(
+      encoded_input_buffer,
+      sizeof(encoded_input_buffer) / sizeof(encoded_input_buffer[0]),
+      output_buffer,
+      parsed_msg_len)
+  );
+  ASSERT_EQ(parsed_msg_len, msg_len);
+}
+
+TEST_F(TestMsgParser, testMultipleMsgsCallback) {
+  // Msg Configuration
+  std::string start_seq = "start";
+  int max_msg_len = 4;
+
+  // Three msgs (one containing a zero byte) back to back, with noise in between
+  std::vector<std::vector<unsigned char>> msgs{{'a', 'b', 'c'}, {'d', 0x00, 'f', 'g'}, {'h'}};
+  std::vector<unsigned char> stream{'n', 'o', 0x00};
+  for (const auto & msg : msgs) {
+    std::vector<unsigned char> raw_msg(start_seq.begin(), start_seq.end());
+    raw_msg.insert(raw_msg.end(), msg.begin(), msg.end());
+    std::vector<unsigned char> encoded_msg(raw_msg.size() + 2, 0);
+    COBS::cobsEncode(raw_msg.data(), raw_msg.size(), encoded_msg.data());
+    stream.insert(stream.end(), encoded_msg.begin(), encoded_msg.end());
+    stream.push_back('x');
+  }
+
+  // Msg Parser
+  auto msg_parser = ghost_serial::MsgParser(max_msg_len, start_seq);
+
+  // Feed stream one byte at a time for the first half, then the remainder at once
+  std::vector<std::vector<unsigned char>> parsed_msgs;
+  auto callback = [&](const unsigned char msg[], int msg_len) {
+      parsed_msgs.emplace_back(msg, msg + msg_len);
+    };
+  int split = stream.size() / 2;
+  int num_msgs = 0;
+  for (int i = 0; i < split; i++) {
+    num_msgs += msg_parser.parseByteStream(stream.data() + i, 1, callback);
+  }
+  num_msgs += msg_parser.parseByteStream(stream.data() + split, stream.size() - split, callback);
+
+  ASSERT_EQ(num_msgs, 3);
+  ASSERT_EQ(parsed_msgs, msgs);
+}
+
+TEST_F(TestMsgParser, testMultipleMsgsReturnsLatest) {
+  // Msg Configuration
+  std::string start_seq = "start";
+  int max_msg_len = 3;
+
+  unsigned char input_buffer[] = {
+    9, 's', 't', 'a', 'r', 't', 'o', 'n', 'e', 0x00,
+    9, 's', 't', 'a', 'r', 't', 't', 'w', 'o', 0x00};
+
+  // Msg Parser
+  auto msg_parser = ghost_serial::MsgParser(max_msg_len, start_seq);
+
+  // Parse the stream
+  int parsed_msg_len;
+  unsigned char output_buffer[3] = {0, };
+  ASSERT_TRUE(
+    msg_parser.parseByteStream(
+      input_buffer,
+      sizeof(input_buffer) / sizeof(input_buffer[0]),
+      output_buffer,
+      parsed_msg_len)
+  );
+
+  unsigned char expected[] = {'t', 'w', 'o'};
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(expected[i], output_buffer[i]);
+  }
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
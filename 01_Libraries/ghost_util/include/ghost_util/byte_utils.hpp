@@ -89,4 +89,38 @@ inline unsigned char packByte(const std::vector<bool> & bool_arr)
   return byte;
 }
 
+/**
+ * @brief Allocation-free variant of unpackByte for fixed size bool arrays.
+ * Uses the same bit ordering as unpackByte (element 0 is the most significant bit).
+ *
+ * @param val
+ * @param bit_arr output array of 8 bools
+ */
+inline void unpackByte(unsigned char val, bool (& bit_arr)[8])
+{
+  for (int i = 0; i < 8; i++) {
+    auto index = (isBigEndian()) ? i : 7 - i;
+    bit_arr[i] = val & BITMASK_ARR_32BIT[index];
+  }
+}
+
+/**
+ * @brief Allocation-free variant of packByte for fixed size bool arrays.
+ * Uses the same bit ordering as packByte (element 0 is the most significant bit).
+ *
+ * @param bool_arr array of 8 bools
+ * @return unsigned char
+ */
+inline unsigned char packByte(const bool (& bool_arr)[8])
+{
+  unsigned char byte = 0;
+  for (int i = 0; i < 8; i++) {
+    auto index = (isBigEndian()) ? i : 7 - i;
+    if (bool_arr[i]) {
+      byte |= BITMASK_ARR_32BIT[index];
+    }
+  }
+  return byte;
+}
+
 } // namespace ghost_util
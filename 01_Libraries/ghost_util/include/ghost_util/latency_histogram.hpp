@@ -0,0 +1,93 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace ghost_util
+{
+
+/**
+ * @brief Fixed-size histogram of latencies in microseconds.
+ *
+ * Buckets are exact below 16us, then split every power of two into 16 linear sub-buckets, so a
+ * percentile is reported to within 1/16 (6.25%) of its true value. Recording is O(1) and never
+ * allocates, which keeps it usable on serial and control paths.
+ */
+class LatencyHistogram
+{
+public:
+  LatencyHistogram();
+
+  /**
+   * @brief Adds one sample. Negative samples are recorded as zero.
+   *
+   * @param latency_us latency in microseconds
+   */
+  void record(int64_t latency_us);
+
+  void reset();
+
+  uint64_t getCount() const
+  {
+    return count_;
+  }
+
+  int64_t getMax() const
+  {
+    return max_;
+  }
+
+  double getMean() const
+  {
+    return (count_ > 0) ? (double)sum_ / count_ : 0.0;
+  }
+
+  /**
+   * @brief Returns the smallest recorded latency which is greater than or equal to the given fraction of
+   * samples (e.g. 50.0 for the median). Resolution is limited by the bucket width.
+   *
+   * @param percentile value in [0, 100]
+   * @return int64_t latency in microseconds, or 0 if empty
+   */
+  int64_t getPercentile(double percentile) const;
+
+private:
+  static constexpr int SUB_BUCKET_BITS = 4;
+  static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static constexpr int MAX_EXPONENT = 35;        // ~9.5 hours, larger samples share the last bucket
+  static constexpr int NUM_BUCKETS =
+    SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  static int getBucketIndex(int64_t value);
+  static int64_t getBucketUpperBound(int index);
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_;
+  uint64_t count_;
+  int64_t sum_;
+  int64_t max_;
+};
+
+} // namespace ghost_util
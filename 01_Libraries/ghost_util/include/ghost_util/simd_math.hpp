@@ -0,0 +1,165 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ghost_util
+{
+
+// Portable SIMD batch using GCC/Clang vector extensions, which lower to AVX, SSE or NEON
+// depending on the target. Lane count follows the widest float unit enabled at compile time.
+#if defined(__AVX__)
+constexpr int SIMD_WIDTH = 8;
+#else
+constexpr int SIMD_WIDTH = 4;
+#endif
+typedef float FloatBatch __attribute__((vector_size(SIMD_WIDTH * sizeof(float))));
+
+// Integer lanes matching FloatBatch, for bit manipulation and comparison masks
+typedef int32_t IntBatch __attribute__((vector_size(SIMD_WIDTH * sizeof(int32_t))));
+
+/**
+ * @brief Natural log of each lane, for positive finite inputs. Absolute error is about 1e-6.
+ */
+inline FloatBatch fastLog(FloatBatch x)
+{
+  // x = m * 2^e with m in [1, 2), and ln(m) = 2 atanh(t) for t = (m - 1) / (m + 1) in [0, 1/3)
+  IntBatch bits = (IntBatch)x;
+  IntBatch exponent = ((bits >> 23) & 0xFF) - 127;
+  FloatBatch m = (FloatBatch)((bits & 0x7FFFFF) | 0x3F800000);
+  FloatBatch t = (m - 1.0f) / (m + 1.0f);
+  FloatBatch t2 = t * t;
+  FloatBatch series = (((t2 * (1.0f / 9.0f) + (1.0f / 7.0f)) * t2 + 0.2f) * t2 + (1.0f / 3.0f)) *
+    t2 + 1.0f;
+  return 2.0f * t * series + __builtin_convertvector(exponent, FloatBatch) * 0.693147181f;
+}
+
+/**
+ * @brief Sine and cosine of each lane. Absolute error is below 1e-6 for angles within a few
+ * hundred radians, beyond which float angles are already coarser than that.
+ */
+inline void fastSinCos(FloatBatch angle, FloatBatch * sin_out, FloatBatch * cos_out)
+{
+  // Reduce to angle = q * pi/2 + r with r in [-pi/4, pi/4], splitting pi/2 for precision
+  const IntBatch sign_bit = (IntBatch){} + INT32_MIN;
+  FloatBatch q_float = angle * 0.636619772f;
+  FloatBatch half = (FloatBatch)(((IntBatch)q_float & sign_bit) | (IntBatch)((FloatBatch){} + 0.5f));
+  IntBatch q = __builtin_convertvector(q_float + half, IntBatch);
+  FloatBatch q_rounded = __builtin_convertvector(q, FloatBatch);
+  FloatBatch r = angle - q_rounded * 1.5703125f - q_rounded * 4.83826794897e-4f;
+
+  FloatBatch r2 = r * r;
+  FloatBatch sin_r = r + r * r2 *
+    (-1.0f / 6.0f + r2 * (1.0f / 120.0f + r2 * (-1.0f / 5040.0f + r2 * (1.0f / 362880.0f))));
+  FloatBatch cos_r = 1.0f + r2 *
+    (-0.5f + r2 * (1.0f / 24.0f + r2 * (-1.0f / 720.0f + r2 * (1.0f / 40320.0f))));
+
+  // Odd quarter turns swap sine and cosine, the quadrant sets the signs
+  IntBatch swap = (q & 1) != 0;
+  IntBatch s = (swap & (IntBatch)cos_r) | (~swap & (IntBatch)sin_r);
+  IntBatch c = (swap & (IntBatch)sin_r) | (~swap & (IntBatch)cos_r);
+  *sin_out = (FloatBatch)(s ^ ((q & 2) << 30));
+  *cos_out = (FloatBatch)(c ^ (((q + 1) & 2) << 30));
+}
+
+/**
+ * @brief Lanes of a where mask is set, lanes of b elsewhere.
+ */
+inline FloatBatch selectBatch(IntBatch mask, FloatBatch a, FloatBatch b)
+{
+  return (FloatBatch)((mask & (IntBatch)a) | (~mask & (IntBatch)b));
+}
+
+/**
+ * @brief Square root of each lane, for non-negative finite inputs. Relative error is about 2e-7
+ * and zero maps to zero.
+ */
+inline FloatBatch fastSqrt(FloatBatch x)
+{
+  // Bit-level guess for 1/sqrt(x), refined with Newton steps, then sqrt(x) = x / sqrt(x)
+  FloatBatch y = (FloatBatch)(0x5F3759DF - ((IntBatch)x >> 1));
+  const FloatBatch half_x = x * 0.5f;
+  y = y * (1.5f - half_x * y * y);
+  y = y * (1.5f - half_x * y * y);
+  y = y * (1.5f - half_x * y * y);
+  return x * y;
+}
+
+/**
+ * @brief Four-quadrant arctangent of each lane, in [-pi, pi]. Matches std::atan2 except for the
+ * sign of zero x. Absolute error is about 3e-7.
+ */
+inline FloatBatch fastAtan2(FloatBatch y, FloatBatch x)
+{
+  const IntBatch sign_bit = (IntBatch){} + INT32_MIN;
+  FloatBatch abs_y = (FloatBatch)((IntBatch)y & ~sign_bit);
+  FloatBatch abs_x = (FloatBatch)((IntBatch)x & ~sign_bit);
+
+  // Reduce to t = min / max in [0, 1], then fold t above tan(pi/8) onto [-tan(pi/8), tan(pi/8)]
+  IntBatch y_larger = abs_y > abs_x;
+  FloatBatch num = selectBatch(y_larger, abs_x, abs_y);
+  FloatBatch den = selectBatch(y_larger, abs_y, abs_x);
+  FloatBatch t = num / selectBatch(den == 0.0f, (FloatBatch){} + 1.0f, den);
+  IntBatch folded = t > 0.414213562f;
+  FloatBatch r = selectBatch(folded, (t - 1.0f) / (t + 1.0f), t);
+
+  FloatBatch r2 = r * r;
+  FloatBatch angle = (FloatBatch)(folded & (IntBatch)((FloatBatch){} + 0.785398163f)) + r + r *
+    r2 * (((8.05374449538e-2f * r2 - 1.38776856032e-1f) * r2 + 1.99777106478e-1f) * r2 -
+    3.33329491539e-1f);
+
+  // Undo the octant reduction, then take the sign of y
+  angle = selectBatch(y_larger, 1.570796327f - angle, angle);
+  angle = selectBatch(x < 0.0f, 3.141592654f - angle, angle);
+  return (FloatBatch)((IntBatch)angle | ((IntBatch)y & sign_bit));
+}
+
+/**
+ * @brief Sine and cosine of n angles. sin_out and cos_out must not alias angles.
+ */
+inline void fastSinCos(const float * angles, float * sin_out, float * cos_out, std::size_t n)
+{
+  std::size_t i = 0;
+  FloatBatch angle, s, c;
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+    std::memcpy(&angle, angles + i, sizeof(angle));
+    fastSinCos(angle, &s, &c);
+    std::memcpy(sin_out + i, &s, sizeof(s));
+    std::memcpy(cos_out + i, &c, sizeof(c));
+  }
+  if (i < n) {
+    angle = FloatBatch{};
+    std::memcpy(&angle, angles + i, (n - i) * sizeof(float));
+    fastSinCos(angle, &s, &c);
+    std::memcpy(sin_out + i, &s, (n - i) * sizeof(float));
+    std::memcpy(cos_out + i, &c, (n - i) * sizeof(float));
+  }
+}
+
+} // namespace ghost_util
@@ -0,0 +1,106 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ghost_util
+{
+
+/**
+ * @brief Persistent pool of worker threads for data-parallel loops.
+ *
+ * parallelFor() splits a range into one contiguous chunk per thread and blocks until every chunk is done.
+ * The calling thread works on the first chunk, so a pool of one thread runs the loop inline. Chunk bounds
+ * only depend on the range size and thread count, so each index is always processed by the same thread
+ * index, which lets callers keep per-thread scratch buffers and reduce per-thread results in a fixed order.
+ *
+ * Workers sleep between loops instead of being created per call. Only one thread may call parallelFor()
+ * at a time.
+ */
+class ThreadPool
+{
+public:
+  using Task = std::function<void (int begin, int end, int thread_index)>;
+
+  /**
+   * @brief Construct a new ThreadPool.
+   *
+   * @param num_threads total threads, including the caller. Zero or less uses all hardware threads.
+   */
+  explicit ThreadPool(int num_threads = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  int getNumThreads() const
+  {
+    return num_threads_;
+  }
+
+  /**
+   * @brief Runs task over [0, num_items), one contiguous chunk per thread. Threads without any items are
+   * not woken up.
+   *
+   * If a chunk throws, the first exception is rethrown here once all chunks have finished.
+   *
+   * @param num_items size of the range
+   * @param task called as task(begin, end, thread_index) with thread_index in [0, getNumThreads())
+   */
+  void parallelFor(int num_items, const Task & task);
+
+  /**
+   * @brief Returns the [begin, end) chunk of [0, num_items) handled by thread_index.
+   */
+  static void getChunk(int num_items, int num_threads, int thread_index, int & begin, int & end);
+
+private:
+  void workerLoop(int thread_index);
+  void runChunk(int thread_index);
+
+  int num_threads_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  const Task * task_;
+  int num_items_;
+  int num_active_threads_;
+  int num_pending_;
+  uint64_t generation_;
+  bool shutdown_;
+  std::exception_ptr error_;
+};
+
+} // namespace ghost_util
@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace ghost_util
+{
+
+/**
+ * @brief Lock-free handoff of the latest value from one writer thread to one reader thread.
+ *
+ * The writer fills back() and calls publish(); the reader calls update() and then reads front().
+ * Three slots let both sides work without waiting: the writer never touches the slot being read,
+ * and intermediate values the reader never picked up are simply overwritten. Readers always see a
+ * complete value, never one that is half written.
+ *
+ * Only one thread may write and one thread may read at a time, e.g. callbacks in two separate
+ * mutually exclusive callback groups.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer() = default;
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer & operator=(const TripleBuffer &) = delete;
+
+  /**
+   * @brief Writer side slot to fill before publish(). Keeps whatever value it last held.
+   */
+  T & back()
+  {
+    return slots_[back_];
+  }
+
+  /**
+   * @brief Makes the value in back() the latest one, and hands the writer a free slot.
+   */
+  void publish()
+  {
+    back_ = middle_.exchange(back_ | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  /**
+   * @brief Moves the latest published value into front(), if there is one.
+   *
+   * @return true if front() changed
+   */
+  bool update()
+  {
+    if (!(middle_.load(std::memory_order_acquire) & NEW_DATA)) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief Reader side value, as of the last update() that returned true.
+   */
+  const T & front() const
+  {
+    return slots_[front_];
+  }
+
+private:
+  static constexpr int INDEX_MASK = 0x3;
+  static constexpr int NEW_DATA = 0x4;
+
+  std::array<T, 3> slots_{};
+  int back_ = 0;
+  int front_ = 1;
+  std::atomic<int> middle_{2};
+};
+
+} // namespace ghost_util
@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "ghost_util/latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ghost_util
+{
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::reset()
+{
+  buckets_.fill(0);
+  count_ = 0;
+  sum_ = 0;
+  max_ = 0;
+}
+
+void LatencyHistogram::record(int64_t latency_us)
+{
+  latency_us = std::max<int64_t>(latency_us, 0);
+  buckets_[getBucketIndex(latency_us)]++;
+  count_++;
+  sum_ += latency_us;
+  max_ = std::max(max_, latency_us);
+}
+
+int64_t LatencyHistogram::getPercentile(double percentile) const
+{
+  if (count_ == 0) {
+    return 0;
+  }
+
+  uint64_t rank = (uint64_t)std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count_);
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t cumulative_count = 0;
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    cumulative_count += buckets_[i];
+    if ((cumulative_count >= rank) && (i < NUM_BUCKETS - 1)) {
+      return std::min(getBucketUpperBound(i), max_);
+    }
+  }
+
+  // Last bucket is unbounded
+  return max_;
+}
+
+int LatencyHistogram::getBucketIndex(int64_t value)
+{
+  if (value < SUB_BUCKET_COUNT) {
+    return (int)value;
+  }
+
+  // Position of the most significant bit selects the octave, the next bits select the sub-bucket
+  int exponent = 63 - __builtin_clzll((uint64_t)value);
+  if (exponent > MAX_EXPONENT) {
+    return NUM_BUCKETS - 1;
+  }
+  int shift = exponent - SUB_BUCKET_BITS;
+  int sub_bucket = (int)(value >> shift) - SUB_BUCKET_COUNT;
+  return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+int64_t LatencyHistogram::getBucketUpperBound(int index)
+{
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+  int sub_bucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+  return ((int64_t)(SUB_BUCKET_COUNT + sub_bucket + 1) << shift) - 1;
+}
+
+} // namespace ghost_util
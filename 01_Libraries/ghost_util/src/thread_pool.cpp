@@ -0,0 +1,152 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "ghost_util/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace ghost_util
+{
+
+ThreadPool::ThreadPool(int num_threads)
+: num_threads_(num_threads),
+  task_(nullptr),
+  num_items_(0),
+  num_active_threads_(0),
+  num_pending_(0),
+  generation_(0),
+  shutdown_(false)
+{
+  if (num_threads_ <= 0) {
+    num_threads_ = std::max(1, (int) std::thread::hardware_concurrency());
+  }
+
+  // Thread 0 is the caller of parallelFor
+  for (int i = 1; i < num_threads_; i++) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::getChunk(int num_items, int num_threads, int thread_index, int & begin, int & end)
+{
+  // The first (num_items % num_threads) chunks take one extra item
+  int chunk_size = num_items / num_threads;
+  int remainder = num_items % num_threads;
+  begin = thread_index * chunk_size + std::min(thread_index, remainder);
+  end = begin + chunk_size + ((thread_index < remainder) ? 1 : 0);
+}
+
+void ThreadPool::parallelFor(int num_items, const Task & task)
+{
+  if (num_items <= 0) {
+    return;
+  }
+
+  int num_active_threads = std::min(num_threads_, num_items);
+  if (num_active_threads == 1) {
+    task(0, num_items, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_items_ = num_items;
+    num_active_threads_ = num_active_threads;
+    num_pending_ = num_active_threads - 1;
+    error_ = nullptr;
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  runChunk(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() {return num_pending_ == 0;});
+  task_ = nullptr;
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void ThreadPool::runChunk(int thread_index)
+{
+  int begin;
+  int end;
+  getChunk(num_items_, num_active_threads_, thread_index, begin, end);
+  try {
+    (*task_)(begin, end, thread_index);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+  }
+}
+
+void ThreadPool::workerLoop(int thread_index)
+{
+  uint64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(
+        lock, [&]() {
+          return shutdown_ || (generation_ != last_generation);
+        });
+      if (shutdown_) {
+        return;
+      }
+      last_generation = generation_;
+      if (thread_index >= num_active_threads_) {
+        continue;
+      }
+    }
+
+    runChunk(thread_index);
+
+    bool last_chunk;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last_chunk = (--num_pending_ == 0);
+    }
+    if (last_chunk) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+} // namespace ghost_util
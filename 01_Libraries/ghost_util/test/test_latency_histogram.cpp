@@ -0,0 +1,81 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "ghost_util/latency_histogram.hpp"
+#include "gtest/gtest.h"
+
+using ghost_util::LatencyHistogram;
+
+TEST(TestLatencyHistogram, testEmpty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.getCount(), 0u);
+  EXPECT_EQ(histogram.getMax(), 0);
+  EXPECT_EQ(histogram.getMean(), 0.0);
+  EXPECT_EQ(histogram.getPercentile(50.0), 0);
+}
+
+TEST(TestLatencyHistogram, testSmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 10; i++) {
+    histogram.record(i);
+  }
+  histogram.record(-5);         // Clamped to zero
+
+  EXPECT_EQ(histogram.getCount(), 11u);
+  EXPECT_EQ(histogram.getPercentile(0.0), 0);
+  EXPECT_EQ(histogram.getPercentile(50.0), 5);
+  EXPECT_EQ(histogram.getPercentile(100.0), 10);
+  EXPECT_EQ(histogram.getMax(), 10);
+  EXPECT_DOUBLE_EQ(histogram.getMean(), 55.0 / 11.0);
+}
+
+TEST(TestLatencyHistogram, testPercentilesWithinBucketResolution) {
+  LatencyHistogram histogram;
+  for (int64_t i = 1; i <= 100000; i++) {
+    histogram.record(i);
+  }
+
+  for (double percentile : {10.0, 50.0, 90.0, 99.0, 99.9}) {
+    double expected = percentile * 1000.0;
+    auto actual = histogram.getPercentile(percentile);
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected * (1.0 + 1.0 / 16.0));
+  }
+  EXPECT_EQ(histogram.getPercentile(100.0), 100000);
+  EXPECT_EQ(histogram.getMax(), 100000);
+}
+
+TEST(TestLatencyHistogram, testOutlierAndReset) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; i++) {
+    histogram.record(1000);
+  }
+  histogram.record(int64_t(1) << 40);          // Beyond the last bucket
+
+  EXPECT_LE(histogram.getPercentile(99.0), 1000 * 17 / 16);
+  EXPECT_EQ(histogram.getPercentile(100.0), int64_t(1) << 40);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.getCount(), 0u);
+  EXPECT_EQ(histogram.getMax(), 0);
+}
@@ -0,0 +1,115 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include "ghost_util/simd_math.hpp"
+#include "gtest/gtest.h"
+
+using namespace ghost_util;
+
+namespace
+{
+
+FloatBatch makeBatch(float first, float step)
+{
+  FloatBatch batch;
+  for (int i = 0; i < SIMD_WIDTH; i++) {
+    batch[i] = first + step * i;
+  }
+  return batch;
+}
+
+} // namespace
+
+TEST(TestSimdMath, testFastLog) {
+  for (float first = 1e-6f; first < 1e6f; first *= 3.7f) {
+    FloatBatch x = makeBatch(first, first * 0.13f);
+    FloatBatch result = fastLog(x);
+    for (int i = 0; i < SIMD_WIDTH; i++) {
+      EXPECT_NEAR(result[i], std::log(x[i]), 2e-6f * (1.0f + std::abs(std::log(x[i]))));
+    }
+  }
+}
+
+TEST(TestSimdMath, testFastSqrt) {
+  FloatBatch zero = fastSqrt(FloatBatch{});
+  for (int i = 0; i < SIMD_WIDTH; i++) {
+    EXPECT_EQ(zero[i], 0.0f);
+  }
+  for (float first = 1e-6f; first < 1e6f; first *= 3.7f) {
+    FloatBatch x = makeBatch(first, first * 0.13f);
+    FloatBatch result = fastSqrt(x);
+    for (int i = 0; i < SIMD_WIDTH; i++) {
+      EXPECT_NEAR(result[i], std::sqrt(x[i]), 1e-6f * std::sqrt(x[i]));
+    }
+  }
+}
+
+TEST(TestSimdMath, testFastAtan2) {
+  for (float angle = -3.14f; angle < 3.14f; angle += 0.01f) {
+    FloatBatch radius = makeBatch(0.5f, 1.5f);
+    FloatBatch y = radius * std::sin(angle);
+    FloatBatch x = radius * std::cos(angle);
+    FloatBatch result = fastAtan2(y, x);
+    for (int i = 0; i < SIMD_WIDTH; i++) {
+      EXPECT_NEAR(result[i], std::atan2(y[i], x[i]), 1e-6f);
+    }
+  }
+}
+
+TEST(TestSimdMath, testFastSinCos) {
+  for (float first = -300.0f; first < 300.0f; first += 0.37f) {
+    FloatBatch angle = makeBatch(first, 0.05f);
+    FloatBatch s, c;
+    fastSinCos(angle, &s, &c);
+    for (int i = 0; i < SIMD_WIDTH; i++) {
+      EXPECT_NEAR(s[i], std::sin(angle[i]), 2e-6f);
+      EXPECT_NEAR(c[i], std::cos(angle[i]), 2e-6f);
+    }
+  }
+}
+
+TEST(TestSimdMath, testFastSinCosArrayTail) {
+  // Length that is not a whole number of batches, to cover the partial last batch
+  const std::size_t n = 3 * SIMD_WIDTH + 1;
+  float angles[n], s[n], c[n];
+  for (std::size_t i = 0; i < n; i++) {
+    angles[i] = 0.3f * i - 2.0f;
+  }
+  fastSinCos(angles, s, c, n);
+  for (std::size_t i = 0; i < n; i++) {
+    EXPECT_NEAR(s[i], std::sin(angles[i]), 2e-6f);
+    EXPECT_NEAR(c[i], std::cos(angles[i]), 2e-6f);
+  }
+}
+
+TEST(TestSimdMath, testSelectBatch) {
+  FloatBatch a = makeBatch(0.0f, 1.0f);
+  FloatBatch b = makeBatch(100.0f, 1.0f);
+  FloatBatch result = selectBatch(a > 1.5f, a, b);
+  for (int i = 0; i < SIMD_WIDTH; i++) {
+    EXPECT_EQ(result[i], (a[i] > 1.5f) ? a[i] : b[i]);
+  }
+}
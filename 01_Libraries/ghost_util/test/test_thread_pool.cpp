@@ -0,0 +1,118 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ghost_util/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+using ghost_util::ThreadPool;
+
+TEST(TestThreadPool, testChunksCoverRange) {
+  for (int num_items : {1, 7, 100, 101}) {
+    for (int num_threads : {1, 3, 4}) {
+      int expected_begin = 0;
+      for (int i = 0; i < num_threads; i++) {
+        int begin;
+        int end;
+        ThreadPool::getChunk(num_items, num_threads, i, begin, end);
+        EXPECT_EQ(begin, expected_begin);
+        EXPECT_GE(end, begin);
+        EXPECT_LE(end - begin, num_items / num_threads + 1);
+        expected_begin = end;
+      }
+      EXPECT_EQ(expected_begin, num_items);
+    }
+  }
+}
+
+TEST(TestThreadPool, testEveryItemVisitedOnce) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.getNumThreads(), 4);
+
+  // Reuse the pool across many loops, including ones with fewer items than threads
+  for (int num_items : {1000, 3, 1, 0, 517}) {
+    std::vector<int> visits(num_items, 0);
+    std::vector<int> owner(num_items, -1);
+    pool.parallelFor(
+      num_items, [&](int begin, int end, int thread_index) {
+        for (int i = begin; i < end; i++) {
+          visits[i]++;
+          owner[i] = thread_index;
+        }
+      });
+    for (int i = 0; i < num_items; i++) {
+      EXPECT_EQ(visits[i], 1);
+    }
+
+    // Each item goes to the thread predicted by getChunk
+    int num_active_threads = std::min(4, num_items);
+    for (int t = 0; t < num_active_threads; t++) {
+      int begin;
+      int end;
+      ThreadPool::getChunk(num_items, num_active_threads, t, begin, end);
+      for (int i = begin; i < end; i++) {
+        EXPECT_EQ(owner[i], t);
+      }
+    }
+  }
+}
+
+TEST(TestThreadPool, testSingleThreadRunsInline) {
+  ThreadPool pool(1);
+  auto caller_id = std::this_thread::get_id();
+  pool.parallelFor(
+    10, [&](int begin, int end, int thread_index) {
+      EXPECT_EQ(begin, 0);
+      EXPECT_EQ(end, 10);
+      EXPECT_EQ(thread_index, 0);
+      EXPECT_EQ(std::this_thread::get_id(), caller_id);
+    });
+}
+
+TEST(TestThreadPool, testExceptionRethrown) {
+  ThreadPool pool(3);
+  std::atomic<int> chunks_run(0);
+  EXPECT_THROW(
+    pool.parallelFor(
+      30, [&](int /*begin*/, int /*end*/, int thread_index) {
+        chunks_run++;
+        if (thread_index == 2) {
+          throw std::runtime_error("chunk failed");
+        }
+      }),
+    std::runtime_error);
+  EXPECT_EQ(chunks_run, 3);
+
+  // Pool is still usable afterwards
+  std::atomic<int> sum(0);
+  pool.parallelFor(
+    30, [&](int begin, int end, int /*thread_index*/) {
+      sum += end - begin;
+    });
+  EXPECT_EQ(sum, 30);
+}
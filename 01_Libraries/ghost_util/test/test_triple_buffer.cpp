@@ -0,0 +1,96 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include <atomic>
+#include <thread>
+
+#include "ghost_util/triple_buffer.hpp"
+#include "gtest/gtest.h"
+
+using ghost_util::TripleBuffer;
+
+TEST(TestTripleBuffer, testNoDataBeforePublish) {
+  TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.front(), 0);
+}
+
+TEST(TestTripleBuffer, testReaderSeesLatestValue) {
+  TripleBuffer<int> buffer;
+  buffer.back() = 1;
+  buffer.publish();
+  buffer.back() = 2;
+  buffer.publish();
+
+  ASSERT_TRUE(buffer.update());
+  EXPECT_EQ(buffer.front(), 2);
+
+  // Nothing new until the next publish
+  EXPECT_FALSE(buffer.update());
+  EXPECT_EQ(buffer.front(), 2);
+
+  buffer.back() = 3;
+  buffer.publish();
+  ASSERT_TRUE(buffer.update());
+  EXPECT_EQ(buffer.front(), 3);
+}
+
+TEST(TestTripleBuffer, testConcurrentValuesAreNeverTorn) {
+  // Each value is written as a pair of equal fields, so a torn read shows up as a mismatch
+  struct Pair
+  {
+    long a;
+    long b;
+  };
+  TripleBuffer<Pair> buffer;
+  const long num_values = 200000;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+      for (long i = 1; i <= num_values; i++) {
+        buffer.back().a = i;
+        buffer.back().b = i;
+        buffer.publish();
+      }
+      done = true;
+    });
+
+  long last = 0;
+  bool ok = true;
+  while (true) {
+    // Read the flag first, so the final value is still picked up after the writer finishes
+    bool finished = done;
+    if (buffer.update()) {
+      const Pair & value = buffer.front();
+      ok = ok && (value.a == value.b) && (value.a > last);
+      last = value.a;
+    } else if (finished) {
+      break;
+    }
+  }
+  writer.join();
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(last, num_values);
+}
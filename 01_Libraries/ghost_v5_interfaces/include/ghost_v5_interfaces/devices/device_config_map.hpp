@@ -44,6 +44,7 @@ public:
     for (const auto & [key, val] : device_configs_) {
       cloned_config_map_ptr->addDeviceConfig(val->clone()->as<DeviceConfig>());
     }
+    cloned_config_map_ptr->setSensorKeyframePeriod(sensor_keyframe_period_);
     return cloned_config_map_ptr;
   }
 
@@ -93,6 +94,26 @@ public:
     return device_configs_.end();
   }
 
+  /**
+   * @brief Sets how often (in msgs) a full sensor update keyframe is sent when devices use compact encoding.
+   * A period of 1 sends every sensor update as a keyframe.
+   *
+   * @param period
+   */
+  void setSensorKeyframePeriod(int period)
+  {
+    if (period < 1) {
+      throw std::runtime_error(
+              "[DeviceConfigMap::setSensorKeyframePeriod] Error: Keyframe period must be at least 1!");
+    }
+    sensor_keyframe_period_ = period;
+  }
+
+  int getSensorKeyframePeriod() const
+  {
+    return sensor_keyframe_period_;
+  }
+
   size_t size() const
   {
     return device_configs_.size();
@@ -106,6 +127,7 @@ public:
   bool operator==(const DeviceConfigMap & rhs) const
   {
     bool result = (size() == rhs.size());
+    result &= (sensor_keyframe_period_ == rhs.sensor_keyframe_period_);
     for (const auto & [key, val] : device_configs_) {
       if (rhs.contains(key)) {
         result &= ((*val) == *(rhs.getDeviceConfig(key)));
@@ -119,6 +141,7 @@ public:
 private:
   std::unordered_map<std::string, std::shared_ptr<const DeviceConfig>> device_configs_;
   std::unordered_map<int, std::string> port_to_device_name_map_;
+  int sensor_keyframe_period_ = 10;
 };
 
 } // namespace devices
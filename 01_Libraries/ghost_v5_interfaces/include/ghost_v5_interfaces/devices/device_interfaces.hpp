@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
@@ -161,23 +164,119 @@ public:
    */
   virtual bool operator==(const DeviceBase & rhs) const = 0;
 
+  /**
+   * @brief Returns the size of the packet this device writes when serializing on the given hardware.
+   *
+   * @param hardware_type
+   * @return int
+   */
+  int getOutgoingPacketSize(hardware_type_e hardware_type) const
+  {
+    return (hardware_type == hardware_type_e::COPROCESSOR) ? getActuatorPacketSize() :
+           getSensorPacketSize();
+  }
+
+  /**
+   * @brief Returns the size of the packet this device expects when deserializing on the given hardware.
+   *
+   * @param hardware_type
+   * @return int
+   */
+  int getIncomingPacketSize(hardware_type_e hardware_type) const
+  {
+    return (hardware_type == hardware_type_e::V5_BRAIN) ? getActuatorPacketSize() :
+           getSensorPacketSize();
+  }
+
+  /**
+   * @brief Writes device data directly into a msg buffer without allocating.
+   *
+   * The buffer must have at least getOutgoingPacketSize(hardware_type) bytes available.
+   *
+   * @param buffer destination for this device's packet
+   * @param hardware_type hardware the data is being serialized on
+   * @return int number of bytes written
+   */
+  virtual int serialize(unsigned char * buffer, hardware_type_e hardware_type) const = 0;
+
+  /**
+   * @brief Updates device data directly from a msg buffer without allocating.
+   *
+   * The buffer must have at least getIncomingPacketSize(hardware_type) bytes available.
+   *
+   * @param buffer start of this device's packet
+   * @param hardware_type hardware the data is being deserialized on
+   * @return int number of bytes read
+   */
+  virtual int deserialize(const unsigned char * buffer, hardware_type_e hardware_type) = 0;
+
+  /**
+   * @brief Returns the size of the sensor packet in a delta (non-key) frame.
+   * Devices without a compact encoding send their full packet in every frame.
+   *
+   * @return int
+   */
+  virtual int getSensorDeltaPacketSize() const
+  {
+    return getSensorPacketSize();
+  }
+
+  /**
+   * @brief Writes the sensor packet for a delta frame (V5 Brain only).
+   *
+   * @param buffer destination for this device's packet
+   * @return int number of bytes written
+   */
+  virtual int serializeSensorDelta(unsigned char * buffer) const
+  {
+    return serialize(buffer, hardware_type_e::V5_BRAIN);
+  }
+
+  /**
+   * @brief Reads the sensor packet of a delta frame (Coprocessor only).
+   *
+   * @param buffer start of this device's packet
+   * @return int number of bytes read
+   */
+  virtual int deserializeSensorDelta(const unsigned char * buffer)
+  {
+    return deserialize(buffer, hardware_type_e::COPROCESSOR);
+  }
+
+  /**
+   * @brief Returns true if the current data cannot be represented in a delta frame.
+   * Forces the next sensor update to be a keyframe.
+   */
+  virtual bool requiresSensorKeyframe() const
+  {
+    return false;
+  }
+
   /**
    * @brief Converts device data to byte stream.
    *
-   * @param to_v5	set to true when the data is going from coprocessor -> V5 Brain
+   * @param hardware_type hardware the data is being serialized on
    * @return std::vector<unsigned char> byte stream
    */
-  virtual std::vector<unsigned char> serialize(hardware_type_e hardware_type) const = 0;
+  std::vector<unsigned char> serialize(hardware_type_e hardware_type) const
+  {
+    std::vector<unsigned char> msg(getOutgoingPacketSize(hardware_type), 0);
+    int byte_offset = serialize(msg.data(), hardware_type);
+    checkMsgSize(byte_offset, msg.size());
+    return msg;
+  }
 
   /**
    * @brief Updates device data from byte stream.
    *
    * @param data byte stream as unsigned char vector
-   * @param from_coprocessor set to true when the data is going from coprocesspr -> V5 Brain
+   * @param hardware_type hardware the data is being deserialized on
    */
-  virtual void deserialize(
-    const std::vector<unsigned char> & data,
-    hardware_type_e hardware_type)  = 0;
+  void deserialize(const std::vector<unsigned char> & data, hardware_type_e hardware_type)
+  {
+    checkMsgSize(data, getIncomingPacketSize(hardware_type));
+    deserialize(data.data(), hardware_type);
+  }
 
   /**
    * @brief Validates serial msg size
@@ -185,7 +284,7 @@ public:
    * @param data serialized data buffer
    * @param msg_size	expected msg size
    */
-  void checkMsgSize(std::vector<unsigned char> data, int msg_size) const
+  void checkMsgSize(const std::vector<unsigned char> & data, int msg_size) const
   {
     if (data.size() != msg_size) {
       throw std::runtime_error(
@@ -204,6 +303,48 @@ public:
                 expected_size) + " bytes, received " + std::to_string(true_size) + " bytes.");
     }
   }
+
+protected:
+  /**
+   * @brief Writes value as a 16-bit fixed point number with the given resolution, saturating at the int16 limits.
+   *
+   * @param buffer msg buffer
+   * @param byte_offset incremented by the number of bytes written
+   * @param value
+   * @param scale value of one least significant bit
+   */
+  static void writeFixedPoint16(
+    unsigned char * buffer, int & byte_offset, float value,
+    float scale)
+  {
+    float scaled = std::round(value / scale);
+    int16_t fixed_point = 0;
+    if (scaled >= INT16_MAX) {
+      fixed_point = INT16_MAX;
+    } else if (scaled <= -INT16_MAX) {
+      fixed_point = -INT16_MAX;
+    } else if (!std::isnan(scaled)) {
+      fixed_point = (int16_t) scaled;
+    }
+    memcpy(buffer + byte_offset, &fixed_point, 2);
+    byte_offset += 2;
+  }
+
+  /**
+   * @brief Reads a 16-bit fixed point number written by writeFixedPoint16.
+   *
+   * @param buffer msg buffer
+   * @param byte_offset incremented by the number of bytes read
+   * @param scale value of one least significant bit
+   * @return float
+   */
+  static float readFixedPoint16(const unsigned char * buffer, int & byte_offset, float scale)
+  {
+    int16_t fixed_point;
+    memcpy(&fixed_point, buffer + byte_offset, 2);
+    byte_offset += 2;
+    return fixed_point * scale;
+  }
 };
 
 struct DevicePair
@@ -116,15 +116,13 @@ public:
            (heading == d_rhs->heading);
   }
 
-  std::vector<unsigned char> serialize(hardware_type_e hardware_type) const override
+  using DeviceData::serialize;
+  using DeviceData::deserialize;
+
+  int serialize(unsigned char * msg_buffer, hardware_type_e hardware_type) const override
   {
-    std::vector<unsigned char> msg;
     int byte_offset = 0;
-    if ((hardware_type == hardware_type_e::V5_BRAIN)) {
-      msg.resize(getSensorPacketSize(), 0);
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
-
+    if (hardware_type == hardware_type_e::V5_BRAIN) {
       if (serial_config_.send_accel_data) {
         memcpy(msg_buffer + byte_offset, &x_accel, 4);
         byte_offset += 4;
@@ -148,26 +146,13 @@ public:
         byte_offset += 4;
       }
     }
-
-    int msg_size =
-      (hardware_type ==
-      hardware_type_e::V5_BRAIN) ? getSensorPacketSize() : getActuatorPacketSize();
-    checkMsgSize(msg, msg_size);
-    return msg;
+    return byte_offset;
   }
 
-  void deserialize(const std::vector<unsigned char> & msg, hardware_type_e hardware_type) override
+  int deserialize(const unsigned char * msg_buffer, hardware_type_e hardware_type) override
   {
-    int msg_size =
-      (hardware_type ==
-      hardware_type_e::V5_BRAIN) ? getActuatorPacketSize() : getSensorPacketSize();
-    checkMsgSize(msg, msg_size);
-
+    int byte_offset = 0;
     if (hardware_type == hardware_type_e::COPROCESSOR) {
-      checkMsgSize(msg, getSensorPacketSize());
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
-
       if (serial_config_.send_accel_data) {
         memcpy(&x_accel, msg_buffer + byte_offset, 4);
         byte_offset += 4;
@@ -191,6 +176,7 @@ public:
         byte_offset += 4;
       }
     }
+    return byte_offset;
   }
 };
 
@@ -113,13 +113,13 @@ public:
            (btn_d == d_rhs->btn_d);
   }
 
-  std::vector<unsigned char> serialize(hardware_type_e hardware_type) const override
+  using DeviceData::serialize;
+  using DeviceData::deserialize;
+
+  int serialize(unsigned char * msg_data, hardware_type_e hardware_type) const override
   {
-    std::vector<unsigned char> msg;
     int byte_offset = 0;
     if ((hardware_type == hardware_type_e::V5_BRAIN)) {
-      msg.resize(getSensorPacketSize(), 0);
-      auto msg_data = msg.data();
       memcpy(msg_data + byte_offset, &left_x, 4);
       byte_offset += 4;
       memcpy(msg_data + byte_offset, &left_y, 4);
@@ -129,36 +129,19 @@ public:
       memcpy(msg_data + byte_offset, &right_y, 4);
       byte_offset += 4;
 
-      auto byte_pack_1 = packByte(
-        std::vector<bool>{
-            btn_a, btn_b, btn_x, btn_y, btn_u, btn_l, btn_r, btn_d
-          });
-      memcpy(msg_data + byte_offset, &byte_pack_1, 1);
+      const bool byte_pack_1[8] = {btn_a, btn_b, btn_x, btn_y, btn_u, btn_l, btn_r, btn_d};
+      msg_data[byte_offset] = packByte(byte_pack_1);
       byte_offset += 1;
 
-      auto byte_pack_2 = packByte(
-        std::vector<bool>{
-            btn_r1, btn_r2, btn_l1, btn_l2, 0, 0, 0, 0
-          });
-      memcpy(msg_data + byte_offset, &byte_pack_2, 1);
+      const bool byte_pack_2[8] = {btn_r1, btn_r2, btn_l1, btn_l2, 0, 0, 0, 0};
+      msg_data[byte_offset] = packByte(byte_pack_2);
       byte_offset += 1;
     }
-
-    int msg_size =
-      (hardware_type ==
-      hardware_type_e::V5_BRAIN) ? getSensorPacketSize() : getActuatorPacketSize();
-    checkMsgSize(msg, msg_size);
-    return msg;
+    return byte_offset;
   }
 
-  void deserialize(const std::vector<unsigned char> & msg, hardware_type_e hardware_type) override
+  int deserialize(const unsigned char * msg_data, hardware_type_e hardware_type) override
   {
-    int msg_size =
-      (hardware_type ==
-      hardware_type_e::V5_BRAIN) ? getActuatorPacketSize() : getSensorPacketSize();
-    checkMsgSize(msg, msg_size);
-
-    auto msg_data = msg.data();
     int byte_offset = 0;
     if (hardware_type == hardware_type_e::COPROCESSOR) {
       memcpy(&left_x, msg_data + byte_offset, 4);
@@ -170,15 +153,12 @@ public:
       memcpy(&right_y, msg_data + byte_offset, 4);
       byte_offset += 4;
 
-      unsigned char byte_pack_1, byte_pack_2;
-      memcpy(&byte_pack_1, msg_data + byte_offset, 1);
+      bool byte_vector_1[8], byte_vector_2[8];
+      unpackByte(msg_data[byte_offset], byte_vector_1);
       byte_offset += 1;
-      memcpy(&byte_pack_2, msg_data + byte_offset, 1);
+      unpackByte(msg_data[byte_offset], byte_vector_2);
       byte_offset += 1;
 
-      auto byte_vector_1 = unpackByte(byte_pack_1);
-      auto byte_vector_2 = unpackByte(byte_pack_2);
-
       btn_a = byte_vector_1[0];
       btn_b = byte_vector_1[1];
       btn_x = byte_vector_1[2];
@@ -192,6 +172,7 @@ public:
       btn_l1 = byte_vector_2[2];
       btn_l2 = byte_vector_2[3];
     }
+    return byte_offset;
   }
 };
 
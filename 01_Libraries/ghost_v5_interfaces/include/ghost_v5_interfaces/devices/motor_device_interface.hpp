@@ -84,7 +84,15 @@ public:
              (send_voltage_data == rhs.send_voltage_data) &&
              (send_current_data == rhs.send_current_data) &&
              (send_power_data == rhs.send_power_data) &&
-             (send_temp_data == rhs.send_temp_data);
+             (send_temp_data == rhs.send_temp_data) &&
+             (use_compact_sensor_encoding == rhs.use_compact_sensor_encoding) &&
+             (position_scale == rhs.position_scale) &&
+             (velocity_scale == rhs.velocity_scale) &&
+             (torque_scale == rhs.torque_scale) &&
+             (voltage_scale == rhs.voltage_scale) &&
+             (current_scale == rhs.current_scale) &&
+             (power_scale == rhs.power_scale) &&
+             (temp_scale == rhs.temp_scale);
     }
 
     // Actuation Msg Config
@@ -99,6 +107,18 @@ public:
     bool send_current_data = false;
     bool send_power_data = false;
     bool send_temp_data = false;
+
+    // Compact Sensor Update Encoding
+    // Sends sensor data as 16-bit fixed point with the resolutions below. Position is sent in full on
+    // keyframes and as a delta from the last keyframe otherwise. Power and temperature are only sent on keyframes.
+    bool use_compact_sensor_encoding = false;
+    float position_scale = 0.1;         // Encoder units per LSB
+    float velocity_scale = 0.1;         // RPM per LSB
+    float torque_scale = 0.001;         // N - m per LSB
+    float voltage_scale = 1.0;          // MilliVolts per LSB
+    float current_scale = 1.0;          // MilliAmps per LSB
+    float power_scale = 0.01;           // Watts per LSB
+    float temp_scale = 0.1;             // Celsius per LSB
   };
 
   MotorDeviceData(std::string name, SerialConfig serial_config = SerialConfig())
@@ -122,6 +142,9 @@ public:
 
   int getSensorPacketSize() const override
   {
+    if (serial_config_.use_compact_sensor_encoding) {
+      return getCompactSensorPacketSize(true);
+    }
     int packet_size = 0;
     packet_size += 4 + 4;             // Position/Velocity
     packet_size += 4 * ((int) serial_config_.send_torque_data);
@@ -132,6 +155,14 @@ public:
     return packet_size;
   }
 
+  int getSensorDeltaPacketSize() const override
+  {
+    if (serial_config_.use_compact_sensor_encoding) {
+      return getCompactSensorPacketSize(false);
+    }
+    return getSensorPacketSize();
+  }
+
   // Actuator Values
   float position_command = 0.0;         // Degrees
   float velocity_command = 0.0;         // RPM
@@ -199,14 +230,13 @@ public:
            (serial_config_ == d_rhs->serial_config_);
   }
 
-  std::vector<unsigned char> serialize(hardware_type_e hardware_type) const override
+  using DeviceData::serialize;
+  using DeviceData::deserialize;
+
+  int serialize(unsigned char * msg_buffer, hardware_type_e hardware_type) const override
   {
-    std::vector<unsigned char> msg;
+    int byte_offset = 0;
     if (hardware_type == hardware_type_e::COPROCESSOR) {
-      msg.resize(getActuatorPacketSize(), 0);
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
-
       memcpy(msg_buffer + byte_offset, &current_limit, 4);
       byte_offset += 4;
 
@@ -227,24 +257,22 @@ public:
         byte_offset += 4;
       }
 
-      unsigned char ctrl_byte = packByte(
-        std::vector<bool>{
-            position_control && serial_config_.send_position_command,
-            velocity_control && serial_config_.send_velocity_command,
-            voltage_control && serial_config_.send_voltage_command,
-            torque_control && serial_config_.send_torque_command,
-            0,
-            0,
-            0,
-            0});
-
-      memcpy(msg_buffer + byte_offset, &ctrl_byte, 1);
+      const bool ctrl_bits[8] = {
+        position_control && serial_config_.send_position_command,
+        velocity_control && serial_config_.send_velocity_command,
+        voltage_control && serial_config_.send_voltage_command,
+        torque_control && serial_config_.send_torque_command,
+        0,
+        0,
+        0,
+        0};
+      msg_buffer[byte_offset] = packByte(ctrl_bits);
       byte_offset++;
       checkMsgSize(byte_offset, getActuatorPacketSize());
     } else if (hardware_type == hardware_type_e::V5_BRAIN) {
-      msg.resize(getSensorPacketSize(), 0);
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
+      if (serial_config_.use_compact_sensor_encoding) {
+        return serializeCompactSensorData(msg_buffer, true);
+      }
 
       memcpy(msg_buffer + byte_offset, &curr_position, 4);
       byte_offset += 4;
@@ -275,19 +303,17 @@ public:
       checkMsgSize(byte_offset, getSensorPacketSize());
     } else {
       throw std::runtime_error(
-              "[MotorDeviceData::deserialize] Error: Received unsupported hardware type " + std::to_string(
+              "[MotorDeviceData::serialize] Error: Received unsupported hardware type " + std::to_string(
                 hardware_type) + " on motor " + name);
     }
-    return msg;
+    return byte_offset;
   }
 
-  void deserialize(const std::vector<unsigned char> & msg, hardware_type_e hardware_type) override
+  int deserialize(const unsigned char * msg_buffer, hardware_type_e hardware_type) override
   {
+    int byte_offset = 0;
     if (hardware_type == hardware_type_e::V5_BRAIN) {
       // Actuator Msg
-      checkMsgSize(msg, getActuatorPacketSize());
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
       memcpy(&current_limit, msg_buffer + byte_offset, 4);
       byte_offset += 4;
 
@@ -308,20 +334,20 @@ public:
         byte_offset += 4;
       }
 
-      unsigned char ctrl_byte;
-      memcpy(&ctrl_byte, msg_buffer + byte_offset, 1);
-
-      auto ctrl_vec = unpackByte(ctrl_byte);
+      bool ctrl_bits[8];
+      unpackByte(msg_buffer[byte_offset], ctrl_bits);
+      byte_offset++;
 
-      position_control = ctrl_vec[0] && serial_config_.send_position_command;
-      velocity_control = ctrl_vec[1] && serial_config_.send_velocity_command;
-      voltage_control = ctrl_vec[2] && serial_config_.send_voltage_command;
-      torque_control = ctrl_vec[3] && serial_config_.send_torque_command;
+      position_control = ctrl_bits[0] && serial_config_.send_position_command;
+      velocity_control = ctrl_bits[1] && serial_config_.send_velocity_command;
+      voltage_control = ctrl_bits[2] && serial_config_.send_voltage_command;
+      torque_control = ctrl_bits[3] && serial_config_.send_torque_command;
     } else if (hardware_type == hardware_type_e::COPROCESSOR) {
       // Sensor Msg
-      checkMsgSize(msg, getSensorPacketSize());
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
+      if (serial_config_.use_compact_sensor_encoding) {
+        return deserializeCompactSensorData(msg_buffer, true);
+      }
+
       memcpy(&curr_position, msg_buffer + byte_offset, 4);
       byte_offset += 4;
       memcpy(&curr_velocity_rpm, msg_buffer + byte_offset, 4);
@@ -352,9 +378,126 @@ public:
               "[MotorDeviceData::deserialize] Error: Received unsupported hardware type " + std::to_string(
                 hardware_type) + " on motor " + name);
     }
+    return byte_offset;
+  }
+
+  int serializeSensorDelta(unsigned char * msg_buffer) const override
+  {
+    if (serial_config_.use_compact_sensor_encoding) {
+      return serializeCompactSensorData(msg_buffer, false);
+    }
+    return serialize(msg_buffer, hardware_type_e::V5_BRAIN);
+  }
+
+  int deserializeSensorDelta(const unsigned char * msg_buffer) override
+  {
+    if (serial_config_.use_compact_sensor_encoding) {
+      return deserializeCompactSensorData(msg_buffer, false);
+    }
+    return deserialize(msg_buffer, hardware_type_e::COPROCESSOR);
+  }
+
+  bool requiresSensorKeyframe() const override
+  {
+    if (!serial_config_.use_compact_sensor_encoding) {
+      return false;
+    }
+    // Position delta must fit in the fixed point range
+    return !has_position_reference_ ||
+           (std::fabs(curr_position - position_reference_) >=
+           INT16_MAX * serial_config_.position_scale);
   }
 
   SerialConfig serial_config_;
+
+private:
+  int getCompactSensorPacketSize(bool keyframe) const
+  {
+    int packet_size = 0;
+    packet_size += (keyframe) ? 4 : 2;      // Position (full on keyframes, delta otherwise)
+    packet_size += 2;                       // Velocity
+    packet_size += 2 * ((int) serial_config_.send_torque_data);
+    packet_size += 2 * ((int) serial_config_.send_voltage_data);
+    packet_size += 2 * ((int) serial_config_.send_current_data);
+    if (keyframe) {
+      packet_size += 2 * ((int) serial_config_.send_power_data);
+      packet_size += 2 * ((int) serial_config_.send_temp_data);
+    }
+    return packet_size;
+  }
+
+  int serializeCompactSensorData(unsigned char * msg_buffer, bool keyframe) const
+  {
+    int byte_offset = 0;
+    if (keyframe) {
+      memcpy(msg_buffer + byte_offset, &curr_position, 4);
+      byte_offset += 4;
+      position_reference_ = curr_position;
+      has_position_reference_ = true;
+    } else {
+      writeFixedPoint16(
+        msg_buffer, byte_offset, curr_position - position_reference_,
+        serial_config_.position_scale);
+    }
+    writeFixedPoint16(msg_buffer, byte_offset, curr_velocity_rpm, serial_config_.velocity_scale);
+
+    if (serial_config_.send_torque_data) {
+      writeFixedPoint16(msg_buffer, byte_offset, curr_torque_nm, serial_config_.torque_scale);
+    }
+    if (serial_config_.send_voltage_data) {
+      writeFixedPoint16(msg_buffer, byte_offset, curr_voltage_mv, serial_config_.voltage_scale);
+    }
+    if (serial_config_.send_current_data) {
+      writeFixedPoint16(msg_buffer, byte_offset, curr_current_ma, serial_config_.current_scale);
+    }
+
+    // Slow changing values are decimated to keyframes
+    if (keyframe && serial_config_.send_power_data) {
+      writeFixedPoint16(msg_buffer, byte_offset, curr_power_w, serial_config_.power_scale);
+    }
+    if (keyframe && serial_config_.send_temp_data) {
+      writeFixedPoint16(msg_buffer, byte_offset, curr_temp_c, serial_config_.temp_scale);
+    }
+
+    checkMsgSize(byte_offset, getCompactSensorPacketSize(keyframe));
+    return byte_offset;
+  }
+
+  int deserializeCompactSensorData(const unsigned char * msg_buffer, bool keyframe)
+  {
+    int byte_offset = 0;
+    if (keyframe) {
+      memcpy(&curr_position, msg_buffer + byte_offset, 4);
+      byte_offset += 4;
+      position_reference_ = curr_position;
+      has_position_reference_ = true;
+    } else {
+      curr_position = position_reference_ +
+        readFixedPoint16(msg_buffer, byte_offset, serial_config_.position_scale);
+    }
+    curr_velocity_rpm = readFixedPoint16(msg_buffer, byte_offset, serial_config_.velocity_scale);
+
+    if (serial_config_.send_torque_data) {
+      curr_torque_nm = readFixedPoint16(msg_buffer, byte_offset, serial_config_.torque_scale);
+    }
+    if (serial_config_.send_voltage_data) {
+      curr_voltage_mv = readFixedPoint16(msg_buffer, byte_offset, serial_config_.voltage_scale);
+    }
+    if (serial_config_.send_current_data) {
+      curr_current_ma = readFixedPoint16(msg_buffer, byte_offset, serial_config_.current_scale);
+    }
+    if (keyframe && serial_config_.send_power_data) {
+      curr_power_w = readFixedPoint16(msg_buffer, byte_offset, serial_config_.power_scale);
+    }
+    if (keyframe && serial_config_.send_temp_data) {
+      curr_temp_c = readFixedPoint16(msg_buffer, byte_offset, serial_config_.temp_scale);
+    }
+    return byte_offset;
+  }
+
+  // Last keyframe position, used as the base for position deltas on both ends of the link.
+  mutable float position_reference_ = 0.0;
+  mutable bool has_position_reference_ = false;
 };
 
 class MotorDeviceConfig : public DeviceConfig
@@ -106,14 +106,13 @@ public:
            (serial_config_ == d_rhs->serial_config_);
   }
 
-  std::vector<unsigned char> serialize(hardware_type_e hardware_type) const override
+  using DeviceData::serialize;
+  using DeviceData::deserialize;
+
+  int serialize(unsigned char * msg_buffer, hardware_type_e hardware_type) const override
   {
-    std::vector<unsigned char> msg;
+    int byte_offset = 0;
     if (hardware_type == hardware_type_e::V5_BRAIN) {
-      msg.resize(getSensorPacketSize(), 0);
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
-
       if (serial_config_.send_angle_data) {
         memcpy(msg_buffer + byte_offset, &angle, 4);
         byte_offset += 4;
@@ -128,16 +127,14 @@ public:
       }
       checkMsgSize(byte_offset, getSensorPacketSize());
     }
-    return msg;
+    return byte_offset;
   }
 
-  void deserialize(const std::vector<unsigned char> & msg, hardware_type_e hardware_type) override
+  int deserialize(const unsigned char * msg_buffer, hardware_type_e hardware_type) override
   {
+    int byte_offset = 0;
     if (hardware_type == hardware_type_e::COPROCESSOR) {
       // Sensor Msg
-      checkMsgSize(msg, getSensorPacketSize());
-      auto msg_buffer = msg.data();
-      int byte_offset = 0;
       if (serial_config_.send_angle_data) {
         memcpy(&angle, msg_buffer + byte_offset, 4);
         byte_offset += 4;
@@ -151,6 +148,7 @@ public:
         byte_offset += 4;
       }
     }
+    return byte_offset;
   }
 
   SerialConfig serial_config_;
@@ -50,6 +50,25 @@ namespace ghost_v5_interfaces
 class RobotHardwareInterface
 {
 public:
+  /**
+   * @brief Location of a single device's packet within a serial msg.
+   * Computed once at construction so that serialization only copies fields into place.
+   */
+  struct SerialPlanEntry
+  {
+    int port;
+    int offset;
+    int length;
+    devices::device_type_e type;
+    devices::DeviceData * data_ptr;
+  };
+
+  // Sensor updates lead with the competition status byte, the msg id, and the echoed actuator msg id
+  static constexpr int SENSOR_UPDATE_HEADER_LENGTH = 3;
+
+  // Actuator commands lead with the digital IO byte and the msg id
+  static constexpr int ACTUATOR_COMMAND_HEADER_LENGTH = 2;
+
   RobotHardwareInterface(
     std::shared_ptr<devices::DeviceConfigMap> robot_config_ptr,
     devices::hardware_type_e hardware_type);
@@ -337,7 +356,9 @@ public:
   }
 
   /**
-   * @brief Set Msg ID of most recent update
+   * @brief Set Msg ID of most recent update. The V5 Brain numbers each sensor update, and the
+   * coprocessor tags each actuator command with the ID of the sensor update it responds to. Only the
+   * low byte is sent over serial.
    *
    * @param msg_id
    */
@@ -346,8 +367,27 @@ public:
     msg_id_ = msg_id;
   }
 
+  /**
+   * @brief Returns the Msg ID of the latest actuator command received by the V5 Brain. The V5 echoes it
+   * back in every sensor update so the coprocessor can measure round trip latency.
+   *
+   * This is link metadata and is not compared by isDataEqual.
+   *
+   * @return int
+   */
+  int getEchoedMsgID() const
+  {
+    return echoed_msg_id_;
+  }
+
+  void setEchoedMsgID(int echoed_msg_id)
+  {
+    echoed_msg_id_ = echoed_msg_id;
+  }
+
   /**
    * @brief Returns the length of the sensor update byte stream given the current robot configuration.
+   * This is the length of a keyframe, which is the longest sensor update msg.
    *
    * @return int
    */
@@ -356,6 +396,25 @@ public:
     return sensor_update_msg_length_;
   }
 
+  /**
+   * @brief Returns the length of a sensor update delta frame. Equal to getSensorUpdateMsgLength()
+   * unless a device uses compact sensor encoding.
+   *
+   * @return int
+   */
+  int getSensorUpdateDeltaMsgLength() const
+  {
+    return sensor_update_delta_msg_length_;
+  }
+
+  /**
+   * @brief Returns true if the sensor update stream alternates between keyframes and delta frames.
+   */
+  bool usesSensorDeltaFrames() const
+  {
+    return use_sensor_delta_frames_;
+  }
+
   /**
    * @brief Returns the length of the actuator command byte stream given the current robot configuration.
    *
@@ -366,6 +425,38 @@ public:
     return actuator_command_msg_length_;
   }
 
+  /**
+   * @brief Returns the precomputed layout of the sensor update msg (ordered by port).
+   * Devices which contribute no bytes to the msg are omitted.
+   *
+   * @return const std::vector<SerialPlanEntry>&
+   */
+  const std::vector<SerialPlanEntry> & getSensorUpdatePlan() const
+  {
+    return sensor_update_plan_;
+  }
+
+  /**
+   * @brief Returns the precomputed layout of a sensor update delta frame (ordered by port).
+   *
+   * @return const std::vector<SerialPlanEntry>&
+   */
+  const std::vector<SerialPlanEntry> & getSensorUpdateDeltaPlan() const
+  {
+    return sensor_update_delta_plan_;
+  }
+
+  /**
+   * @brief Returns the precomputed layout of the actuator command msg (ordered by port).
+   * Devices which contribute no bytes to the msg are omitted.
+   *
+   * @return const std::vector<SerialPlanEntry>&
+   */
+  const std::vector<SerialPlanEntry> & getActuatorCommandPlan() const
+  {
+    return actuator_command_plan_;
+  }
+
   /**
    * @brief Converts all device data into a single byte stream.
    *
@@ -375,6 +466,21 @@ public:
    */
   std::vector<unsigned char> serialize() const;
 
+  /**
+   * @brief Writes all device data into a caller-provided buffer without allocating.
+   * This is the preferred interface in the control loop.
+   *
+   * On the V5 Brain this decides whether the sensor update is a keyframe or a delta frame,
+   * so the number of bytes written may be less than getSensorUpdateMsgLength().
+   *
+   * Throws a runtime error if the buffer is smaller than the expected msg length.
+   *
+   * @param buffer destination buffer
+   * @param buffer_len number of bytes available in buffer
+   * @return int number of bytes written
+   */
+  int serialize(unsigned char * buffer, int buffer_len) const;
+
   /**
    * @brief Updates all device date from a single byte stream.
    *
@@ -387,7 +493,25 @@ public:
    */
   int deserialize(const std::vector<unsigned char> & msg);
 
+  /**
+   * @brief Updates all device data directly from a msg buffer without allocating.
+   *
+   * Sensor update delta frames which reference a keyframe that was never received are dropped
+   * and leave all data unchanged.
+   *
+   * Throws a runtime error if msg_len does not match the expected msg length.
+   *
+   * @param msg
+   * @param msg_len
+   * @return int number of bytes processed (zero if the msg was dropped)
+   */
+  int deserialize(const unsigned char * msg, int msg_len);
+
 private:
+  void buildSerialPlans();
+  int getOutgoingMsgLength() const;
+  int getIncomingMsgLength() const;
+  void checkPlanEntrySize(const SerialPlanEntry & entry, int num_bytes) const;
   void setDeviceDataNoLock(std::shared_ptr<devices::DeviceData> device_data);
   void throwOnNonexistentDevice(const std::string & device_name) const;
   devices::hardware_type_e hardware_type_;
@@ -402,9 +526,18 @@ private:
 
   // Serialization
   int msg_id_ = 0;
+  int echoed_msg_id_ = 0;
   int sensor_update_msg_length_;
+  int sensor_update_delta_msg_length_;
   int actuator_command_msg_length_;
 
+  // Sensor Update Keyframes
+  bool use_sensor_delta_frames_ = false;
+  int sensor_keyframe_period_;
+  mutable int frames_since_keyframe_ = 0;
+  mutable int keyframe_seq_ = 0;
+  int last_received_keyframe_seq_ = -1;
+
   // Update Lock
   mutable CROSSPLATFORM_MUTEX_T update_mutex_;
 
@@ -414,6 +547,11 @@ private:
   std::vector<std::string> device_names_ordered_by_port_;
   std::map<int, std::string> port_to_device_name_map_;
   std::shared_ptr<devices::DeviceConfigMap> robot_config_ptr_;
+
+  // Serialization Plans
+  std::vector<SerialPlanEntry> sensor_update_plan_;
+  std::vector<SerialPlanEntry> sensor_update_delta_plan_;
+  std::vector<SerialPlanEntry> actuator_command_plan_;
 };
 
 } // namespace ghost_v5_interfaces
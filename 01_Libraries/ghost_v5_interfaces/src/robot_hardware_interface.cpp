@@ -37,7 +37,9 @@ RobotHardwareInterface::RobotHardwareInterface(
   hardware_type_(hardware_type)
 {
   sensor_update_msg_length_ = 0;
+  sensor_update_delta_msg_length_ = 0;
   actuator_command_msg_length_ = 0;
+  sensor_keyframe_period_ = robot_config_ptr_->getSensorKeyframePeriod();
 
   for (const auto & [key, val] : *robot_config_ptr_) {
     DevicePair pair;
@@ -69,6 +71,7 @@ RobotHardwareInterface::RobotHardwareInterface(
 
     // Update msg lengths based on each device
     sensor_update_msg_length_ += pair.data_ptr->getSensorPacketSize();
+    sensor_update_delta_msg_length_ += pair.data_ptr->getSensorDeltaPacketSize();
     actuator_command_msg_length_ += pair.data_ptr->getActuatorPacketSize();
   }
 
@@ -76,111 +79,223 @@ RobotHardwareInterface::RobotHardwareInterface(
     device_names_ordered_by_port_.emplace_back(val);
   }
 
-  // Add Digital IO to actuator command msg
-  actuator_command_msg_length_ += 1;
+  // Add Digital IO and msg id to actuator command msg
+  actuator_command_msg_length_ += ACTUATOR_COMMAND_HEADER_LENGTH;
   digital_io_ = std::vector<bool>(8, false);
 
-  // Add Competition State to sensor update msg
-  sensor_update_msg_length_ += 1;
+  // Add Competition State and msg ids to sensor update msg
+  sensor_update_msg_length_ += SENSOR_UPDATE_HEADER_LENGTH;
+  sensor_update_delta_msg_length_ += SENSOR_UPDATE_HEADER_LENGTH;
+
+  // Delta frames are only worthwhile if a device has a compact encoding
+  use_sensor_delta_frames_ = (sensor_update_delta_msg_length_ != sensor_update_msg_length_) &&
+    (sensor_keyframe_period_ > 1);
+
+  buildSerialPlans();
+}
+
+void RobotHardwareInterface::buildSerialPlans()
+{
+  // Device packets follow the msg header
+  int sensor_offset = SENSOR_UPDATE_HEADER_LENGTH;
+  int sensor_delta_offset = SENSOR_UPDATE_HEADER_LENGTH;
+  int actuator_offset = ACTUATOR_COMMAND_HEADER_LENGTH;
+
+  for (const auto & [port, pair] : device_pair_port_map_) {
+    int sensor_len = pair.data_ptr->getSensorPacketSize();
+    if (sensor_len > 0) {
+      sensor_update_plan_.push_back(
+        SerialPlanEntry{port, sensor_offset, sensor_len, pair.config_ptr->type,
+          pair.data_ptr.get()});
+      sensor_offset += sensor_len;
+    }
+
+    int sensor_delta_len = pair.data_ptr->getSensorDeltaPacketSize();
+    if (sensor_delta_len > 0) {
+      sensor_update_delta_plan_.push_back(
+        SerialPlanEntry{port, sensor_delta_offset, sensor_delta_len, pair.config_ptr->type,
+          pair.data_ptr.get()});
+      sensor_delta_offset += sensor_delta_len;
+    }
+
+    int actuator_len = pair.data_ptr->getActuatorPacketSize();
+    if (actuator_len > 0) {
+      actuator_command_plan_.push_back(
+        SerialPlanEntry{port, actuator_offset, actuator_len, pair.config_ptr->type,
+          pair.data_ptr.get()});
+      actuator_offset += actuator_len;
+    }
+  }
+
+  if ((sensor_offset != sensor_update_msg_length_) ||
+    (sensor_delta_offset != sensor_update_delta_msg_length_) ||
+    (actuator_offset != actuator_command_msg_length_))
+  {
+    throw std::runtime_error(
+            "[RobotHardwareInterface::buildSerialPlans] Error: Serialization plan does not match msg lengths!");
+  }
+}
+
+int RobotHardwareInterface::getOutgoingMsgLength() const
+{
+  return (hardware_type_ == hardware_type_e::V5_BRAIN) ? sensor_update_msg_length_ :
+         actuator_command_msg_length_;
+}
+
+int RobotHardwareInterface::getIncomingMsgLength() const
+{
+  return (hardware_type_ == hardware_type_e::V5_BRAIN) ? actuator_command_msg_length_ :
+         sensor_update_msg_length_;
 }
 
 std::vector<unsigned char> RobotHardwareInterface::serialize() const
 {
-  std::vector<unsigned char> serial_data;
+  std::vector<unsigned char> serial_data(getOutgoingMsgLength(), 0);
+  int msg_len = serialize(serial_data.data(), serial_data.size());
+  serial_data.resize(msg_len);
+  return serial_data;
+}
+
+int RobotHardwareInterface::serialize(unsigned char * buffer, int buffer_len) const
+{
+  int expected_size = getOutgoingMsgLength();
+  if (buffer_len < expected_size) {
+    throw std::runtime_error(
+            "[RobotHardwareInterface::serialize] Error: Buffer is too small for serial msg! Expected: " +
+            std::to_string(expected_size) + " Actual: " + std::to_string(buffer_len));
+  }
+
   std::unique_lock<CROSSPLATFORM_MUTEX_T> update_lock(update_mutex_);
 
-  // Only send competition state and joystick info from V5 Brain to Coprocessor
-  if (hardware_type_ == hardware_type_e::V5_BRAIN) {
-    serial_data.push_back(
-      packByte(
-        std::vector<bool>{
-        is_disabled_, is_autonomous_, is_connected_, 0, 0, 0, 0, 0
-      }));
-  } else if (hardware_type_ == hardware_type_e::COPROCESSOR) {
+  if (hardware_type_ == hardware_type_e::COPROCESSOR) {
     // Send state of all Digital IO Ports
-    serial_data.push_back(packByte(digital_io_));
+    buffer[0] = packByte(digital_io_);
+    buffer[1] = (unsigned char) msg_id_;
+    for (const auto & entry : actuator_command_plan_) {
+      int bytes_written = entry.data_ptr->serialize(buffer + entry.offset, hardware_type_);
+      checkPlanEntrySize(entry, bytes_written);
+    }
+    return expected_size;
   }
 
-  for (const auto & [key, val] : device_pair_port_map_) {
-    auto device_serial_msg = val.data_ptr->serialize(hardware_type_);
-    serial_data.insert(serial_data.end(), device_serial_msg.begin(), device_serial_msg.end());
+  // Only send competition state and joystick info from V5 Brain to Coprocessor
+  bool keyframe = true;
+  if (use_sensor_delta_frames_) {
+    keyframe = (frames_since_keyframe_ + 1 >= sensor_keyframe_period_);
+    for (const auto & entry : sensor_update_delta_plan_) {
+      keyframe = keyframe || entry.data_ptr->requiresSensorKeyframe();
+    }
   }
 
-  // Error Checking
-  int expected_size = 0;
-  if (hardware_type_ == hardware_type_e::V5_BRAIN) {
-    expected_size = sensor_update_msg_length_;
-  } else if (hardware_type_ == hardware_type_e::COPROCESSOR) {
-    expected_size = actuator_command_msg_length_;
+  if (keyframe) {
+    frames_since_keyframe_ = 0;
+    keyframe_seq_ = (keyframe_seq_ + 1) & 0x0F;
+  } else {
+    frames_since_keyframe_++;
   }
 
-  if (serial_data.size() != expected_size) {
-    throw std::runtime_error(
-            "[RobotHardwareInterface::serialize()] Error: Serial Msg Length does not "
-            "match data from Robot Hardware Interface! Expected: " + std::to_string(expected_size) +
-            " Actual: " + std::to_string(serial_data.size()));
+  // Delta frames carry the sequence number of the keyframe they are relative to
+  const bool status_bits[8] = {
+    is_disabled_, is_autonomous_, is_connected_, keyframe,
+    (bool)(keyframe_seq_ & 0x08), (bool)(keyframe_seq_ & 0x04),
+    (bool)(keyframe_seq_ & 0x02), (bool)(keyframe_seq_ & 0x01)};
+  buffer[0] = packByte(status_bits);
+  buffer[1] = (unsigned char) msg_id_;
+  buffer[2] = (unsigned char) echoed_msg_id_;
+
+  if (keyframe) {
+    for (const auto & entry : sensor_update_plan_) {
+      int bytes_written = entry.data_ptr->serialize(buffer + entry.offset, hardware_type_);
+      checkPlanEntrySize(entry, bytes_written);
+    }
+    return sensor_update_msg_length_;
   }
 
-  return serial_data;
+  for (const auto & entry : sensor_update_delta_plan_) {
+    int bytes_written = entry.data_ptr->serializeSensorDelta(buffer + entry.offset);
+    checkPlanEntrySize(entry, bytes_written);
+  }
+  return sensor_update_delta_msg_length_;
 }
 
 int RobotHardwareInterface::deserialize(const std::vector<unsigned char> & msg)
+{
+  return deserialize(msg.data(), msg.size());
+}
+
+int RobotHardwareInterface::deserialize(const unsigned char * msg, int msg_len)
 {
   // Error Checking
-  int expected_size = 0;
+  int expected_size = getIncomingMsgLength();
+  bool status_bits[8] = {false};
+  if (msg_len > 0) {
+    unpackByte(msg[0], status_bits);
+  }
 
-  if (hardware_type_ == hardware_type_e::V5_BRAIN) {
-    expected_size = actuator_command_msg_length_;
-  } else if (hardware_type_ == hardware_type_e::COPROCESSOR) {
-    expected_size = sensor_update_msg_length_;
+  bool keyframe = true;
+  int keyframe_seq = 0;
+  if ((hardware_type_ == hardware_type_e::COPROCESSOR) && use_sensor_delta_frames_) {
+    keyframe = status_bits[3];
+    keyframe_seq = (status_bits[4] << 3) | (status_bits[5] << 2) | (status_bits[6] << 1) |
+      status_bits[7];
+    if (!keyframe) {
+      expected_size = sensor_update_delta_msg_length_;
+    }
   }
 
-  if (msg.size() != expected_size) {
+  if (msg_len != expected_size) {
     throw std::runtime_error(
             "[RobotHardwareInterface::deserialize] Error: Serial Msg Length does not "
             "match data from Robot Hardware Interface! Expected: " + std::to_string(expected_size) +
-            " Actual: " + std::to_string(msg.size()));
+            " Actual: " + std::to_string(msg_len));
   }
 
-  // Deserialize
-  int byte_offset = 0;
   std::unique_lock<CROSSPLATFORM_MUTEX_T> update_lock(update_mutex_);
 
   if (hardware_type_ == hardware_type_e::V5_BRAIN) {
     // Unpack Digital IO
-    digital_io_ = unpackByte(msg[byte_offset]);
-    byte_offset++;
+    digital_io_.assign(status_bits, status_bits + 8);
+    echoed_msg_id_ = msg[1];
+    for (const auto & entry : actuator_command_plan_) {
+      entry.data_ptr->deserialize(msg + entry.offset, hardware_type_);
+    }
+    return expected_size;
   }
 
-  if (hardware_type_ == hardware_type_e::COPROCESSOR) {
-    // Unpack competition state
-    auto packet_start_byte = unpackByte(msg[byte_offset]);
-    is_disabled_ = packet_start_byte[0];
-    is_autonomous_ = packet_start_byte[1];
-    is_connected_ = packet_start_byte[2];
-    byte_offset++;
+  // A delta is meaningless without the keyframe it was computed against
+  if (!keyframe && (keyframe_seq != last_received_keyframe_seq_)) {
+    return 0;
   }
 
+  // Unpack competition state
+  is_disabled_ = status_bits[0];
+  is_autonomous_ = status_bits[1];
+  is_connected_ = status_bits[2];
+  msg_id_ = msg[1];
+  echoed_msg_id_ = msg[2];
+
   // Unpack each device in device tree
-  for (const auto & [key, val] : device_pair_port_map_) {
-    int msg_len;
-    if (hardware_type_ == hardware_type_e::COPROCESSOR) {
-      msg_len = val.data_ptr->getSensorPacketSize();
-    } else if (hardware_type_ == hardware_type_e::V5_BRAIN) {
-      msg_len = val.data_ptr->getActuatorPacketSize();
-    } else {
-      throw std::runtime_error(
-              "[RobotHardwareInterface::deserialize] Error: Attempted to deserialize with unsupported hardware type.");
+  if (keyframe) {
+    last_received_keyframe_seq_ = keyframe_seq;
+    for (const auto & entry : sensor_update_plan_) {
+      entry.data_ptr->deserialize(msg + entry.offset, hardware_type_);
+    }
+  } else {
+    for (const auto & entry : sensor_update_delta_plan_) {
+      entry.data_ptr->deserializeSensorDelta(msg + entry.offset);
     }
+  }
+  return expected_size;
+}
 
-    auto start_itr = msg.begin() + byte_offset;
-    val.data_ptr->deserialize(
-      std::vector<unsigned char>(
-        start_itr,
-        start_itr + msg_len), hardware_type_);
-    byte_offset += msg_len;
+void RobotHardwareInterface::checkPlanEntrySize(const SerialPlanEntry & entry, int num_bytes) const
+{
+  if (num_bytes != entry.length) {
+    throw std::runtime_error(
+            "[RobotHardwareInterface::serialize] Error: Serial Msg Length does not "
+            "match data from Robot Hardware Interface! Expected: " + std::to_string(entry.length) +
+            " Actual: " + std::to_string(num_bytes) + " on port " + std::to_string(entry.port));
   }
-  return byte_offset;
 }
 
 bool RobotHardwareInterface::isDataEqual(const RobotHardwareInterface & rhs) const
@@ -33,7 +33,10 @@
 
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <unordered_map>
 
 using ghost_util::loadYAMLParam;
@@ -45,12 +48,35 @@ namespace ghost_v5_interfaces
 namespace util
 {
 
+namespace
+{
+
+// std::to_string keeps six decimal places, which changes small scales like 1/4096. Writing
+// max_digits10 significant digits makes the generated float parse back to the exact same value.
+std::string floatToCodeString(float value)
+{
+  std::ostringstream stream;
+  stream << std::showpoint << std::setprecision(std::numeric_limits<float>::max_digits10) <<
+    value << "f";
+  return stream.str();
+}
+
+} // namespace
+
 std::shared_ptr<DeviceConfigMap> loadRobotConfigFromYAML(YAML::Node node, bool verbose)
 {
   auto device_config_map_ptr = std::make_shared<DeviceConfigMap>();
   bool use_partner_joystick = false;
   loadYAMLParam(node["port_configuration"], "use_partner_joystick", use_partner_joystick, false);
 
+  int sensor_keyframe_period = device_config_map_ptr->getSensorKeyframePeriod();
+  if (loadYAMLParam(
+      node["port_configuration"], "sensor_keyframe_period", sensor_keyframe_period,
+      verbose))
+  {
+    device_config_map_ptr->setSensorKeyframePeriod(sensor_keyframe_period);
+  }
+
   // Load primary joystick
   auto joy_master = std::make_shared<JoystickDeviceConfig>();
   joy_master->name = MAIN_JOYSTICK_NAME;
@@ -231,6 +257,8 @@ void generateCodeFromRobotConfig(
     "extern \"C\" ghost_v5_interfaces::devices::DeviceConfigMap* getRobotConfig(void) {\n";
   output_file <<
     "\tghost_v5_interfaces::devices::DeviceConfigMap* robot_config = new ghost_v5_interfaces::devices::DeviceConfigMap;\n";
+  output_file << "\trobot_config->setSensorKeyframePeriod(" +
+    std::to_string(config_ptr->getSensorKeyframePeriod()) + ");\n";
   output_file << "\n";
 
   // Generate code from DeviceConfigMap
@@ -313,6 +341,30 @@ void generateCodeFromRobotConfig(
         config_ptr->serial_config.send_power_data) + ";\n";
       output_file << "\t" + motor_name + "->" + "serial_config.send_temp_data = " + std::to_string(
         config_ptr->serial_config.send_temp_data) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.use_compact_sensor_encoding = " + std::to_string(
+        config_ptr->serial_config.use_compact_sensor_encoding) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.position_scale = " + floatToCodeString(
+        config_ptr->serial_config.position_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.velocity_scale = " + floatToCodeString(
+        config_ptr->serial_config.velocity_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.torque_scale = " + floatToCodeString(
+        config_ptr->serial_config.torque_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.voltage_scale = " + floatToCodeString(
+        config_ptr->serial_config.voltage_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.current_scale = " + floatToCodeString(
+        config_ptr->serial_config.current_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.power_scale = " + floatToCodeString(
+        config_ptr->serial_config.power_scale) + ";\n";
+      output_file <<
+        "\t" + motor_name + "->" + "serial_config.temp_scale = " + floatToCodeString(
+        config_ptr->serial_config.temp_scale) + ";\n";
       output_file << "\trobot_config->addDeviceConfig(" + motor_name + ");\n";
       output_file << "\n";
     } else if (val->type == device_type_e::ROTATION_SENSOR) {
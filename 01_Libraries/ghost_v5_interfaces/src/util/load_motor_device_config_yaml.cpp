@@ -77,6 +77,16 @@ MotorDeviceData::SerialConfig loadMotorSerialConfigFromYAML(YAML::Node node, boo
   loadYAMLParam(node, "send_current_data", config.send_current_data, verbose);
   loadYAMLParam(node, "send_power_data", config.send_power_data, verbose);
   loadYAMLParam(node, "send_temp_data", config.send_temp_data, verbose);
+  loadYAMLParam(
+    node, "use_compact_sensor_encoding", config.use_compact_sensor_encoding,
+    verbose);
+  loadYAMLParam(node, "position_scale", config.position_scale, verbose);
+  loadYAMLParam(node, "velocity_scale", config.velocity_scale, verbose);
+  loadYAMLParam(node, "torque_scale", config.torque_scale, verbose);
+  loadYAMLParam(node, "voltage_scale", config.voltage_scale, verbose);
+  loadYAMLParam(node, "current_scale", config.current_scale, verbose);
+  loadYAMLParam(node, "power_scale", config.power_scale, verbose);
+  loadYAMLParam(node, "temp_scale", config.temp_scale, verbose);
   return config;
 }
 
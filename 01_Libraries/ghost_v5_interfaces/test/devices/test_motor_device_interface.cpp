@@ -32,6 +32,7 @@ using ghost_v5_interfaces::devices::MotorDeviceConfig;
 using ghost_v5_interfaces::devices::MotorDeviceData;
 using ghost_v5_interfaces::test_util::getRandomMotorData;
 using ghost_v5_interfaces::test_util::getRandomMotorSerialConfig;
+using ghost_util::getRandomFloat;
 
 const int NUM_TESTS = 50;
 TEST(TestMotorDeviceInterface, testSerializationV5ToCoprocessor) {
@@ -70,3 +71,109 @@ TEST(TestMotorDeviceInterface, testSerialMsgLengths) {
     EXPECT_EQ(m2->serialize(hardware_type_e::V5_BRAIN).size(), m1->getSensorPacketSize());
   }
 }
+
+MotorDeviceData::SerialConfig getRandomCompactMotorSerialConfig()
+{
+  auto serial_config = getRandomMotorSerialConfig();
+  serial_config.use_compact_sensor_encoding = true;
+  return serial_config;
+}
+
+void setRandomCompactSensorData(std::shared_ptr<MotorDeviceData> motor, float position)
+{
+  motor->curr_position = position;
+  motor->curr_velocity_rpm = getRandomFloat(3000.0);
+  motor->curr_torque_nm = getRandomFloat(30.0);
+  motor->curr_voltage_mv = getRandomFloat(12000.0);
+  motor->curr_current_ma = getRandomFloat(2500.0);
+  motor->curr_power_w = getRandomFloat(300.0);
+  motor->curr_temp_c = getRandomFloat(100.0);
+}
+
+void expectCompactFastDataNear(
+  std::shared_ptr<MotorDeviceData> expected,
+  std::shared_ptr<MotorDeviceData> actual)
+{
+  const auto & config = expected->serial_config_;
+  EXPECT_NEAR(expected->curr_velocity_rpm, actual->curr_velocity_rpm, config.velocity_scale);
+  if (config.send_torque_data) {
+    EXPECT_NEAR(expected->curr_torque_nm, actual->curr_torque_nm, config.torque_scale);
+  }
+  if (config.send_voltage_data) {
+    EXPECT_NEAR(expected->curr_voltage_mv, actual->curr_voltage_mv, config.voltage_scale);
+  }
+  if (config.send_current_data) {
+    EXPECT_NEAR(expected->curr_current_ma, actual->curr_current_ma, config.current_scale);
+  }
+}
+
+TEST(TestMotorDeviceInterface, testCompactSerialMsgLengths) {
+  for (int i = 0; i < NUM_TESTS; i++) {
+    auto serial_config = getRandomCompactMotorSerialConfig();
+    auto motor = getRandomMotorData(false, serial_config);
+
+    std::vector<unsigned char> buffer(motor->getSensorPacketSize());
+    EXPECT_EQ(motor->serialize(hardware_type_e::V5_BRAIN).size(), motor->getSensorPacketSize());
+    EXPECT_EQ(motor->serializeSensorDelta(buffer.data()), motor->getSensorDeltaPacketSize());
+    EXPECT_LT(motor->getSensorDeltaPacketSize(), motor->getSensorPacketSize());
+
+    // Compact keyframes are never larger than the full float encoding
+    serial_config.use_compact_sensor_encoding = false;
+    MotorDeviceData full_motor("test", serial_config);
+    EXPECT_LT(motor->getSensorPacketSize(), full_motor.getSensorPacketSize());
+    EXPECT_EQ(full_motor.getSensorDeltaPacketSize(), full_motor.getSensorPacketSize());
+  }
+}
+
+TEST(TestMotorDeviceInterface, testCompactSerializationKeyframeAndDelta) {
+  for (int i = 0; i < NUM_TESTS; i++) {
+    auto serial_config = getRandomCompactMotorSerialConfig();
+    auto sender = std::make_shared<MotorDeviceData>("test", serial_config);
+    auto receiver = std::make_shared<MotorDeviceData>("test", serial_config);
+
+    // Keyframe sends position exactly and quantizes everything else
+    setRandomCompactSensorData(sender, getRandomFloat(100000.0));
+    EXPECT_TRUE(sender->requiresSensorKeyframe());
+    receiver->deserialize(sender->serialize(hardware_type_e::V5_BRAIN), hardware_type_e::COPROCESSOR);
+    EXPECT_FALSE(sender->requiresSensorKeyframe());
+
+    EXPECT_EQ(sender->curr_position, receiver->curr_position);
+    expectCompactFastDataNear(sender, receiver);
+    if (serial_config.send_power_data) {
+      EXPECT_NEAR(sender->curr_power_w, receiver->curr_power_w, serial_config.power_scale);
+    }
+    if (serial_config.send_temp_data) {
+      EXPECT_NEAR(sender->curr_temp_c, receiver->curr_temp_c, serial_config.temp_scale);
+    }
+    float keyframe_power = receiver->curr_power_w;
+    float keyframe_temp = receiver->curr_temp_c;
+
+    // Deltas are relative to the keyframe and leave slow data untouched
+    std::vector<unsigned char> buffer(sender->getSensorDeltaPacketSize());
+    for (int j = 0; j < 5; j++) {
+      setRandomCompactSensorData(sender, sender->curr_position + getRandomFloat(3000.0));
+      if (sender->requiresSensorKeyframe()) {
+        break;
+      }
+      EXPECT_EQ(sender->serializeSensorDelta(buffer.data()), buffer.size());
+      EXPECT_EQ(receiver->deserializeSensorDelta(buffer.data()), buffer.size());
+
+      EXPECT_NEAR(sender->curr_position, receiver->curr_position, serial_config.position_scale);
+      expectCompactFastDataNear(sender, receiver);
+      EXPECT_EQ(keyframe_power, receiver->curr_power_w);
+      EXPECT_EQ(keyframe_temp, receiver->curr_temp_c);
+    }
+  }
+}
+
+TEST(TestMotorDeviceInterface, testCompactRequiresKeyframeOnLargeDelta) {
+  auto serial_config = getRandomCompactMotorSerialConfig();
+  serial_config.position_scale = 0.1;
+  MotorDeviceData motor("test", serial_config);
+  motor.serialize(hardware_type_e::V5_BRAIN);
+
+  motor.curr_position = 3000.0;
+  EXPECT_FALSE(motor.requiresSensorKeyframe());
+  motor.curr_position = -4000.0;
+  EXPECT_TRUE(motor.requiresSensorKeyframe());
+}
@@ -33,6 +33,7 @@
 #include "yaml-cpp/yaml.h"
 
 #include <algorithm>
+#include <limits>
 
 using ghost_v5_interfaces::util::loadRobotConfigFromYAML;
 using namespace ghost_util;
@@ -382,6 +383,153 @@ TEST_F(RobotHardwareInterfaceTestFixture, testSerializationPipelineV5ToCoprocess
   EXPECT_TRUE(hw_interface.isDataEqual(hw_interface_copy));
 }
 
+TEST_F(RobotHardwareInterfaceTestFixture, testSerialPlanIsContiguousAndOrderedByPort) {
+  RobotHardwareInterface hw_interface(device_config_map_ptr_dual_joy_, hardware_type_e::V5_BRAIN);
+
+  auto check_plan = [](const std::vector<RobotHardwareInterface::SerialPlanEntry> & plan,
+      int header_len, int msg_len) {
+      int offset = header_len;
+      int last_port = std::numeric_limits<int>::min();
+      for (const auto & entry : plan) {
+        EXPECT_EQ(entry.offset, offset);
+        EXPECT_GT(entry.length, 0);
+        EXPECT_GT(entry.port, last_port);
+        EXPECT_EQ(entry.type, entry.data_ptr->type);
+        offset += entry.length;
+        last_port = entry.port;
+      }
+      EXPECT_EQ(offset, msg_len);
+    };
+
+  check_plan(
+    hw_interface.getSensorUpdatePlan(), RobotHardwareInterface::SENSOR_UPDATE_HEADER_LENGTH,
+    hw_interface.getSensorUpdateMsgLength());
+  check_plan(
+    hw_interface.getActuatorCommandPlan(), RobotHardwareInterface::ACTUATOR_COMMAND_HEADER_LENGTH,
+    hw_interface.getActuatorCommandMsgLength());
+}
+
+TEST_F(RobotHardwareInterfaceTestFixture, testBufferSerializationMatchesVectorSerialization) {
+  RobotHardwareInterface hw_interface(device_config_map_ptr_dual_joy_, hardware_type_e::V5_BRAIN);
+
+  for (const auto & name : hw_interface) {
+    auto type = hw_interface.getDevicePair(name).config_ptr->type;
+    std::shared_ptr<DeviceData> data_ptr;
+    if (type == device_type_e::MOTOR) {
+      data_ptr = getRandomMotorData(false);
+    } else if (type == device_type_e::ROTATION_SENSOR) {
+      data_ptr = getRandomRotationSensorData();
+    } else if (type == device_type_e::INERTIAL_SENSOR) {
+      data_ptr = getRandomInertialSensorData();
+    } else if (type == device_type_e::JOYSTICK) {
+      data_ptr = getRandomJoystickData();
+    }
+    data_ptr->name = name;
+    hw_interface.setDeviceData(data_ptr);
+  }
+  hw_interface.setDisabledStatus(getRandomBool());
+  hw_interface.setAutonomousStatus(getRandomBool());
+  hw_interface.setConnectedStatus(getRandomBool());
+
+  // Caller-provided buffers may be larger than the msg
+  int msg_len = hw_interface.getSensorUpdateMsgLength();
+  std::vector<unsigned char> buffer(msg_len + 16, 0xAA);
+  EXPECT_EQ(hw_interface.serialize(buffer.data(), buffer.size()), msg_len);
+
+  // Status byte also carries a keyframe counter, so only competition state is compared
+  auto serial_data = hw_interface.serialize();
+  ASSERT_EQ(serial_data.size(), msg_len);
+  EXPECT_EQ(serial_data[0] & 0xE0, buffer[0] & 0xE0);
+  EXPECT_TRUE(std::equal(serial_data.begin() + 1, serial_data.end(), buffer.begin() + 1));
+  EXPECT_EQ(buffer[msg_len], 0xAA);
+
+  RobotHardwareInterface hw_interface_copy(device_config_map_ptr_dual_joy_,
+    hardware_type_e::COPROCESSOR);
+  EXPECT_EQ(hw_interface_copy.deserialize(buffer.data(), msg_len), msg_len);
+  EXPECT_TRUE(hw_interface.isDataEqual(hw_interface_copy));
+}
+
+TEST_F(RobotHardwareInterfaceTestFixture, testMsgIDsRoundTrip) {
+  RobotHardwareInterface v5_interface(device_config_map_ptr_dual_joy_, hardware_type_e::V5_BRAIN);
+  RobotHardwareInterface coprocessor_interface(device_config_map_ptr_dual_joy_,
+    hardware_type_e::COPROCESSOR);
+
+  // Sensor update 300 (sent as its low byte) reaches the coprocessor
+  v5_interface.setMsgID(300);
+  coprocessor_interface.deserialize(v5_interface.serialize());
+  EXPECT_EQ(coprocessor_interface.getMsgID(), 300 & 0xFF);
+  EXPECT_EQ(coprocessor_interface.getEchoedMsgID(), 0);
+
+  // Actuator command responding to it is echoed back by the V5 in its next sensor update
+  v5_interface.deserialize(coprocessor_interface.serialize());
+  EXPECT_EQ(v5_interface.getEchoedMsgID(), 300 & 0xFF);
+  EXPECT_EQ(v5_interface.getMsgID(), 300);
+
+  v5_interface.setMsgID(301);
+  coprocessor_interface.deserialize(v5_interface.serialize());
+  EXPECT_EQ(coprocessor_interface.getMsgID(), 301 & 0xFF);
+  EXPECT_EQ(coprocessor_interface.getEchoedMsgID(), 300 & 0xFF);
+}
+
+TEST_F(RobotHardwareInterfaceTestFixture, testBufferSerializationThrowsOnBadLength) {
+  RobotHardwareInterface hw_interface(device_config_map_ptr_dual_joy_,
+    hardware_type_e::COPROCESSOR);
+  int msg_len = hw_interface.getActuatorCommandMsgLength();
+  std::vector<unsigned char> buffer(msg_len + 1, 0);
+
+  EXPECT_THROW(hw_interface.serialize(buffer.data(), msg_len - 1), std::runtime_error);
+  EXPECT_NO_THROW(hw_interface.serialize(buffer.data(), msg_len));
+
+  // Coprocessor receives sensor updates, which are a different length
+  EXPECT_THROW(hw_interface.deserialize(buffer.data(), msg_len), std::runtime_error);
+  EXPECT_THROW(
+    hw_interface.deserialize(buffer.data(), hw_interface.getSensorUpdateMsgLength() + 1),
+    std::runtime_error);
+}
+
+TEST_F(RobotHardwareInterfaceTestFixture, testCompactSensorUpdateKeyframesAndDeltas) {
+  // Make every motor use compact encoding with a keyframe every fourth msg
+  auto config_map_ptr = std::make_shared<DeviceConfigMap>();
+  for (const auto & [name, config] : *device_config_map_ptr_single_joy_) {
+    auto config_copy = config->clone()->as<DeviceConfig>();
+    if (config_copy->type == device_type_e::MOTOR) {
+      auto motor_config = config_copy->as<MotorDeviceConfig>();
+      motor_config->serial_config.use_compact_sensor_encoding = true;
+    }
+    config_map_ptr->addDeviceConfig(config_copy);
+  }
+  config_map_ptr->setSensorKeyframePeriod(4);
+
+  RobotHardwareInterface v5_interface(config_map_ptr, hardware_type_e::V5_BRAIN);
+  RobotHardwareInterface coprocessor_interface(config_map_ptr, hardware_type_e::COPROCESSOR);
+  ASSERT_TRUE(v5_interface.usesSensorDeltaFrames());
+  EXPECT_LT(v5_interface.getSensorUpdateDeltaMsgLength(), v5_interface.getSensorUpdateMsgLength());
+
+  std::vector<unsigned char> buffer(v5_interface.getSensorUpdateMsgLength());
+  for (int i = 0; i < 8; i++) {
+    auto motor_data = v5_interface.getDeviceData<MotorDeviceData>("left_drive_motor");
+    motor_data->curr_position = 10.0 * i;
+    v5_interface.setDeviceData(motor_data);
+    int msg_len = v5_interface.serialize(buffer.data(), buffer.size());
+
+    // First msg and every fourth msg after are keyframes
+    bool keyframe = (i % 4 == 0);
+    EXPECT_EQ(
+      msg_len,
+      (keyframe) ? v5_interface.getSensorUpdateMsgLength() :
+      v5_interface.getSensorUpdateDeltaMsgLength());
+
+    // Drop the second keyframe, so its deltas can't be applied
+    if (i == 4) {
+      continue;
+    }
+    int expected_len = (i > 4) ? 0 : msg_len;
+    EXPECT_EQ(coprocessor_interface.deserialize(buffer.data(), msg_len), expected_len);
+    float expected_position = (i > 4) ? 30.0 : 10.0 * i;
+    EXPECT_NEAR(coprocessor_interface.getMotorPosition("left_drive_motor"), expected_position, 0.1);
+  }
+}
+
 TEST_F(RobotHardwareInterfaceTestFixture, testMotorStateGetters) {
   RobotHardwareInterface hw_interface(device_config_map_ptr_dual_joy_,
     hardware_type_e::COPROCESSOR);
@@ -22,6 +22,8 @@
  */
 
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <dlfcn.h>
 
 #include <ghost_util/test_util.hpp>
@@ -247,3 +249,47 @@ TEST_F(DeviceConfigMapTestFixture, testGenerateCodeFromRobotConfig) {
   std::shared_ptr<DeviceConfigMap> test_config_map(func());
   EXPECT_EQ(*robot_config_ptr, *test_config_map);
 }
+
+/**
+ * @brief Test that the compact encoding scales in generated code parse back to exactly the values
+ * loaded from YAML, so the V5 and the coprocessor quantize sensor data with the same scale.
+ */
+TEST_F(DeviceConfigMapTestFixture, testGenerateCodeKeepsCompactEncodingScales) {
+  auto example_robot_config = YAML::LoadFile(
+    std::string(
+      getenv(
+        "VEXU_HOME")) + "/01_Libraries/ghost_v5_interfaces/test/config/example_robot.yaml");
+  const std::vector<std::string> scale_names{
+    "position_scale", "velocity_scale", "torque_scale", "voltage_scale", "current_scale",
+    "power_scale", "temp_scale"};
+  auto serial_node =
+    example_robot_config["port_configuration"]["device_configurations"]["test_motor_config"]
+    ["serial"];
+  serial_node["use_compact_sensor_encoding"] = true;
+  for (std::size_t i = 0; i < scale_names.size(); i++) {
+    serial_node[scale_names[i]] = 1.0 / (4096.0 + 1000.0 * i);
+  }
+  serial_node["temp_scale"] = 1.0;  // Whole numbers still need a decimal point in the literal
+  auto robot_config_ptr = loadRobotConfigFromYAML(example_robot_config);
+  auto motor_config_ptr =
+    robot_config_ptr->getDeviceConfig("test_motor")->as<const MotorDeviceConfig>();
+  const std::vector<float> loaded_scales{
+    motor_config_ptr->serial_config.position_scale, motor_config_ptr->serial_config.velocity_scale,
+    motor_config_ptr->serial_config.torque_scale, motor_config_ptr->serial_config.voltage_scale,
+    motor_config_ptr->serial_config.current_scale, motor_config_ptr->serial_config.power_scale,
+    motor_config_ptr->serial_config.temp_scale};
+
+  std::string code_path = "/tmp/testGenerateCodeKeepsCompactEncodingScales.cpp";
+  generateCodeFromRobotConfig(robot_config_ptr, code_path);
+
+  std::ifstream code_file(code_path);
+  std::stringstream code;
+  code << code_file.rdbuf();
+  for (std::size_t i = 0; i < scale_names.size(); i++) {
+    std::string prefix = "test_motor->serial_config." + scale_names[i] + " = ";
+    auto start = code.str().find(prefix);
+    ASSERT_NE(start, std::string::npos) << scale_names[i];
+    EXPECT_EQ(std::stof(code.str().substr(start + prefix.size())), loaded_scales[i]) <<
+      scale_names[i];
+  }
+}
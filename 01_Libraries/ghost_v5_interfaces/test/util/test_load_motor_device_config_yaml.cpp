@@ -146,6 +146,9 @@ TEST_F(TestLoadMotorDeviceConfigYAML, testLoadMotorSerialConfig) {
   test_serial_config.send_current_data = true;
   test_serial_config.send_power_data = false;
   test_serial_config.send_temp_data = true;
+  test_serial_config.use_compact_sensor_encoding = true;
+  test_serial_config.position_scale = 0.5;
+  test_serial_config.temp_scale = 1.0;
 
   MotorDeviceData::SerialConfig loaded_serial_config;
   EXPECT_NO_THROW(
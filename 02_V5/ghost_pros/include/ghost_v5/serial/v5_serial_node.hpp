@@ -52,6 +52,7 @@ private:
 	// Serial Interface
 	std::unique_ptr<ghost_serial::V5SerialBase> serial_base_interface_;
 	std::vector<unsigned char> new_msg_;
+	std::vector<unsigned char> sensor_update_msg_;
 	int actuator_command_msg_len_;
 	int sensor_update_msg_len_;
 
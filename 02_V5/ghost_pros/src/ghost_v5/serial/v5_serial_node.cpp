@@ -43,7 +43,9 @@ using namespace ghost_v5_interfaces;
 
 namespace ghost_v5 {
 
-V5SerialNode::V5SerialNode(std::shared_ptr<RobotHardwareInterface> robot_hardware_interface_ptr){
+V5SerialNode::V5SerialNode(std::shared_ptr<RobotHardwareInterface> robot_hardware_interface_ptr) :
+	read_msg_id_(0),
+	write_msg_id_(0){
 	// Set Hardware Interface
 	hardware_interface_ptr_ = robot_hardware_interface_ptr;
 
@@ -53,6 +55,7 @@ V5SerialNode::V5SerialNode(std::shared_ptr<RobotHardwareInterface> robot_hardwar
 
 	// Array to store latest incoming msg
 	new_msg_ = std::vector<unsigned char>(actuator_command_msg_len_, 0);
+	sensor_update_msg_ = std::vector<unsigned char>(sensor_update_msg_len_, 0);
 
 	// Construct Serial Interface
 	serial_base_interface_ = std::make_unique<ghost_serial::V5SerialBase>(
@@ -82,7 +85,7 @@ bool V5SerialNode::readV5ActuatorUpdate(){
 }
 
 void V5SerialNode::updateActuatorCommands(std::vector<unsigned char>& buffer){
-	hardware_interface_ptr_->deserialize(buffer);
+	hardware_interface_ptr_->deserialize(buffer.data(), buffer.size());
 
 	v5_globals::digital_out_cmds = hardware_interface_ptr_->getDigitalIO();
 
@@ -235,7 +238,12 @@ void V5SerialNode::writeV5StateUpdate(){
 		hardware_interface_ptr_->setDeviceData(inertial_sensor_data_ptr);
 	}
 
-	serial_base_interface_->writeMsgToSerial(hardware_interface_ptr_->serialize().data(), sensor_update_msg_len_);
+	// Number each update so the coprocessor can detect drops. Its actuator commands carry this id back,
+	// and the RHI echoes the latest one in the next update for round trip timing.
+	hardware_interface_ptr_->setMsgID(write_msg_id_++);
+
+	int msg_len = hardware_interface_ptr_->serialize(sensor_update_msg_.data(), sensor_update_msg_len_);
+	serial_base_interface_->writeMsgToSerial(sensor_update_msg_.data(), msg_len);
 }
 
 } // namespace ghost_v5
\ No newline at end of file
@@ -18,6 +18,8 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <inttypes.h>
 #include <math.h>
@@ -43,17 +45,57 @@
 #include "nav_msgs/msg/odometry.hpp"
 #include "sensor_msgs/msg/joint_state.hpp"
 #include "sensor_msgs/msg/laser_scan.hpp"
+#include "std_msgs/msg/empty.hpp"
+#include "std_msgs/msg/int32.hpp"
 #include "tf2_msgs/msg/tf_message.hpp"
 #include "visualization_msgs/msg/marker.hpp"
 #include "visualization_msgs/msg/marker_array.hpp"
 
 #include "yaml-cpp/yaml.h"
 
+#include "ghost_estimation/particle_filter/odometry_history.hpp"
 #include "ghost_estimation/particle_filter/particle_filter.hpp"
+#include "ghost_estimation/vector_map/vector_map.hpp"
+#include "ghost_util/triple_buffer.hpp"
 
 namespace ghost_localization
 {
 
+/**
+ * @brief Filter estimate handed from the filter callbacks to the output timers, carried forward
+ * to the odometry stamp it is valid at.
+ */
+struct PoseSnapshot
+{
+  rclcpp::Time stamp;
+  Eigen::Vector2f loc = Eigen::Vector2f::Zero();
+  float angle = 0.0;
+  std::array<double, 36> covariance{};
+};
+
+/**
+ * @brief Everything the visualization timer draws, copied out of the filter on request.
+ */
+struct VisualizationSnapshot
+{
+  Eigen::Vector2f loc = Eigen::Vector2f::Zero();
+  float angle = 0.0;
+  std::vector<particle_filter::Particle> particles;
+  sensor_msgs::msg::LaserScan::SharedPtr laser_msg;
+};
+
+/**
+ * @brief Runs the particle filter on odometry and laser callbacks, and publishes its output from
+ * fixed-rate timers in a separate callback group.
+ *
+ * Filter callbacks only update the filter and hand a snapshot of the result to the output stage,
+ * so message serialization and visualization never delay the next scan. Spin with a
+ * MultiThreadedExecutor so both callback groups can run at once.
+ *
+ * Scans are applied at their own timestamp, with the filter predicted up to that point from a
+ * short odometry history. The published pose is the filter estimate carried forward by the
+ * odometry received since, so scan processing delay does not show up as pose lag.
+ */
 class EkfPfNode : public rclcpp::Node
 {
 public:
@@ -62,10 +104,19 @@ public:
 private:
   void LoadROSParams();
 
+  // Callback Groups
+  rclcpp::CallbackGroup::SharedPtr filter_callback_group_;
+  rclcpp::CallbackGroup::SharedPtr output_callback_group_;
+
+  // Timers
+  rclcpp::TimerBase::SharedPtr pose_timer_;
+  rclcpp::TimerBase::SharedPtr visualization_timer_;
+
   // Subscribers
   rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr ekf_odom_sub_;
   rclcpp::Subscription<sensor_msgs::msg::LaserScan>::SharedPtr laser_sub_;
   rclcpp::Subscription<geometry_msgs::msg::PoseWithCovarianceStamped>::SharedPtr set_pose_sub_;
+  rclcpp::Subscription<std_msgs::msg::Empty>::SharedPtr global_localization_sub_;
 
   // Publishers
   rclcpp::Publisher<geometry_msgs::msg::PoseArray>::SharedPtr cloud_viz_pub_;
@@ -73,34 +124,67 @@ private:
   rclcpp::Publisher<visualization_msgs::msg::MarkerArray>::SharedPtr debug_viz_pub_;
   rclcpp::Publisher<tf2_msgs::msg::TFMessage>::SharedPtr world_tf_pub_;
   rclcpp::Publisher<geometry_msgs::msg::PoseWithCovarianceStamped>::SharedPtr robot_pose_pub_;
+  rclcpp::Publisher<std_msgs::msg::Int32>::SharedPtr particle_count_pub_;
 
   // Callback functions
   void EkfCallback(const nav_msgs::msg::Odometry::SharedPtr msg);
   void LaserCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg);
   void InitialPoseCallback(const geometry_msgs::msg::PoseWithCovarianceStamped::SharedPtr msg);
+  void GlobalLocalizationCallback(const std_msgs::msg::Empty::SharedPtr msg);
+
+  // Filter thread side of the output stage
+  void UpdateFilterEstimate();
+  void PublishFilterState();
+
+  // Output timers
+  void PoseTimerCallback();
+  void VisualizationTimerCallback();
 
   // Visualizations
-  void DrawParticles(geometry_msgs::msg::PoseArray & cloud_msg);
-  void PublishVisualization();
-  void PublishWorldTransform();
-  void DrawPredictedScan(visualization_msgs::msg::MarkerArray & viz_msg);
+  void DrawParticles(
+    const VisualizationSnapshot & snapshot,
+    geometry_msgs::msg::PoseArray & cloud_msg);
+  void PublishWorldTransform(const PoseSnapshot & snapshot);
+  void DrawPredictedScan(
+    const VisualizationSnapshot & snapshot,
+    visualization_msgs::msg::MarkerArray & viz_msg);
   void PublishMapViz();
-  void PublishRobotPose();
+  void PublishRobotPose(const PoseSnapshot & snapshot);
 
   // Particle Filter
   particle_filter::ParticleFilter particle_filter_;
   sensor_msgs::msg::LaserScan::SharedPtr last_laser_msg_;
 
+  // Output Stage
+  ghost_util::TripleBuffer<PoseSnapshot> pose_snapshot_;
+  ghost_util::TripleBuffer<VisualizationSnapshot> viz_snapshot_;
+  std::atomic<bool> viz_requested_{false};
+
+  // Read-only copy of the filter map, so the output stage never touches the filter
+  vector_map::VectorMap viz_map_;
+  std::vector<float> viz_predicted_ranges_;
+
   // EKF
   nav_msgs::msg::Odometry last_filtered_odom_msg_;
+  rclcpp::Time last_odom_stamp_;
+
+  // Latency Compensation
+  particle_filter::OdometryHistory odom_history_;
+  particle_filter::OdometrySample filter_odom_;  // Odometry the filter was last predicted to
+  Eigen::Vector2f filter_loc_;
+  float filter_angle_;
+  std::array<double, 36> filter_covariance_;
 
   // Configuration
   YAML::Node config_yaml_;
   particle_filter::ParticleFilterConfig config_params;
-  bool first_map_load_;
   bool laser_msg_received_;
   std::string rviz_set_pose_topic_;
   bool publish_tf_;
+  bool global_localization_on_start_;
+  double pose_publish_rate_;
+  double visualization_rate_;
+  int odom_history_size_;
 
   Eigen::Vector2f odom_loc_;
   float odom_angle_;
@@ -42,16 +42,26 @@ namespace ghost_localization
 EkfPfNode::EkfPfNode()
 : Node("ekf_pf_node")
 {
+  // Filter updates are serialized in one group, publishing runs alongside them in another
+  filter_callback_group_ = this->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  output_callback_group_ = this->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  rclcpp::SubscriptionOptions filter_sub_options;
+  filter_sub_options.callback_group = filter_callback_group_;
+
   // Subscribers
   ekf_odom_sub_ = this->create_subscription<nav_msgs::msg::Odometry>(
     "/odom_ekf/odometry",
     10,
-    std::bind(&EkfPfNode::EkfCallback, this, _1));
+    std::bind(&EkfPfNode::EkfCallback, this, _1),
+    filter_sub_options);
 
   laser_sub_ = this->create_subscription<sensor_msgs::msg::LaserScan>(
     "/scan",
     rclcpp::SensorDataQoS(),
-    std::bind(&EkfPfNode::LaserCallback, this, _1));
+    std::bind(&EkfPfNode::LaserCallback, this, _1),
+    filter_sub_options);
 
   auto map_qos = rclcpp::QoS(10);
   map_qos.durability(rmw_qos_durability_policy_t::RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL);
@@ -65,6 +75,8 @@ EkfPfNode::EkfPfNode()
   world_tf_pub_ = this->create_publisher<tf2_msgs::msg::TFMessage>("tf", 10);
   robot_pose_pub_ = this->create_publisher<geometry_msgs::msg::PoseWithCovarianceStamped>(
     "estimation/pose", 10);
+  particle_count_pub_ = this->create_publisher<std_msgs::msg::Int32>(
+    "estimation/particle_count", 10);
 
   // Use simulated time in ROS TODO:!!!!
   rclcpp::Parameter use_sim_time_param("use_sim_time", false);
@@ -75,11 +87,17 @@ EkfPfNode::EkfPfNode()
   set_pose_sub_ = this->create_subscription<geometry_msgs::msg::PoseWithCovarianceStamped>(
     rviz_set_pose_topic_,
     10,
-    std::bind(&EkfPfNode::InitialPoseCallback, this, _1)
+    std::bind(&EkfPfNode::InitialPoseCallback, this, _1),
+    filter_sub_options
   );
 
+  global_localization_sub_ = this->create_subscription<std_msgs::msg::Empty>(
+    "estimation/global_localization",
+    10,
+    std::bind(&EkfPfNode::GlobalLocalizationCallback, this, _1),
+    filter_sub_options);
+
   particle_filter_ = ParticleFilter(config_params);
-  first_map_load_ = true;
   laser_msg_received_ = false;
 
   const Vector2f init_loc(config_params.init_x, config_params.init_y);
@@ -88,7 +106,29 @@ EkfPfNode::EkfPfNode()
   odom_loc_ = Eigen::Vector2f(config_params.init_x, config_params.init_y);
   odom_angle_ = config_params.init_r;
 
-  particle_filter_.Initialize(config_params.map, init_loc, config_params.init_r);
+  // The filter measures motion from a zero odometry pose until the first prediction
+  odom_history_ = particle_filter::OdometryHistory(odom_history_size_);
+  filter_odom_ = particle_filter::OdometrySample{};
+  last_odom_stamp_ = this->get_clock()->now();
+
+  if (global_localization_on_start_) {
+    particle_filter_.GlobalInitialize(config_params.map);
+  } else {
+    particle_filter_.Initialize(config_params.map, init_loc, config_params.init_r);
+  }
+  viz_map_ = particle_filter_.GetMap();
+  UpdateFilterEstimate();
+  PublishFilterState();
+  PublishMapViz();
+
+  pose_timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(1.0 / pose_publish_rate_),
+    std::bind(&EkfPfNode::PoseTimerCallback, this),
+    output_callback_group_);
+  visualization_timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(1.0 / visualization_rate_),
+    std::bind(&EkfPfNode::VisualizationTimerCallback, this),
+    output_callback_group_);
 }
 
 void EkfPfNode::LoadROSParams()
@@ -184,7 +224,92 @@ void EkfPfNode::LoadROSParams()
   config_params.use_skip_range = get_parameter("particle_filter.use_skip_range").as_bool();
   config_params.skip_index_min = get_parameter("particle_filter.skip_index_min").as_int();
   config_params.skip_index_max = get_parameter("particle_filter.skip_index_max").as_int();
+
+  declare_parameter("particle_filter.scan_mask_angles", std::vector<double>{});
+  declare_parameter("particle_filter.max_beams", 0);
+  config_params.scan_mask_angles =
+    get_parameter("particle_filter.scan_mask_angles").as_double_array();
+  config_params.max_beams = get_parameter("particle_filter.max_beams").as_int();
+
+  declare_parameter("particle_filter.num_threads", 0);
+  config_params.num_threads = get_parameter("particle_filter.num_threads").as_int();
+
+  declare_parameter("particle_filter.observation_model", "ray_cast");
+  config_params.observation_model = get_parameter("particle_filter.observation_model").as_string();
+
+  declare_parameter("particle_filter.likelihood_field_resolution", 0.02);
+  config_params.likelihood_field_resolution =
+    get_parameter("particle_filter.likelihood_field_resolution").as_double();
+
+  declare_parameter("particle_filter.range_table_xy_resolution", 0.05);
+  config_params.range_table_xy_resolution =
+    get_parameter("particle_filter.range_table_xy_resolution").as_double();
+
+  declare_parameter("particle_filter.range_table_num_angles", 360);
+  config_params.range_table_num_angles =
+    get_parameter("particle_filter.range_table_num_angles").as_int();
+
+  declare_parameter("particle_filter.range_table_interpolate", false);
+  config_params.range_table_interpolate =
+    get_parameter("particle_filter.range_table_interpolate").as_bool();
+
+  declare_parameter("particle_filter.map_cache_dir", "");
+  config_params.map_cache_dir = get_parameter("particle_filter.map_cache_dir").as_string();
+
+  declare_parameter("particle_filter.kld_sampling", false);
+  declare_parameter("particle_filter.kld_min_particles", 50);
+  declare_parameter("particle_filter.kld_max_particles", 2000);
+  declare_parameter("particle_filter.kld_epsilon", 0.05);
+  declare_parameter("particle_filter.kld_z", 2.33);
+  declare_parameter("particle_filter.kld_bin_size_xy", 0.1);
+  declare_parameter("particle_filter.kld_bin_size_theta", 0.1745);
+  config_params.kld_sampling = get_parameter("particle_filter.kld_sampling").as_bool();
+  config_params.kld_min_particles = get_parameter("particle_filter.kld_min_particles").as_int();
+  config_params.kld_max_particles = get_parameter("particle_filter.kld_max_particles").as_int();
+  config_params.kld_epsilon = get_parameter("particle_filter.kld_epsilon").as_double();
+  config_params.kld_z = get_parameter("particle_filter.kld_z").as_double();
+  config_params.kld_bin_size_xy = get_parameter("particle_filter.kld_bin_size_xy").as_double();
+  config_params.kld_bin_size_theta =
+    get_parameter("particle_filter.kld_bin_size_theta").as_double();
   publish_tf_ = get_parameter("particle_filter.publish_tf").as_bool();
+
+  declare_parameter("particle_filter.pose_publish_rate", 50.0);
+  declare_parameter("particle_filter.visualization_rate", 5.0);
+  pose_publish_rate_ = get_parameter("particle_filter.pose_publish_rate").as_double();
+  visualization_rate_ = get_parameter("particle_filter.visualization_rate").as_double();
+  declare_parameter("particle_filter.global_localization_on_start", false);
+  declare_parameter("particle_filter.global_loc_particles", 20000);
+  declare_parameter("particle_filter.global_loc_xy_resolution", 0.1);
+  declare_parameter("particle_filter.global_loc_clearance", 0.1);
+  global_localization_on_start_ =
+    get_parameter("particle_filter.global_localization_on_start").as_bool();
+  config_params.global_loc_particles =
+    get_parameter("particle_filter.global_loc_particles").as_int();
+  config_params.global_loc_xy_resolution =
+    get_parameter("particle_filter.global_loc_xy_resolution").as_double();
+  config_params.global_loc_clearance =
+    get_parameter("particle_filter.global_loc_clearance").as_double();
+
+  declare_parameter("particle_filter.augmented_mcl", false);
+  declare_parameter("particle_filter.recovery_alpha_slow", 0.001);
+  declare_parameter("particle_filter.recovery_alpha_fast", 0.1);
+  declare_parameter("particle_filter.recovery_max_inject_ratio", 0.25);
+  config_params.augmented_mcl = get_parameter("particle_filter.augmented_mcl").as_bool();
+  config_params.recovery_alpha_slow =
+    get_parameter("particle_filter.recovery_alpha_slow").as_double();
+  config_params.recovery_alpha_fast =
+    get_parameter("particle_filter.recovery_alpha_fast").as_double();
+  config_params.recovery_max_inject_ratio =
+    get_parameter("particle_filter.recovery_max_inject_ratio").as_double();
+
+  declare_parameter("particle_filter.odom_history_size", 200);
+  odom_history_size_ = get_parameter("particle_filter.odom_history_size").as_int();
+
+  if (pose_publish_rate_ <= 0.0 || visualization_rate_ <= 0.0) {
+    throw std::runtime_error(
+            "[EkfPfNode::LoadROSParams] Error: pose_publish_rate and visualization_rate must be "
+            "positive");
+  }
 }
 
 void EkfPfNode::LaserCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg)
@@ -194,18 +319,35 @@ void EkfPfNode::LaserCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg)
   }
   try {
     last_laser_msg_ = msg;
+
+    // Bring the filter to the odometry pose at scan time, never back past its last prediction
+    const double scan_stamp = rclcpp::Time(msg->header.stamp).seconds();
+    if (!odom_history_.empty()) {
+      particle_filter::OdometrySample scan_odom;
+      odom_history_.interpolate(scan_stamp, &scan_odom);
+      if (scan_odom.stamp > scan_stamp) {
+        RCLCPP_WARN_THROTTLE(
+          this->get_logger(), *this->get_clock(), 5000,
+          "Scan is %.3f s older than the odometry history, increase odom_history_size",
+          scan_odom.stamp - scan_stamp);
+      }
+
+      // Skipping updates while turning fast depends on how fast the robot turned during the scan
+      particle_filter_.setAngularVelocity(scan_odom.angular_velocity);
+      if (scan_stamp >= filter_odom_.stamp) {
+        particle_filter_.Predict(scan_odom.loc, scan_odom.angle);
+        filter_odom_ = scan_odom;
+      }
+    }
+
     particle_filter_.ObserveLaser(
       msg->ranges,
       msg->range_min,
       msg->range_max,
       msg->angle_min + config_params.laser_angle_offset,
       msg->angle_max + config_params.laser_angle_offset);
-
-    PublishRobotPose();
-    PublishVisualization();
-    if (publish_tf_) {
-      PublishWorldTransform();
-    }
+    UpdateFilterEstimate();
+    PublishFilterState();
   } catch (std::exception e) {
     RCLCPP_ERROR(this->get_logger(), "Laser : % s ", e.what());
   }
@@ -229,18 +371,40 @@ void EkfPfNode::InitialPoseCallback(
       init_loc.y(),
       RadToDeg(init_angle));
 
-    particle_filter_.Initialize(config_params.map, init_loc, init_angle);
-
-    if (publish_tf_) {
-      PublishWorldTransform();
+    // The new pose holds at the newest odometry, so odometry before it must not move the filter
+    if (!odom_history_.empty()) {
+      filter_odom_ = odom_history_.latest();
+      particle_filter_.Predict(filter_odom_.loc, filter_odom_.angle);
     }
-    PublishVisualization();
+    particle_filter_.Initialize(config_params.map, init_loc, init_angle);
+    UpdateFilterEstimate();
+    PublishFilterState();
     PublishMapViz();
   } catch (std::exception e) {
     RCLCPP_ERROR(this->get_logger(), "Initial Pose:% s ", e.what());
   }
 }
 
+void EkfPfNode::GlobalLocalizationCallback(const std_msgs::msg::Empty::SharedPtr /*msg*/)
+{
+  try {
+    RCLCPP_INFO(
+      this->get_logger(), "Global localization: %s",
+      config_params.map.c_str());
+
+    // Same as a new initial pose, the spread holds from the newest odometry on
+    if (!odom_history_.empty()) {
+      filter_odom_ = odom_history_.latest();
+      particle_filter_.Predict(filter_odom_.loc, filter_odom_.angle);
+    }
+    particle_filter_.GlobalInitialize(config_params.map);
+    UpdateFilterEstimate();
+    PublishFilterState();
+  } catch (std::exception e) {
+    RCLCPP_ERROR(this->get_logger(), "Global Localization: %s", e.what());
+  }
+}
+
 // Odometry
 void EkfPfNode::EkfCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
 {
@@ -252,35 +416,107 @@ void EkfPfNode::EkfCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
     last_filtered_odom_msg_.pose.pose.orientation.z,
     last_filtered_odom_msg_.pose.pose.orientation.w);
 
-  particle_filter_.setAngularVelocity(msg->twist.twist.angular.z);
-
   try {
-    Vector2f robot_loc(0, 0);
-    float robot_angle(0);
-    std::array<double, 36> covariance;
-    particle_filter_.Predict(odom_loc_, odom_angle_);
-
-    particle_filter_.GetLocation(&robot_loc, &robot_angle, &covariance);
-    PublishRobotPose();
-    PublishVisualization();
-    if (publish_tf_) {
-      PublishWorldTransform();
+    // The filter itself only moves on scans, the published pose follows odometry in between
+    const double stamp = rclcpp::Time(msg->header.stamp).seconds();
+    if (stamp < filter_odom_.stamp) {
+      // Time went backwards (e.g. a restarted bag), measure motion from here on
+      filter_odom_.stamp = stamp;
     }
+    odom_history_.add(
+      particle_filter::OdometrySample{
+        stamp, odom_loc_, odom_angle_, static_cast<float>(msg->twist.twist.angular.z)});
+    last_odom_stamp_ = msg->header.stamp;
+    PublishFilterState();
   } catch (std::exception e) {
     RCLCPP_ERROR(this->get_logger(), "Odom: %s", e.what());
   }
 }
 
-void EkfPfNode::PublishRobotPose()
+void EkfPfNode::UpdateFilterEstimate()
+{
+  // GetLocation accumulates into loc
+  filter_loc_ = Vector2f(0, 0);
+  particle_filter_.GetLocation(&filter_loc_, &filter_angle_, &filter_covariance_);
+}
+
+void EkfPfNode::PublishFilterState()
+{
+  // Runs on the filter thread, so only copy state out here and leave messages to the timers
+  PoseSnapshot & pose = pose_snapshot_.back();
+  pose.stamp = last_odom_stamp_;
+  pose.loc = filter_loc_;
+  pose.angle = filter_angle_;
+  pose.covariance = filter_covariance_;
+  if (!odom_history_.empty()) {
+    particle_filter::propagatePose(filter_odom_, odom_history_.latest(), &pose.loc, &pose.angle);
+  }
+
+  if (viz_requested_.exchange(false, std::memory_order_acquire)) {
+    // Particles and scan markers are drawn at scan time, where the filter estimate is
+    VisualizationSnapshot & viz = viz_snapshot_.back();
+    particle_filter_.GetParticles(&viz.particles);
+    viz.loc = filter_loc_;
+    viz.angle = filter_angle_;
+    viz.laser_msg = last_laser_msg_;
+    viz_snapshot_.publish();
+  }
+  pose_snapshot_.publish();
+}
+
+void EkfPfNode::PoseTimerCallback()
 {
-  Vector2f robot_loc(0, 0);
-  float robot_angle(0);
-  std::array<double, 36> covariance;
-  particle_filter_.GetLocation(&robot_loc, &robot_angle, &covariance);
+  if (!pose_snapshot_.update()) {
+    return;
+  }
+  const PoseSnapshot & pose = pose_snapshot_.front();
+  PublishRobotPose(pose);
+  if (publish_tf_) {
+    PublishWorldTransform(pose);
+  }
+}
+
+void EkfPfNode::VisualizationTimerCallback()
+{
+  const bool has_subscribers = (cloud_viz_pub_->get_subscription_count() > 0) ||
+    (debug_viz_pub_->get_subscription_count() > 0) ||
+    (particle_count_pub_->get_subscription_count() > 0);
+  if (!has_subscribers) {
+    return;
+  }
+
+  // Ask the filter for a fresh copy, drawn on a later tick once it has been handed over
+  viz_requested_.store(true, std::memory_order_release);
+  if (!viz_snapshot_.update()) {
+    return;
+  }
+  const VisualizationSnapshot & viz = viz_snapshot_.front();
+
+  std_msgs::msg::Int32 particle_count_msg{};
+  particle_count_msg.data = viz.particles.size();
+  particle_count_pub_->publish(particle_count_msg);
+
+  // Publish Particle Cloud
+  auto cloud_msg = geometry_msgs::msg::PoseArray{};
+  cloud_msg.header.frame_id = config_params.world_frame;
+  cloud_msg.header.stamp = this->get_clock()->now();
+  DrawParticles(viz, cloud_msg);
+  cloud_viz_pub_->publish(cloud_msg);
+
+  // Publish Debug Markers
+  viz_msg_ = visualization_msgs::msg::MarkerArray{};
+  DrawPredictedScan(viz, viz_msg_);
+  debug_viz_pub_->publish(viz_msg_);
+}
+
+void EkfPfNode::PublishRobotPose(const PoseSnapshot & snapshot)
+{
+  const Vector2f & robot_loc = snapshot.loc;
+  const float robot_angle = snapshot.angle;
 
   robot_pose_ = geometry_msgs::msg::PoseWithCovarianceStamped{};
 
-  robot_pose_.header.stamp = this->get_clock()->now();
+  robot_pose_.header.stamp = snapshot.stamp;
   robot_pose_.header.frame_id = config_params.world_frame;
 
   robot_pose_.pose.pose.position.x = robot_loc.x();
@@ -294,18 +530,16 @@ void EkfPfNode::PublishRobotPose()
     robot_pose_.pose.pose.orientation.y,
     robot_pose_.pose.pose.orientation.z
   );
-  robot_pose_.pose.covariance = covariance;
+  robot_pose_.pose.covariance = snapshot.covariance;
   robot_pose_pub_->publish(robot_pose_);
 }
 
 void EkfPfNode::PublishMapViz()
 {
   auto map_msg = visualization_msgs::msg::Marker{};
-  auto map = particle_filter_.GetMap();
-
   // Iterate through all lines in map
-  for (size_t i = 0; i < map.lines.size(); ++i) {
-    const geometry::Line2f line = map.lines[i];
+  for (size_t i = 0; i < viz_map_.lines.size(); ++i) {
+    const geometry::Line2f & line = viz_map_.lines[i];
     auto start_point = geometry_msgs::msg::Point{};
     start_point.x = line.p0.x();
     start_point.y = line.p0.y();
@@ -332,18 +566,16 @@ void EkfPfNode::PublishMapViz()
   map_viz_pub_->publish(map_msg);
 }
 
-void EkfPfNode::PublishWorldTransform()
+void EkfPfNode::PublishWorldTransform(const PoseSnapshot & snapshot)
 {
   auto tf_msg = tf2_msgs::msg::TFMessage{};
   auto world_to_base_tf = geometry_msgs::msg::TransformStamped{};
-  world_to_base_tf.header.stamp = this->get_clock()->now();
+  world_to_base_tf.header.stamp = snapshot.stamp;
   world_to_base_tf.header.frame_id = config_params.world_frame;
   world_to_base_tf.child_frame_id = "base_link";
 
-  Vector2f robot_loc(0, 0);
-  float robot_angle(0);
-  std::array<double, 36> covariance;
-  particle_filter_.GetLocation(&robot_loc, &robot_angle, &covariance);
+  const Vector2f & robot_loc = snapshot.loc;
+  const float robot_angle = snapshot.angle;
 
   world_to_base_tf.transform.translation.x = robot_loc.x();
   world_to_base_tf.transform.translation.y = robot_loc.y();
@@ -357,31 +589,12 @@ void EkfPfNode::PublishWorldTransform()
   world_tf_pub_->publish(tf_msg);
 }
 
-void EkfPfNode::PublishVisualization()
+void EkfPfNode::DrawParticles(
+  const VisualizationSnapshot & snapshot,
+  geometry_msgs::msg::PoseArray & cloud_msg)
 {
-  // Publish Particle Cloud
-  auto cloud_msg = geometry_msgs::msg::PoseArray{};
-  cloud_msg.header.frame_id = config_params.world_frame;
-  cloud_msg.header.stamp = this->get_clock()->now();
-  DrawParticles(cloud_msg);
-  cloud_viz_pub_->publish(cloud_msg);
-
-  // Publish Debug Markers
-  viz_msg_ = visualization_msgs::msg::MarkerArray{};
-  DrawPredictedScan(viz_msg_);
-
-  if (first_map_load_) {
-    PublishMapViz();
-    first_map_load_ = false;
-  }
-  debug_viz_pub_->publish(viz_msg_);
-}
-
-void EkfPfNode::DrawParticles(geometry_msgs::msg::PoseArray & cloud_msg)
-{
-  vector<particle_filter::Particle> particles;
-  particle_filter_.GetParticles(&particles);
-  for (const particle_filter::Particle & p : particles) {
+  cloud_msg.poses.reserve(snapshot.particles.size());
+  for (const particle_filter::Particle & p : snapshot.particles) {
     auto pose_msg = geometry_msgs::msg::Pose{};
     pose_msg.position.x = p.loc.x();
     pose_msg.position.y = p.loc.y();
@@ -391,26 +604,38 @@ void EkfPfNode::DrawParticles(geometry_msgs::msg::PoseArray & cloud_msg)
   }
 }
 
-void EkfPfNode::DrawPredictedScan(visualization_msgs::msg::MarkerArray & viz_msg)
+void EkfPfNode::DrawPredictedScan(
+  const VisualizationSnapshot & snapshot,
+  visualization_msgs::msg::MarkerArray & viz_msg)
 {
-  if (!laser_msg_received_) {
+  if (!snapshot.laser_msg) {
     return;
   }
-  Vector2f robot_loc(0, 0);
-  float robot_angle(0);
-  std::array<double, 36> covariance;
-  particle_filter_.GetLocation(&robot_loc, &robot_angle, &covariance);
-  vector<Vector2f> predicted_scan;
-
-  particle_filter_.GetPredictedPointCloud(
-    robot_loc,
-    robot_angle,
-    last_laser_msg_->ranges.size(),
-    last_laser_msg_->range_min,
-    last_laser_msg_->range_max,
-    last_laser_msg_->angle_min + config_params.laser_angle_offset,
-    last_laser_msg_->angle_max + config_params.laser_angle_offset,
-    &predicted_scan);
+  const sensor_msgs::msg::LaserScan & laser_msg = *snapshot.laser_msg;
+  const Vector2f & robot_loc = snapshot.loc;
+  const float robot_angle = snapshot.angle;
+  auto rot_bl_to_world = Eigen::Rotation2D<float>(robot_angle).toRotationMatrix();
+
+  // Cast against the node's own map copy, with the same beam spacing the filter uses
+  const Vector2f sensor_loc = robot_loc + rot_bl_to_world * Vector2f(
+    config_params.laser_offset_x, config_params.laser_offset_y);
+  const float scan_angle_min = laser_msg.angle_min + config_params.laser_angle_offset +
+    robot_angle;
+  const float scan_angle_max = laser_msg.angle_max + config_params.laser_angle_offset +
+    robot_angle;
+  const int num_rays = laser_msg.ranges.size() / config_params.resize_factor;
+  if (num_rays <= 0) {
+    return;
+  }
+  viz_map_.GetPredictedScan(
+    sensor_loc,
+    laser_msg.range_min,
+    laser_msg.range_max,
+    scan_angle_min,
+    scan_angle_max,
+    num_rays,
+    &viz_predicted_ranges_);
+  const float ray_increment = (scan_angle_max - scan_angle_min) / num_rays;
 
   auto predicted_scan_msg = visualization_msgs::msg::Marker{};
   predicted_scan_msg.header.stamp = this->get_clock()->now();
@@ -422,15 +647,16 @@ void EkfPfNode::DrawPredictedScan(visualization_msgs::msg::MarkerArray & viz_msg
   predicted_scan_msg.scale.x = 0.04;
   predicted_scan_msg.scale.y = 0.04;
 
-  for (std::size_t i = 0; i < predicted_scan.size(); i++) {
+  for (std::size_t i = 0; i < viz_predicted_ranges_.size(); i++) {
     int laser_index = i * config_params.resize_factor;
     if (!config_params.use_skip_range || (laser_index < config_params.skip_index_min) ||
       (laser_index > config_params.skip_index_max) )
     {
       // Transform particle to map
+      const float ray_angle = scan_angle_min + i * ray_increment;
       auto point_msg = geometry_msgs::msg::Point{};
-      point_msg.x = predicted_scan[i].x();
-      point_msg.y = predicted_scan[i].y();
+      point_msg.x = sensor_loc.x() + viz_predicted_ranges_[i] * cos(ray_angle);
+      point_msg.y = sensor_loc.y() + viz_predicted_ranges_[i] * sin(ray_angle);
       predicted_scan_msg.points.push_back(point_msg);
     }
   }
@@ -447,23 +673,18 @@ void EkfPfNode::DrawPredictedScan(visualization_msgs::msg::MarkerArray & viz_msg
   true_scan_msg.scale.x = 0.02;
   true_scan_msg.scale.y = 0.02;
 
-  auto rot_bl_to_world = Eigen::Rotation2D<float>(robot_angle).toRotationMatrix();
-  for (std::size_t i = 0; i < last_laser_msg_->ranges.size(); i++) {
+  for (std::size_t i = 0; i < laser_msg.ranges.size(); i++) {
     int laser_index = ((int) (i / config_params.resize_factor)) * config_params.resize_factor;
     if (!config_params.use_skip_range || (laser_index < config_params.skip_index_min) ||
       (laser_index > config_params.skip_index_max) )
     {
       // Transform particle to map
-      float range = last_laser_msg_->ranges[i];
+      float range = laser_msg.ranges[i];
       if ((range >= config_params.range_min) && (range <= config_params.range_max) ) {
-        float angle = last_laser_msg_->angle_min + i * last_laser_msg_->angle_increment +
+        float angle = laser_msg.angle_min + i * laser_msg.angle_increment +
           config_params.laser_angle_offset + robot_angle;
 
-        Eigen::Vector2f p =
-          Eigen::Vector2f(
-          range * cos(angle),
-          range * sin(angle)) + robot_loc + rot_bl_to_world * Eigen::Vector2f(
-          config_params.laser_offset_x, config_params.laser_offset_y);
+        Eigen::Vector2f p = Eigen::Vector2f(range * cos(angle), range * sin(angle)) + sensor_loc;
         auto point_msg = geometry_msgs::msg::Point{};
         point_msg.x = p.x();
         point_msg.y = p.y();
@@ -479,7 +700,12 @@ void EkfPfNode::DrawPredictedScan(visualization_msgs::msg::MarkerArray & viz_msg
 int main(int argc, char * argv[])
 {
   rclcpp::init(argc, argv);
-  rclcpp::spin(std::make_shared<ghost_localization::EkfPfNode>());
+  auto node = std::make_shared<ghost_localization::EkfPfNode>();
+
+  // One thread for filter updates, one for the output timers
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2);
+  executor.add_node(node);
+  executor.spin();
   rclcpp::shutdown();
   return 0;
 }
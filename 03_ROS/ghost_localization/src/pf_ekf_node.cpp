@@ -71,6 +71,8 @@ PfEkfNode::PfEkfNode()
   world_tf_pub_ = this->create_publisher<tf2_msgs::msg::TFMessage>("tf", 10);
   ekf_odom_pub_ = this->create_publisher<geometry_msgs::msg::PoseWithCovarianceStamped>(
     "pf_odometry", 10);
+  particle_count_pub_ = this->create_publisher<std_msgs::msg::Int32>(
+    "estimation/particle_count", 10);
 
   // Use simulated time in ROS TODO:!!!!
   rclcpp::Parameter use_sim_time_param("use_sim_time", true);
@@ -175,6 +177,53 @@ void PfEkfNode::LoadROSParams()
   config_params.use_skip_range = get_parameter("particle_filter.use_skip_range").as_bool();
   config_params.skip_index_min = get_parameter("particle_filter.skip_index_min").as_int();
   config_params.skip_index_max = get_parameter("particle_filter.skip_index_max").as_int();
+
+  declare_parameter("particle_filter.scan_mask_angles", std::vector<double>{});
+  declare_parameter("particle_filter.max_beams", 0);
+  config_params.scan_mask_angles =
+    get_parameter("particle_filter.scan_mask_angles").as_double_array();
+  config_params.max_beams = get_parameter("particle_filter.max_beams").as_int();
+
+  declare_parameter("particle_filter.num_threads", 0);
+  config_params.num_threads = get_parameter("particle_filter.num_threads").as_int();
+
+  declare_parameter("particle_filter.observation_model", "ray_cast");
+  config_params.observation_model = get_parameter("particle_filter.observation_model").as_string();
+
+  declare_parameter("particle_filter.likelihood_field_resolution", 0.02);
+  config_params.likelihood_field_resolution =
+    get_parameter("particle_filter.likelihood_field_resolution").as_double();
+
+  declare_parameter("particle_filter.range_table_xy_resolution", 0.05);
+  config_params.range_table_xy_resolution =
+    get_parameter("particle_filter.range_table_xy_resolution").as_double();
+
+  declare_parameter("particle_filter.range_table_num_angles", 360);
+  config_params.range_table_num_angles =
+    get_parameter("particle_filter.range_table_num_angles").as_int();
+
+  declare_parameter("particle_filter.range_table_interpolate", false);
+  config_params.range_table_interpolate =
+    get_parameter("particle_filter.range_table_interpolate").as_bool();
+
+  declare_parameter("particle_filter.map_cache_dir", "");
+  config_params.map_cache_dir = get_parameter("particle_filter.map_cache_dir").as_string();
+
+  declare_parameter("particle_filter.kld_sampling", false);
+  declare_parameter("particle_filter.kld_min_particles", 50);
+  declare_parameter("particle_filter.kld_max_particles", 2000);
+  declare_parameter("particle_filter.kld_epsilon", 0.05);
+  declare_parameter("particle_filter.kld_z", 2.33);
+  declare_parameter("particle_filter.kld_bin_size_xy", 0.1);
+  declare_parameter("particle_filter.kld_bin_size_theta", 0.1745);
+  config_params.kld_sampling = get_parameter("particle_filter.kld_sampling").as_bool();
+  config_params.kld_min_particles = get_parameter("particle_filter.kld_min_particles").as_int();
+  config_params.kld_max_particles = get_parameter("particle_filter.kld_max_particles").as_int();
+  config_params.kld_epsilon = get_parameter("particle_filter.kld_epsilon").as_double();
+  config_params.kld_z = get_parameter("particle_filter.kld_z").as_double();
+  config_params.kld_bin_size_xy = get_parameter("particle_filter.kld_bin_size_xy").as_double();
+  config_params.kld_bin_size_theta =
+    get_parameter("particle_filter.kld_bin_size_theta").as_double();
 }
 
 void PfEkfNode::LaserCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg)
@@ -191,6 +240,10 @@ void PfEkfNode::LaserCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg)
       msg->angle_min + config_params.laser_angle_offset,
       msg->angle_max + config_params.laser_angle_offset);
 
+    std_msgs::msg::Int32 particle_count_msg{};
+    particle_count_msg.data = particle_filter_.GetNumParticles();
+    particle_count_pub_->publish(particle_count_msg);
+
     PublishRobotPose();
     PublishWorldTransform();
     PublishVisualization();
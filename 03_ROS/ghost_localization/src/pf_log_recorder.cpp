@@ -0,0 +1,129 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "nav_msgs/msg/odometry.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/laser_scan.hpp"
+
+#include "ghost_estimation/particle_filter/replay_log.hpp"
+
+using particle_filter::ReplayEvent;
+using std::placeholders::_1;
+
+namespace ghost_localization
+{
+
+/**
+ * @brief Records the particle filter's inputs, and optionally a ground truth pose, to a replay log
+ * for offline tuning with pf_replay. Ground truth can come from any nav_msgs/Odometry topic, e.g. a
+ * simulator pose plugin or motion capture.
+ */
+class PfLogRecorder : public rclcpp::Node
+{
+public:
+  PfLogRecorder()
+  : rclcpp::Node("pf_log_recorder")
+  {
+    declare_parameter("output_file", "pf_replay.log");
+    declare_parameter("odom_topic", "/odom_ekf/odometry");
+    declare_parameter("scan_topic", "/scan");
+    declare_parameter("ground_truth_topic", "");
+    std::string output_file = get_parameter("output_file").as_string();
+    std::string ground_truth_topic = get_parameter("ground_truth_topic").as_string();
+
+    if (!writer_.open(output_file)) {
+      throw std::runtime_error("[PfLogRecorder] Error: could not open " + output_file + ".");
+    }
+    RCLCPP_INFO(get_logger(), "Recording to %s", output_file.c_str());
+
+    odom_sub_ = create_subscription<nav_msgs::msg::Odometry>(
+      get_parameter("odom_topic").as_string(), 100,
+      std::bind(&PfLogRecorder::OdomCallback, this, _1));
+    scan_sub_ = create_subscription<sensor_msgs::msg::LaserScan>(
+      get_parameter("scan_topic").as_string(), rclcpp::SensorDataQoS(),
+      std::bind(&PfLogRecorder::ScanCallback, this, _1));
+    if (!ground_truth_topic.empty()) {
+      ground_truth_sub_ = create_subscription<nav_msgs::msg::Odometry>(
+        ground_truth_topic, 100, std::bind(&PfLogRecorder::GroundTruthCallback, this, _1));
+    }
+  }
+
+private:
+  static ReplayEvent PoseEvent(
+    ReplayEvent::Type type,
+    const nav_msgs::msg::Odometry & msg)
+  {
+    ReplayEvent event;
+    event.type = type;
+    event.stamp = rclcpp::Time(msg.header.stamp).seconds();
+    event.x = msg.pose.pose.position.x;
+    event.y = msg.pose.pose.position.y;
+    // Same planar yaw extraction as EkfPfNode
+    event.theta = 2.0 * atan2(msg.pose.pose.orientation.z, msg.pose.pose.orientation.w);
+    event.angular_velocity = msg.twist.twist.angular.z;
+    return event;
+  }
+
+  void OdomCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
+  {
+    writer_.write(PoseEvent(ReplayEvent::ODOMETRY, *msg));
+  }
+
+  void GroundTruthCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
+  {
+    writer_.write(PoseEvent(ReplayEvent::GROUND_TRUTH, *msg));
+  }
+
+  void ScanCallback(const sensor_msgs::msg::LaserScan::SharedPtr msg)
+  {
+    ReplayEvent event;
+    event.type = ReplayEvent::SCAN;
+    event.stamp = rclcpp::Time(msg->header.stamp).seconds();
+    event.angle_min = msg->angle_min;
+    event.angle_max = msg->angle_max;
+    event.range_min = msg->range_min;
+    event.range_max = msg->range_max;
+    event.ranges = msg->ranges;
+    writer_.write(event);
+  }
+
+  particle_filter::ReplayLogWriter writer_;
+  rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr odom_sub_;
+  rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr ground_truth_sub_;
+  rclcpp::Subscription<sensor_msgs::msg::LaserScan>::SharedPtr scan_sub_;
+};
+
+} // namespace ghost_localization
+
+int main(int argc, char * argv[])
+{
+  rclcpp::init(argc, argv);
+  rclcpp::spin(std::make_shared<ghost_localization::PfLogRecorder>());
+  rclcpp::shutdown();
+  return 0;
+}
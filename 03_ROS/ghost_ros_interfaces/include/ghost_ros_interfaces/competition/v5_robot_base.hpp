@@ -29,6 +29,7 @@
 #include <rclcpp/rclcpp.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <ghost_msgs/srv/start_recorder.hpp>
 #include <ghost_msgs/srv/stop_recorder.hpp>
 #include "ghost_msgs/msg/robot_trajectory.hpp"
@@ -37,6 +38,7 @@
 #include "ghost_msgs/msg/v5_sensor_update.hpp"
 
 #include <ghost_planners/robot_trajectory.hpp>
+#include <ghost_util/latency_histogram.hpp>
 #include <ghost_v5_interfaces/robot_hardware_interface.hpp>
 
 namespace ghost_ros_interfaces
@@ -53,7 +55,11 @@ class V5RobotBase
 {
 public:
   V5RobotBase() = default;
-  virtual ~V5RobotBase() = default;
+
+  /**
+   * @brief Logs the control loop latency summary.
+   */
+  virtual ~V5RobotBase();
 
   ///////////////////////////
   ///// Virtual Methods /////
@@ -110,8 +116,10 @@ public:
   /**
    * @brief Called for all V5 Robot Classes after construction. Calls user-defined intialize method internally.
    * Marked as final to throw an error if a derived class attempts to define a configure method.
+   *
+   * @param options options for the ROS node, e.g. intra-process comms when composed with the serial node
    */
-  virtual void configure() final;
+  virtual void configure(const rclcpp::NodeOptions & options = rclcpp::NodeOptions()) final;
 
   /**
    * @brief Returns a shared pointer to the ROS node for this robot instance
@@ -140,9 +148,11 @@ protected:
 
 private:
   void loadRobotHardwareInterface();
-  void sensorUpdateCallback(const ghost_msgs::msg::V5SensorUpdate::SharedPtr msg);
+  void sensorUpdateCallback(const ghost_msgs::msg::V5SensorUpdate::ConstSharedPtr msg);
   void updateCompetitionState(bool is_disabled, bool is_autonomous);
   void trajectoryCallback(const ghost_msgs::msg::RobotTrajectory::SharedPtr msg);
+  void publishControlDiagnostics();
+  std::string getControlLatencySummary() const;
 
   bool configured_ = false;
   robot_state_e last_comp_state_ = robot_state_e::TELEOP;
@@ -156,6 +166,13 @@ private:
   rclcpp::Client<ghost_msgs::srv::StopRecorder>::SharedPtr m_stop_recorder_client;
 
   std::chrono::time_point<std::chrono::system_clock> start_time_;
+
+  // Control Loop Timing. Splits the serial node's "control" interval into ROS transport (sensor update
+  // stamp to callback) and time spent in the competition callbacks.
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnostics_pub_;
+  rclcpp::TimerBase::SharedPtr diagnostics_timer_;
+  ghost_util::LatencyHistogram sensor_update_transport_latency_;
+  ghost_util::LatencyHistogram control_callback_latency_;
 };
 
 } // namespace ghost_ros_interfaces
@@ -23,14 +23,19 @@
 
 #pragma once
 
+#include <condition_variable>
+
 #include <rclcpp/rclcpp.hpp>
 
 #include <yaml-cpp/yaml.h>
 
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <ghost_msgs/msg/v5_actuator_command.hpp>
 #include <ghost_msgs/msg/v5_sensor_update.hpp>
-#include <ghost_serial/base_interfaces/jetson_serial_base.hpp>
+#include <ghost_serial/base_interfaces/jetson_dual_port_serial_base.hpp>
+#include <ghost_serial/base_interfaces/jetson_epoll_serial_base.hpp>
 
+#include <ghost_ros_interfaces/serial/serial_latency_tracer.hpp>
 #include <ghost_v5_interfaces/devices/device_config_map.hpp>
 #include <ghost_v5_interfaces/robot_hardware_interface.hpp>
 
@@ -40,21 +45,37 @@ namespace ghost_ros_interfaces
 class JetsonV5SerialNode : public rclcpp::Node
 {
 public:
-  JetsonV5SerialNode();
+  /**
+   * @brief Construct a new JetsonV5SerialNode. Pass options with intra-process comms enabled to run it in the
+   * same process as a V5RobotBase, so sensor updates and actuator commands skip DDS serialization.
+   */
+  explicit JetsonV5SerialNode(const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
   ~JetsonV5SerialNode();
 
   bool initSerial();
 
 private:
   // Process incoming/outgoing msgs w/ ROS
-  void actuatorCommandCallback(const ghost_msgs::msg::V5ActuatorCommand::SharedPtr msg);
-  void publishV5SensorUpdate(const std::vector<unsigned char> & buffer);
+  void actuatorCommandCallback(const ghost_msgs::msg::V5ActuatorCommand::ConstSharedPtr msg);
+  void publishV5SensorUpdate(
+    const std::vector<unsigned char> & buffer,
+    int msg_len,
+    std::chrono::steady_clock::time_point read_time);
 
   // Background thread for processing serial data and maintaining serial connection
   void serialLoop();
 
-  // Background thread to periodically check if serial data has timed out
-  void serialTimeoutLoop();
+  // Background thread which sleeps until the next msg deadline, and closes the port if it passes
+  void serialWatchdogLoop();
+
+  // Periodically publishes link health (reconnects, reconnect latency, dropped msgs)
+  void publishSerialDiagnostics();
+
+  // Dispatch to the single port or dual port transport, whichever is configured
+  bool readSerialMsg(std::vector<unsigned char> & msg_buffer, int & msg_len);
+  bool writeSerialMsg(const unsigned char buffer[], int num_bytes);
+  bool isSerialPortOpen() const;
+  void closeSerialPort();
 
   // ROS Parameters
   bool use_checksum_;
@@ -63,23 +84,48 @@ private:
   std::string write_msg_start_seq_;
   std::string port_name_;
   std::string backup_port_name_;
+  std::chrono::milliseconds serial_timeout_;
+  int baud_rate_;
+  std::string dual_port_mode_;
 
   // ROS Topics
   rclcpp::Subscription<ghost_msgs::msg::V5ActuatorCommand>::SharedPtr actuator_command_sub_;
   rclcpp::Publisher<ghost_msgs::msg::V5SensorUpdate>::SharedPtr sensor_update_pub_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnostics_pub_;
+  rclcpp::TimerBase::SharedPtr diagnostics_timer_;
 
-  // Serial Interface
-  std::shared_ptr<ghost_serial::JetsonSerialBase> serial_base_interface_;
+  // Serial Interface (exactly one is set). In dual port mode both port_name and backup_port_name are
+  // used at once, instead of failing over between them.
+  std::shared_ptr<ghost_serial::JetsonEpollSerialBase> serial_base_interface_;
+  std::shared_ptr<ghost_serial::JetsonDualPortSerialBase> dual_port_interface_;
   std::vector<unsigned char> sensor_update_msg_;
+  std::vector<unsigned char> actuator_command_msg_;
   std::thread serial_thread_;
-  std::thread serial_timeout_thread_;
   std::atomic_bool serial_open_;
-  std::chrono::time_point<std::chrono::system_clock> last_msg_time_;
   std::mutex serial_reset_mutex_;
-  bool using_backup_port_;
-
-  // Robot Hardware Interface
+  std::atomic_bool using_backup_port_;
+
+  // Link Watchdog
+  std::thread serial_watchdog_thread_;
+  std::mutex watchdog_mutex_;
+  std::condition_variable watchdog_cv_;
+  std::atomic_bool shutdown_;
+  std::atomic<std::chrono::steady_clock::rep> last_msg_time_;
+
+  // Link Diagnostics (guarded by watchdog_mutex_ unless atomic)
+  std::atomic_bool link_recovering_;
+  std::chrono::steady_clock::time_point link_lost_time_;
+  uint32_t reconnect_count_;
+  double last_reconnect_latency_ms_;
+  double max_reconnect_latency_ms_;
+  std::atomic<uint64_t> msgs_received_;
+
+  // Per msg timing from serial read to V5 echo, published with the link diagnostics
+  SerialLatencyTracer latency_tracer_;
+
+  // Robot Hardware Interface, shared by the command callback and the serial thread
   std::shared_ptr<ghost_v5_interfaces::RobotHardwareInterface> rhi_ptr_;
+  std::mutex rhi_mutex_;
 
   // Msg Config
   int actuator_command_msg_len_;
@@ -0,0 +1,144 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ghost_util/latency_histogram.hpp>
+
+namespace ghost_ros_interfaces
+{
+
+/**
+ * @brief Follows each sensor update through the Jetson and back to the V5 Brain, keyed by its msg id.
+ *
+ * A trace starts when a sensor update is read and parsed. Its actuator command, which carries the same
+ * msg id, marks the remaining stages as it is received from ROS and written to serial. The trace ends when
+ * the V5 echoes the msg id back in a later sensor update. The time between consecutive stages is
+ * accumulated in a histogram per interval.
+ *
+ * Msg ids are one byte on the wire, so traces older than max_trace_age are ignored rather than matched to a
+ * wrapped id. All methods are thread-safe.
+ */
+class SerialLatencyTracer
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  enum stage_e
+  {
+    READ,           // Sensor update returned by the serial transport
+    PARSE,          // Sensor update deserialized into the RobotHardwareInterface
+    PUBLISH,        // Sensor update published to ROS
+    COMMAND,        // Actuator command received from ROS (after the V5RobotBase callbacks)
+    WRITE,          // Actuator command queued on the serial transport
+    ECHO,           // V5 reported receiving the actuator command
+    NUM_STAGES
+  };
+
+  struct IntervalStats
+  {
+    std::string name;
+    uint64_t count;
+    int64_t p50_us;
+    int64_t p99_us;
+    int64_t max_us;
+  };
+
+  explicit SerialLatencyTracer(
+    std::chrono::milliseconds max_trace_age = std::chrono::milliseconds(1000));
+
+  /**
+   * @brief Starts a new trace for msg_id. Gaps in consecutive msg ids are counted as dropped sensor
+   * updates.
+   */
+  void recordSensorUpdate(int msg_id, clock::time_point read_time, clock::time_point parse_time);
+
+  /**
+   * @brief Marks PUBLISH, COMMAND, or WRITE for the trace of msg_id. Ignored unless the previous stage was
+   * recorded, so only the first actuator command for each sensor update is timed.
+   */
+  void recordStage(int msg_id, stage_e stage, clock::time_point time);
+
+  /**
+   * @brief Marks ECHO for the trace of echoed_msg_id. The V5 repeats the same id until it receives a new
+   * command, so only the first echo counts.
+   */
+  void recordEcho(int echoed_msg_id, clock::time_point time);
+
+  /**
+   * @brief Returns p50/p99/max for each stage interval, followed by the Jetson total (READ to WRITE) and
+   * end-to-end total (READ to ECHO).
+   */
+  std::vector<IntervalStats> getIntervalStats() const;
+
+  uint64_t getSensorUpdateCount() const;
+  uint64_t getDroppedSensorUpdateCount() const;
+  uint64_t getWrittenCommandCount() const;
+  uint64_t getEchoedCommandCount() const;
+
+  /**
+   * @brief Multi-line human readable report of all counters and intervals.
+   */
+  std::string getSummary() const;
+
+  void reset();
+
+private:
+  static constexpr int NUM_TRACES = 256;
+
+  // Histograms are indexed by the stage ending the interval (READ is unused), then the two totals
+  static constexpr int JETSON_TOTAL = NUM_STAGES;
+  static constexpr int ROUND_TRIP = NUM_STAGES + 1;
+  static constexpr int NUM_INTERVALS = NUM_STAGES + 2;
+  static const char * const INTERVAL_NAMES[NUM_INTERVALS];
+
+  struct Trace
+  {
+    std::array<clock::time_point, NUM_STAGES> times;
+    std::array<bool, NUM_STAGES> recorded;
+  };
+
+  void recordStageNoLock(int msg_id, stage_e stage, clock::time_point time);
+  static int64_t toMicroseconds(clock::duration duration);
+
+  mutable std::mutex mutex_;
+  std::chrono::milliseconds max_trace_age_;
+  std::array<Trace, NUM_TRACES> traces_;
+  std::array<ghost_util::LatencyHistogram, NUM_INTERVALS> histograms_;
+
+  bool has_last_sensor_msg_id_;
+  int last_sensor_msg_id_;
+  uint64_t sensor_update_count_;
+  uint64_t dropped_sensor_update_count_;
+  uint64_t written_command_count_;
+  uint64_t echoed_command_count_;
+};
+
+} // namespace ghost_ros_interfaces
@@ -0,0 +1,122 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ghost_util/latency_histogram.hpp>
+#include <ghost_v5_interfaces/devices/device_config_map.hpp>
+
+namespace ghost_ros_interfaces
+{
+
+struct SerialLoopbackConfig
+{
+  // Time between sensor updates from the simulated V5 Brain (zero sends as fast as the link accepts)
+  std::chrono::microseconds sensor_update_period{5000};
+
+  // Probability that each byte sent by the simulated V5 Brain has one random bit flipped
+  double byte_error_rate = 0.0;
+
+  bool use_checksum = true;
+  unsigned int noise_seed = 0;
+};
+
+struct SerialLoopbackResults
+{
+  double duration_s = 0.0;                         // Length of the send window (excludes the drain)
+
+  uint64_t sensor_updates_sent = 0;
+  uint64_t corrupted_sensor_updates_sent = 0;
+  uint64_t sensor_updates_received = 0;            // Every frame returned by the Jetson transport
+  uint64_t intact_sensor_updates_received = 0;     // Payload identical to what the V5 sent
+  uint64_t corrupted_sensor_updates_accepted = 0;  // Passed framing and checksum with a damaged payload
+  uint64_t dropped_delta_frames = 0;               // Delta frames whose keyframe was lost
+
+  // Clean sensor updates sent directly after a corrupted one, and how many of those arrived intact
+  uint64_t updates_after_corruption_sent = 0;
+  uint64_t updates_after_corruption_received = 0;
+
+  uint64_t actuator_commands_sent = 0;
+  uint64_t actuator_commands_received = 0;
+  uint32_t jetson_dropped_read_msgs = 0;
+
+  ghost_util::LatencyHistogram sensor_update_latency;   // V5 write to Jetson read
+  ghost_util::LatencyHistogram round_trip_latency;      // V5 write to matching actuator command on the V5
+
+  double getIntactSensorUpdateRate() const
+  {
+    return (duration_s > 0.0) ? intact_sensor_updates_received / duration_s : 0.0;
+  }
+
+  double getActuatorCommandRate() const
+  {
+    return (duration_s > 0.0) ? actuator_commands_received / duration_s : 0.0;
+  }
+
+  /**
+   * @brief Multi-line human readable report of all counters and latencies.
+   */
+  std::string getSummary() const;
+};
+
+/**
+ * @brief Exercises the full serial protocol over a pseudo-terminal, without a V5 Brain attached.
+ *
+ * The harness holds the master side of a pty and plays the V5 Brain: it serializes sensor updates with a
+ * V5_BRAIN RobotHardwareInterface, frames them exactly like the V5 serial node, optionally flips bits in the
+ * outgoing bytes, and parses the actuator commands that come back. The Jetson side is the production
+ * JetsonEpollSerialBase opened on the slave side, which answers every sensor update with an actuator command
+ * tagged with the same msg id, like JetsonV5SerialNode.
+ *
+ * Recently sent payloads are remembered, so the Jetson can tell an intact msg from a corrupted msg which
+ * slipped past the checksum. Bit flips are only injected on the V5 to Jetson direction.
+ */
+class SerialLoopbackHarness
+{
+public:
+  SerialLoopbackHarness(
+    std::shared_ptr<ghost_v5_interfaces::devices::DeviceConfigMap> robot_config_ptr,
+    SerialLoopbackConfig config);
+
+  /**
+   * @brief Streams sensor updates for the given duration, then waits briefly for msgs still in flight.
+   *
+   * THROWS runtime errors if the pty cannot be created or the Jetson transport fails to open it.
+   *
+   * @param duration
+   * @return SerialLoopbackResults
+   */
+  SerialLoopbackResults run(std::chrono::milliseconds duration);
+
+private:
+  std::shared_ptr<ghost_v5_interfaces::devices::DeviceConfigMap> robot_config_ptr_;
+  SerialLoopbackConfig config_;
+};
+
+} // namespace ghost_ros_interfaces
@@ -23,9 +23,12 @@
 
 #include <pluginlib/class_loader.hpp>
 #include "ghost_ros_interfaces/competition/v5_robot_base.hpp"
+#include "ghost_ros_interfaces/serial/jetson_v5_serial_node.hpp"
 
+#include <algorithm>
 #include <iostream>
 
+using ghost_ros_interfaces::JetsonV5SerialNode;
 using ghost_ros_interfaces::V5RobotBase;
 
 int main(int argc, char * argv[])
@@ -35,6 +38,14 @@ int main(int argc, char * argv[])
   // Pass name of plugin which is derived from V5RobotBase (e.g. my_robot_pkg::MyRobotPlugin)
   std::string plugin_name = std::string(argv[1]);
 
+  // With --compose-serial-node, the serial node runs in this process and msgs between the two nodes are
+  // passed by pointer instead of being serialized through DDS.
+  auto args = rclcpp::remove_ros_arguments(argc, argv);
+  bool compose_serial_node =
+    std::find(args.begin(), args.end(), "--compose-serial-node") != args.end();
+  rclcpp::NodeOptions node_options;
+  node_options.use_intra_process_comms(compose_serial_node);
+
   pluginlib::ClassLoader<V5RobotBase> robot_class_loader("ghost_ros_interfaces",
     "ghost_ros_interfaces::V5RobotBase");
   std::shared_ptr<V5RobotBase> v5_robot_base_ptr;
@@ -49,7 +60,7 @@ int main(int argc, char * argv[])
   }
 
   try {
-    v5_robot_base_ptr->configure();
+    v5_robot_base_ptr->configure(node_options);
   } catch (const std::exception & e) {
     std::cout << std::endl;
     std::cout << "Failed to configure plugin for some reason. Error: " << std::endl << e.what() <<
@@ -57,7 +68,15 @@ int main(int argc, char * argv[])
     std::cout << std::endl;
   }
 
-  rclcpp::spin(v5_robot_base_ptr->getROSNodePtr());
+  if (compose_serial_node) {
+    auto serial_node = std::make_shared<JetsonV5SerialNode>(node_options);
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(v5_robot_base_ptr->getROSNodePtr());
+    executor.add_node(serial_node);
+    executor.spin();
+  } else {
+    rclcpp::spin(v5_robot_base_ptr->getROSNodePtr());
+  }
   rclcpp::shutdown();
   return 0;
 }
@@ -27,6 +27,8 @@
 #include <ghost_v5_interfaces/util/device_config_factory_utils.hpp>
 #include "rclcpp/rclcpp.hpp"
 
+#include <cstdio>
+
 using ghost_planners::RobotTrajectory;
 using ghost_ros_interfaces::msg_helpers::fromROSMsg;
 using ghost_ros_interfaces::msg_helpers::toROSMsg;
@@ -34,13 +36,24 @@ using ghost_v5_interfaces::devices::hardware_type_e;
 using ghost_v5_interfaces::RobotHardwareInterface;
 using ghost_v5_interfaces::util::loadRobotConfigFromYAMLFile;
 using std::placeholders::_1;
+using namespace std::literals::chrono_literals;
+
 namespace ghost_ros_interfaces
 {
 
-void V5RobotBase::configure()
+V5RobotBase::~V5RobotBase()
+{
+  if (configured_) {
+    RCLCPP_INFO(
+      node_ptr_->get_logger(), "Control loop latency summary:\n%s",
+      getControlLatencySummary().c_str());
+  }
+}
+
+void V5RobotBase::configure(const rclcpp::NodeOptions & options)
 {
   std::cout << "Configuring V5 Robot Base!" << std::endl;
-  node_ptr_ = std::make_shared<rclcpp::Node>("competition_state_machine_node");
+  node_ptr_ = std::make_shared<rclcpp::Node>("competition_state_machine_node", options);
 
   loadRobotHardwareInterface();
 
@@ -66,6 +79,11 @@ void V5RobotBase::configure()
   m_stop_recorder_client = node_ptr_->create_client<ghost_msgs::srv::StopRecorder>(
     "bag_recorder/stop");
 
+  diagnostics_pub_ = node_ptr_->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+    "/diagnostics", 10);
+  diagnostics_timer_ = node_ptr_->create_wall_timer(
+    1s, std::bind(&V5RobotBase::publishControlDiagnostics, this));
+
   start_time_ = std::chrono::system_clock::now();
   trajectory_start_time_ = 0;
 
@@ -89,8 +107,12 @@ void V5RobotBase::loadRobotHardwareInterface()
     hardware_type_e::COPROCESSOR);
 }
 
-void V5RobotBase::sensorUpdateCallback(const ghost_msgs::msg::V5SensorUpdate::SharedPtr msg)
+void V5RobotBase::sensorUpdateCallback(const ghost_msgs::msg::V5SensorUpdate::ConstSharedPtr msg)
 {
+  auto callback_start_time = std::chrono::steady_clock::now();
+  sensor_update_transport_latency_.record(
+    (node_ptr_->get_clock()->now() - rclcpp::Time(msg->header.stamp)).nanoseconds() / 1000);
+
   // Update Competition State Machine
   updateCompetitionState(
     msg->competition_status.is_disabled,
@@ -125,10 +147,61 @@ void V5RobotBase::sensorUpdateCallback(const ghost_msgs::msg::V5SensorUpdate::Sh
   }
 
   // Get Actuator Msg from RobotHardwareInterface and publish
-  ghost_msgs::msg::V5ActuatorCommand cmd_msg{};
-  cmd_msg.header.stamp = node_ptr_->get_clock()->now();
-  toROSMsg(*rhi_ptr_, cmd_msg);
-  actuator_command_pub_->publish(cmd_msg);
+  auto cmd_msg = std::make_unique<ghost_msgs::msg::V5ActuatorCommand>();
+  cmd_msg->header.stamp = node_ptr_->get_clock()->now();
+  toROSMsg(*rhi_ptr_, *cmd_msg);
+  actuator_command_pub_->publish(std::move(cmd_msg));
+
+  control_callback_latency_.record(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - callback_start_time).count());
+}
+
+void V5RobotBase::publishControlDiagnostics()
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = std::string(node_ptr_->get_name()) + ": control loop latency";
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.message = "p50/p99/max in ms";
+
+  auto add_histogram = [&status](const std::string & name,
+      const ghost_util::LatencyHistogram & histogram) {
+      for (const auto & [suffix, value_us] : std::vector<std::pair<std::string, int64_t>>{
+          {"_p50_ms", histogram.getPercentile(50.0)},
+          {"_p99_ms", histogram.getPercentile(99.0)},
+          {"_max_ms", histogram.getMax()}})
+      {
+        diagnostic_msgs::msg::KeyValue key_value;
+        key_value.key = name + suffix;
+        key_value.value = std::to_string(value_us / 1000.0);
+        status.values.push_back(key_value);
+      }
+    };
+  add_histogram("sensor_update_transport", sensor_update_transport_latency_);
+  add_histogram("control_callback", control_callback_latency_);
+
+  diagnostic_msgs::msg::DiagnosticArray diagnostics_msg;
+  diagnostics_msg.header.stamp = node_ptr_->get_clock()->now();
+  diagnostics_msg.status.push_back(status);
+  diagnostics_pub_->publish(diagnostics_msg);
+}
+
+std::string V5RobotBase::getControlLatencySummary() const
+{
+  std::string summary;
+  char line[128];
+  for (const auto & [name, histogram] :
+    std::vector<std::pair<std::string, const ghost_util::LatencyHistogram *>>{
+      {"sensor_update_transport", &sensor_update_transport_latency_},
+      {"control_callback", &control_callback_latency_}})
+  {
+    snprintf(
+      line, sizeof(line), "%-24s count %lu  p50 %.3f ms  p99 %.3f ms  max %.3f ms\n",
+      name.c_str(), (unsigned long)histogram->getCount(), histogram->getPercentile(50.0) / 1000.0,
+      histogram->getPercentile(99.0) / 1000.0, histogram->getMax() / 1000.0);
+    summary += line;
+  }
+  return summary;
 }
 
 void V5RobotBase::updateCompetitionState(bool is_disabled, bool is_autonomous)
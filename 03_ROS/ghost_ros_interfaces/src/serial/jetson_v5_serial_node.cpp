@@ -36,10 +36,17 @@ using namespace std::literals::chrono_literals;
 namespace ghost_ros_interfaces
 {
 
-JetsonV5SerialNode::JetsonV5SerialNode()
-: Node("ghost_serial_node"),
+JetsonV5SerialNode::JetsonV5SerialNode(const rclcpp::NodeOptions & options)
+: Node("ghost_serial_node", options),
   serial_open_(false),
-  using_backup_port_(false)
+  using_backup_port_(false),
+  shutdown_(false),
+  last_msg_time_(0),
+  link_recovering_(false),
+  reconnect_count_(0),
+  last_reconnect_latency_ms_(0.0),
+  max_reconnect_latency_ms_(0.0),
+  msgs_received_(0)
 {
   // Load ROS Params
   declare_parameter("use_checksum", true);
@@ -60,6 +67,16 @@ JetsonV5SerialNode::JetsonV5SerialNode()
   declare_parameter("backup_port_name", "/dev/ttyACM2");
   backup_port_name_ = get_parameter("backup_port_name").as_string();
 
+  declare_parameter("serial_timeout_ms", 100);
+  serial_timeout_ = std::chrono::milliseconds(get_parameter("serial_timeout_ms").as_int());
+
+  declare_parameter("baud_rate", 115200);
+  baud_rate_ = get_parameter("baud_rate").as_int();
+
+  // "disabled", "split" (sensor msgs on port_name, actuator msgs on backup_port_name), or "stripe"
+  declare_parameter("dual_port_mode", "disabled");
+  dual_port_mode_ = get_parameter("dual_port_mode").as_string();
+
   declare_parameter("robot_config_yaml_path", "");
   std::string robot_config_yaml_path = get_parameter("robot_config_yaml_path").as_string();
 
@@ -71,10 +88,13 @@ JetsonV5SerialNode::JetsonV5SerialNode()
   actuator_command_msg_len_ = rhi_ptr_->getActuatorCommandMsgLength();
   sensor_update_msg_len_ = rhi_ptr_->getSensorUpdateMsgLength();
   sensor_update_msg_ = std::vector<unsigned char>(sensor_update_msg_len_, 0);
+  actuator_command_msg_ = std::vector<unsigned char>(actuator_command_msg_len_, 0);
 
   // Debug Info
   RCLCPP_INFO(get_logger(), "Port Name: %s", port_name_.c_str());
   RCLCPP_INFO(get_logger(), "Backup Port Name: %s", backup_port_name_.c_str());
+  RCLCPP_INFO(get_logger(), "Baud Rate: %d", baud_rate_);
+  RCLCPP_INFO(get_logger(), "Dual Port Mode: %s", dual_port_mode_.c_str());
 
   int incoming_packet_len = sensor_update_msg_len_ +
     use_checksum_ +
@@ -86,12 +106,33 @@ JetsonV5SerialNode::JetsonV5SerialNode()
   RCLCPP_INFO(get_logger(), "Incoming Packet Length: %d", incoming_packet_len);
 
   // Serial Interface
-  serial_base_interface_ = std::make_shared<ghost_serial::JetsonSerialBase>(
-    write_msg_start_seq_,
-    read_msg_start_seq_,
-    sensor_update_msg_len_,
-    use_checksum_,
-    verbose_);
+  if (dual_port_mode_ == "disabled") {
+    serial_base_interface_ = std::make_shared<ghost_serial::JetsonEpollSerialBase>(
+      write_msg_start_seq_,
+      read_msg_start_seq_,
+      sensor_update_msg_len_,
+      actuator_command_msg_len_,
+      use_checksum_,
+      verbose_);
+    serial_base_interface_->setBaudRate(baud_rate_);
+  } else if ((dual_port_mode_ == "split") || (dual_port_mode_ == "stripe")) {
+    auto mode = (dual_port_mode_ == "split") ?
+      ghost_serial::JetsonDualPortSerialBase::SPLIT :
+      ghost_serial::JetsonDualPortSerialBase::STRIPE;
+    dual_port_interface_ = std::make_shared<ghost_serial::JetsonDualPortSerialBase>(
+      write_msg_start_seq_,
+      read_msg_start_seq_,
+      sensor_update_msg_len_,
+      actuator_command_msg_len_,
+      mode,
+      use_checksum_,
+      verbose_);
+    dual_port_interface_->setBaudRate(baud_rate_);
+  } else {
+    throw std::runtime_error(
+            "[JetsonV5SerialNode::JetsonV5SerialNode] Error: unknown dual_port_mode \"" +
+            dual_port_mode_ + "\", expected disabled, split, or stripe.");
+  }
 
   // Sensor Update Msg Publisher
   sensor_update_pub_ = create_publisher<ghost_msgs::msg::V5SensorUpdate>("v5/sensor_update", 10);
@@ -102,23 +143,73 @@ JetsonV5SerialNode::JetsonV5SerialNode()
     10,
     std::bind(&JetsonV5SerialNode::actuatorCommandCallback, this, _1));
 
-  // Start Serial Thread
+  // Link Diagnostics
+  diagnostics_pub_ = create_publisher<diagnostic_msgs::msg::DiagnosticArray>("diagnostics", 10);
+  diagnostics_timer_ = create_wall_timer(
+    1s, std::bind(&JetsonV5SerialNode::publishSerialDiagnostics, this));
+
+  // Start Serial Threads
   serial_thread_ = std::thread(&JetsonV5SerialNode::serialLoop, this);
-  serial_timeout_thread_ = std::thread(&JetsonV5SerialNode::serialTimeoutLoop, this);
+  serial_watchdog_thread_ = std::thread(&JetsonV5SerialNode::serialWatchdogLoop, this);
 }
 
 JetsonV5SerialNode::~JetsonV5SerialNode()
 {
+  shutdown_ = true;
+  watchdog_cv_.notify_all();
+  serial_watchdog_thread_.join();
+
+  // Unblocks reader waiting on the port
+  closeSerialPort();
   serial_thread_.join();
-  serial_timeout_thread_.join();
+
+  RCLCPP_INFO(get_logger(), "Serial latency summary:\n%s", latency_tracer_.getSummary().c_str());
+}
+
+bool JetsonV5SerialNode::readSerialMsg(std::vector<unsigned char> & msg_buffer, int & msg_len)
+{
+  return (dual_port_interface_) ?
+         dual_port_interface_->readMsgFromSerial(msg_buffer, msg_len) :
+         serial_base_interface_->readMsgFromSerial(msg_buffer, msg_len);
+}
+
+bool JetsonV5SerialNode::writeSerialMsg(const unsigned char buffer[], int num_bytes)
+{
+  return (dual_port_interface_) ?
+         dual_port_interface_->writeMsgToSerial(buffer, num_bytes) :
+         serial_base_interface_->writeMsgToSerial(buffer, num_bytes);
+}
+
+bool JetsonV5SerialNode::isSerialPortOpen() const
+{
+  return (dual_port_interface_) ?
+         dual_port_interface_->isPortOpen() :
+         serial_base_interface_->isPortOpen();
+}
+
+void JetsonV5SerialNode::closeSerialPort()
+{
+  if (dual_port_interface_) {
+    dual_port_interface_->closeSerialPort();
+  } else {
+    serial_base_interface_->closeSerialPort();
+  }
 }
 
 bool JetsonV5SerialNode::initSerial()
 {
   // Wait for serial to become available
   static int err_count = 0;
+
+  // Give the port a full timeout period to deliver its first msg
+  last_msg_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
   try {
-    if (!using_backup_port_) {
+    if (dual_port_interface_) {
+      RCLCPP_DEBUG(
+        get_logger(), "Attempting to open %s and %s", port_name_.c_str(),
+        backup_port_name_.c_str());
+      serial_open_ = dual_port_interface_->trySerialInit(port_name_, backup_port_name_);
+    } else if (!using_backup_port_) {
       RCLCPP_DEBUG(get_logger(), "Attempting to open %s", port_name_.c_str());
       serial_open_ = serial_base_interface_->trySerialInit(port_name_);
     } else {
@@ -137,105 +228,248 @@ bool JetsonV5SerialNode::initSerial()
     err_count = 0;             // Reset error output if we succeed
     auto opened_port_name = (using_backup_port_) ? backup_port_name_.c_str() : port_name_.c_str();
     RCLCPP_DEBUG(get_logger(), "Succesfully opened serial on port: %s", opened_port_name);
-  } else {
+  } else if (!dual_port_interface_) {
     using_backup_port_ = !using_backup_port_;
   }
   return serial_open_;
 }
 
-void JetsonV5SerialNode::serialTimeoutLoop()
+void JetsonV5SerialNode::serialWatchdogLoop()
 {
-  while (rclcpp::ok()) {
-    if ((std::chrono::system_clock::now() - last_msg_time_ > 100ms) && serial_open_) {
-      // Acquire exclusive access to serial port, and then reset
-      std::unique_lock<std::mutex> serial_lock(serial_reset_mutex_);
-      serial_open_ = false;
+  std::unique_lock<std::mutex> watchdog_lock(watchdog_mutex_);
+  while (rclcpp::ok() && !shutdown_) {
+    auto now = std::chrono::steady_clock::now();
+    auto last_msg_time = std::chrono::steady_clock::time_point(
+      std::chrono::steady_clock::duration(last_msg_time_.load()));
+
+    if (serial_open_ && (now - last_msg_time > serial_timeout_)) {
+      // Mark link as lost before closing, so the first msg after reopening is always counted
+      if (!link_recovering_) {
+        link_lost_time_ = now;
+        link_recovering_ = true;
+      }
+      watchdog_lock.unlock();
 
-      // Serial Interface
-      serial_base_interface_ = std::make_shared<ghost_serial::JetsonSerialBase>(
-        write_msg_start_seq_,
-        read_msg_start_seq_,
-        sensor_update_msg_len_,
-        use_checksum_,
-        verbose_);
+      RCLCPP_WARN(
+        get_logger(), "No msgs received for %ld ms, reopening serial port",
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - last_msg_time).count());
 
+      // Close in place (serial loop reopens it), keeping all serial buffers and queued msgs
+      std::unique_lock<std::mutex> serial_lock(serial_reset_mutex_);
+      closeSerialPort();
+      serial_open_ = false;
       serial_lock.unlock();
+
+      watchdog_lock.lock();
+      continue;
     }
+
+    // Sleep until the current msg deadline passes. Woken early on shutdown or port failure.
+    auto deadline = (serial_open_) ? last_msg_time + serial_timeout_ + 1ms : now + serial_timeout_;
+    watchdog_cv_.wait_until(watchdog_lock, deadline);
   }
 }
 
 void JetsonV5SerialNode::serialLoop()
 {
-  while (rclcpp::ok()) {
-    // Ensure serial timeout does not interrupt a msg read operation
-    std::unique_lock<std::mutex> serial_lock(serial_reset_mutex_);
+  while (rclcpp::ok() && !shutdown_) {
     if (serial_open_) {
       RCLCPP_DEBUG(get_logger(), "Serial Loop is Running");
       try {
         int msg_len;
-        bool msg_found = serial_base_interface_->readMsgFromSerial(sensor_update_msg_, msg_len);
+        bool msg_found = readSerialMsg(sensor_update_msg_, msg_len);
 
         if (msg_found) {
           RCLCPP_DEBUG(get_logger(), "Received new message over serial");
-          last_msg_time_ = std::chrono::system_clock::now();
-          publishV5SensorUpdate(sensor_update_msg_);
+          auto now = std::chrono::steady_clock::now();
+          last_msg_time_ = now.time_since_epoch().count();
+          msgs_received_++;
+
+          if (link_recovering_) {
+            std::unique_lock<std::mutex> watchdog_lock(watchdog_mutex_);
+            last_reconnect_latency_ms_ =
+              std::chrono::duration<double, std::milli>(now - link_lost_time_).count();
+            max_reconnect_latency_ms_ = std::max(max_reconnect_latency_ms_, last_reconnect_latency_ms_);
+            reconnect_count_++;
+            link_recovering_ = false;
+            RCLCPP_INFO(
+              get_logger(), "Serial link recovered after %.1f ms", last_reconnect_latency_ms_);
+          }
+
+          publishV5SensorUpdate(sensor_update_msg_, msg_len, now);
+        } else if (!isSerialPortOpen()) {
+          // Port failed underneath us (e.g. unplugged). Have the watchdog reset it now rather than
+          // spinning on a closed port until the timeout expires.
+          last_msg_time_ = 0;
+          watchdog_cv_.notify_all();
+          std::this_thread::sleep_for(1ms);
         }
       } catch (std::exception & e) {
         RCLCPP_ERROR(get_logger(), e.what());
       }
     } else {
       RCLCPP_DEBUG(get_logger(), "Initializing Serial");
-      initSerial();
-      std::this_thread::sleep_for(10ms);
+      std::unique_lock<std::mutex> serial_lock(serial_reset_mutex_);
+      bool opened = initSerial();
+      serial_lock.unlock();
+      if (!opened) {
+        std::this_thread::sleep_for(10ms);
+      }
     }
-    serial_lock.unlock();
   }
 }
 
+void JetsonV5SerialNode::publishSerialDiagnostics()
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.name = std::string(get_name()) + ": serial link";
+  if (dual_port_interface_) {
+    status.hardware_id = port_name_ + "," + backup_port_name_;
+  } else {
+    status.hardware_id = (using_backup_port_) ? backup_port_name_ : port_name_;
+  }
+
+  std::unique_lock<std::mutex> watchdog_lock(watchdog_mutex_);
+  uint32_t reconnect_count = reconnect_count_;
+  double last_reconnect_latency_ms = last_reconnect_latency_ms_;
+  double max_reconnect_latency_ms = max_reconnect_latency_ms_;
+  watchdog_lock.unlock();
+
+  if (!serial_open_) {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+    status.message = "Port closed";
+  } else if (link_recovering_) {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::WARN;
+    status.message = "Port reopened, waiting for msgs";
+  } else {
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.message = "Receiving msgs";
+  }
+
+  auto add_value = [&status](const std::string & key, const std::string & value) {
+      diagnostic_msgs::msg::KeyValue key_value;
+      key_value.key = key;
+      key_value.value = value;
+      status.values.push_back(key_value);
+    };
+  add_value("msgs_received", std::to_string(msgs_received_.load()));
+  add_value("reconnect_count", std::to_string(reconnect_count));
+  add_value("last_reconnect_latency_ms", std::to_string(last_reconnect_latency_ms));
+  add_value("max_reconnect_latency_ms", std::to_string(max_reconnect_latency_ms));
+  if (dual_port_interface_) {
+    add_value(
+      "dropped_read_msgs",
+      std::to_string(dual_port_interface_->getDroppedReadMsgCount()));
+    add_value(
+      "dropped_write_msgs",
+      std::to_string(dual_port_interface_->getDroppedWriteMsgCount()));
+    add_value("write_errors", std::to_string(dual_port_interface_->getWriteErrorCount()));
+    add_value("stale_stripe_msgs", std::to_string(dual_port_interface_->getStaleMsgCount()));
+  } else {
+    add_value(
+      "dropped_read_msgs",
+      std::to_string(serial_base_interface_->getDroppedReadMsgCount()));
+    add_value(
+      "dropped_write_msgs",
+      std::to_string(serial_base_interface_->getDroppedWriteMsgCount()));
+    add_value("write_errors", std::to_string(serial_base_interface_->getWriteErrorCount()));
+  }
+
+  // Latency per stage, from reading a sensor update to the V5 echoing its actuator command
+  diagnostic_msgs::msg::DiagnosticStatus latency_status;
+  latency_status.name = std::string(get_name()) + ": serial latency";
+  latency_status.hardware_id = status.hardware_id;
+  latency_status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  latency_status.message = "p50/p99/max in ms";
+
+  auto add_latency_value = [&latency_status](const std::string & key, const std::string & value) {
+      diagnostic_msgs::msg::KeyValue key_value;
+      key_value.key = key;
+      key_value.value = value;
+      latency_status.values.push_back(key_value);
+    };
+  add_latency_value("sensor_updates", std::to_string(latency_tracer_.getSensorUpdateCount()));
+  add_latency_value(
+    "dropped_sensor_updates",
+    std::to_string(latency_tracer_.getDroppedSensorUpdateCount()));
+  add_latency_value("commands_written", std::to_string(latency_tracer_.getWrittenCommandCount()));
+  add_latency_value("commands_echoed", std::to_string(latency_tracer_.getEchoedCommandCount()));
+  for (const auto & interval : latency_tracer_.getIntervalStats()) {
+    add_latency_value(interval.name + "_p50_ms", std::to_string(interval.p50_us / 1000.0));
+    add_latency_value(interval.name + "_p99_ms", std::to_string(interval.p99_us / 1000.0));
+    add_latency_value(interval.name + "_max_ms", std::to_string(interval.max_us / 1000.0));
+  }
+
+  diagnostic_msgs::msg::DiagnosticArray diagnostics_msg;
+  diagnostics_msg.header.stamp = get_clock()->now();
+  diagnostics_msg.status.push_back(status);
+  diagnostics_msg.status.push_back(latency_status);
+  diagnostics_pub_->publish(diagnostics_msg);
+}
+
 void JetsonV5SerialNode::actuatorCommandCallback(
-  const ghost_msgs::msg::V5ActuatorCommand::SharedPtr msg)
+  const ghost_msgs::msg::V5ActuatorCommand::ConstSharedPtr msg)
 {
   RCLCPP_DEBUG(get_logger(), "Received Actuator Command");
+  latency_tracer_.recordStage(
+    msg->msg_id, SerialLatencyTracer::COMMAND,
+    std::chrono::steady_clock::now());
 
   if (!serial_open_) {
     RCLCPP_ERROR(get_logger(), "Cannot write to serial, port is not open");
     return;
   }
 
-  fromROSMsg(*rhi_ptr_, *msg);
-
-  auto msg_buffer = rhi_ptr_->serialize();
+  {
+    std::unique_lock<std::mutex> rhi_lock(rhi_mutex_);
+    fromROSMsg(*rhi_ptr_, *msg);
+    rhi_ptr_->serialize(actuator_command_msg_.data(), actuator_command_msg_len_);
+  }
 
-  serial_base_interface_->writeMsgToSerial(msg_buffer.data(), actuator_command_msg_len_);
+  if (writeSerialMsg(actuator_command_msg_.data(), actuator_command_msg_len_)) {
+    latency_tracer_.recordStage(
+      msg->msg_id, SerialLatencyTracer::WRITE,
+      std::chrono::steady_clock::now());
+  }
 }
 
-void JetsonV5SerialNode::publishV5SensorUpdate(const std::vector<unsigned char> & buffer)
+void JetsonV5SerialNode::publishV5SensorUpdate(
+  const std::vector<unsigned char> & buffer,
+  int msg_len,
+  std::chrono::steady_clock::time_point read_time)
 {
   RCLCPP_DEBUG(get_logger(), "Publishing Sensor Update");
 
-  // Update hardware interface
-  rhi_ptr_->deserialize(buffer);
-
-  // Initialize msg and set time
-  ghost_msgs::msg::V5SensorUpdate sensor_update_msg{};
-  auto curr_ros_time = get_clock()->now();
-  sensor_update_msg.header.stamp = curr_ros_time;
-
-  // Convert updated RHI to msg
-  toROSMsg(*rhi_ptr_, sensor_update_msg);
+  // Published as a unique_ptr, so an intra-process subscriber takes ownership without a copy
+  auto sensor_update_msg = std::make_unique<ghost_msgs::msg::V5SensorUpdate>();
+  sensor_update_msg->header.stamp = get_clock()->now();
+
+  // Update hardware interface and convert it to a msg. Msg ids are read under the same lock, so the
+  // tracer never pairs them with state from another frame or command.
+  int msg_id;
+  int echoed_msg_id;
+  std::chrono::steady_clock::time_point parse_time;
+  {
+    std::unique_lock<std::mutex> rhi_lock(rhi_mutex_);
+    // Delta frames without a matching keyframe are skipped
+    if (rhi_ptr_->deserialize(buffer.data(), msg_len) == 0) {
+      rhi_lock.unlock();
+      RCLCPP_DEBUG(get_logger(), "Dropped sensor delta frame with no matching keyframe");
+      return;
+    }
+    parse_time = std::chrono::steady_clock::now();
+    msg_id = rhi_ptr_->getMsgID();
+    echoed_msg_id = rhi_ptr_->getEchoedMsgID();
+    toROSMsg(*rhi_ptr_, *sensor_update_msg);
+  }
+  latency_tracer_.recordSensorUpdate(msg_id, read_time, parse_time);
+  latency_tracer_.recordEcho(echoed_msg_id, parse_time);
 
   // Publish update
-  sensor_update_pub_->publish(sensor_update_msg);
+  sensor_update_pub_->publish(std::move(sensor_update_msg));
+  latency_tracer_.recordStage(
+    msg_id, SerialLatencyTracer::PUBLISH,
+    std::chrono::steady_clock::now());
 }
 
 } // namespace ghost_ros_interfaces
-
-int main(int argc, char * argv[])
-{
-  rclcpp::init(argc, argv);
-
-  auto serial_node = std::make_shared<ghost_ros_interfaces::JetsonV5SerialNode>();
-  rclcpp::spin(serial_node);
-  rclcpp::shutdown();
-  return 0;
-}
@@ -0,0 +1,189 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <ghost_ros_interfaces/serial/serial_latency_tracer.hpp>
+
+#include <cstdio>
+
+namespace ghost_ros_interfaces
+{
+
+const char * const SerialLatencyTracer::INTERVAL_NAMES[NUM_INTERVALS] = {
+  "unused",
+  "parse",
+  "publish",
+  "control",
+  "write",
+  "v5_echo",
+  "jetson_total",
+  "round_trip"
+};
+
+SerialLatencyTracer::SerialLatencyTracer(std::chrono::milliseconds max_trace_age)
+: max_trace_age_(max_trace_age)
+{
+  reset();
+}
+
+void SerialLatencyTracer::reset()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto & trace : traces_) {
+    trace.recorded.fill(false);
+  }
+  for (auto & histogram : histograms_) {
+    histogram.reset();
+  }
+  has_last_sensor_msg_id_ = false;
+  last_sensor_msg_id_ = 0;
+  sensor_update_count_ = 0;
+  dropped_sensor_update_count_ = 0;
+  written_command_count_ = 0;
+  echoed_command_count_ = 0;
+}
+
+void SerialLatencyTracer::recordSensorUpdate(
+  int msg_id,
+  clock::time_point read_time,
+  clock::time_point parse_time)
+{
+  msg_id &= 0xFF;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // A large backwards jump is a V5 restart or reordering, not a burst of drops
+  if (has_last_sensor_msg_id_) {
+    int gap = (msg_id - last_sensor_msg_id_ - 1) & 0xFF;
+    if (gap < NUM_TRACES / 2) {
+      dropped_sensor_update_count_ += gap;
+    }
+  }
+  has_last_sensor_msg_id_ = true;
+  last_sensor_msg_id_ = msg_id;
+  sensor_update_count_++;
+
+  auto & trace = traces_[msg_id];
+  trace.recorded.fill(false);
+  trace.times[READ] = read_time;
+  trace.recorded[READ] = true;
+  recordStageNoLock(msg_id, PARSE, parse_time);
+}
+
+void SerialLatencyTracer::recordStage(int msg_id, stage_e stage, clock::time_point time)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  recordStageNoLock(msg_id & 0xFF, stage, time);
+}
+
+void SerialLatencyTracer::recordEcho(int echoed_msg_id, clock::time_point time)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  recordStageNoLock(echoed_msg_id & 0xFF, ECHO, time);
+}
+
+void SerialLatencyTracer::recordStageNoLock(int msg_id, stage_e stage, clock::time_point time)
+{
+  auto & trace = traces_[msg_id];
+  if ((stage <= READ) || (stage >= NUM_STAGES) || !trace.recorded[stage - 1] ||
+    trace.recorded[stage] || (time - trace.times[READ] > max_trace_age_))
+  {
+    return;
+  }
+
+  trace.times[stage] = time;
+  trace.recorded[stage] = true;
+  histograms_[stage].record(toMicroseconds(time - trace.times[stage - 1]));
+
+  if (stage == WRITE) {
+    written_command_count_++;
+    histograms_[JETSON_TOTAL].record(toMicroseconds(time - trace.times[READ]));
+  } else if (stage == ECHO) {
+    echoed_command_count_++;
+    histograms_[ROUND_TRIP].record(toMicroseconds(time - trace.times[READ]));
+  }
+}
+
+std::vector<SerialLatencyTracer::IntervalStats> SerialLatencyTracer::getIntervalStats() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<IntervalStats> stats;
+  for (int i = PARSE; i < NUM_INTERVALS; i++) {
+    const auto & histogram = histograms_[i];
+    stats.push_back(
+      IntervalStats{INTERVAL_NAMES[i], histogram.getCount(), histogram.getPercentile(50.0),
+        histogram.getPercentile(99.0), histogram.getMax()});
+  }
+  return stats;
+}
+
+uint64_t SerialLatencyTracer::getSensorUpdateCount() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return sensor_update_count_;
+}
+
+uint64_t SerialLatencyTracer::getDroppedSensorUpdateCount() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return dropped_sensor_update_count_;
+}
+
+uint64_t SerialLatencyTracer::getWrittenCommandCount() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return written_command_count_;
+}
+
+uint64_t SerialLatencyTracer::getEchoedCommandCount() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return echoed_command_count_;
+}
+
+std::string SerialLatencyTracer::getSummary() const
+{
+  std::string summary = "Sensor updates: " + std::to_string(getSensorUpdateCount()) +
+    " (dropped " + std::to_string(getDroppedSensorUpdateCount()) + "), commands written: " +
+    std::to_string(getWrittenCommandCount()) + " (echoed " +
+    std::to_string(getEchoedCommandCount()) + ")\n";
+
+  char line[128];
+  snprintf(
+    line, sizeof(line), "%-14s %8s %10s %10s %10s\n", "interval", "count", "p50_ms",
+    "p99_ms", "max_ms");
+  summary += line;
+  for (const auto & interval : getIntervalStats()) {
+    snprintf(
+      line, sizeof(line), "%-14s %8lu %10.3f %10.3f %10.3f\n", interval.name.c_str(),
+      (unsigned long)interval.count, interval.p50_us / 1000.0, interval.p99_us / 1000.0,
+      interval.max_us / 1000.0);
+    summary += line;
+  }
+  return summary;
+}
+
+int64_t SerialLatencyTracer::toMicroseconds(clock::duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace ghost_ros_interfaces
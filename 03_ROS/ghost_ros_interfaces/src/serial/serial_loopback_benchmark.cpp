@@ -0,0 +1,75 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <ghost_ros_interfaces/serial/serial_loopback_harness.hpp>
+#include <ghost_v5_interfaces/util/device_config_factory_utils.hpp>
+
+/**
+ * @brief Runs the serial protocol over a pty loopback and prints throughput, latency, and recovery stats.
+ *
+ * Usage: serial_loopback_benchmark [duration_ms] [sensor_update_period_us] [byte_error_rate] [robot_config_yaml]
+ *
+ * A period of zero sends sensor updates as fast as the link accepts them. The robot config defaults to the
+ * ghost_v5_interfaces test config under $VEXU_HOME.
+ */
+int main(int argc, char * argv[])
+{
+  int duration_ms = (argc > 1) ? std::atoi(argv[1]) : 5000;
+
+  ghost_ros_interfaces::SerialLoopbackConfig config;
+  if (argc > 2) {
+    config.sensor_update_period = std::chrono::microseconds(std::atol(argv[2]));
+  }
+  if (argc > 3) {
+    config.byte_error_rate = std::atof(argv[3]);
+  }
+
+  std::string config_path;
+  if (argc > 4) {
+    config_path = argv[4];
+  } else {
+    const char * vexu_home = std::getenv("VEXU_HOME");
+    if (vexu_home == nullptr) {
+      std::cerr << "VEXU_HOME is not set, pass a robot config yaml" << std::endl;
+      return 1;
+    }
+    config_path = std::string(vexu_home) +
+      "/01_Libraries/ghost_v5_interfaces/test/config/example_robot_2.yaml";
+  }
+
+  auto robot_config_ptr = ghost_v5_interfaces::util::loadRobotConfigFromYAMLFile(config_path);
+  ghost_ros_interfaces::SerialLoopbackHarness harness(robot_config_ptr, config);
+
+  printf(
+    "Running %dms, sensor update period %ldus, byte error rate %g\n",
+    duration_ms, (long) config.sensor_update_period.count(), config.byte_error_rate);
+  auto results = harness.run(std::chrono::milliseconds(duration_ms));
+  printf("%s", results.getSummary().c_str());
+  return 0;
+}
@@ -0,0 +1,466 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <ghost_ros_interfaces/serial/serial_loopback_harness.hpp>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ghost_serial/base_interfaces/jetson_epoll_serial_base.hpp>
+#include <ghost_serial/base_interfaces/jetson_serial_base.hpp>
+#include <ghost_serial/msg_parser/msg_parser.hpp>
+#include <ghost_v5_interfaces/robot_hardware_interface.hpp>
+
+using ghost_v5_interfaces::RobotHardwareInterface;
+using ghost_v5_interfaces::devices::hardware_type_e;
+using ghost_v5_interfaces::devices::device_type_e;
+using ghost_v5_interfaces::devices::MotorDeviceData;
+using std::chrono::steady_clock;
+
+namespace ghost_ros_interfaces
+{
+
+namespace
+{
+
+const std::string SENSOR_UPDATE_START_SEQ = "sout";
+const std::string ACTUATOR_COMMAND_START_SEQ = "msg";
+
+// Time allowed after the last sensor update for msgs still in flight
+constexpr auto DRAIN_TIME = std::chrono::milliseconds(50);
+
+int64_t toMicroseconds(steady_clock::duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+// What the simulated V5 Brain sent for one sensor update
+struct SentMsg
+{
+  std::vector<unsigned char> payload;
+  int len = 0;
+  steady_clock::time_point send_time;
+  bool follows_corruption = false;
+  bool received = false;
+  bool echoed = false;
+};
+
+/**
+ * @brief The most recent sensor updates sent by the simulated V5 Brain, by send order.
+ *
+ * Msg ids are one byte on the wire, while a pty can buffer well over 256 msgs when sending flat out. A
+ * received msg is therefore matched against every remembered msg which shares its id, newest first.
+ */
+class SentMsgHistory
+{
+public:
+  static constexpr uint64_t HISTORY_LEN = 4096;
+
+  explicit SentMsgHistory(int max_msg_len)
+  : msgs_(HISTORY_LEN),
+    num_sent_(0)
+  {
+    for (auto & sent_msg : msgs_) {
+      sent_msg.payload.resize(max_msg_len);
+    }
+  }
+
+  std::mutex & mutex()
+  {
+    return mutex_;
+  }
+
+  // Caller must hold mutex()
+  SentMsg & add()
+  {
+    auto & sent_msg = msgs_[num_sent_++ % HISTORY_LEN];
+    sent_msg.received = false;
+    sent_msg.echoed = false;
+    return sent_msg;
+  }
+
+  // Returns the newest msg with this id and payload, or nullptr. Caller must hold mutex().
+  SentMsg * findPayload(const unsigned char * msg, int msg_len)
+  {
+    return findNewest(
+      msg[1], [&](const SentMsg & sent_msg) {
+        return (sent_msg.len == msg_len) && (memcmp(sent_msg.payload.data(), msg, msg_len) == 0);
+      });
+  }
+
+  // Returns the newest msg with this id which reached the Jetson but has no actuator command yet, or
+  // nullptr. Caller must hold mutex().
+  SentMsg * findUnanswered(int msg_id)
+  {
+    return findNewest(
+      msg_id, [](const SentMsg & sent_msg) {
+        return sent_msg.received && !sent_msg.echoed;
+      });
+  }
+
+private:
+  template<typename Predicate>
+  SentMsg * findNewest(int msg_id, Predicate && predicate)
+  {
+    if (num_sent_ == 0) {
+      return nullptr;
+    }
+    uint64_t last = num_sent_ - 1;
+    uint64_t offset = (last - msg_id) & 0xFF;
+    for (; (offset <= last) && (offset < HISTORY_LEN); offset += 256) {
+      auto & sent_msg = msgs_[(last - offset) % HISTORY_LEN];
+      if (predicate(sent_msg)) {
+        return &sent_msg;
+      }
+    }
+    return nullptr;
+  }
+
+  std::mutex mutex_;
+  std::vector<SentMsg> msgs_;
+  uint64_t num_sent_;
+};
+
+/**
+ * @brief Flips one random bit in randomly chosen bytes. The gap to the next damaged byte is drawn from a
+ * geometric distribution, so clean bytes cost a single decrement.
+ */
+class ByteNoise
+{
+public:
+  ByteNoise(double byte_error_rate, unsigned int seed)
+  : enabled_(byte_error_rate > 0.0),
+    rng_(seed),
+    gap_dist_(enabled_ ? std::min(byte_error_rate, 1.0) : 0.5),
+    bit_dist_(0, 7)
+  {
+    bytes_until_error_ = enabled_ ? gap_dist_(rng_) : 0;
+  }
+
+  // Returns true if any byte was changed
+  bool apply(unsigned char * buffer, int num_bytes)
+  {
+    if (!enabled_) {
+      return false;
+    }
+    bool changed = false;
+    int i = 0;
+    while (bytes_until_error_ < num_bytes - i) {
+      i += bytes_until_error_;
+      buffer[i] ^= (unsigned char) (1 << bit_dist_(rng_));
+      changed = true;
+      i++;
+      bytes_until_error_ = gap_dist_(rng_);
+    }
+    bytes_until_error_ -= num_bytes - i;
+    return changed;
+  }
+
+private:
+  bool enabled_;
+  std::mt19937 rng_;
+  std::geometric_distribution<int> gap_dist_;
+  std::uniform_int_distribution<int> bit_dist_;
+  int bytes_until_error_;
+};
+
+} // namespace
+
+std::string SerialLoopbackResults::getSummary() const
+{
+  char line[160];
+  std::string summary;
+  snprintf(
+    line, sizeof(line), "duration: %.2fs, intact sensor updates: %.1f msgs/s, actuator commands: %.1f msgs/s\n",
+    duration_s, getIntactSensorUpdateRate(), getActuatorCommandRate());
+  summary += line;
+  snprintf(
+    line, sizeof(line), "sensor updates: %lu sent (%lu corrupted), %lu received, %lu intact\n",
+    (unsigned long) sensor_updates_sent, (unsigned long) corrupted_sensor_updates_sent,
+    (unsigned long) sensor_updates_received, (unsigned long) intact_sensor_updates_received);
+  summary += line;
+  snprintf(
+    line, sizeof(line),
+    "corrupted accepted: %lu, dropped delta frames: %lu, jetson queue drops: %u\n",
+    (unsigned long) corrupted_sensor_updates_accepted, (unsigned long) dropped_delta_frames,
+    jetson_dropped_read_msgs);
+  summary += line;
+  snprintf(
+    line, sizeof(line), "recovered after corruption: %lu / %lu\n",
+    (unsigned long) updates_after_corruption_received, (unsigned long) updates_after_corruption_sent);
+  summary += line;
+  snprintf(
+    line, sizeof(line), "actuator commands: %lu sent, %lu received\n",
+    (unsigned long) actuator_commands_sent, (unsigned long) actuator_commands_received);
+  summary += line;
+
+  const std::pair<const char *, const ghost_util::LatencyHistogram *> histograms[] = {
+    {"one_way", &sensor_update_latency},
+    {"round_trip", &round_trip_latency}
+  };
+  for (const auto & entry : histograms) {
+    snprintf(
+      line, sizeof(line), "%-10s n=%-8lu p50=%6ldus p99=%6ldus max=%6ldus\n",
+      entry.first, (unsigned long) entry.second->getCount(),
+      (long) entry.second->getPercentile(50.0), (long) entry.second->getPercentile(99.0),
+      (long) entry.second->getMax());
+    summary += line;
+  }
+  return summary;
+}
+
+SerialLoopbackHarness::SerialLoopbackHarness(
+  std::shared_ptr<ghost_v5_interfaces::devices::DeviceConfigMap> robot_config_ptr,
+  SerialLoopbackConfig config)
+: robot_config_ptr_(robot_config_ptr),
+  config_(config)
+{
+  if (config_.sensor_update_period.count() < 0) {
+    throw std::runtime_error(
+            "[SerialLoopbackHarness::SerialLoopbackHarness] Error: sensor_update_period must be non-negative.");
+  }
+  if ((config_.byte_error_rate < 0.0) || (config_.byte_error_rate > 1.0)) {
+    throw std::runtime_error(
+            "[SerialLoopbackHarness::SerialLoopbackHarness] Error: byte_error_rate must be in [0, 1].");
+  }
+}
+
+SerialLoopbackResults SerialLoopbackHarness::run(std::chrono::milliseconds duration)
+{
+  SerialLoopbackResults results;
+
+  int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_fd < 0) {
+    throw std::runtime_error("[SerialLoopbackHarness::run] Error: failed to open pty master.");
+  }
+  if ((grantpt(master_fd) != 0) || (unlockpt(master_fd) != 0)) {
+    close(master_fd);
+    throw std::runtime_error("[SerialLoopbackHarness::run] Error: failed to unlock pty slave.");
+  }
+  std::string port_name = ptsname(master_fd);
+
+  // Simulated V5 Brain
+  RobotHardwareInterface v5_rhi(robot_config_ptr_, hardware_type_e::V5_BRAIN);
+  const int sensor_update_max_len = v5_rhi.getSensorUpdateMsgLength();
+  const int actuator_command_len = v5_rhi.getActuatorCommandMsgLength();
+
+  // Jetson
+  RobotHardwareInterface jetson_rhi(robot_config_ptr_, hardware_type_e::COPROCESSOR);
+  auto jetson_serial = std::make_shared<ghost_serial::JetsonEpollSerialBase>(
+    ACTUATOR_COMMAND_START_SEQ,
+    SENSOR_UPDATE_START_SEQ,
+    sensor_update_max_len,
+    actuator_command_len,
+    config_.use_checksum);
+  jetson_serial->setReadTimeout(std::chrono::milliseconds(10));
+  if (!jetson_serial->trySerialInit(port_name)) {
+    close(master_fd);
+    throw std::runtime_error("[SerialLoopbackHarness::run] Error: failed to open " + port_name + ".");
+  }
+
+  SentMsgHistory sent_msgs(sensor_update_max_len);
+
+  std::atomic_bool jetson_running(true);
+  std::thread jetson_thread([&]() {
+      std::vector<unsigned char> sensor_update(sensor_update_max_len);
+      std::vector<unsigned char> actuator_command(actuator_command_len);
+      int msg_len;
+      while (jetson_running) {
+        if (!jetson_serial->readMsgFromSerial(sensor_update, msg_len)) {
+          continue;
+        }
+        auto read_time = steady_clock::now();
+        results.sensor_updates_received++;
+
+        bool intact = false;
+        if (msg_len >= RobotHardwareInterface::SENSOR_UPDATE_HEADER_LENGTH) {
+          std::lock_guard<std::mutex> lock(sent_msgs.mutex());
+          auto sent_msg = sent_msgs.findPayload(sensor_update.data(), msg_len);
+          intact = (sent_msg != nullptr);
+          if (intact && !sent_msg->received) {
+            sent_msg->received = true;
+            results.intact_sensor_updates_received++;
+            results.updates_after_corruption_received += sent_msg->follows_corruption;
+            results.sensor_update_latency.record(toMicroseconds(read_time - sent_msg->send_time));
+          }
+        }
+        if (!intact) {
+          results.corrupted_sensor_updates_accepted++;
+        }
+
+        // Respond like JetsonV5SerialNode, skipping anything the RHI refuses to parse
+        try {
+          if (jetson_rhi.deserialize(sensor_update.data(), msg_len) == 0) {
+            results.dropped_delta_frames++;
+            continue;
+          }
+        } catch (const std::exception & e) {
+          continue;
+        }
+        jetson_rhi.serialize(actuator_command.data(), actuator_command_len);
+        if (jetson_serial->writeMsgToSerial(actuator_command.data(), actuator_command_len)) {
+          results.actuator_commands_sent++;
+        }
+      }
+    });
+
+  // The V5 side runs on this thread: send on schedule, parse actuator commands in between
+  ghost_serial::MsgParser command_parser(
+    actuator_command_len, ACTUATOR_COMMAND_START_SEQ, config_.use_checksum);
+  ByteNoise noise(config_.byte_error_rate, config_.noise_seed);
+
+  // Never opened, only frames sensor updates with the same encoder the V5 serial base uses
+  ghost_serial::JetsonSerialBase v5_encoder(
+    SENSOR_UPDATE_START_SEQ,
+    ACTUATOR_COMMAND_START_SEQ,
+    actuator_command_len,
+    config_.use_checksum);
+  std::vector<unsigned char> payload(sensor_update_max_len);
+  std::vector<unsigned char> raw_msg(SENSOR_UPDATE_START_SEQ.size() + sensor_update_max_len + 1);
+  std::vector<unsigned char> encoded_msg(v5_encoder.getMaxEncodedMsgLength(sensor_update_max_len));
+  std::vector<unsigned char> read_buffer(1024);
+
+  std::vector<std::string> motor_names;
+  for (const auto & name : v5_rhi) {
+    if (v5_rhi.getDevicePair(name).config_ptr->type == device_type_e::MOTOR) {
+      motor_names.push_back(name);
+    }
+  }
+
+  auto start_time = steady_clock::now();
+  auto send_end_time = start_time + duration;
+  auto next_send_time = start_time;
+  int msg_id = 0;
+  bool last_msg_corrupted = false;
+  bool write_failed = false;
+
+  while (!write_failed) {
+    auto now = steady_clock::now();
+    if (now >= send_end_time + DRAIN_TIME) {
+      break;
+    }
+
+    if ((now < send_end_time) && (now >= next_send_time)) {
+      // Move the motors so delta frames carry real changes
+      for (const auto & name : motor_names) {
+        auto motor_data = v5_rhi.getDeviceData<MotorDeviceData>(name);
+        motor_data->curr_position += 0.5;
+        motor_data->curr_velocity_rpm = (float) (msg_id % 200);
+        v5_rhi.setDeviceData(motor_data);
+      }
+      v5_rhi.setMsgID(msg_id);
+      int payload_len = v5_rhi.serialize(payload.data(), sensor_update_max_len);
+      int encoded_len = v5_encoder.encodeMsg(
+        payload.data(), payload_len, raw_msg.data(), encoded_msg.data());
+      bool corrupted = noise.apply(encoded_msg.data(), encoded_len);
+
+      {
+        std::lock_guard<std::mutex> lock(sent_msgs.mutex());
+        auto & sent_msg = sent_msgs.add();
+        memcpy(sent_msg.payload.data(), payload.data(), payload_len);
+        sent_msg.len = payload_len;
+        sent_msg.follows_corruption = !corrupted && last_msg_corrupted;
+        sent_msg.send_time = steady_clock::now();
+      }
+
+      int bytes_written = 0;
+      while (bytes_written < encoded_len) {
+        int n = write(master_fd, encoded_msg.data() + bytes_written, encoded_len - bytes_written);
+        if (n < 0) {
+          write_failed = true;
+          break;
+        }
+        bytes_written += n;
+      }
+
+      results.sensor_updates_sent++;
+      results.corrupted_sensor_updates_sent += corrupted;
+      results.updates_after_corruption_sent += (!corrupted && last_msg_corrupted);
+      last_msg_corrupted = corrupted;
+      msg_id = (msg_id + 1) & 0xFF;
+
+      next_send_time += config_.sensor_update_period;
+      if (next_send_time < now) {
+        next_send_time = now;     // Don't burst to catch up after a stall
+      }
+    }
+
+    // Wait for actuator commands until the next sensor update is due (only polls when sending flat out)
+    now = steady_clock::now();
+    auto wait_until = (now < send_end_time) ? next_send_time : send_end_time + DRAIN_TIME;
+    auto wait_us = std::max<int64_t>(toMicroseconds(wait_until - now), 0);
+    struct timespec timeout;
+    timeout.tv_sec = wait_us / 1000000;
+    timeout.tv_nsec = (wait_us % 1000000) * 1000;
+    struct pollfd pfd{master_fd, POLLIN, 0};
+    if (ppoll(&pfd, 1, &timeout, nullptr) <= 0) {
+      continue;
+    }
+
+    int bytes_read = read(master_fd, read_buffer.data(), read_buffer.size());
+    if (bytes_read <= 0) {
+      continue;
+    }
+    auto read_time = steady_clock::now();
+    command_parser.parseByteStream(
+      read_buffer.data(), bytes_read,
+      [&](const unsigned char * msg, int msg_len) {
+        results.actuator_commands_received++;
+        try {
+          v5_rhi.deserialize(msg, msg_len);
+        } catch (const std::exception & e) {
+          return;
+        }
+        std::lock_guard<std::mutex> lock(sent_msgs.mutex());
+        auto sent_msg = sent_msgs.findUnanswered(msg[1]);
+        if (sent_msg != nullptr) {
+          sent_msg->echoed = true;
+          results.round_trip_latency.record(toMicroseconds(read_time - sent_msg->send_time));
+        }
+      });
+  }
+  results.duration_s = std::chrono::duration<double>(duration).count();
+
+  jetson_running = false;
+  jetson_thread.join();
+  results.jetson_dropped_read_msgs = jetson_serial->getDroppedReadMsgCount();
+  jetson_serial.reset();
+  close(master_fd);
+
+  return results;
+}
+
+} // namespace ghost_ros_interfaces
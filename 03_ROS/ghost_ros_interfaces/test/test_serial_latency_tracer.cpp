@@ -0,0 +1,118 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include "ghost_ros_interfaces/serial/serial_latency_tracer.hpp"
+
+using ghost_ros_interfaces::SerialLatencyTracer;
+using namespace std::chrono_literals;
+
+class TestSerialLatencyTracer : public ::testing::Test
+{
+protected:
+  // Runs one sensor update and its actuator command through every stage, 1ms apart
+  void traceMsg(int msg_id, SerialLatencyTracer::clock::time_point start)
+  {
+    tracer_.recordSensorUpdate(msg_id, start, start + 1ms);
+    tracer_.recordStage(msg_id, SerialLatencyTracer::PUBLISH, start + 2ms);
+    tracer_.recordStage(msg_id, SerialLatencyTracer::COMMAND, start + 3ms);
+    tracer_.recordStage(msg_id, SerialLatencyTracer::WRITE, start + 4ms);
+    tracer_.recordEcho(msg_id, start + 5ms);
+  }
+
+  SerialLatencyTracer tracer_;
+};
+
+TEST_F(TestSerialLatencyTracer, testFullTrace) {
+  auto start = SerialLatencyTracer::clock::now();
+  for (int i = 0; i < 10; i++) {
+    traceMsg(i, start + i * 10ms);
+  }
+
+  auto stats = tracer_.getIntervalStats();
+  ASSERT_EQ(stats.size(), 7u);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(stats[i].count, 10u);
+    EXPECT_EQ(stats[i].p50_us, 1000);
+    EXPECT_EQ(stats[i].max_us, 1000);
+  }
+  EXPECT_EQ(stats[5].name, "jetson_total");
+  EXPECT_EQ(stats[5].max_us, 4000);
+  EXPECT_EQ(stats[6].name, "round_trip");
+  EXPECT_EQ(stats[6].max_us, 5000);
+
+  EXPECT_EQ(tracer_.getSensorUpdateCount(), 10u);
+  EXPECT_EQ(tracer_.getDroppedSensorUpdateCount(), 0u);
+  EXPECT_EQ(tracer_.getWrittenCommandCount(), 10u);
+  EXPECT_EQ(tracer_.getEchoedCommandCount(), 10u);
+}
+
+TEST_F(TestSerialLatencyTracer, testRepeatsAndOutOfOrderStagesAreIgnored) {
+  auto start = SerialLatencyTracer::clock::now();
+  tracer_.recordSensorUpdate(7, start, start + 1ms);
+
+  // Command without a publish, then a second command and repeated echoes
+  tracer_.recordStage(7, SerialLatencyTracer::COMMAND, start + 2ms);
+  tracer_.recordStage(7, SerialLatencyTracer::PUBLISH, start + 2ms);
+  tracer_.recordStage(7, SerialLatencyTracer::COMMAND, start + 3ms);
+  tracer_.recordStage(7, SerialLatencyTracer::COMMAND, start + 9ms);
+  tracer_.recordStage(7, SerialLatencyTracer::WRITE, start + 4ms);
+  tracer_.recordEcho(7, start + 5ms);
+  tracer_.recordEcho(7, start + 15ms);
+
+  // Unknown msg id
+  tracer_.recordEcho(8, start + 5ms);
+
+  auto stats = tracer_.getIntervalStats();
+  EXPECT_EQ(stats[2].name, "control");
+  EXPECT_EQ(stats[2].count, 1u);
+  EXPECT_EQ(stats[2].max_us, 1000);
+  EXPECT_EQ(stats[6].count, 1u);
+  EXPECT_EQ(stats[6].max_us, 5000);
+  EXPECT_EQ(tracer_.getEchoedCommandCount(), 1u);
+}
+
+TEST_F(TestSerialLatencyTracer, testDroppedSensorUpdatesAndWrap) {
+  auto start = SerialLatencyTracer::clock::now();
+  for (int msg_id : {250, 251, 254, 255, 256, 259}) {
+    tracer_.recordSensorUpdate(msg_id, start, start);
+  }
+  EXPECT_EQ(tracer_.getSensorUpdateCount(), 6u);
+  EXPECT_EQ(tracer_.getDroppedSensorUpdateCount(), 4u);
+
+  // V5 restart is not counted as drops
+  tracer_.recordSensorUpdate(0, start, start);
+  EXPECT_EQ(tracer_.getDroppedSensorUpdateCount(), 4u);
+}
+
+TEST_F(TestSerialLatencyTracer, testStaleTracesAreIgnored) {
+  auto start = SerialLatencyTracer::clock::now();
+  tracer_.recordSensorUpdate(3, start, start + 1ms);
+  tracer_.recordStage(3, SerialLatencyTracer::PUBLISH, start + 2s);
+  EXPECT_EQ(tracer_.getIntervalStats()[1].count, 0u);
+
+  tracer_.reset();
+  EXPECT_EQ(tracer_.getSensorUpdateCount(), 0u);
+  EXPECT_EQ(tracer_.getIntervalStats()[0].count, 0u);
+  EXPECT_FALSE(tracer_.getSummary().empty());
+}
@@ -28,6 +28,10 @@ def generate_launch_description():
     plugin_type = "ghost_swerve::SwerveRobotPlugin"
     robot_name = "ghost_24"
 
+    # Runs the serial node inside competition_state_machine_node, so sensor updates and actuator
+    # commands are handed over in-process instead of through DDS
+    compose_serial_node = False
+
     ghost_swerve_share_dir = get_package_share_directory("ghost_swerve")
     bt_path = os.path.join(ghost_swerve_share_dir, "config", "bt.xml")
 
@@ -57,7 +61,8 @@ def generate_launch_description():
                 "bt_path": bt_path,
             },
         ],
-        arguments=[plugin_type, robot_name],
+        arguments=[plugin_type, robot_name]
+        + (["--compose-serial-node"] if compose_serial_node else []),
         # arguments=["--ros-args", "--log-level", "debug"]
     )
 
@@ -154,8 +159,8 @@ def generate_launch_description():
     )
 
     return LaunchDescription(
-        [
-            serial_node,
+        ([] if compose_serial_node else [serial_node])
+        + [
             competition_state_machine_node,
             bag_recorder_service,
             ekf_pf_node,  # THIS ONE
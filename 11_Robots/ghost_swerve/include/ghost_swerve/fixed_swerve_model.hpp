@@ -0,0 +1,691 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "eigen3/Eigen/Dense"
+#include <ghost_swerve/swerve_model.hpp>
+#include <ghost_util/angle_util.hpp>
+#include <ghost_util/math_util.hpp>
+#include <ghost_util/unit_conversion_utils.hpp>
+
+namespace ghost_swerve
+{
+
+/**
+ * @brief Swerve model with the module count fixed at compile time.
+ *
+ * Computes the same estimates and commands as SwerveModel, but modules are addressed by index and
+ * all state lives in fixed-size arrays and Eigen types, so updates never touch the heap. Module
+ * indices follow the sorted order of the module names in SwerveConfig::module_positions, which is
+ * the order SwerveModel iterates them in. Use getModuleIndex() once at setup to look them up.
+ *
+ * The ICR least squares problem is solved in closed form: eliminating the per-module distances
+ * leaves a 2x2 system in the ICR point, and the task space Jacobian pseudo-inverse is computed once
+ * at construction.
+ *
+ * @tparam N number of swerve modules
+ */
+template<int N>
+class FixedSwerveModel
+{
+  static_assert(N >= 2, "FixedSwerveModel requires at least two modules");
+
+public:
+  using TaskSpaceJacobian = Eigen::Matrix<double, 3, 2 * N>;
+  using TaskSpaceJacobianInverse = Eigen::Matrix<double, 2 * N, 3>;
+  using ModuleVelocityVector = Eigen::Matrix<double, 2 * N, 1>;
+
+  explicit FixedSwerveModel(const SwerveConfig & config)
+  : m_config(config)
+  {
+    validateConfig();
+    calculateJacobians();
+    calculateMaxBaseTwist();
+  }
+
+  static constexpr int getNumModules()
+  {
+    return N;
+  }
+
+  /**
+   * @brief Get the Swerve Model Configration
+   *
+   * @return const SwerveConfig&
+   */
+  const SwerveConfig & getConfig() const
+  {
+    return m_config;
+  }
+
+  /**
+   * @brief Returns the index of a module by name. Not meant for the control loop.
+   *
+   * @param name
+   * @return int
+   */
+  int getModuleIndex(const std::string & name) const
+  {
+    for (int i = 0; i < N; i++) {
+      if (m_module_names[i] == name) {
+        return i;
+      }
+    }
+    throw std::runtime_error(
+            "[FixedSwerveModel::getModuleIndex] Error: " + name +
+            " is not a known swerve module!");
+  }
+
+  const std::string & getModuleName(int index) const
+  {
+    return m_module_names[index];
+  }
+
+  const Eigen::Vector2d & getModulePosition(int index) const
+  {
+    return m_module_positions[index];
+  }
+
+  /**
+   * @brief Updates a swerve module state by module index.
+   *
+   * @param index
+   * @param state
+   */
+  void setModuleState(int index, ModuleState state)
+  {
+    state.steering_angle = ghost_util::WrapAngle360(state.steering_angle);
+    m_previous_module_states[index] = m_current_module_states[index];
+    m_current_module_states[index] = state;
+  }
+
+  const ModuleState & getCurrentModuleState(int index) const
+  {
+    return m_current_module_states[index];
+  }
+
+  const ModuleState & getPreviousModuleState(int index) const
+  {
+    return m_previous_module_states[index];
+  }
+
+  /**
+   * @brief Updates a swerve module command by module index.
+   *
+   * @param index
+   * @param command
+   */
+  void setModuleCommand(int index, ModuleCommand command)
+  {
+    command.steering_angle_command = ghost_util::WrapAngle360(command.steering_angle_command);
+    m_previous_module_states[index] = m_current_module_states[index];
+    m_module_commands[index] = command;
+  }
+
+  const ModuleCommand & getModuleCommand(int index) const
+  {
+    return m_module_commands[index];
+  }
+
+  /**
+   * @brief Calculates various attributes of the swerve model based on the current Module States.
+   * Call after updating all modules with new sensor data.
+   */
+  void updateSwerveModel()
+  {
+    updateBaseTwist();
+    calculateLeastSquaresICREstimate();
+    calculateOdometry();
+  }
+
+  /// Jacobians ///
+  const Eigen::Matrix2d & getModuleJacobian() const
+  {
+    return m_module_jacobian;
+  }
+
+  const Eigen::Matrix2d & getModuleJacobianInverse() const
+  {
+    return m_module_jacobian_inv;
+  }
+
+  const Eigen::Matrix2d & getModuleJacobianTranspose() const
+  {
+    return m_module_jacobian_transpose;
+  }
+
+  const Eigen::Matrix2d & getModuleJacobianInverseTranspose() const
+  {
+    return m_module_jacobian_inv_transpose;
+  }
+
+  const TaskSpaceJacobian & getTaskSpaceJacobian() const
+  {
+    return m_task_space_jacobian;
+  }
+
+  const TaskSpaceJacobianInverse & getTaskSpaceJacobianInverse() const
+  {
+    return m_task_space_jacobian_inverse;
+  }
+
+  double getMaxBaseLinearVelocity() const
+  {
+    return m_max_base_lin_vel;
+  }
+
+  double getMaxBaseAngularVelocity() const
+  {
+    return m_max_base_ang_vel;
+  }
+
+  /**
+   * @brief Gets the current estimate for the Instant Center of Rotation in the 2D plane.
+   * If the ICR is at infinity, we return true and a unit vector in the direction of the ICR.
+   *
+   * @param icr_point
+   * @return true if ICR is at infinity
+   */
+  bool getICR(Eigen::Vector2d & icr_point) const
+  {
+    icr_point = m_icr_point;
+    return m_straight_line_translation;
+  }
+
+  double getICRSSE() const
+  {
+    return m_icr_sse;
+  }
+
+  double getICRQuality() const
+  {
+    return m_icr_quality;
+  }
+
+  double getLeastSquaresErrorMetric() const
+  {
+    return m_ls_error_metric;
+  }
+
+  /**
+   * @brief Updates module wheel and steering setpoints given a base twist.
+   *
+   * @param right_cmd
+   * @param forward_cmd
+   * @param clockwise_cmd
+   */
+  void calculateKinematicSwerveControllerNormalized(
+    double right_cmd, double forward_cmd,
+    double clockwise_cmd)
+  {
+    calculateKinematicSwerveControllerVelocity(
+      right_cmd * m_max_base_lin_vel,
+      forward_cmd * m_max_base_lin_vel,
+      clockwise_cmd * m_max_base_ang_vel);
+  }
+
+  void calculateKinematicSwerveControllerJoystick(
+    double right_cmd, double forward_cmd,
+    double clockwise_cmd)
+  {
+    calculateKinematicSwerveControllerNormalized(
+      right_cmd / 127.0, forward_cmd / 127.0,
+      clockwise_cmd / 127.0);
+  }
+
+  void calculateKinematicSwerveControllerAngleControl(
+    double right_cmd, double forward_cmd,
+    double angle_cmd)
+  {
+    angle_cmd = ghost_util::WrapAngle2PI(angle_cmd);
+    double vel_cmd =
+      ghost_util::SmallestAngleDistRad(angle_cmd, m_world_angle) * m_config.angle_control_kp;
+    calculateKinematicSwerveControllerNormalized(right_cmd / 127.0, forward_cmd / 127.0, -vel_cmd);
+  }
+
+  void calculateKinematicSwerveControllerMoveToPoseWorld(
+    double des_x, double des_y,
+    double angle_cmd)
+  {
+    double x_vel = (des_x - m_odom_loc.x()) * m_config.move_to_pose_kp;
+    double y_vel = (des_y - m_odom_loc.y()) * m_config.move_to_pose_kp;
+    calculateKinematicSwerveControllerAngleControl(-y_vel, x_vel, angle_cmd);
+  }
+
+  void calculateKinematicSwerveControllerVelocity(
+    double right_cmd, double forward_cmd,
+    double clockwise_cmd)
+  {
+    // Convert joystick to robot twist command
+    Eigen::Vector2d xy_vel_cmd_base_link(forward_cmd, -right_cmd);
+
+    if (m_is_field_oriented) {
+      xy_vel_cmd_base_link =
+        Eigen::Rotation2D<double>(-m_world_angle).toRotationMatrix() * xy_vel_cmd_base_link;
+    }
+    double lin_vel_cmd = std::clamp<double>(
+      xy_vel_cmd_base_link.norm(), -m_max_base_lin_vel, m_max_base_lin_vel);
+    double ang_vel_cmd =
+      std::clamp<double>(-clockwise_cmd, -m_max_base_ang_vel, m_max_base_ang_vel);
+
+    // Zero commands under 1%
+    lin_vel_cmd = (std::fabs(lin_vel_cmd) > m_max_base_lin_vel * 0.01) ? lin_vel_cmd : 0.0;
+    ang_vel_cmd = (std::fabs(ang_vel_cmd) > m_max_base_ang_vel * 0.01) ? ang_vel_cmd : 0.0;
+
+    // For combined linear and angular velocities, we scale down angular velocity.
+    if (m_swerve_heuristics_enabled &&
+      (std::fabs(lin_vel_cmd) > m_max_base_lin_vel * m_config.velocity_scaling_threshold) &&
+      (std::fabs(ang_vel_cmd) > m_max_base_ang_vel * m_config.velocity_scaling_threshold))
+    {
+      ang_vel_cmd *= m_config.velocity_scaling_ratio;
+    }
+
+    Eigen::Vector2d linear_vel_dir(0.0, 0.0);
+    if (xy_vel_cmd_base_link.norm() != 0) {
+      linear_vel_dir = xy_vel_cmd_base_link.normalized();
+    }
+
+    m_base_vel_cmd = Eigen::Vector3d(
+      ghost_util::slewRate(m_base_vel_cmd[0], xy_vel_cmd_base_link.x(), m_config.max_lin_vel_slew),
+      ghost_util::slewRate(m_base_vel_cmd[1], xy_vel_cmd_base_link.y(), m_config.max_lin_vel_slew),
+      ghost_util::slewRate(m_base_vel_cmd[2], ang_vel_cmd, m_config.max_ang_vel_slew));
+
+    double max_steering_error = 0.0;
+    for (int i = 0; i < N; i++) {
+      const Eigen::Vector2d & position = m_module_positions[i];
+      const ModuleState & state = m_current_module_states[i];
+      ModuleCommand & command = m_module_commands[i];
+
+      // Calculate naive steering angle and wheel velocity setpoints
+      Eigen::Vector2d velocity_vector =
+        ang_vel_cmd * Eigen::Vector2d(-position.y(), position.x()) + linear_vel_dir * lin_vel_cmd;
+
+      command = ModuleCommand();
+      command.wheel_velocity_vector = velocity_vector;
+      command.steering_angle_command = ghost_util::WrapAngle360(
+        atan2(velocity_vector.y(), velocity_vector.x()) * ghost_util::RAD_TO_DEG);
+      command.wheel_velocity_command = velocity_vector.norm() * LIN_VEL_TO_RPM;
+
+      double steering_error = ghost_util::SmallestAngleDistDeg(
+        command.steering_angle_command, state.steering_angle);
+
+      if (std::fabs(steering_error) > 90.0) {
+        command.wheel_velocity_command *= -1.0;
+        command.steering_angle_command = ghost_util::FlipAngle180(command.steering_angle_command);
+        steering_error = ghost_util::SmallestAngleDistDeg(
+          command.steering_angle_command, state.steering_angle);
+      }
+
+      m_error_sum[i] = ghost_util::clamp<double>(
+        m_error_sum[i] + steering_error * m_config.controller_dt,
+        -m_config.steering_ki_limit,
+        m_config.steering_ki_limit);
+      max_steering_error = std::max(max_steering_error, std::fabs(steering_error));
+
+      command.steering_velocity_command = steering_error * m_config.steering_kp +
+        m_error_sum[i] * m_config.steering_ki -
+        state.steering_velocity * m_config.steering_kd;
+
+      if (std::fabs(steering_error) < m_config.steering_control_deadzone) {
+        command.steering_velocity_command = 0.0;
+      }
+    }
+
+    // Transient Misalignment Heuristic
+    const double x1 = m_config.angle_heuristic_start_angle;
+    if (max_steering_error > x1) {
+      const double x2 = m_config.angle_heuristic_end_angle;
+      const double slope = -1.0 / (x2 - x1);
+      const double intercept = 1.0 - slope * x1;
+      const double attenuation_percent = std::max(slope * max_steering_error + intercept, 0.0);
+      for (auto & command : m_module_commands) {
+        command.wheel_velocity_command *= attenuation_percent;
+      }
+    }
+
+    // Calculate commands in Actuator space, normalizing if any motor exceeds its maximum speed
+    double max_velocity = 0.0;
+    for (auto & command : m_module_commands) {
+      command.actuator_velocity_commands = m_module_jacobian_inv *
+        Eigen::Vector2d(command.wheel_velocity_command, command.steering_velocity_command);
+      command.actuator_voltage_commands = m_module_jacobian_transpose *
+        Eigen::Vector2d(command.wheel_voltage_command, command.steering_voltage_command);
+
+      max_velocity = std::max(std::fabs(command.actuator_velocity_commands[0]), max_velocity);
+      if (m_config.module_type == swerve_type_e::DIFFERENTIAL) {
+        max_velocity = std::max(std::fabs(command.actuator_velocity_commands[1]), max_velocity);
+      }
+    }
+
+    if (max_velocity > m_config.max_wheel_actuator_vel) {
+      const double scale = m_config.max_wheel_actuator_vel / max_velocity;
+      for (auto & command : m_module_commands) {
+        if (m_config.module_type == swerve_type_e::DIFFERENTIAL) {
+          command.actuator_velocity_commands *= scale;
+        } else {
+          command.actuator_velocity_commands[0] *= scale;
+        }
+      }
+    }
+
+    // If we don't receive non-zero user input, zero everything
+    if ((std::fabs(lin_vel_cmd) < 1e-5) && (std::fabs(ang_vel_cmd) < 1e-5)) {
+      for (auto & command : m_module_commands) {
+        command.actuator_velocity_commands = Eigen::Vector2d(0.0, 0.0);
+        command.actuator_voltage_commands = Eigen::Vector2d(0.0, 0.0);
+      }
+    }
+  }
+
+  const Eigen::Vector3d & getBaseVelocityCommand() const
+  {
+    return m_base_vel_cmd;
+  }
+
+  const Eigen::Vector3d & getBaseVelocityCurrent() const
+  {
+    return m_base_vel_curr;
+  }
+
+  // Base States
+  const Eigen::Vector2d & getOdometryLocation() const
+  {
+    return m_odom_loc;
+  }
+
+  double getOdometryAngle() const
+  {
+    return m_odom_angle;
+  }
+
+  const Eigen::Vector2d & getWorldLocation() const
+  {
+    return m_world_loc;
+  }
+
+  void setWorldLocation(const double x, const double y)
+  {
+    m_world_loc = Eigen::Vector2d(x, y);
+  }
+
+  double getWorldAngleRad() const
+  {
+    return m_world_angle;
+  }
+
+  void setWorldAngleRad(const double theta)
+  {
+    m_world_angle = theta;
+  }
+
+  bool isFieldOrientedControl() const
+  {
+    return m_is_field_oriented;
+  }
+
+  void setFieldOrientedControl(bool field_oriented_control)
+  {
+    m_is_field_oriented = field_oriented_control;
+  }
+
+  void enableSwerveHeuristics()
+  {
+    m_swerve_heuristics_enabled = true;
+  }
+
+  void disableSwerveHeuristics()
+  {
+    m_swerve_heuristics_enabled = false;
+  }
+
+protected:
+  void validateConfig()
+  {
+    std::unordered_map<std::string, double> larger_than_zero_params{
+      {"max_wheel_lin_vel", m_config.max_wheel_lin_vel},
+      {"max_lin_vel_slew", m_config.max_lin_vel_slew},
+      {"max_ang_vel_slew", m_config.max_ang_vel_slew},
+      {"steering_ratio", m_config.steering_ratio},
+      {"wheel_ratio", m_config.wheel_ratio},
+      {"wheel_radius", m_config.wheel_radius},
+      {"steering_kp", m_config.steering_kp},
+      {"controller_dt", m_config.controller_dt},
+      {"max_wheel_actuator_vel", m_config.max_wheel_actuator_vel}
+    };
+
+    for (const auto & [key, val] : larger_than_zero_params) {
+      if (val <= 0) {
+        throw std::runtime_error(
+                "[FixedSwerveModel::validateConfig] Error: " + key +
+                " must be non-zero and positive!");
+      }
+    }
+
+    std::unordered_map<std::string, double> larger_or_equal_to_zero_params{
+      {"steering_kd", m_config.steering_kd},
+      {"steering_ki", m_config.steering_ki},
+      {"steering_ki_limit", m_config.steering_ki_limit},
+      {"steering_control_deadzone", m_config.steering_control_deadzone},
+      {"angle_heuristic_start_angle", m_config.angle_heuristic_start_angle},
+      {"angle_heuristic_end_angle", m_config.angle_heuristic_end_angle}
+    };
+
+    for (const auto & [key, val] : larger_or_equal_to_zero_params) {
+      if (val < 0) {
+        throw std::runtime_error(
+                "[FixedSwerveModel::validateConfig] Error: " + key + " must be positive!");
+      }
+    }
+
+    if (m_config.module_positions.size() != static_cast<std::size_t>(N)) {
+      throw std::runtime_error(
+              "[FixedSwerveModel::validateConfig] Error: module_positions must have " +
+              std::to_string(N) + " entries (one for each module).");
+    }
+
+    int i = 0;
+    for (const auto & [name, position] : m_config.module_positions) {
+      m_module_names[i] = name;
+      m_module_positions[i] = position;
+      i++;
+    }
+
+    LIN_VEL_TO_RPM = ghost_util::METERS_TO_INCHES / m_config.wheel_radius *
+      ghost_util::RAD_PER_SEC_TO_RPM;
+  }
+
+  void calculateJacobians()
+  {
+    switch (m_config.module_type) {
+      case swerve_type_e::COAXIAL:
+        m_module_jacobian << m_config.wheel_ratio, 0.0, 0.0, m_config.steering_ratio;
+        m_module_jacobian_inv << 1 / m_config.wheel_ratio, 0.0, 0.0, 1 / m_config.steering_ratio;
+        break;
+
+      case swerve_type_e::DIFFERENTIAL:
+        m_module_jacobian << m_config.wheel_ratio / 2.0, -m_config.wheel_ratio / 2.0,
+          m_config.steering_ratio / 2.0, m_config.steering_ratio / 2.0;
+        m_module_jacobian_inv << 1 / m_config.wheel_ratio, 1 / m_config.steering_ratio,
+          -1 / m_config.wheel_ratio, 1 / m_config.steering_ratio;
+        break;
+    }
+
+    m_module_jacobian_transpose = m_module_jacobian.transpose();
+    m_module_jacobian_inv_transpose = m_module_jacobian_inv.transpose();
+
+    // Task Space Jacobians (Transforms module velocity to and from base velocity)
+    m_task_space_jacobian_inverse.setZero();
+    for (int i = 0; i < N; i++) {
+      m_task_space_jacobian_inverse(2 * i, 0) = 1.0;
+      m_task_space_jacobian_inverse(2 * i, 2) = -m_module_positions[i].y();
+      m_task_space_jacobian_inverse(2 * i + 1, 1) = 1.0;
+      m_task_space_jacobian_inverse(2 * i + 1, 2) = m_module_positions[i].x();
+    }
+    m_task_space_jacobian =
+      m_task_space_jacobian_inverse.completeOrthogonalDecomposition().pseudoInverse();
+  }
+
+  void calculateMaxBaseTwist()
+  {
+    double max_wheel_dist = 0.0;
+    for (const auto & position : m_module_positions) {
+      max_wheel_dist = std::max(max_wheel_dist, position.norm());
+    }
+
+    m_max_base_lin_vel = m_config.max_wheel_lin_vel;
+    m_max_base_ang_vel = m_max_base_lin_vel / max_wheel_dist;
+  }
+
+  void updateBaseTwist()
+  {
+    ModuleVelocityVector module_velocity_vector;
+    for (int i = 0; i < N; i++) {
+      const ModuleState & state = m_current_module_states[i];
+      const double angle = state.steering_angle * ghost_util::DEG_TO_RAD;
+      const double speed = state.wheel_velocity / LIN_VEL_TO_RPM;
+      module_velocity_vector[2 * i] = speed * cos(angle);
+      module_velocity_vector[2 * i + 1] = speed * sin(angle);
+    }
+
+    m_base_vel_curr = m_task_space_jacobian * module_velocity_vector;
+    m_ls_error_metric =
+      (module_velocity_vector - m_task_space_jacobian_inverse * m_base_vel_curr).norm();
+
+    m_base_vel_curr[0] = (std::fabs(m_base_vel_curr[0]) > 0.01) ? m_base_vel_curr[0] : 0.0;
+    m_base_vel_curr[1] = (std::fabs(m_base_vel_curr[1]) > 0.01) ? m_base_vel_curr[1] : 0.0;
+    m_base_vel_curr[2] = (std::fabs(m_base_vel_curr[2]) > 0.02) ? m_base_vel_curr[2] : 0.0;
+  }
+
+  /**
+   * @brief Each module contributes the residual of c - p_i * u_i - m_i, where c is the ICR, u_i the
+   * steering axis and m_i the module position. The best p_i projects c - m_i onto u_i, which leaves
+   * sum(P_i) * c = sum(P_i * m_i) with P_i = I - u_i * u_i^T, the projection onto the wheel
+   * direction. That 2x2 system is singular exactly when the full least squares problem is rank
+   * deficient, i.e. when all steering axes are parallel.
+   */
+  void calculateLeastSquaresICREstimate()
+  {
+    std::array<Eigen::Vector2d, N> steering_axes;
+    Eigen::Matrix2d normal_matrix = Eigen::Matrix2d::Zero();
+    Eigen::Vector2d normal_rhs = Eigen::Vector2d::Zero();
+    for (int i = 0; i < N; i++) {
+      const double angle =
+        (m_current_module_states[i].steering_angle + 90.0) * ghost_util::DEG_TO_RAD;
+      steering_axes[i] = Eigen::Vector2d(cos(angle), sin(angle));
+      const Eigen::Matrix2d projection =
+        Eigen::Matrix2d::Identity() - steering_axes[i] * steering_axes[i].transpose();
+      normal_matrix += projection;
+      normal_rhs += projection * m_module_positions[i];
+    }
+
+    // Determinant is the sum of squared sines between axis pairs, so scale the threshold by N^2
+    const double det = normal_matrix.determinant();
+    const bool full_rank = det > N * N * 1e-12;
+
+    if (full_rank) {
+      m_icr_point = normal_matrix.inverse() * normal_rhs;
+
+      double sse = 0.0;
+      for (int i = 0; i < N; i++) {
+        const Eigen::Vector2d offset = m_icr_point - m_module_positions[i];
+        sse += (offset - steering_axes[i].dot(offset) * steering_axes[i]).squaredNorm();
+      }
+      m_icr_sse = std::sqrt(sse);
+    }
+
+    // Handle pure translation
+    m_straight_line_translation = (m_icr_point.norm() > 500.0 || !full_rank);
+    if (m_straight_line_translation) {
+      m_icr_point = steering_axes[0];
+      m_icr_sse = 0.0;
+    }
+
+    double m = 0.0;
+    for (int i = 0; i < N; i++) {
+      Eigen::Vector2d ideal_steering_axis = m_straight_line_translation ?
+        m_icr_point : Eigen::Vector2d((m_icr_point - m_module_positions[i]).normalized());
+      // Both axes are unit vectors, clamp so rounding can't push acos out of its domain
+      double angle = acos(std::clamp(steering_axes[i].dot(ideal_steering_axis), -1.0, 1.0));
+      m += angle * angle / (N * M_PI * M_PI);
+    }
+    double f = 1.0;
+    m_icr_quality = 1 - log(f * m + 1) / log(f + 1);
+  }
+
+  void calculateOdometry()
+  {
+    m_odom_loc += Eigen::Rotation2D<double>(m_odom_angle).toRotationMatrix() *
+      m_base_vel_curr.template head<2>() * 0.01;
+    m_odom_angle = ghost_util::WrapAngle2PI(m_odom_angle + m_base_vel_curr.z() * 0.01);
+  }
+
+  // Configuration
+  SwerveConfig m_config;
+  std::array<std::string, N> m_module_names;
+  std::array<Eigen::Vector2d, N> m_module_positions;
+  double m_max_base_lin_vel = 0;
+  double m_max_base_ang_vel = 0;
+  double LIN_VEL_TO_RPM;
+  bool m_swerve_heuristics_enabled = true;
+  bool m_is_field_oriented = false;
+
+  // Jacobians
+  Eigen::Matrix2d m_module_jacobian;
+  Eigen::Matrix2d m_module_jacobian_inv;
+  Eigen::Matrix2d m_module_jacobian_transpose;
+  Eigen::Matrix2d m_module_jacobian_inv_transpose;
+  TaskSpaceJacobian m_task_space_jacobian;
+  TaskSpaceJacobianInverse m_task_space_jacobian_inverse;
+
+  // Base States
+  Eigen::Vector2d m_odom_loc = Eigen::Vector2d::Zero();
+  double m_odom_angle = 0.0;
+  Eigen::Vector2d m_world_loc = Eigen::Vector2d::Zero();
+  double m_world_angle = 0.0;
+  Eigen::Vector3d m_base_vel_curr = Eigen::Vector3d::Zero();
+  Eigen::Vector3d m_base_vel_cmd = Eigen::Vector3d::Zero();
+
+  // Module States
+  std::array<ModuleState, N> m_previous_module_states{};
+  std::array<ModuleState, N> m_current_module_states{};
+  std::array<ModuleCommand, N> m_module_commands{};
+  std::array<double, N> m_error_sum{};
+
+  // ICR States
+  Eigen::Vector2d m_icr_point = Eigen::Vector2d::Zero();
+  bool m_straight_line_translation = false;
+  double m_icr_quality = 0;
+  double m_icr_sse = 0;
+  double m_ls_error_metric = 0.0;
+};
+
+} // namespace ghost_swerve
@@ -0,0 +1,232 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "eigen3/Eigen/Dense"
+#include <ghost_swerve/swerve_model.hpp>
+
+namespace ghost_swerve
+{
+
+/**
+ * @brief Base twist commands in structure-of-arrays layout, one entry per sample. Units and signs
+ * match SwerveModel::calculateKinematicSwerveControllerVelocity, in the robot frame.
+ */
+struct BaseTwistBatch
+{
+  std::vector<float> right;
+  std::vector<float> forward;
+  std::vector<float> clockwise;
+
+  void resize(std::size_t n)
+  {
+    right.resize(n);
+    forward.resize(n);
+    clockwise.resize(n);
+  }
+
+  std::size_t size() const
+  {
+    return forward.size();
+  }
+};
+
+/**
+ * @brief Measured base velocity per sample: x forward, y left and counter-clockwise angular, as
+ * returned by SwerveModel::getBaseVelocityCurrent.
+ */
+struct BaseVelocityBatch
+{
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> angular;
+  std::vector<float> ls_error_metric;
+
+  void resize(std::size_t n)
+  {
+    x.resize(n);
+    y.resize(n);
+    angular.resize(n);
+    ls_error_metric.resize(n);
+  }
+};
+
+/**
+ * @brief One module's state across all samples. Angles in degrees, velocities in RPM as in
+ * ModuleState.
+ */
+struct ModuleStateBatch
+{
+  std::vector<float> wheel_velocity;
+  std::vector<float> steering_angle;
+  std::vector<float> steering_velocity;
+
+  void resize(std::size_t n)
+  {
+    wheel_velocity.resize(n);
+    steering_angle.resize(n);
+    steering_velocity.resize(n);
+  }
+};
+
+/**
+ * @brief One module's commands across all samples, with the same meaning as ModuleCommand.
+ */
+struct ModuleCommandBatch
+{
+  std::vector<float> steering_angle_command;
+  std::vector<float> wheel_velocity_command;
+  std::vector<float> steering_velocity_command;
+  std::array<std::vector<float>, 2> actuator_velocity_commands;
+
+  void resize(std::size_t n)
+  {
+    steering_angle_command.resize(n);
+    wheel_velocity_command.resize(n);
+    steering_velocity_command.resize(n);
+    actuator_velocity_commands[0].resize(n);
+    actuator_velocity_commands[1].resize(n);
+  }
+};
+
+/**
+ * @brief Controller output for every module, plus whether each sample hit the actuator velocity
+ * limit and was scaled down.
+ */
+struct SwerveCommandBatch
+{
+  std::vector<ModuleCommandBatch> modules;
+  std::vector<uint8_t> saturated;
+};
+
+/**
+ * @brief Command shaping heuristics of the kinematic swerve controller, split out so they can be
+ * swept without rebuilding the batch evaluator.
+ */
+struct SwerveHeuristicParams
+{
+  bool velocity_scaling_enabled = true;
+  double velocity_scaling_ratio;
+  double velocity_scaling_threshold;
+  double angle_heuristic_start_angle;
+  double angle_heuristic_end_angle;
+};
+
+/**
+ * @brief Evaluates swerve kinematics for many base twists and module states at once, for
+ * trajectory validation, MPC warm starts and offline tuning.
+ *
+ * Works on structure-of-arrays float inputs, SIMD_WIDTH samples per instruction, with vectorized
+ * atan2 and sin/cos. Results match SwerveModel to float precision. The evaluator holds no per-robot
+ * state: each sample is computed as if by a freshly constructed SwerveModel, so there is no
+ * steering integral history, command slew or field oriented rotation.
+ *
+ * Module i is the i-th module of SwerveConfig::module_positions in name order, as in
+ * FixedSwerveModel.
+ */
+class SwerveKinematicsBatch
+{
+public:
+  explicit SwerveKinematicsBatch(const SwerveConfig & config);
+
+  int getNumModules() const
+  {
+    return static_cast<int>(m_module_names.size());
+  }
+
+  const std::string & getModuleName(int index) const
+  {
+    return m_module_names[index];
+  }
+
+  int getModuleIndex(const std::string & name) const;
+
+  const SwerveHeuristicParams & getHeuristicParams() const
+  {
+    return m_heuristics;
+  }
+
+  void setHeuristicParams(const SwerveHeuristicParams & params)
+  {
+    m_heuristics = params;
+  }
+
+  /**
+   * @brief Module commands for each (twist, state) sample, following
+   * SwerveModel::calculateKinematicSwerveControllerVelocity.
+   *
+   * @param twists base twist per sample
+   * @param states one entry per module, each sized like twists. Only steering angle and velocity
+   * are used.
+   * @param commands resized to match, reusing its storage between calls
+   */
+  void calculateKinematicSwerveControllerVelocity(
+    const BaseTwistBatch & twists,
+    const std::vector<ModuleStateBatch> & states,
+    SwerveCommandBatch * commands) const;
+
+  /**
+   * @brief Base velocity and least squares error for each module state sample, following
+   * SwerveModel::updateSwerveModel.
+   *
+   * @param states one entry per module, all the same size. Only wheel velocity and steering angle
+   * are used.
+   * @param base_velocity resized to match
+   */
+  void calculateBaseTwist(
+    const std::vector<ModuleStateBatch> & states,
+    BaseVelocityBatch * base_velocity) const;
+
+private:
+  void throwOnSizeMismatch(
+    const std::vector<ModuleStateBatch> & states, std::size_t n,
+    const std::string & method_name) const;
+
+  swerve_type_e m_module_type;
+  std::vector<std::string> m_module_names;
+  std::vector<Eigen::Vector2f> m_module_positions;
+  SwerveHeuristicParams m_heuristics;
+
+  // Constants copied from SwerveModel
+  float m_max_base_lin_vel;
+  float m_max_base_ang_vel;
+  float m_max_actuator_vel;
+  float m_lin_vel_to_rpm;
+  float m_controller_dt;
+  float m_steering_kp;
+  float m_steering_ki;
+  float m_steering_kd;
+  float m_steering_ki_limit;
+  float m_steering_control_deadzone;
+  Eigen::Matrix2f m_module_jacobian_inv;
+  Eigen::MatrixXf m_task_space_jacobian;
+};
+
+} // namespace ghost_swerve
@@ -520,10 +520,10 @@ protected:
 
   // Current centroidal states
   double m_curr_angle;
-  Eigen::Vector3d m_base_vel_curr;
+  Eigen::Vector3d m_base_vel_curr = Eigen::Vector3d::Zero();
 
   // Command Setpoints
-  Eigen::Vector3d m_base_vel_cmd;
+  Eigen::Vector3d m_base_vel_cmd = Eigen::Vector3d::Zero();
 
   // Module States
   std::map<std::string, ModuleState> m_previous_module_states;
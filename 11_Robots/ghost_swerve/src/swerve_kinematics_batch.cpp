@@ -0,0 +1,363 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <ghost_swerve/swerve_kinematics_batch.hpp>
+#include <ghost_util/simd_math.hpp>
+#include <ghost_util/unit_conversion_utils.hpp>
+
+using ghost_util::FloatBatch;
+using ghost_util::IntBatch;
+using ghost_util::SIMD_WIDTH;
+using ghost_util::selectBatch;
+
+namespace ghost_swerve
+{
+
+namespace
+{
+
+FloatBatch loadBatch(const std::vector<float> & data, std::size_t start, std::size_t lanes)
+{
+  FloatBatch batch{};
+  std::memcpy(&batch, data.data() + start, lanes * sizeof(float));
+  return batch;
+}
+
+void storeBatch(FloatBatch batch, std::vector<float> & data, std::size_t start, std::size_t lanes)
+{
+  std::memcpy(data.data() + start, &batch, lanes * sizeof(float));
+}
+
+FloatBatch broadcast(float value)
+{
+  return (FloatBatch){} + value;
+}
+
+FloatBatch absBatch(FloatBatch x)
+{
+  return (FloatBatch)((IntBatch)x & INT32_MAX);
+}
+
+FloatBatch minBatch(FloatBatch a, FloatBatch b)
+{
+  return selectBatch(a < b, a, b);
+}
+
+FloatBatch maxBatch(FloatBatch a, FloatBatch b)
+{
+  return selectBatch(a > b, a, b);
+}
+
+// ghost_util::WrapAngle360 on each lane
+FloatBatch wrapAngle360(FloatBatch angle)
+{
+  FloatBatch turns = angle * (1.0f / 360.0f);
+  FloatBatch whole = __builtin_convertvector(__builtin_convertvector(turns, IntBatch), FloatBatch);
+  whole = selectBatch(whole > turns, whole - 1.0f, whole);
+  angle -= whole * 360.0f;
+  angle = selectBatch(angle >= 360.0f, angle - 360.0f, angle);
+  return selectBatch(angle < 0.0f, angle + 360.0f, angle);
+}
+
+// ghost_util::SmallestAngleDistDeg on each lane
+FloatBatch smallestAngleDistDeg(FloatBatch a2, FloatBatch a1)
+{
+  FloatBatch diff = wrapAngle360(a2) - wrapAngle360(a1);
+  diff = selectBatch(diff > 180.0f, diff - 360.0f, diff);
+  return selectBatch(diff < -180.0f, diff + 360.0f, diff);
+}
+
+// ghost_util::FlipAngle180 on each lane
+FloatBatch flipAngle180(FloatBatch angle)
+{
+  angle = wrapAngle360(angle + 180.0f);
+  return selectBatch(angle > 180.0f, angle - 360.0f, angle);
+}
+
+} // namespace
+
+SwerveKinematicsBatch::SwerveKinematicsBatch(const SwerveConfig & config)
+{
+  // SwerveModel validates the config and owns the kinematics, the batch only borrows its constants
+  SwerveModel model(config);
+
+  m_module_type = config.module_type;
+  for (const auto & [name, position] : config.module_positions) {
+    m_module_names.push_back(name);
+    m_module_positions.push_back(position.cast<float>());
+  }
+
+  m_heuristics.velocity_scaling_ratio = config.velocity_scaling_ratio;
+  m_heuristics.velocity_scaling_threshold = config.velocity_scaling_threshold;
+  m_heuristics.angle_heuristic_start_angle = config.angle_heuristic_start_angle;
+  m_heuristics.angle_heuristic_end_angle = config.angle_heuristic_end_angle;
+
+  m_max_base_lin_vel = model.getMaxBaseLinearVelocity();
+  m_max_base_ang_vel = model.getMaxBaseAngularVelocity();
+  m_max_actuator_vel = config.max_wheel_actuator_vel;
+  m_lin_vel_to_rpm = ghost_util::METERS_TO_INCHES / config.wheel_radius *
+    ghost_util::RAD_PER_SEC_TO_RPM;
+  m_controller_dt = config.controller_dt;
+  m_steering_kp = config.steering_kp;
+  m_steering_ki = config.steering_ki;
+  m_steering_kd = config.steering_kd;
+  m_steering_ki_limit = config.steering_ki_limit;
+  m_steering_control_deadzone = config.steering_control_deadzone;
+  m_module_jacobian_inv = model.getModuleJacobianInverse().cast<float>();
+  m_task_space_jacobian = model.getTaskSpaceJacobian().cast<float>();
+}
+
+int SwerveKinematicsBatch::getModuleIndex(const std::string & name) const
+{
+  auto it = std::find(m_module_names.begin(), m_module_names.end(), name);
+  if (it == m_module_names.end()) {
+    throw std::runtime_error(
+            "[SwerveKinematicsBatch::getModuleIndex] Error: " + name +
+            " is not a known swerve module!");
+  }
+  return static_cast<int>(it - m_module_names.begin());
+}
+
+void SwerveKinematicsBatch::throwOnSizeMismatch(
+  const std::vector<ModuleStateBatch> & states, std::size_t n,
+  const std::string & method_name) const
+{
+  bool sizes_match = (states.size() == m_module_names.size());
+  for (const auto & module : states) {
+    sizes_match &= (module.wheel_velocity.size() == n) && (module.steering_angle.size() == n) &&
+      (module.steering_velocity.size() == n);
+  }
+  if (!sizes_match) {
+    throw std::runtime_error(
+            "[SwerveKinematicsBatch::" + method_name +
+            "] Error: states must hold one batch per module, each with one entry per sample!");
+  }
+}
+
+void SwerveKinematicsBatch::calculateKinematicSwerveControllerVelocity(
+  const BaseTwistBatch & twists,
+  const std::vector<ModuleStateBatch> & states,
+  SwerveCommandBatch * commands) const
+{
+  const std::size_t n = twists.size();
+  if ((twists.right.size() != n) || (twists.clockwise.size() != n)) {
+    throw std::runtime_error(
+            "[SwerveKinematicsBatch::calculateKinematicSwerveControllerVelocity] Error: "
+            "twist arrays must all be the same size!");
+  }
+  throwOnSizeMismatch(states, n, "calculateKinematicSwerveControllerVelocity");
+
+  const int num_modules = getNumModules();
+  commands->modules.resize(num_modules);
+  for (auto & module : commands->modules) {
+    module.resize(n);
+  }
+  commands->saturated.resize(n);
+
+  const bool differential = (m_module_type == swerve_type_e::DIFFERENTIAL);
+  const float scaling_lin_threshold =
+    m_max_base_lin_vel * static_cast<float>(m_heuristics.velocity_scaling_threshold);
+  const float scaling_ang_threshold =
+    m_max_base_ang_vel * static_cast<float>(m_heuristics.velocity_scaling_threshold);
+  const float scaling_ratio = m_heuristics.velocity_scaling_ratio;
+  const float heuristic_start = m_heuristics.angle_heuristic_start_angle;
+  const float heuristic_slope = -1.0 /
+    (m_heuristics.angle_heuristic_end_angle - m_heuristics.angle_heuristic_start_angle);
+  const float heuristic_intercept = 1.0f - heuristic_slope * heuristic_start;
+
+  std::vector<FloatBatch> wheel_velocity(num_modules);
+  std::vector<FloatBatch> steering_velocity(num_modules);
+
+  for (std::size_t start = 0; start < n; start += SIMD_WIDTH) {
+    const std::size_t lanes = std::min<std::size_t>(SIMD_WIDTH, n - start);
+
+    // Robot frame twist, clamped and with commands under 1% zeroed
+    FloatBatch vel_x = loadBatch(twists.forward, start, lanes);
+    FloatBatch vel_y = -loadBatch(twists.right, start, lanes);
+    FloatBatch vel_norm = ghost_util::fastSqrt(vel_x * vel_x + vel_y * vel_y);
+    FloatBatch lin_vel = minBatch(vel_norm, broadcast(m_max_base_lin_vel));
+    FloatBatch ang_vel = maxBatch(
+      minBatch(-loadBatch(twists.clockwise, start, lanes), broadcast(m_max_base_ang_vel)),
+      broadcast(-m_max_base_ang_vel));
+    lin_vel = selectBatch(absBatch(lin_vel) > m_max_base_lin_vel * 0.01f, lin_vel, broadcast(0.0f));
+    ang_vel = selectBatch(absBatch(ang_vel) > m_max_base_ang_vel * 0.01f, ang_vel, broadcast(0.0f));
+
+    if (m_heuristics.velocity_scaling_enabled) {
+      IntBatch combined = (absBatch(lin_vel) > scaling_lin_threshold) &
+        (absBatch(ang_vel) > scaling_ang_threshold);
+      ang_vel = selectBatch(combined, ang_vel * scaling_ratio, ang_vel);
+    }
+
+    IntBatch moving = vel_norm != 0.0f;
+    FloatBatch inv_norm = 1.0f / selectBatch(moving, vel_norm, broadcast(1.0f));
+    FloatBatch lin_x = selectBatch(moving, vel_x * inv_norm, broadcast(0.0f)) * lin_vel;
+    FloatBatch lin_y = selectBatch(moving, vel_y * inv_norm, broadcast(0.0f)) * lin_vel;
+
+    FloatBatch max_steering_error = broadcast(0.0f);
+    for (int i = 0; i < num_modules; i++) {
+      const Eigen::Vector2f & position = m_module_positions[i];
+      ModuleCommandBatch & module = commands->modules[i];
+
+      FloatBatch module_vel_x = lin_x - ang_vel * position.y();
+      FloatBatch module_vel_y = lin_y + ang_vel * position.x();
+      FloatBatch steering_angle_command = wrapAngle360(
+        ghost_util::fastAtan2(module_vel_y, module_vel_x) *
+        static_cast<float>(ghost_util::RAD_TO_DEG));
+      FloatBatch wheel_velocity_command = ghost_util::fastSqrt(
+        module_vel_x * module_vel_x + module_vel_y * module_vel_y) * m_lin_vel_to_rpm;
+
+      // Flip modules that would otherwise steer more than 90 degrees
+      FloatBatch steering_angle = loadBatch(states[i].steering_angle, start, lanes);
+      IntBatch flip =
+        absBatch(smallestAngleDistDeg(steering_angle_command, steering_angle)) > 90.0f;
+      wheel_velocity_command = selectBatch(flip, -wheel_velocity_command, wheel_velocity_command);
+      steering_angle_command =
+        selectBatch(flip, flipAngle180(steering_angle_command), steering_angle_command);
+      FloatBatch steering_error = smallestAngleDistDeg(steering_angle_command, steering_angle);
+      max_steering_error = maxBatch(max_steering_error, absBatch(steering_error));
+
+      // Steering control law, with the integral taken from zero
+      FloatBatch error_sum = maxBatch(
+        minBatch(steering_error * m_controller_dt, broadcast(m_steering_ki_limit)),
+        broadcast(-m_steering_ki_limit));
+      FloatBatch steering_velocity_command = steering_error * m_steering_kp +
+        error_sum * m_steering_ki -
+        loadBatch(states[i].steering_velocity, start, lanes) * m_steering_kd;
+      steering_velocity_command = selectBatch(
+        absBatch(steering_error) < m_steering_control_deadzone, broadcast(0.0f),
+        steering_velocity_command);
+
+      storeBatch(steering_angle_command, module.steering_angle_command, start, lanes);
+      wheel_velocity[i] = wheel_velocity_command;
+      steering_velocity[i] = steering_velocity_command;
+    }
+
+    // Transient misalignment heuristic
+    FloatBatch attenuation = selectBatch(
+      max_steering_error > heuristic_start,
+      maxBatch(max_steering_error * heuristic_slope + heuristic_intercept, broadcast(0.0f)),
+      broadcast(1.0f));
+
+    // Actuator space commands, tracking the largest actuator velocity in each sample
+    FloatBatch max_velocity = broadcast(0.0f);
+    for (int i = 0; i < num_modules; i++) {
+      wheel_velocity[i] *= attenuation;
+      storeBatch(wheel_velocity[i], commands->modules[i].wheel_velocity_command, start, lanes);
+      storeBatch(
+        steering_velocity[i], commands->modules[i].steering_velocity_command, start, lanes);
+
+      FloatBatch actuator_0 = m_module_jacobian_inv(0, 0) * wheel_velocity[i] +
+        m_module_jacobian_inv(0, 1) * steering_velocity[i];
+      FloatBatch actuator_1 = m_module_jacobian_inv(1, 0) * wheel_velocity[i] +
+        m_module_jacobian_inv(1, 1) * steering_velocity[i];
+      max_velocity = maxBatch(max_velocity, absBatch(actuator_0));
+      if (differential) {
+        max_velocity = maxBatch(max_velocity, absBatch(actuator_1));
+      }
+      wheel_velocity[i] = actuator_0;
+      steering_velocity[i] = actuator_1;
+    }
+
+    // Normalize samples where any motor exceeds its maximum speed, and zero samples without input
+    IntBatch saturated = max_velocity > m_max_actuator_vel;
+    FloatBatch scale = selectBatch(saturated, m_max_actuator_vel / max_velocity, broadcast(1.0f));
+    IntBatch no_input = (absBatch(lin_vel) < 1e-5f) & (absBatch(ang_vel) < 1e-5f);
+    scale = selectBatch(no_input, broadcast(0.0f), scale);
+    saturated &= ~no_input;
+
+    for (int i = 0; i < num_modules; i++) {
+      auto & actuator_velocity_commands = commands->modules[i].actuator_velocity_commands;
+      FloatBatch actuator_1 = differential ?
+        steering_velocity[i] * scale :
+        selectBatch(no_input, broadcast(0.0f), steering_velocity[i]);
+      storeBatch(wheel_velocity[i] * scale, actuator_velocity_commands[0], start, lanes);
+      storeBatch(actuator_1, actuator_velocity_commands[1], start, lanes);
+    }
+    for (std::size_t lane = 0; lane < lanes; lane++) {
+      commands->saturated[start + lane] = (saturated[lane] != 0);
+    }
+  }
+}
+
+void SwerveKinematicsBatch::calculateBaseTwist(
+  const std::vector<ModuleStateBatch> & states,
+  BaseVelocityBatch * base_velocity) const
+{
+  const std::size_t n = states.empty() ? 0 : states[0].wheel_velocity.size();
+  throwOnSizeMismatch(states, n, "calculateBaseTwist");
+  base_velocity->resize(n);
+
+  const int num_modules = getNumModules();
+  const float rpm_to_lin_vel = 1.0f / m_lin_vel_to_rpm;
+  std::vector<FloatBatch> module_vel_x(num_modules);
+  std::vector<FloatBatch> module_vel_y(num_modules);
+
+  for (std::size_t start = 0; start < n; start += SIMD_WIDTH) {
+    const std::size_t lanes = std::min<std::size_t>(SIMD_WIDTH, n - start);
+
+    // Base velocity is the task space Jacobian applied to the stacked module velocities
+    FloatBatch vel_x = broadcast(0.0f);
+    FloatBatch vel_y = broadcast(0.0f);
+    FloatBatch vel_angular = broadcast(0.0f);
+    for (int i = 0; i < num_modules; i++) {
+      FloatBatch sin_steering, cos_steering;
+      ghost_util::fastSinCos(
+        loadBatch(states[i].steering_angle, start, lanes) *
+        static_cast<float>(ghost_util::DEG_TO_RAD), &sin_steering, &cos_steering);
+      FloatBatch speed = loadBatch(states[i].wheel_velocity, start, lanes) * rpm_to_lin_vel;
+      module_vel_x[i] = speed * cos_steering;
+      module_vel_y[i] = speed * sin_steering;
+
+      vel_x += m_task_space_jacobian(0, 2 * i) * module_vel_x[i] +
+        m_task_space_jacobian(0, 2 * i + 1) * module_vel_y[i];
+      vel_y += m_task_space_jacobian(1, 2 * i) * module_vel_x[i] +
+        m_task_space_jacobian(1, 2 * i + 1) * module_vel_y[i];
+      vel_angular += m_task_space_jacobian(2, 2 * i) * module_vel_x[i] +
+        m_task_space_jacobian(2, 2 * i + 1) * module_vel_y[i];
+    }
+
+    // Residual of the module velocities the base twist explains
+    FloatBatch error_sq = broadcast(0.0f);
+    for (int i = 0; i < num_modules; i++) {
+      FloatBatch residual_x = module_vel_x[i] - (vel_x - vel_angular * m_module_positions[i].y());
+      FloatBatch residual_y = module_vel_y[i] - (vel_y + vel_angular * m_module_positions[i].x());
+      error_sq += residual_x * residual_x + residual_y * residual_y;
+    }
+
+    vel_x = selectBatch(absBatch(vel_x) > 0.01f, vel_x, broadcast(0.0f));
+    vel_y = selectBatch(absBatch(vel_y) > 0.01f, vel_y, broadcast(0.0f));
+    vel_angular = selectBatch(absBatch(vel_angular) > 0.02f, vel_angular, broadcast(0.0f));
+
+    storeBatch(vel_x, base_velocity->x, start, lanes);
+    storeBatch(vel_y, base_velocity->y, start, lanes);
+    storeBatch(vel_angular, base_velocity->angular, start, lanes);
+    storeBatch(ghost_util::fastSqrt(error_sq), base_velocity->ls_error_metric, start, lanes);
+  }
+}
+
+} // namespace ghost_swerve
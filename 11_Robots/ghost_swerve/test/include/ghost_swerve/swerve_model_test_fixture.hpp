@@ -47,6 +47,16 @@ public:
     m_config.steering_kp = 0.1;
     m_config.max_wheel_actuator_vel = 600.0;
     m_config.controller_dt = 0.01;
+    m_config.steering_kd = 0.01;
+    m_config.steering_ki = 0.05;
+    m_config.steering_ki_limit = 2.0;
+    m_config.steering_control_deadzone = 1.0;
+    m_config.angle_heuristic_start_angle = 30.0;
+    m_config.angle_heuristic_end_angle = 60.0;
+    m_config.velocity_scaling_ratio = 0.5;
+    m_config.velocity_scaling_threshold = 0.7;
+    m_config.angle_control_kp = 1.0;
+    m_config.move_to_pose_kp = 1.0;
 
     // Mobile robots use forward as X, left as Y, and up as Z so that travelling forward is zero degree heading.
     // No, I don't like it either.
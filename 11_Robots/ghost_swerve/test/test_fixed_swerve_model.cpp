@@ -0,0 +1,179 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <ghost_swerve/fixed_swerve_model.hpp>
+#include <ghost_swerve/swerve_model_test_fixture.hpp>
+
+using namespace ghost_swerve::test;
+using namespace ghost_swerve;
+using namespace ghost_util;
+
+class FixedSwerveModelTestFixture : public SwerveModelTestFixture
+{
+public:
+  void SetUp() override
+  {
+    SwerveModelTestFixture::SetUp();
+    // Slew limits small enough that the controller parity tests exercise command slewing
+    m_config.max_lin_vel_slew = 0.2;
+    m_config.max_ang_vel_slew = 0.4;
+  }
+
+  static ModuleState getRandomSteeringState()
+  {
+    return ModuleState(
+      getRandomDouble(), getRandomDouble(360.0), getRandomDouble(600.0),
+      getRandomDouble(100.0));
+  }
+
+  // Both models see the same states, with the fixed model indexed in sorted name order
+  template<int N>
+  static void setStates(
+    SwerveModel & model, FixedSwerveModel<N> & fixed_model,
+    const std::array<ModuleState, N> & states)
+  {
+    for (int i = 0; i < N; i++) {
+      model.setModuleState(fixed_model.getModuleName(i), states[i]);
+      fixed_model.setModuleState(i, states[i]);
+    }
+  }
+};
+
+TEST_F(FixedSwerveModelTestFixture, testInvalidConfigThrows) {
+  m_config.module_positions.erase("back_left");
+  EXPECT_THROW(auto model = FixedSwerveModel<4>(m_config), std::runtime_error);
+  EXPECT_NO_THROW(auto model = FixedSwerveModel<3>(m_config));
+
+  m_config.wheel_radius = 0.0;
+  EXPECT_THROW(auto model = FixedSwerveModel<3>(m_config), std::runtime_error);
+}
+
+TEST_F(FixedSwerveModelTestFixture, testModuleIndicesFollowNameOrder) {
+  FixedSwerveModel<4> model(m_config);
+  EXPECT_EQ(model.getModuleIndex("back_left"), 0);
+  EXPECT_EQ(model.getModuleIndex("back_right"), 1);
+  EXPECT_EQ(model.getModuleIndex("front_left"), 2);
+  EXPECT_EQ(model.getModuleIndex("front_right"), 3);
+  EXPECT_THROW(model.getModuleIndex("middle"), std::runtime_error);
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(
+      model.getModulePosition(i).isApprox(
+        m_config.module_positions.at(model.getModuleName(i))));
+    EXPECT_EQ(model.getCurrentModuleState(i), ModuleState());
+  }
+}
+
+TEST_F(FixedSwerveModelTestFixture, testJacobiansMatchSwerveModel) {
+  for (auto type : {swerve_type_e::COAXIAL, swerve_type_e::DIFFERENTIAL}) {
+    m_config.module_type = type;
+    SwerveModel model(m_config);
+    FixedSwerveModel<4> fixed_model(m_config);
+
+    EXPECT_TRUE(fixed_model.getModuleJacobian().isApprox(model.getModuleJacobian()));
+    EXPECT_TRUE(fixed_model.getModuleJacobianInverse().isApprox(model.getModuleJacobianInverse()));
+    EXPECT_TRUE(
+      Eigen::MatrixXd(fixed_model.getTaskSpaceJacobian()).isApprox(
+        model.getTaskSpaceJacobian()));
+    EXPECT_EQ(fixed_model.getMaxBaseLinearVelocity(), model.getMaxBaseLinearVelocity());
+    EXPECT_EQ(fixed_model.getMaxBaseAngularVelocity(), model.getMaxBaseAngularVelocity());
+  }
+}
+
+TEST_F(FixedSwerveModelTestFixture, testICRMatchesSwerveModel) {
+  // Known ICR cases from test_swerve_icr, plus random steering
+  std::vector<std::array<double, 4>> steering_cases{
+    {45.0, -45.0, -45.0, 45.0},
+    {90.0, 90.0, -26.5650511771, 26.5650511771},
+    {0.0, 0.0, 90 - 26.5650511771, -(90 - 26.5650511771)},
+    {30.0, 30.0, 30.0, 30.0},
+    {30.0, 30.1, 29.9, 30.0},
+  };
+  for (int k = 0; k < 200; k++) {
+    steering_cases.push_back(
+      {getRandomDouble(360.0), getRandomDouble(360.0), getRandomDouble(360.0),
+        getRandomDouble(360.0)});
+  }
+
+  SwerveModel model(m_config);
+  FixedSwerveModel<4> fixed_model(m_config);
+  for (const auto & steering : steering_cases) {
+    std::array<ModuleState, 4> states;
+    for (int i = 0; i < 4; i++) {
+      states[i] = ModuleState(0.0, steering[i], getRandomDouble(600.0), 0.0);
+    }
+    setStates<4>(model, fixed_model, states);
+    model.updateSwerveModel();
+    fixed_model.updateSwerveModel();
+
+    Eigen::Vector2d icr, fixed_icr;
+    bool straight = model.getICR(icr);
+    EXPECT_EQ(fixed_model.getICR(fixed_icr), straight);
+    EXPECT_LT((fixed_icr - icr).norm(), 1e-6 * std::max(1.0, icr.norm()));
+    EXPECT_NEAR(fixed_model.getICRSSE(), model.getICRSSE(), 1e-6);
+    if (!std::isnan(model.getICRQuality())) {
+      EXPECT_NEAR(fixed_model.getICRQuality(), model.getICRQuality(), 1e-6);
+    }
+    EXPECT_FALSE(std::isnan(fixed_model.getICRQuality()));
+
+    EXPECT_LT((fixed_model.getBaseVelocityCurrent() - model.getBaseVelocityCurrent()).norm(), 1e-9);
+    EXPECT_NEAR(
+      fixed_model.getLeastSquaresErrorMetric(), model.getLeastSquaresErrorMetric(), 1e-9);
+    EXPECT_LT((fixed_model.getOdometryLocation() - model.getOdometryLocation()).norm(), 1e-9);
+    EXPECT_NEAR(fixed_model.getOdometryAngle(), model.getOdometryAngle(), 1e-9);
+  }
+}
+
+TEST_F(FixedSwerveModelTestFixture, testControllerMatchesSwerveModel) {
+  for (auto type : {swerve_type_e::COAXIAL, swerve_type_e::DIFFERENTIAL}) {
+    m_config.module_type = type;
+    SwerveModel model(m_config);
+    FixedSwerveModel<4> fixed_model(m_config);
+
+    for (int k = 0; k < 200; k++) {
+      std::array<ModuleState, 4> states;
+      for (auto & state : states) {
+        state = getRandomSteeringState();
+      }
+      setStates<4>(model, fixed_model, states);
+
+      double right = getRandomDouble(1.0);
+      double forward = getRandomDouble(1.0);
+      double clockwise = getRandomDouble(1.0);
+      model.calculateKinematicSwerveControllerNormalized(right, forward, clockwise);
+      fixed_model.calculateKinematicSwerveControllerNormalized(right, forward, clockwise);
+
+      EXPECT_LT(
+        (fixed_model.getBaseVelocityCommand() - model.getBaseVelocityCommand()).norm(), 1e-9);
+      for (int i = 0; i < 4; i++) {
+        const auto & expected = model.getModuleCommand(fixed_model.getModuleName(i));
+        const auto & command = fixed_model.getModuleCommand(i);
+        EXPECT_NEAR(command.steering_angle_command, expected.steering_angle_command, 1e-9);
+        EXPECT_NEAR(command.wheel_velocity_command, expected.wheel_velocity_command, 1e-9);
+        EXPECT_NEAR(command.steering_velocity_command, expected.steering_velocity_command, 1e-9);
+        EXPECT_LT(
+          (command.actuator_velocity_commands - expected.actuator_velocity_commands).norm(), 1e-9);
+      }
+    }
+  }
+}
@@ -0,0 +1,205 @@
+/*
+ *   Copyright (c) 2024 Maxx Wilson
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include <ghost_swerve/swerve_kinematics_batch.hpp>
+#include <ghost_swerve/swerve_model_test_fixture.hpp>
+
+using namespace ghost_swerve::test;
+using namespace ghost_swerve;
+using namespace ghost_util;
+
+class SwerveKinematicsBatchTestFixture : public SwerveModelTestFixture
+{
+public:
+  // Random twists within the base limits and random module states, a few hundred samples so the
+  // last SIMD batch is partial
+  void fillRandomSamples(
+    const SwerveKinematicsBatch & batch, std::size_t n,
+    BaseTwistBatch & twists, std::vector<ModuleStateBatch> & states)
+  {
+    SwerveModel model(m_config);
+    twists.resize(n);
+    states.resize(batch.getNumModules());
+    for (auto & module : states) {
+      module.resize(n);
+    }
+    for (std::size_t k = 0; k < n; k++) {
+      twists.right[k] = getRandomDouble(1.0) * model.getMaxBaseLinearVelocity();
+      twists.forward[k] = getRandomDouble(1.0) * model.getMaxBaseLinearVelocity();
+      twists.clockwise[k] = getRandomDouble(1.0) * model.getMaxBaseAngularVelocity();
+      for (auto & module : states) {
+        module.wheel_velocity[k] = getRandomDouble(600.0);
+        module.steering_angle[k] = getRandomDouble(360.0);
+        module.steering_velocity[k] = getRandomDouble(100.0);
+      }
+    }
+  }
+
+  // Runs sample k through a freshly constructed SwerveModel
+  std::shared_ptr<SwerveModel> getReferenceModel(
+    const SwerveKinematicsBatch & batch,
+    const std::vector<ModuleStateBatch> & states, std::size_t k)
+  {
+    auto model = std::make_shared<SwerveModel>(m_config);
+    for (int i = 0; i < batch.getNumModules(); i++) {
+      model->setModuleState(
+        batch.getModuleName(i),
+        ModuleState(
+          0.0, states[i].steering_angle[k], states[i].wheel_velocity[k],
+          states[i].steering_velocity[k]));
+    }
+    return model;
+  }
+
+  void checkControllerMatchesSwerveModel(bool heuristics_enabled)
+  {
+    SwerveKinematicsBatch batch(m_config);
+    auto params = batch.getHeuristicParams();
+    params.velocity_scaling_enabled = heuristics_enabled;
+    batch.setHeuristicParams(params);
+
+    BaseTwistBatch twists;
+    std::vector<ModuleStateBatch> states;
+    fillRandomSamples(batch, 301, twists, states);
+
+    SwerveCommandBatch commands;
+    batch.calculateKinematicSwerveControllerVelocity(twists, states, &commands);
+    ASSERT_EQ(commands.modules.size(), 4);
+    ASSERT_EQ(commands.saturated.size(), twists.size());
+
+    for (std::size_t k = 0; k < twists.size(); k++) {
+      auto model = getReferenceModel(batch, states, k);
+      if (!heuristics_enabled) {
+        model->disableSwerveHeuristics();
+      }
+      model->calculateKinematicSwerveControllerVelocity(
+        twists.right[k], twists.forward[k], twists.clockwise[k]);
+
+      double max_actuator_velocity = 0.0;
+      for (int i = 0; i < 4; i++) {
+        const auto & expected = model->getModuleCommand(batch.getModuleName(i));
+        const auto & module = commands.modules[i];
+        EXPECT_NEAR(
+          SmallestAngleDistDeg(module.steering_angle_command[k], expected.steering_angle_command),
+          0.0, 1e-3);
+        EXPECT_NEAR(
+          module.wheel_velocity_command[k], expected.wheel_velocity_command,
+          1e-3 + 1e-4 * std::fabs(expected.wheel_velocity_command));
+        EXPECT_NEAR(
+          module.steering_velocity_command[k], expected.steering_velocity_command, 1e-3);
+        for (int a = 0; a < 2; a++) {
+          EXPECT_NEAR(
+            module.actuator_velocity_commands[a][k], expected.actuator_velocity_commands[a],
+            1e-3 + 1e-4 * std::fabs(expected.actuator_velocity_commands[a]));
+          max_actuator_velocity = std::max<double>(
+            max_actuator_velocity, std::fabs(module.actuator_velocity_commands[a][k]));
+        }
+      }
+      if (commands.saturated[k]) {
+        EXPECT_NEAR(max_actuator_velocity, m_config.max_wheel_actuator_vel, 1e-2);
+      }
+    }
+  }
+};
+
+TEST_F(SwerveKinematicsBatchTestFixture, testModuleIndicesFollowNameOrder) {
+  SwerveKinematicsBatch batch(m_config);
+  EXPECT_EQ(batch.getNumModules(), 4);
+  EXPECT_EQ(batch.getModuleIndex("back_left"), 0);
+  EXPECT_EQ(batch.getModuleIndex("front_right"), 3);
+  EXPECT_THROW(batch.getModuleIndex("middle"), std::runtime_error);
+}
+
+TEST_F(SwerveKinematicsBatchTestFixture, testSizeMismatchThrows) {
+  SwerveKinematicsBatch batch(m_config);
+  BaseTwistBatch twists;
+  std::vector<ModuleStateBatch> states;
+  fillRandomSamples(batch, 10, twists, states);
+  SwerveCommandBatch commands;
+
+  states[2].steering_angle.resize(9);
+  EXPECT_THROW(
+    batch.calculateKinematicSwerveControllerVelocity(twists, states, &commands),
+    std::runtime_error);
+
+  states.pop_back();
+  BaseVelocityBatch base_velocity;
+  EXPECT_THROW(batch.calculateBaseTwist(states, &base_velocity), std::runtime_error);
+}
+
+TEST_F(SwerveKinematicsBatchTestFixture, testCoaxialControllerMatchesSwerveModel) {
+  m_config.module_type = swerve_type_e::COAXIAL;
+  checkControllerMatchesSwerveModel(true);
+  checkControllerMatchesSwerveModel(false);
+}
+
+TEST_F(SwerveKinematicsBatchTestFixture, testDifferentialControllerMatchesSwerveModel) {
+  m_config.module_type = swerve_type_e::DIFFERENTIAL;
+  checkControllerMatchesSwerveModel(true);
+  checkControllerMatchesSwerveModel(false);
+}
+
+TEST_F(SwerveKinematicsBatchTestFixture, testSaturatedSamplesAreFlagged) {
+  m_config.module_type = swerve_type_e::COAXIAL;
+  SwerveKinematicsBatch batch(m_config);
+  BaseTwistBatch twists;
+  std::vector<ModuleStateBatch> states(4);
+  twists.resize(3);
+  for (auto & module : states) {
+    module.resize(3);
+  }
+
+  // Full speed forward with aligned modules saturates, a slow one doesn't, no input never does
+  twists.forward = {static_cast<float>(m_config.max_wheel_lin_vel), 0.1, 0.0};
+
+  SwerveCommandBatch commands;
+  batch.calculateKinematicSwerveControllerVelocity(twists, states, &commands);
+  EXPECT_TRUE(commands.saturated[0]);
+  EXPECT_FALSE(commands.saturated[1]);
+  EXPECT_FALSE(commands.saturated[2]);
+  for (const auto & module : commands.modules) {
+    EXPECT_NEAR(module.actuator_velocity_commands[0][0], m_config.max_wheel_actuator_vel, 1e-2);
+    EXPECT_EQ(module.actuator_velocity_commands[0][2], 0.0);
+  }
+}
+
+TEST_F(SwerveKinematicsBatchTestFixture, testBaseTwistMatchesSwerveModel) {
+  SwerveKinematicsBatch batch(m_config);
+  BaseTwistBatch twists;
+  std::vector<ModuleStateBatch> states;
+  fillRandomSamples(batch, 301, twists, states);
+
+  BaseVelocityBatch base_velocity;
+  batch.calculateBaseTwist(states, &base_velocity);
+  ASSERT_EQ(base_velocity.x.size(), twists.size());
+
+  for (std::size_t k = 0; k < twists.size(); k++) {
+    auto model = getReferenceModel(batch, states, k);
+    model->updateSwerveModel();
+    const auto & expected = model->getBaseVelocityCurrent();
+    EXPECT_NEAR(base_velocity.x[k], expected.x(), 1e-4);
+    EXPECT_NEAR(base_velocity.y[k], expected.y(), 1e-4);
+    EXPECT_NEAR(base_velocity.angular[k], expected.z(), 1e-4);
+    EXPECT_NEAR(base_velocity.ls_error_metric[k], model->getLeastSquaresErrorMetric(), 1e-4);
+  }
+}